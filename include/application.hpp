@@ -4,6 +4,7 @@
 #include "main_ui.hpp"
 #include "sys_check.hpp"
 #include "i18n.hpp"
+#include "core/metrics.hpp"
 #include <mini/ini.h>
 
 namespace Win11SysCheck
@@ -23,6 +24,7 @@ namespace Win11SysCheck
 		auto GetUI() const		 { return m_spUI.get(); };
 		auto GetI18N() const	 { return m_spI18N.get(); };
 		auto GetSysCheck() const { return m_spSysCheck.get(); };
+		auto GetMetrics() const	 { return m_spMetrics.get(); };
 		auto GetConfigFile()	 { return m_pConfigFile; };
 		auto& GetConfigContext() { return m_pConfigContext; };
 
@@ -31,6 +33,7 @@ namespace Win11SysCheck
 		std::shared_ptr <gui::CMainUI>	m_spUI;
 		std::shared_ptr <CI18N>			m_spI18N;
 		std::shared_ptr <CSysCheck>		m_spSysCheck;
+		std::shared_ptr <CMetricsRegistry> m_spMetrics;
 		mINI::INIFile					m_pConfigFile;
 		mINI::INIStructure				m_pConfigContext;
 	};
@@ -0,0 +1,99 @@
+#pragma once
+#include "probe_result.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	// Bumped whenever the encoding changes, readers refuse other versions
+	static constexpr uint8_t BINARY_REPORT_VERSION = 2;
+
+	// Section mask bits are indexed by EMenuType
+	static constexpr uint16_t GetSectionBit(EMenuType nType) { return static_cast<uint16_t>(1u << static_cast<uint8_t>(nType)); };
+	static constexpr uint16_t BINARY_REPORT_ALL_SECTIONS =
+		GetSectionBit(EMenuType::MENU_TYPE_OS) | GetSectionBit(EMenuType::MENU_TYPE_BOOT) | GetSectionBit(EMenuType::MENU_TYPE_CPU) |
+		GetSectionBit(EMenuType::MENU_TYPE_RAM) | GetSectionBit(EMenuType::MENU_TYPE_DISK) | GetSectionBit(EMenuType::MENU_TYPE_DISPLAY) |
+		GetSectionBit(EMenuType::MENU_TYPE_INTERNET);
+	// Mask bit 0 has no section, it marks delta reports: the masked sections changed, the others are as in the base
+	static constexpr uint16_t BINARY_REPORT_DELTA = GetSectionBit(EMenuType::MENU_TYPE_UNKNOWN);
+
+	// LEB128, signed values are zigzag mapped first
+	void AppendVarint(std::string& stBuffer, uint64_t nValue);
+	bool ReadVarint(const char*& pData, const char* pEnd, uint64_t& nValue);
+
+	// "os,cpu,display" -> mask, unknown names fail
+	bool ParseSectionMask(const std::string& stSections, uint16_t& nSectionMask);
+
+	// Batch layout: [version u8][report count][string count][strings: length, bytes][reports]
+	// Report layout: [machine id][section mask][statuses, two bits per menu type][base digest u64, delta reports only]
+	//	[masked sections in menu order]
+	// Every integer is a varint and every string an index into the batch string table, so vendor, CPU,
+	// file system and adapter names repeating across a batch are sent once. Sections outside the mask
+	// are left out and decode to their defaults.
+	class CBinaryReportWriter
+	{
+	public:
+		explicit CBinaryReportWriter(uint16_t nSectionMask = BINARY_REPORT_ALL_SECTIONS);
+		~CBinaryReportWriter() = default;
+
+		void Add(const SProbeResult& result, uint64_t nMachineId);
+		void Add(const SProbeResult& result, uint64_t nMachineId, uint16_t nSectionMask);
+		// Only the changed sections are written, none makes a heartbeat
+		void AddDelta(const SProbeResult& result, uint64_t nMachineId, uint16_t nChangedSections, uint64_t nBaseDigest);
+
+		size_t GetReportCount() const { return m_nReportCount; };
+		// Bytes Finish would append, for callers cutting batches by size
+		size_t GetEncodedSize() const;
+
+		// Appends the batch and starts a new one
+		void Finish(std::string& stBuffer);
+
+	protected:
+		void __AddReport(const SProbeResult& result, uint64_t nMachineId, uint16_t nSectionMask, uint64_t nBaseDigest);
+		void __AppendString(const std::string& stValue);
+
+	private:
+		uint16_t m_nSectionMask;
+		size_t m_nReportCount{ 0 };
+		std::string m_stBody;
+		std::vector <std::string> m_vStrings;
+		std::unordered_map <std::string, uint32_t> m_mapStrings;
+		size_t m_nStringBytes{ 0 };
+	};
+
+	class CBinaryReportReader
+	{
+	public:
+		CBinaryReportReader() = default;
+		~CBinaryReportReader() = default;
+
+		// The data must outlive the reader
+		bool Open(const char* pData, size_t nSize);
+		// False once every report is read or the batch turns out to be malformed
+		bool Next(SProbeResult& result, uint64_t& nMachineId, uint16_t* pnSectionMask = nullptr, uint64_t* pnBaseDigest = nullptr);
+
+		size_t GetReportCount() const { return m_nReportCount; };
+		bool IsCorrupt() const { return m_bCorrupt; };
+
+	protected:
+		bool __ReadNumber(uint64_t& nValue);
+		template <class T>
+		bool __Read(T& value);
+		bool __ReadString(std::string& stValue);
+		bool __ReadSections(SProbeResult& result, uint16_t nSectionMask);
+
+	private:
+		const char* m_pCursor{ nullptr };
+		const char* m_pEnd{ nullptr };
+		size_t m_nReportCount{ 0 };
+		size_t m_nReadCount{ 0 };
+		std::vector <std::string> m_vStrings;
+		bool m_bCorrupt{ false };
+	};
+
+	// Single report batches
+	void EncodeBinaryReport(const SProbeResult& result, uint64_t nMachineId, std::string& stBuffer, uint16_t nSectionMask = BINARY_REPORT_ALL_SECTIONS);
+	bool DecodeBinaryReport(const char* pData, size_t nSize, SProbeResult& result, uint64_t& nMachineId);
+};
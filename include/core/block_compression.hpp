@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	static constexpr uint32_t COMPRESSION_BLOCK_SIZE = 64 * 1024;
+	static constexpr uint32_t COMPRESSION_MAX_BLOCK_SIZE = 4 * 1024 * 1024;
+	static constexpr size_t COMPRESSION_STREAM_HEADER_SIZE = 8;
+	static constexpr size_t COMPRESSION_BLOCK_HEADER_SIZE = 12;
+	static constexpr size_t COMPRESSION_STREAM_TRAILER_SIZE = 12;
+	static constexpr const char* COMPRESSED_FILE_SUFFIX = ".w11z";
+
+	// Castagnoli polynomial, the SSE4.2 crc32 instruction is used when the processor has it
+	uint32_t ComputeCrc32c(const char* pData, size_t nSize, uint32_t nCrc = 0);
+
+	// Worst case size of a compressed block, incompressible input grows by about 0.4%
+	constexpr size_t GetCompressBound(size_t nSize)
+	{
+		return nSize + nSize / 255 + 16;
+	}
+
+	// LZ4 block format: greedy single hash matcher, 64 KB window. The table holds one entry per
+	// hash bucket and is overwritten by every call, the destination needs GetCompressBound bytes.
+	size_t CompressBlock(const char* pSource, size_t nSize, char* pDestination, std::vector <uint32_t>& vHashTable);
+	// Bounds checked, fails on any reference outside the source or destination
+	bool DecompressBlock(const char* pSource, size_t nSize, char* pDestination, size_t nCapacity, size_t& nWritten);
+
+	// Stream layout: header [magic "W11Z"][version u8][block size log2 u8][reserved u16], blocks
+	// [stored size u32, high bit set when stored raw][raw size u32][crc32c of the raw data u32][data],
+	// trailer [zero u32][content size u64]. A stream missing its trailer is truncated.
+	bool IsCompressedStream(const char* pData, size_t nSize);
+
+	class CStreamCompressor
+	{
+	public:
+		explicit CStreamCompressor(uint32_t nBlockSize = COMPRESSION_BLOCK_SIZE);
+		~CStreamCompressor() = default;
+
+		// Complete blocks are compressed and appended to the output, the header goes first
+		void Append(const char* pData, size_t nSize, std::string& stOutput);
+		// Compresses what is buffered and writes the trailer
+		void Finish(std::string& stOutput);
+		void Reset();
+
+		uint64_t GetContentSize() const { return m_nContentSize; };
+
+	protected:
+		void __WriteHeader(std::string& stOutput);
+		void __CompressBlock(const char* pData, size_t nSize, std::string& stOutput);
+
+	private:
+		uint32_t m_nBlockSize;
+		bool m_bStarted{ false };
+		uint64_t m_nContentSize{ 0 };
+		std::string m_stBlock;
+		std::vector <uint32_t> m_vHashTable;
+	};
+
+	// Decodes a stream fed in arbitrary pieces, every block is verified against its checksum
+	class CStreamDecompressor
+	{
+	public:
+		CStreamDecompressor() = default;
+		~CStreamDecompressor() = default;
+
+		// Decoded data is appended to the output, errors are sticky
+		bool Append(const char* pData, size_t nSize, std::string& stOutput);
+		void Reset();
+
+		bool IsFinished() const { return m_bFinished; };
+		bool IsCorrupt() const { return m_bCorrupt; };
+
+	private:
+		std::string m_stBuffer;
+		size_t m_nOffset{ 0 };
+		uint32_t m_nBlockSize{ 0 };
+		uint64_t m_nContentSize{ 0 };
+		bool m_bFinished{ false };
+		bool m_bCorrupt{ false };
+	};
+
+	// Whole stream at once, fails unless the stream ends with its trailer
+	bool DecompressStream(const char* pData, size_t nSize, std::string& stOutput);
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	static constexpr uint32_t BLOCKER_SKETCH_DEFAULT_CAPACITY = 256;
+	static constexpr uint32_t BLOCKER_SKETCH_DEFAULT_WIDTH = 4096;
+	static constexpr uint32_t BLOCKER_SKETCH_DEFAULT_DEPTH = 4;
+
+	struct SHeavyHitter
+	{
+		std::string stKey;
+		uint64_t nCount{ 0 }; // Never below the true count
+		uint64_t nError{ 0 }; // nCount - nError is never above the true count
+	};
+
+	// Space-Saving summary: keeps at most nCapacity counters, a new key takes over the smallest one
+	// and inherits its count as error. Every key seen more than total / capacity times is kept.
+	class CSpaceSaving
+	{
+	public:
+		explicit CSpaceSaving(uint32_t nCapacity = BLOCKER_SKETCH_DEFAULT_CAPACITY);
+		~CSpaceSaving() = default;
+
+		void Offer(const std::string& stKey, uint64_t nCount = 1);
+		// Counts of keys missing from one side are bounded by that side's smallest counter
+		void Merge(const CSpaceSaving& other);
+
+		// Largest counters first
+		std::vector <SHeavyHitter> GetTop(size_t nCount) const;
+		const SHeavyHitter* Find(const std::string& stKey) const;
+
+		uint32_t GetCapacity() const { return m_nCapacity; };
+		uint64_t GetTotal() const { return m_nTotal; };
+
+		void Serialize(std::string& stBuffer) const;
+		bool Deserialize(const char* pData, size_t nSize, size_t& nOffset);
+
+	protected:
+		uint64_t __GetMinCount() const;
+		void __SiftUp(size_t nIndex);
+		void __SiftDown(size_t nIndex);
+		void __Swap(size_t nLeft, size_t nRight);
+
+	private:
+		uint32_t m_nCapacity;
+		uint64_t m_nTotal{ 0 };
+		std::vector <SHeavyHitter> m_vHeap; // Min-heap on nCount
+		std::unordered_map <std::string, size_t> m_mapSlots;
+	};
+
+	// Count-Min sketch: nDepth rows of nWidth counters, estimates never undercount and overcount by
+	// at most e / width * total with probability 1 - exp(-depth)
+	class CCountMinSketch
+	{
+	public:
+		CCountMinSketch(uint32_t nWidth = BLOCKER_SKETCH_DEFAULT_WIDTH, uint32_t nDepth = BLOCKER_SKETCH_DEFAULT_DEPTH);
+		~CCountMinSketch() = default;
+
+		void Add(const std::string& stKey, uint64_t nCount = 1);
+		uint64_t Estimate(const std::string& stKey) const;
+		// Both sketches must have the same dimensions
+		bool Merge(const CCountMinSketch& other);
+
+		uint32_t GetWidth() const { return m_nWidth; };
+		uint32_t GetDepth() const { return m_nDepth; };
+
+		void Serialize(std::string& stBuffer) const;
+		bool Deserialize(const char* pData, size_t nSize, size_t& nOffset);
+
+	protected:
+		static uint64_t __Hash(const std::string& stKey);
+
+	private:
+		uint32_t m_nWidth;
+		uint32_t m_nDepth;
+		std::vector <uint64_t> m_vCounters;
+	};
+
+	// Fleet wide blocker statistics fed with one ExplainReadiness record per machine, memory only
+	// depends on the sketch dimensions so shards can run forever and be merged at any time
+	class CBlockerAggregator
+	{
+	public:
+		CBlockerAggregator(uint32_t nCapacity = BLOCKER_SKETCH_DEFAULT_CAPACITY, uint32_t nWidth = BLOCKER_SKETCH_DEFAULT_WIDTH, uint32_t nDepth = BLOCKER_SKETCH_DEFAULT_DEPTH);
+		~CBlockerAggregator() = default;
+
+		void Add(const std::vector <std::string>& vReasons);
+		bool Merge(const CBlockerAggregator& other);
+
+		// Space-Saving candidates with their count tightened by the Count-Min estimate
+		std::vector <SHeavyHitter> GetTopBlockers(size_t nCount) const;
+		uint64_t EstimateBlocker(const std::string& stKey) const;
+
+		uint64_t GetMachineCount() const { return m_nMachineCount; };
+		uint64_t GetBlockedCount() const { return m_nBlockedCount; };
+
+		bool Save(const std::string& stFileName) const;
+		bool Load(const std::string& stFileName);
+
+	private:
+		uint64_t m_nMachineCount{ 0 };
+		uint64_t m_nBlockedCount{ 0 };
+		CSpaceSaving m_kTopK;
+		CCountMinSketch m_kCounts;
+	};
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "hardware_fingerprint.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	// Bloom filter over hardware fingerprints. The fingerprint already is a 128 bit hash so the
+	// k probe positions are derived as low + i * high without hashing again.
+	class CBloomFilter
+	{
+	public:
+		CBloomFilter() = default;
+		~CBloomFilter() = default;
+
+		// Sized for nExpectedCount items at the requested false positive rate
+		static CBloomFilter ForFalsePositiveRate(uint64_t nExpectedCount, double dFalsePositiveRate);
+		// Fixed size, the probe count is chosen for nExpectedCount items
+		static CBloomFilter ForBitCount(uint64_t nBitCount, uint64_t nExpectedCount);
+
+		void Insert(const SHardwareFingerprint& fingerprint);
+		bool MayContain(const SHardwareFingerprint& fingerprint) const;
+
+		bool IsEmpty() const { return m_vWords.empty(); };
+		uint64_t GetBitCount() const { return m_nBitCount; };
+		uint32_t GetHashCount() const { return m_nHashCount; };
+		uint64_t GetItemCount() const { return m_nItemCount; };
+		// Expected false positive rate for the items inserted so far
+		double GetEstimatedFalsePositiveRate() const;
+
+		// Publisher defined generation, agents can refuse to downgrade
+		uint64_t GetVersion() const { return m_nVersion; };
+		void SetVersion(uint64_t nVersion) { m_nVersion = nVersion; };
+
+		bool Save(const std::string& stFileName) const;
+		// Also fails when the filter was built for another hardware profile encoding
+		bool Load(const std::string& stFileName);
+
+	protected:
+		void __Init(uint64_t nBitCount, uint32_t nHashCount);
+
+	private:
+		uint64_t m_nBitCount{ 0 };
+		uint32_t m_nHashCount{ 0 };
+		uint64_t m_nItemCount{ 0 };
+		uint64_t m_nVersion{ 0 };
+		std::vector <uint64_t> m_vWords;
+	};
+};
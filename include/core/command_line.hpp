@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	// "--name=value" options, "--name" flags, everything else is positional
+	class CCommandLine
+	{
+	public:
+		CCommandLine(int argc, char* argv[], int nFirstArg = 1);
+		~CCommandLine() = default;
+
+		bool Has(const std::string& stName) const;
+		std::string Get(const std::string& stName, const std::string& stDefault = "") const;
+		uint64_t GetNumber(const std::string& stName, uint64_t nDefault = 0) const;
+		double GetDouble(const std::string& stName, double dDefault = 0.0) const;
+
+		const auto& GetPositionals() const { return m_vPositionals; };
+
+	private:
+		std::map <std::string, std::string> m_mapOptions;
+		std::vector <std::string> m_vPositionals;
+	};
+};
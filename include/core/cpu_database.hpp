@@ -0,0 +1,152 @@
+#pragma once
+#include "probe_result.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Win11SysCheck
+{
+	enum class ECPUVendor : uint8_t
+	{
+		CPU_VENDOR_UNKNOWN,
+		CPU_VENDOR_INTEL,
+		CPU_VENDOR_AMD,
+		CPU_VENDOR_QUALCOMM,
+		CPU_VENDOR_MAX
+	};
+
+	enum class ECPUSupport : uint8_t
+	{
+		CPU_SUPPORT_UNKNOWN,
+		CPU_SUPPORT_SUPPORTED,
+		CPU_SUPPORT_UNSUPPORTED
+	};
+
+	enum class ECPUMatch : uint8_t
+	{
+		CPU_MATCH_NONE,
+		CPU_MATCH_MODEL_NAME,
+		CPU_MATCH_SIGNATURE
+	};
+
+	// How sure the classification is. Name matches: high for a whole token the signature agrees with,
+	// medium when the signature of the silicon is listed as unsupported, low for a key inside a longer
+	// token. Signature matches: medium for a row of the exact stepping, low for a row with a wildcard
+	// model or stepping, which covers parts the lists may not.
+	enum class ECPUMatchConfidence : uint8_t
+	{
+		CPU_CONFIDENCE_NONE,
+		CPU_CONFIDENCE_LOW,
+		CPU_CONFIDENCE_MEDIUM,
+		CPU_CONFIDENCE_HIGH
+	};
+
+	// Normalized model tokens are at most 15 characters, e.g. "I58250U" or "X1E78100"
+	static constexpr size_t CPU_MODEL_KEY_SIZE = 16;
+	// Wildcards of the signature table, see data/cpu/signatures.csv
+	static constexpr uint16_t CPU_SIGNATURE_ANY_MODEL = 0xFFFF;
+	static constexpr uint8_t CPU_SIGNATURE_ANY_STEPPING = 0xFF;
+
+	// Slots of the generated tables, a zero vendor marks an empty one
+	struct SCPUModelEntry
+	{
+		ECPUVendor nVendor;
+		uint8_t nLength;
+		char szKey[CPU_MODEL_KEY_SIZE];
+		const char* szName;
+	};
+
+	struct SCPUSignatureEntry
+	{
+		uint64_t nKey;
+		ECPUSupport nSupport;
+	};
+
+	struct SCPUClassification
+	{
+		ECPUVendor nVendor{ ECPUVendor::CPU_VENDOR_UNKNOWN };
+		ECPUSupport nSupport{ ECPUSupport::CPU_SUPPORT_UNKNOWN };
+		ECPUMatch nMatch{ ECPUMatch::CPU_MATCH_NONE };
+		ECPUMatchConfidence nConfidence{ ECPUMatchConfidence::CPU_CONFIDENCE_NONE };
+		const char* szModel{ "" }; // Brand and model of the matched list entry
+	};
+
+	// Accepts the CPUID vendor strings and the manufacturer names of the supported-processor lists
+	constexpr ECPUVendor GetCPUVendor(std::string_view stVendor)
+	{
+		if (stVendor == "GenuineIntel" || stVendor == "Intel")
+			return ECPUVendor::CPU_VENDOR_INTEL;
+		if (stVendor == "AuthenticAMD" || stVendor == "AMD")
+			return ECPUVendor::CPU_VENDOR_AMD;
+		if (stVendor.find("Qualcomm") != std::string_view::npos)
+			return ECPUVendor::CPU_VENDOR_QUALCOMM;
+		return ECPUVendor::CPU_VENDOR_UNKNOWN;
+	}
+
+	constexpr bool IsCPUModelTokenChar(char c)
+	{
+		return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.';
+	}
+
+	// Uppercased with the dashes dropped, so "i5-8250U" of the lists and of a processor name meet.
+	// Returns zero for a token that does not fit a key.
+	constexpr size_t NormalizeCPUModelToken(const char* pToken, size_t nLength, char* pKey)
+	{
+		size_t nKeyLength = 0;
+		for (size_t i = 0; i < nLength; ++i)
+		{
+			auto c = pToken[i];
+			if (c == '-')
+				continue;
+			if (nKeyLength == CPU_MODEL_KEY_SIZE - 1)
+				return 0;
+			if (c >= 'a' && c <= 'z')
+				c = static_cast<char>(c - 'a' + 'A');
+			pKey[nKeyLength++] = c;
+		}
+		return nKeyLength;
+	}
+
+	constexpr uint64_t MixCPUKey(uint64_t nValue)
+	{
+		nValue ^= nValue >> 33;
+		nValue *= 0xFF51AFD7ED558CCDull;
+		nValue ^= nValue >> 33;
+		nValue *= 0xC4CEB9FE1A85EC53ull;
+		return nValue ^ (nValue >> 33);
+	}
+
+	constexpr uint64_t HashCPUModelKey(ECPUVendor nVendor, const char* pKey, size_t nLength)
+	{
+		auto nHash = 0xCBF29CE484222325ull ^ static_cast<uint64_t>(nVendor);
+		for (size_t i = 0; i < nLength; ++i)
+			nHash = (nHash ^ static_cast<uint8_t>(pKey[i])) * 0x100000001B3ull;
+		return MixCPUKey(nHash);
+	}
+
+	constexpr uint64_t GetCPUSignatureKey(ECPUVendor nVendor, uint16_t nFamily, uint16_t nModel, uint8_t nStepping)
+	{
+		return (static_cast<uint64_t>(nVendor) << 40) | (static_cast<uint64_t>(nFamily) << 24) | (static_cast<uint64_t>(nModel) << 8) | nStepping;
+	}
+
+	// Hash and displace: the high half of the hash picks a bucket, the seed of the bucket moves its
+	// keys to free slots. The generator searched the seeds, a lookup is one probe.
+	constexpr uint32_t GetPerfectHashBucket(uint64_t nHash, uint32_t nBucketMask)
+	{
+		return static_cast<uint32_t>(nHash >> 32) & nBucketMask;
+	}
+	constexpr uint32_t GetPerfectHashSlot(uint64_t nHash, uint32_t nSeed, uint32_t nSlotMask)
+	{
+		return static_cast<uint32_t>(MixCPUKey(nHash + nSeed * 0x9E3779B97F4A7C15ull)) & nSlotMask;
+	}
+
+	// Both take normalized keys, neither allocates
+	const SCPUModelEntry* FindCPUModel(ECPUVendor nVendor, const char* pKey, size_t nLength);
+	// pbExactStepping tells whether the deciding row names the stepping rather than a wildcard
+	ECPUSupport FindCPUSignature(ECPUVendor nVendor, uint16_t nFamily, uint16_t nModel, uint8_t nStepping, bool* pbExactStepping = nullptr);
+	size_t GetCPUModelCount();
+
+	// A model of the supported-processor lists found as a whole token of the name wins, otherwise
+	// the most specific signature row of family, model and stepping decides
+	SCPUClassification ClassifyProcessor(const SCPUFacts& facts);
+};
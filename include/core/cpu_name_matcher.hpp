@@ -0,0 +1,53 @@
+#pragma once
+#include "cpu_database.hpp"
+#include <array>
+#include <string_view>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	struct SCPUNameMatch
+	{
+		const SCPUModelEntry* pModel{ nullptr };
+		bool bWholeToken{ false }; // False when the key only occurs inside a longer token
+	};
+
+	// Aho-Corasick automaton over the normalized model keys of every vendor, with the failure links
+	// folded into a dense transition table. One pass over the name strips "(R)", "(TM)" and "(C)",
+	// drops dashes, stops at the "@ x GHz" clock suffix and advances the automaton.
+	class CCPUNameMatcher
+	{
+	public:
+		CCPUNameMatcher();
+		~CCPUNameMatcher() = default;
+
+		void Add(const SCPUModelEntry& entry);
+		// Fails when the keys need more states than the 16 bit transitions address
+		bool Build();
+
+		// Whole token matches win over partial ones, then longer keys; an unknown vendor takes any
+		bool Match(std::string_view stName, ECPUVendor nVendor, SCPUNameMatch& match) const;
+
+		size_t GetStateCount() const { return m_vPatterns.size(); };
+		size_t GetKeyCount() const { return m_vKeys.size(); };
+
+	protected:
+		uint16_t __AddState();
+
+	private:
+		struct SKey
+		{
+			uint8_t nLength;
+			std::array <const SCPUModelEntry*, static_cast<size_t>(ECPUVendor::CPU_VENDOR_MAX)> arEntries;
+		};
+
+		std::vector <uint16_t> m_vTransitions;
+		std::vector <int16_t> m_vPatterns; // Key ending in the state, -1 for none
+		std::vector <uint16_t> m_vOutputLinks; // Next state on the failure chain that ends a key
+		std::vector <SKey> m_vKeys;
+		bool m_bBuilt{ false };
+	};
+
+	// Built once, on first use, from the generated supported-model table
+	const CCPUNameMatcher& GetCPUNameMatcher();
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace Win11SysCheck
+{
+	// Bit positions of the feature set, only ever appended: the value is exported and stored
+	enum class ECPUFeature : uint8_t
+	{
+		CPU_FEATURE_SSE2,
+		CPU_FEATURE_SSE3,
+		CPU_FEATURE_SSSE3,
+		CPU_FEATURE_SSE41,
+		CPU_FEATURE_SSE42,
+		CPU_FEATURE_POPCNT,
+		CPU_FEATURE_CX16,
+		CPU_FEATURE_LAHF_SAHF,
+		CPU_FEATURE_PREFETCHW,
+		CPU_FEATURE_LZCNT,
+		CPU_FEATURE_MOVBE,
+		CPU_FEATURE_PCLMULQDQ,
+		CPU_FEATURE_AES,
+		CPU_FEATURE_SHA,
+		CPU_FEATURE_RDRAND,
+		CPU_FEATURE_RDSEED,
+		CPU_FEATURE_XSAVE,
+		CPU_FEATURE_OSXSAVE,
+		CPU_FEATURE_AVX,
+		CPU_FEATURE_F16C,
+		CPU_FEATURE_FMA3,
+		CPU_FEATURE_AVX2,
+		CPU_FEATURE_BMI1,
+		CPU_FEATURE_BMI2,
+		CPU_FEATURE_AVX512F,
+		CPU_FEATURE_AVX512DQ,
+		CPU_FEATURE_AVX512CD,
+		CPU_FEATURE_AVX512BW,
+		CPU_FEATURE_AVX512VL,
+		CPU_FEATURE_NX,
+		CPU_FEATURE_LONG_MODE,
+		CPU_FEATURE_HYPERVISOR,
+		CPU_FEATURE_MAX
+	};
+	static_assert(static_cast<size_t>(ECPUFeature::CPU_FEATURE_MAX) <= 64, "Feature set is 64 bits wide");
+
+	constexpr uint64_t GetCPUFeatureBit(ECPUFeature nFeature)
+	{
+		return 1ull << static_cast<uint8_t>(nFeature);
+	}
+
+	// Instructions Windows 11 24H2 does not boot without, on top of the CMPXCHG16B and LAHF/SAHF x64 Windows
+	// has needed since 8.1. PREFETCHW is left out: Intel parts before Broadwell execute it without reporting it.
+	static constexpr uint64_t CPU_FEATURES_24H2_REQUIRED =
+		GetCPUFeatureBit(ECPUFeature::CPU_FEATURE_SSE42) | GetCPUFeatureBit(ECPUFeature::CPU_FEATURE_POPCNT) |
+		GetCPUFeatureBit(ECPUFeature::CPU_FEATURE_CX16) | GetCPUFeatureBit(ECPUFeature::CPU_FEATURE_LAHF_SAHF);
+
+	// Zero stands for "not read": ARM64 machines, exports from before the collector, profiles
+	class CCPUFeatureSet
+	{
+	public:
+		constexpr CCPUFeatureSet() = default;
+		constexpr explicit CCPUFeatureSet(uint64_t nBits) : m_nBits(nBits) {};
+
+		constexpr bool IsKnown() const { return m_nBits != 0; };
+		constexpr bool Has(ECPUFeature nFeature) const { return (m_nBits & GetCPUFeatureBit(nFeature)) != 0; };
+		constexpr void Set(ECPUFeature nFeature, bool bPresent = true) { m_nBits = bPresent ? m_nBits | GetCPUFeatureBit(nFeature) : m_nBits & ~GetCPUFeatureBit(nFeature); };
+		constexpr uint64_t GetBits() const { return m_nBits; };
+
+		constexpr bool HasSSE42() const { return Has(ECPUFeature::CPU_FEATURE_SSE42); };
+		constexpr bool HasPOPCNT() const { return Has(ECPUFeature::CPU_FEATURE_POPCNT); };
+		constexpr bool HasCX16() const { return Has(ECPUFeature::CPU_FEATURE_CX16); };
+		constexpr bool HasLAHFSAHF() const { return Has(ECPUFeature::CPU_FEATURE_LAHF_SAHF); };
+		constexpr bool HasPREFETCHW() const { return Has(ECPUFeature::CPU_FEATURE_PREFETCHW); };
+		constexpr bool HasAVX2() const { return Has(ECPUFeature::CPU_FEATURE_AVX2); };
+		constexpr bool HasAVX512F() const { return Has(ECPUFeature::CPU_FEATURE_AVX512F); };
+		constexpr bool IsHypervisorPresent() const { return Has(ECPUFeature::CPU_FEATURE_HYPERVISOR); };
+
+		// Required bits the set lacks, zero for an unknown set
+		constexpr uint64_t GetMissing(uint64_t nRequired) const { return IsKnown() ? nRequired & ~m_nBits : 0; };
+
+	private:
+		uint64_t m_nBits{ 0 };
+	};
+
+	// Leaf 1 EAX: the extended family is added for base family 15, the extended model is the high nibble
+	// of the model for base families 6 and 15
+	constexpr void DecodeCPUSignature(uint32_t nSignature, uint16_t& nFamily, uint16_t& nModel, uint8_t& nStepping)
+	{
+		const auto nBaseFamily = static_cast<uint16_t>((nSignature >> 8) & 0xF);
+		const auto nBaseModel = static_cast<uint16_t>((nSignature >> 4) & 0xF);
+
+		nStepping = static_cast<uint8_t>(nSignature & 0xF);
+		nFamily = nBaseFamily == 0xF ? static_cast<uint16_t>(nBaseFamily + ((nSignature >> 20) & 0xFF)) : nBaseFamily;
+		nModel = nBaseFamily == 0x6 || nBaseFamily == 0xF ? static_cast<uint16_t>((((nSignature >> 16) & 0xF) << 4) | nBaseModel) : nBaseModel;
+	}
+
+	struct SCPUIDInfo
+	{
+		std::string stVendor; // "GenuineIntel", "AuthenticAMD"
+		std::string stBrand; // Leaves 0x80000002-0x80000004, leading spaces trimmed
+		uint32_t nMaxLeaf{ 0 };
+		uint32_t nMaxExtendedLeaf{ 0 };
+		uint32_t nSignature{ 0 };
+		uint16_t nFamily{ 0 };
+		uint16_t nModel{ 0 };
+		uint8_t nStepping{ 0 };
+		CCPUFeatureSet features;
+	};
+
+	// Walks leaves 0, 1 and 7 and the extended leaves 0x80000000-0x80000004 of the executing processor.
+	// Fails on processors without CPUID, i.e. everything but x86 and x64.
+	bool ReadCPUID(SCPUIDInfo& info);
+
+	// "sse4.2", "popcnt", ...; an empty string for an unknown feature
+	const char* GetCPUFeatureName(ECPUFeature nFeature);
+	// Space separated names in bit order, "sse2 sse3 ssse3 ..."
+	std::string FormatCPUFeatures(uint64_t nFeatures);
+	// Unknown names are skipped, so sets written by newer versions still load
+	uint64_t ParseCPUFeatures(const std::string& stFeatures);
+};
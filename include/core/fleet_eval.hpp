@@ -0,0 +1,103 @@
+#pragma once
+#include "fleet_store.hpp"
+#include "simd_support.hpp"
+
+namespace Win11SysCheck
+{
+	enum class ECompareOp : uint8_t
+	{
+		COMPARE_EQ,
+		COMPARE_NE,
+		COMPARE_LT,
+		COMPARE_LE,
+		COMPARE_GT,
+		COMPARE_GE,
+		COMPARE_IN // Any of the operands
+	};
+
+	struct SFleetPredicate
+	{
+		EFleetColumn nColumn{ EFleetColumn::COLUMN_MAX };
+		ECompareOp nOp{ ECompareOp::COMPARE_EQ };
+		std::vector <uint64_t> vOperands;
+	};
+
+	// A machine passes a rule when every predicate holds
+	struct SFleetRule
+	{
+		std::string stName;
+		std::vector <SFleetPredicate> vPredicates;
+	};
+
+	// Bit i is row i, bits past the row count are always clear
+	class CSelectionBitmap
+	{
+	public:
+		CSelectionBitmap() = default;
+		~CSelectionBitmap() = default;
+
+		void Reset(size_t nRowCount, bool bValue);
+		void And(const CSelectionBitmap& other);
+		void Or(const CSelectionBitmap& other);
+		void AndNot(const CSelectionBitmap& other);
+		void Invert();
+
+		bool Test(size_t nRow) const { return (m_vWords[nRow >> 6] >> (nRow & 63)) & 1; };
+		uint64_t Count() const;
+
+		size_t GetRowCount() const { return m_nRowCount; };
+		uint64_t* GetWords() { return m_vWords.data(); };
+		const uint64_t* GetWords() const { return m_vWords.data(); };
+		size_t GetWordCount() const { return m_vWords.size(); };
+
+	protected:
+		void __ClearTail();
+
+	private:
+		size_t m_nRowCount{ 0 };
+		std::vector <uint64_t> m_vWords;
+	};
+
+	// Sets bit i of pWords when pValues[i] <op> nOperand holds, COMPARE_IN is not handled here
+	void CompareColumn(const uint64_t* pValues, size_t nCount, ECompareOp nOp, uint64_t nOperand, uint64_t* pWords, ESimdLevel nLevel);
+
+	struct SFleetEvalResult
+	{
+		uint64_t nRowCount{ 0 };
+		uint64_t nPassCount{ 0 };
+		uint64_t nPredicateCount{ 0 }; // Row x predicate evaluations, including the ones settled by statistics
+		std::vector <uint64_t> vRuleFailCounts;
+	};
+
+	class CFleetEvaluator
+	{
+	public:
+		CFleetEvaluator(std::vector <SFleetRule> vRules, ESimdLevel nLevel);
+		~CFleetEvaluator() = default;
+
+		// Predicates already decided by the row group min/max statistics skip the decode and the compare
+		bool EvaluateRowGroup(const CFleetStoreReader& reader, size_t nGroup, std::vector <CSelectionBitmap>& vRuleBitmaps, CSelectionBitmap& passBitmap);
+		// Rule bitmaps over already decoded columns, indexed by EFleetColumn
+		void EvaluateColumns(const std::vector <const uint64_t*>& vColumns, size_t nRowCount, std::vector <CSelectionBitmap>& vRuleBitmaps, CSelectionBitmap& passBitmap);
+		bool EvaluateStore(const CFleetStoreReader& reader, SFleetEvalResult& result);
+
+		const auto& GetRules() const { return m_vRules; };
+
+	protected:
+		void __EvaluatePredicate(const SFleetPredicate& predicate, const uint64_t* pValues, size_t nRowCount, CSelectionBitmap& bitmap);
+
+	private:
+		std::vector <SFleetRule> m_vRules;
+		ESimdLevel m_nLevel;
+		CSelectionBitmap m_predicateBitmap;
+		CSelectionBitmap m_scratchBitmap;
+	};
+
+	// Column level port of the readiness rules, multi instance facts use the fleet record reductions
+	std::vector <SFleetRule> GetDefaultFleetPolicy();
+	// "column>=value" on a number column, "column==a|b" becomes COMPARE_IN
+	bool ParseFleetPredicate(const std::string& stText, SFleetPredicate& predicate);
+	// "name:column>=value,column!=value;name2:column==a|b" where a "==" list becomes COMPARE_IN
+	bool ParseFleetRules(const std::string& stRules, std::vector <SFleetRule>& vRules);
+	std::string FormatFleetRule(const SFleetRule& rule);
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include "fleet_store.hpp"
+#include "roaring_bitmap.hpp"
+#include <map>
+
+namespace Win11SysCheck
+{
+	// Value -> row bitmap maps over the low cardinality columns of a fleet store, row numbers are
+	// global store rows. Number values are kept in their decimal form so every column is queried alike.
+	class CFleetIndex
+	{
+		using TValueMap = std::map <std::string, CRoaringBitmap>;
+
+	public:
+		CFleetIndex() = default;
+		~CFleetIndex() = default;
+
+		static std::vector <EFleetColumn> GetDefaultColumns();
+
+		bool Build(const CFleetStoreReader& reader, const std::vector <EFleetColumn>& vColumns);
+		bool Save(const std::string& stFileName) const;
+		bool Load(const std::string& stFileName);
+
+		uint64_t GetRowCount() const { return m_nRowCount; };
+		bool HasColumn(EFleetColumn nColumn) const { return m_mapColumns.find(nColumn) != m_mapColumns.end(); };
+		// nullptr when the column is not indexed
+		const TValueMap* GetValues(EFleetColumn nColumn) const;
+		// Empty bitmap when the column is not indexed or the value never occurs
+		const CRoaringBitmap& Find(EFleetColumn nColumn, const std::string& stValue) const;
+
+		// Terms are column=value, '&' binds tighter than '|', parentheses group and values with
+		// spaces or operators are double quoted: cpu_vendor=GenuineIntel & (tpm_version=1 | tpm_version=0)
+		bool Query(const std::string& stExpression, CRoaringBitmap& result, std::string& stError) const;
+
+	private:
+		uint64_t m_nRowCount{ 0 };
+		std::map <EFleetColumn, TValueMap> m_mapColumns;
+	};
+};
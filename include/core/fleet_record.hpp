@@ -0,0 +1,141 @@
+#pragma once
+#include "probe_result.hpp"
+#include <cstddef>
+
+namespace Win11SysCheck
+{
+	// Flat per machine row of the fleet side tooling, multi instance facts are reduced to the
+	// values the readiness rules and fleet queries look at
+	struct SFleetRecord
+	{
+		uint64_t nMachineId{ 0 };
+
+		uint32_t nOSBuild{ 0 };
+		uint32_t nOSProductType{ 0 };
+
+		EFirmwareType nFirmwareType{ EFirmwareType::FIRMWARE_UNKNOWN };
+		bool bSecureBootCapable{ false };
+		bool bSecureBootEnabled{ false };
+		bool bTpmPresent{ false };
+		uint32_t nTpmVersion{ 0 };
+
+		std::string stCPUVendor;
+		std::string stCPUName;
+		EProcessorArchitecture nCPUArchitecture{ EProcessorArchitecture::ARCHITECTURE_UNKNOWN };
+		uint16_t nCPUFamily{ 0 };
+		uint16_t nCPUModel{ 0 };
+		uint8_t nCPUStepping{ 0 };
+		uint32_t nCPUPlatformField{ 0 };
+		uint32_t nCPUProcessorCount{ 0 };
+		uint32_t nCPUFastProcessorCount{ 0 };
+		uint32_t nCPUMaxMhz{ 0 };
+		bool bCPUArmV81Atomics{ false };
+		bool bCPUSupported{ false };
+		uint64_t nCPUMissingInstructions{ 0 };
+
+		uint64_t nRAMTotalBytes{ 0 };
+		uint64_t nRAMAvailableBytes{ 0 };
+
+		uint32_t nVolumeCount{ 0 };
+		EPartitionStyle nSystemPartitionStyle{ EPartitionStyle::PARTITION_UNKNOWN };
+		uint64_t nSystemFreeBytes{ 0 };
+		uint64_t nLargestVolumeBytes{ 0 };
+
+		uint32_t nMonitorCount{ 0 };
+		uint32_t nMaxMonitorHeight{ 0 };
+		uint32_t nMaxBitsPerPixel{ 0 };
+		uint32_t nMaxPanelDiagonal{ 0 }; // 1/100 inches
+		std::string stAdapterDescription;
+		std::string stAdapterDriverModel;
+		uint32_t nMaxWDDMVersion{ 0 };
+		uint32_t nDirectXMajor{ 0 };
+		uint32_t nDirectXMinor{ 0 };
+
+		bool bInternetConnected{ false };
+		bool bInternetReachable{ false };
+
+		EStatus nOSStatus{ EStatus::STATUS_UNKNOWN };
+		EStatus nBootStatus{ EStatus::STATUS_UNKNOWN };
+		EStatus nCPUStatus{ EStatus::STATUS_UNKNOWN };
+		EStatus nRAMStatus{ EStatus::STATUS_UNKNOWN };
+		EStatus nDiskStatus{ EStatus::STATUS_UNKNOWN };
+		EStatus nDisplayStatus{ EStatus::STATUS_UNKNOWN };
+		EStatus nInternetStatus{ EStatus::STATUS_UNKNOWN };
+		bool bUpgradeReady{ false };
+	};
+
+	// Column order is the on-disk order of the fleet store, append new columns at the end
+	enum class EFleetColumn : uint8_t
+	{
+		COLUMN_MACHINE_ID,
+		COLUMN_OS_BUILD,
+		COLUMN_OS_PRODUCT_TYPE,
+		COLUMN_FIRMWARE_TYPE,
+		COLUMN_SECURE_BOOT_CAPABLE,
+		COLUMN_SECURE_BOOT_ENABLED,
+		COLUMN_TPM_PRESENT,
+		COLUMN_TPM_VERSION,
+		COLUMN_CPU_VENDOR,
+		COLUMN_CPU_NAME,
+		COLUMN_CPU_ARCHITECTURE,
+		COLUMN_CPU_FAMILY,
+		COLUMN_CPU_MODEL,
+		COLUMN_CPU_STEPPING,
+		COLUMN_CPU_PLATFORM_FIELD,
+		COLUMN_CPU_PROCESSOR_COUNT,
+		COLUMN_CPU_FAST_PROCESSOR_COUNT,
+		COLUMN_CPU_MAX_MHZ,
+		COLUMN_CPU_ARM_V81_ATOMICS,
+		COLUMN_CPU_SUPPORTED,
+		COLUMN_RAM_TOTAL_BYTES,
+		COLUMN_RAM_AVAILABLE_BYTES,
+		COLUMN_VOLUME_COUNT,
+		COLUMN_SYSTEM_PARTITION_STYLE,
+		COLUMN_SYSTEM_FREE_BYTES,
+		COLUMN_LARGEST_VOLUME_BYTES,
+		COLUMN_MONITOR_COUNT,
+		COLUMN_MAX_MONITOR_HEIGHT,
+		COLUMN_MAX_BITS_PER_PIXEL,
+		COLUMN_MAX_PANEL_DIAGONAL,
+		COLUMN_ADAPTER_DESCRIPTION,
+		COLUMN_ADAPTER_DRIVER_MODEL,
+		COLUMN_MAX_WDDM_VERSION,
+		COLUMN_DIRECTX_MAJOR,
+		COLUMN_DIRECTX_MINOR,
+		COLUMN_INTERNET_CONNECTED,
+		COLUMN_INTERNET_REACHABLE,
+		COLUMN_OS_STATUS,
+		COLUMN_BOOT_STATUS,
+		COLUMN_CPU_STATUS,
+		COLUMN_RAM_STATUS,
+		COLUMN_DISK_STATUS,
+		COLUMN_DISPLAY_STATUS,
+		COLUMN_INTERNET_STATUS,
+		COLUMN_UPGRADE_READY,
+		COLUMN_CPU_MISSING_INSTRUCTIONS,
+		COLUMN_MAX
+	};
+
+	enum class EFleetColumnKind : uint8_t
+	{
+		COLUMN_KIND_NUMBER,
+		COLUMN_KIND_STRING
+	};
+
+	struct SFleetColumnInfo
+	{
+		EFleetColumn nColumn;
+		const char* szName;
+		EFleetColumnKind nKind;
+		uint64_t(*pfnGetNumber)(const SFleetRecord& record);
+		void(*pfnSetNumber)(SFleetRecord& record, uint64_t nValue);
+		std::string SFleetRecord::* pString;
+	};
+
+	const SFleetColumnInfo& GetFleetColumnInfo(EFleetColumn nColumn);
+	// COLUMN_MAX when the name is unknown
+	EFleetColumn FindFleetColumn(const std::string& stName);
+
+	// Expects the section statuses of the result to be evaluated
+	SFleetRecord MakeFleetRecord(const SProbeResult& result, uint64_t nMachineId);
+};
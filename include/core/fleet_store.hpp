@@ -0,0 +1,106 @@
+#pragma once
+#include "fleet_record.hpp"
+#include "mapped_file.hpp"
+#include <array>
+#include <cstdio>
+#include <mutex>
+
+namespace Win11SysCheck
+{
+	static constexpr uint32_t FLEET_STORE_VERSION = 2;
+	static constexpr uint32_t FLEET_STORE_DEFAULT_ROW_GROUP_SIZE = 65536;
+
+	// Number columns: frame of reference, strings: dictionary codes
+	struct SFleetColumnStats
+	{
+		uint64_t nMin{ 0 };
+		uint64_t nMax{ 0 };
+	};
+
+	struct SFleetColumnChunk
+	{
+		uint64_t nOffset{ 0 };
+		uint64_t nSize{ 0 };
+		SFleetColumnStats stats;
+	};
+
+	struct SFleetRowGroup
+	{
+		uint64_t nRowCount{ 0 };
+		std::vector <SFleetColumnChunk> vChunks; // File column order
+	};
+
+	// File layout: header (magic, version, row group size, column schema), row groups made of one chunk per column,
+	// footer (row group directory with per chunk offsets and min/max), footer offset and magic.
+	// Every row group is framed by its own checksummed directory entry, so a segment that lost its
+	// footer to a crash still opens with every row group that was flushed.
+	// Number chunks are frame of reference bit-packed, so booleans and enums take one or two bits;
+	// string chunks carry a row group dictionary followed by bit-packed codes. Little endian only.
+	class CFleetStoreWriter
+	{
+	public:
+		explicit CFleetStoreWriter(uint32_t nRowGroupSize = FLEET_STORE_DEFAULT_ROW_GROUP_SIZE);
+		~CFleetStoreWriter();
+
+		bool Open(const std::string& stFileName);
+		// Buffers until a row group is full
+		bool Append(const SFleetRecord& record);
+		// Writes the records as one row group, safe to call from several threads; fails beyond the row group size
+		bool AppendRowGroup(const std::vector <SFleetRecord>& vRecords);
+		// Syncs the written row groups to disk, from then on they survive a crash even without the footer
+		bool Flush();
+		bool Close();
+
+		auto GetRowGroupSize() const { return m_nRowGroupSize; };
+		uint64_t GetRowCount() const;
+
+	private:
+		uint32_t m_nRowGroupSize;
+		std::vector <SFleetRecord> m_vPending;
+
+		mutable std::mutex m_mtxFile;
+		std::FILE* m_pFile{ nullptr };
+		uint64_t m_nOffset{ 0 };
+		std::vector <SFleetRowGroup> m_vRowGroups;
+	};
+
+	class CFleetStoreReader
+	{
+	public:
+		CFleetStoreReader() = default;
+		~CFleetStoreReader() = default;
+
+		// Segments without a footer are recovered from the row group frames
+		bool Open(const std::string& stFileName);
+
+		uint64_t GetRowCount() const;
+		auto GetRowGroupSize() const { return m_nRowGroupSize; };
+		size_t GetRowGroupCount() const { return m_vRowGroups.size(); };
+		uint64_t GetRowGroupRowCount(size_t nGroup) const { return m_vRowGroups[nGroup].nRowCount; };
+		bool IsRecovered() const { return m_bRecovered; };
+
+		// Columns added after the file was written are reported missing
+		bool HasColumn(EFleetColumn nColumn) const;
+		SFleetColumnStats GetColumnStats(size_t nGroup, EFleetColumn nColumn) const;
+
+		// Number columns decode to their values, string columns to dictionary codes
+		bool ReadColumn(size_t nGroup, EFleetColumn nColumn, std::vector <uint64_t>& vValues) const;
+		bool ReadDictionary(size_t nGroup, EFleetColumn nColumn, std::vector <std::string>& vDictionary) const;
+		// Only the projected columns are decoded, others keep their defaults
+		bool ReadRecords(size_t nGroup, const std::vector <EFleetColumn>& vProjection, std::vector <SFleetRecord>& vRecords) const;
+
+	protected:
+		const SFleetColumnChunk* __GetChunk(size_t nGroup, EFleetColumn nColumn) const;
+		// Row counts are checked against the row group size and the packed chunk sizes before anything is decoded
+		bool __IsValidRowGroup(const SFleetRowGroup& group) const;
+		bool __ReadFooter(uint32_t nColumnCount, uint64_t nDataOffset);
+		void __RecoverRowGroups(uint32_t nColumnCount, uint64_t nDataOffset);
+
+	private:
+		CMappedFile m_file;
+		uint32_t m_nRowGroupSize{ 0 };
+		bool m_bRecovered{ false };
+		std::vector <SFleetRowGroup> m_vRowGroups;
+		std::array <int32_t, static_cast<size_t>(EFleetColumn::COLUMN_MAX)> m_arFileColumns{};
+	};
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include "fleet_eval.hpp"
+
+namespace Win11SysCheck
+{
+	enum class ETransformOp : uint8_t
+	{
+		TRANSFORM_SET,	// column=value
+		TRANSFORM_ADD	// column+=value
+	};
+
+	struct SFleetAssignment
+	{
+		EFleetColumn nColumn{ EFleetColumn::COLUMN_MAX };
+		ETransformOp nOp{ ETransformOp::TRANSFORM_SET };
+		uint64_t nValue{ 0 };
+	};
+
+	// Assignments applied to the machines matching every condition. String columns can be tested for
+	// (in)equality, the text is looked up in each row group dictionary.
+	struct SFleetTransform
+	{
+		std::vector <SFleetAssignment> vAssignments;
+		std::vector <SFleetPredicate> vConditions;
+		std::vector <std::string> vConditionTexts; // Per condition, the operand of string columns
+	};
+
+	// "tpm_present=1,tpm_version=2 if cpu_vendor==GenuineIntel;ram_total_bytes+=8589934592 if ram_total_bytes<4294967296"
+	// Only number columns can be assigned.
+	bool ParseFleetTransforms(const std::string& stText, std::vector <SFleetTransform>& vTransforms);
+
+	struct SWhatIfRuleDelta
+	{
+		uint64_t nBaselineFailCount{ 0 };
+		uint64_t nScenarioFailCount{ 0 };
+		uint64_t nFixedCount{ 0 };	// Failed in the baseline, pass in the scenario
+		uint64_t nBrokenCount{ 0 };	// Passed in the baseline, fail in the scenario
+	};
+
+	struct SWhatIfResult
+	{
+		uint64_t nRowCount{ 0 };
+		uint64_t nTransformedCount{ 0 };	// Rows matched by at least one transform
+		uint64_t nBaselinePassCount{ 0 };
+		uint64_t nScenarioPassCount{ 0 };
+		uint64_t nGainedCount{ 0 };
+		uint64_t nLostCount{ 0 };
+		uint64_t nBaselinePredicateCount{ 0 };	// Row x predicate evaluations
+		uint64_t nScenarioPredicateCount{ 0 };	// Only the recomputed ones
+		uint64_t nSkippedRowGroupCount{ 0 };	// Row groups whose scenario is the baseline
+		std::vector <SWhatIfRuleDelta> vRules;
+
+		void Merge(const SWhatIfResult& other);
+	};
+
+	// Evaluates a policy against the stored fleet and against a scenario: transformed facts and replaced
+	// or added rules. Only the rules reading an assigned column or changed by the scenario are evaluated
+	// again, and only in row groups where a transform selects a machine or the rule itself changed.
+	class CFleetSimulator
+	{
+	public:
+		// Scenario rules replace the baseline rule of the same name or are added, a rule without
+		// predicates drops the requirement
+		CFleetSimulator(std::vector <SFleetRule> vBaseline, const std::vector <SFleetRule>& vScenario, std::vector <SFleetTransform> vTransforms, ESimdLevel nLevel);
+		~CFleetSimulator() = default;
+
+		bool SimulateStore(const CFleetStoreReader& reader, SWhatIfResult& result, uint32_t nThreadCount = 0) const;
+
+		// Baseline rules followed by the added ones
+		const std::vector <std::string>& GetRuleNames() const { return m_vRuleNames; };
+		bool IsRecomputed(size_t nRule) const { return m_vDirty[nRule]; };
+
+	protected:
+		bool __SimulateRowGroup(const CFleetStoreReader& reader, size_t nGroup, CFleetEvaluator& baseline, CFleetEvaluator& scenario, SWhatIfResult& result) const;
+
+	private:
+		std::vector <SFleetRule> m_vBaseline;
+		std::vector <SFleetRule> m_vScenario;		// The recomputed rules only
+		std::vector <size_t> m_vScenarioIndexes;	// Rule index of every recomputed rule
+		std::vector <std::string> m_vRuleNames;
+		std::vector <bool> m_vDirty;
+		std::vector <SFleetTransform> m_vTransforms;
+		std::vector <bool> m_vAssigned;				// Indexed by EFleetColumn
+		bool m_bPolicyChanged{ false };
+		uint64_t m_nBaselinePredicateCount{ 0 };
+		uint64_t m_nScenarioPredicateCount{ 0 };
+		ESimdLevel m_nLevel;
+	};
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include "probe_result.hpp"
+#include <cstdint>
+#include <string>
+
+namespace Win11SysCheck
+{
+	// Bumped whenever the canonical encoding changes, fingerprints of different versions never match
+	static constexpr uint8_t HARDWARE_PROFILE_VERSION = 2;
+
+	struct SHardwareFingerprint
+	{
+		uint64_t nLow{ 0 };
+		uint64_t nHigh{ 0 };
+
+		// 64 bit form for callers which can afford the higher collision rate
+		uint64_t Get64() const { return nLow; };
+		std::string ToString() const;
+
+		bool operator==(const SHardwareFingerprint& other) const { return nLow == other.nLow && nHigh == other.nHigh; };
+		bool operator!=(const SHardwareFingerprint& other) const { return !(*this == other); };
+		bool operator<(const SHardwareFingerprint& other) const { return nHigh != other.nHigh ? nHigh < other.nHigh : nLow < other.nLow; };
+	};
+
+	struct SHardwareFingerprintHash
+	{
+		size_t operator()(const SHardwareFingerprint& fingerprint) const { return static_cast<size_t>(fingerprint.nLow); };
+	};
+
+	// MurmurHash3 x64 128
+	SHardwareFingerprint HashBytes128(const void* pData, size_t nSize, uint64_t nSeed = 0);
+
+	// Fixed order, fixed width little endian encoding of every stable fact. Volatile values (free memory
+	// and disk space, connectivity, statuses) and per instance names (volume labels, device paths,
+	// EDID registry keys) are left out so identical SKUs encode to identical bytes.
+	// The DxDiag facts (adapters, DirectX version) come last, without them the encoding only needs
+	// the cheap probes and is a prefix of the full one.
+	void EncodeHardwareProfile(const SProbeResult& result, std::string& stBuffer, bool bIncludeDxDiag = true);
+	// Leaves the excluded facts at their defaults
+	bool DecodeHardwareProfile(const char* pData, size_t nSize, SProbeResult& result);
+
+	SHardwareFingerprint ComputeHardwareFingerprint(const SProbeResult& result, bool bIncludeDxDiag = true);
+	bool ParseHardwareFingerprint(const std::string& stText, SHardwareFingerprint& fingerprint);
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include "probe_result.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	// High dynamic range histogram: values in [lowest, highest] are recorded with nSignificantDigits
+	// decimal digits of precision into a fixed counts array of log2(highest / lowest) buckets, each
+	// split into linear sub buckets. Recording is a couple of shifts, percentile queries walk the
+	// fixed array and never depend on the number of recorded values.
+	class CHdrHistogram
+	{
+	public:
+		CHdrHistogram(uint64_t nLowest = 1, uint64_t nHighest = 3600000000ull, uint32_t nSignificantDigits = 3);
+		~CHdrHistogram() = default;
+
+		// Values above the trackable range are clamped to it
+		void Record(uint64_t nValue, uint64_t nCount = 1);
+		// Both histograms must have the same range and precision
+		bool Merge(const CHdrHistogram& other);
+		void Reset();
+
+		// Highest value equivalent to the recorded value at the percentile, zero when empty
+		uint64_t GetValueAtPercentile(double dPercentile) const;
+		uint64_t GetTotalCount() const { return m_nTotalCount; };
+		uint64_t GetMin() const { return m_nTotalCount ? m_nMin : 0; };
+		uint64_t GetMax() const { return m_nMax; };
+		double GetMean() const { return m_nTotalCount ? static_cast<double>(m_nSum) / m_nTotalCount : 0.0; };
+
+		uint64_t GetLowest() const { return m_nLowest; };
+		uint64_t GetHighest() const { return m_nHighest; };
+		uint32_t GetSignificantDigits() const { return m_nSignificantDigits; };
+
+		// Only non empty counters are written
+		void Serialize(std::string& stBuffer) const;
+		bool Deserialize(const char* pData, size_t nSize, size_t& nOffset);
+
+	protected:
+		void __Init(uint64_t nLowest, uint64_t nHighest, uint32_t nSignificantDigits);
+		size_t __GetCountsIndex(uint64_t nValue) const;
+		uint64_t __GetHighestEquivalent(size_t nIndex) const;
+
+	private:
+		uint64_t m_nLowest{ 1 };
+		uint64_t m_nHighest{ 1 };
+		uint32_t m_nSignificantDigits{ 3 };
+		uint32_t m_nUnitMagnitude{ 0 };
+		uint32_t m_nSubBucketHalfCountMagnitude{ 0 };
+		uint64_t m_nSubBucketHalfCount{ 0 };
+		uint64_t m_nSubBucketMask{ 0 };
+
+		uint64_t m_nTotalCount{ 0 };
+		uint64_t m_nSum{ 0 };
+		uint64_t m_nMin{ 0 };
+		uint64_t m_nMax{ 0 };
+		std::vector <uint64_t> m_vCounts;
+	};
+
+	enum class EFactHistogram : uint8_t
+	{
+		FACT_HISTOGRAM_RAM_MB,
+		FACT_HISTOGRAM_DISK_FREE_MB,		// Summed over every volume
+		FACT_HISTOGRAM_PANEL_DIAGONAL,		// Largest panel, 1/100 inch
+		FACT_HISTOGRAM_CPU_MAX_MHZ,
+		FACT_HISTOGRAM_PROBE_LATENCY_US,	// Time to obtain and evaluate one report
+		FACT_HISTOGRAM_MAX
+	};
+
+	const char* GetFactHistogramName(EFactHistogram nFact);
+
+	// One histogram per numeric fleet fact, owned by one thread and merged at the end
+	class CFactHistograms
+	{
+	public:
+		CFactHistograms() : CFactHistograms(3) {};
+		explicit CFactHistograms(uint32_t nSignificantDigits);
+		~CFactHistograms() = default;
+
+		void Record(const SProbeResult& result);
+		void RecordLatency(uint64_t nMicroseconds) { Get(EFactHistogram::FACT_HISTOGRAM_PROBE_LATENCY_US).Record(nMicroseconds); };
+		bool Merge(const CFactHistograms& other);
+
+		CHdrHistogram& Get(EFactHistogram nFact) { return m_arHistograms[static_cast<size_t>(nFact)]; };
+		const CHdrHistogram& Get(EFactHistogram nFact) const { return m_arHistograms[static_cast<size_t>(nFact)]; };
+
+		bool Save(const std::string& stFileName) const;
+		bool Load(const std::string& stFileName);
+
+	private:
+		std::array <CHdrHistogram, static_cast<size_t>(EFactHistogram::FACT_HISTOGRAM_MAX)> m_arHistograms;
+	};
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "output_file.hpp"
+#include "probe_result.hpp"
+
+namespace Win11SysCheck
+{
+	// Texts of the human oriented result document, defaults are the en_us.json values
+	struct SLegacyLabels
+	{
+		std::array <std::string, static_cast<size_t>(EMenuType::MENU_TYPE_MAX)> arMenuNames{
+			"", "Summary", "OS", "Boot", "CPU", "RAM", "Disk", "Display", "Internet"
+		};
+		std::string stDetails{ "Details" };
+		std::string stCapable{ "Capable" };
+		std::string stEnabled{ "Enabled" };
+		std::string stDisabled{ "disabled" };
+		std::string stStatus{ "Status" };
+		std::string stVersion{ "Version" };
+
+		std::string stOSVersion{ "OS Version" };
+		std::string stOSServicePack{ "OS Service pack" };
+		std::string stOSBuild{ "OS Build" };
+		std::string stOSPlatform{ "OS Platform" };
+		std::string stOSProductType{ "OS Product Type" };
+		std::string stBootFirmware{ "Boot Firmware" };
+		std::string stSecureBoot{ "Secure Boot status" };
+		std::string stTPM{ "TPM" };
+		std::string stCPUName{ "Processor name" };
+		std::string stCPUDetails{ "Processor details" };
+		std::string stCPUArchitecture{ "Processor architecture" };
+		std::string stActiveProcessorCount{ "Active processor count" };
+		std::string stProcessorCount{ "Processor count" };
+	};
+
+	// "<menu> <details>:", the UI prefixes it with the menu icon
+	std::string GetLegacySectionTitle(EMenuType nType, const SLegacyLabels& labels);
+	std::vector <std::string> FormatLegacySectionTexts(EMenuType nType, const SProbeResult& result, const SLegacyLabels& labels);
+
+	// Document layout of CSysCheck::ExportResult: { "<menu>": { "<title>": [ texts ] }, ... }
+	std::string SerializeLegacyJson(const SProbeResult& result, const SLegacyLabels& labels);
+	// Streams the same document through the file buffer
+	bool WriteLegacyJson(const SProbeResult& result, const SLegacyLabels& labels, COutputFile& file);
+	// Rebuilds the facts of a result document, sections are read in export order so localized
+	// menu names are accepted; statuses are left to the readiness rules
+	bool ParseLegacyJson(const char* pData, size_t nSize, SProbeResult& result, const SLegacyLabels& labels = {});
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace Win11SysCheck
+{
+	// Read only view of a whole file, empty files open successfully with a null view
+	class CMappedFile
+	{
+	public:
+		CMappedFile() = default;
+		~CMappedFile();
+
+		CMappedFile(const CMappedFile&) = delete;
+		CMappedFile& operator=(const CMappedFile&) = delete;
+
+		bool Open(const std::string& stFileName);
+		void Close();
+
+		const char* GetData() const { return m_pData; };
+		size_t GetSize() const { return m_nSize; };
+
+	private:
+#ifdef _WIN32
+		void* m_hFile{ nullptr };
+		void* m_hMapping{ nullptr };
+#else
+		int m_nFile{ -1 };
+#endif
+		const char* m_pData{ nullptr };
+		size_t m_nSize{ 0 };
+	};
+};
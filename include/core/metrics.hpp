@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	using TMetricLabels = std::vector <std::pair <std::string, std::string>>;
+
+	enum class EMetricType : uint8_t
+	{
+		METRIC_TYPE_COUNTER,
+		METRIC_TYPE_GAUGE,
+		METRIC_TYPE_HISTOGRAM
+	};
+
+	// All metric updates are lock-free, only registration and serialization takes the registry lock
+	class CCounter
+	{
+	public:
+		void Increment(uint64_t nValue = 1) { m_nValue.fetch_add(nValue, std::memory_order_relaxed); };
+		uint64_t Value() const				{ return m_nValue.load(std::memory_order_relaxed); };
+
+	private:
+		std::atomic <uint64_t> m_nValue{ 0 };
+	};
+
+	class CGauge
+	{
+	public:
+		void Set(double dValue);
+		void Add(double dValue);
+		double Value() const;
+
+	private:
+		std::atomic <uint64_t> m_nBits{ 0 };
+	};
+
+	class CHistogram
+	{
+	public:
+		explicit CHistogram(const std::vector <double>& vBounds);
+
+		void Observe(double dValue);
+
+		const auto& GetBounds() const { return m_vBounds; };
+		uint64_t GetBucketCount(size_t nIndex) const;
+		uint64_t GetCount() const { return m_nCount.load(std::memory_order_relaxed); };
+		double GetSum() const { return m_kSum.Value(); };
+
+		static std::vector <double> DefaultLatencyBounds();
+
+	private:
+		std::vector <double> m_vBounds;
+		std::unique_ptr <std::atomic <uint64_t>[]> m_pBuckets;
+		std::atomic <uint64_t> m_nCount{ 0 };
+		CGauge m_kSum;
+	};
+
+	class CMetricsRegistry
+	{
+		struct SMetricFamily
+		{
+			std::string stHelp;
+			EMetricType nType{ EMetricType::METRIC_TYPE_COUNTER };
+			std::vector <double> vBounds;
+			std::map <std::string, std::unique_ptr <CCounter>> mapCounters;
+			std::map <std::string, std::unique_ptr <CGauge>> mapGauges;
+			std::map <std::string, std::unique_ptr <CHistogram>> mapHistograms;
+		};
+
+	public:
+		CMetricsRegistry() = default;
+		~CMetricsRegistry() = default;
+
+		CMetricsRegistry(const CMetricsRegistry&) = delete;
+		CMetricsRegistry& operator=(const CMetricsRegistry&) = delete;
+
+		// Returned references stay valid for the registry lifetime, hot paths should keep them
+		CCounter& Counter(const std::string& stName, const std::string& stHelp, const TMetricLabels& labels = {});
+		CGauge& Gauge(const std::string& stName, const std::string& stHelp, const TMetricLabels& labels = {});
+		CHistogram& Histogram(const std::string& stName, const std::string& stHelp, const std::vector <double>& vBounds, const TMetricLabels& labels = {});
+
+		// Prometheus text exposition format (0.0.4)
+		std::string Serialize() const;
+
+		// Written through COutputFile: synced to disk before it is renamed over the target
+		bool WriteTextFile(const std::string& stFileName) const;
+
+	protected:
+		SMetricFamily& __GetFamily(const std::string& stName, const std::string& stHelp, EMetricType nType);
+		static std::string __FormatLabels(const TMetricLabels& labels);
+
+	private:
+		mutable std::mutex m_mtxFamilies;
+		std::map <std::string, SMetricFamily> m_mapFamilies;
+	};
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include "block_compression.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Win11SysCheck
+{
+	static constexpr size_t OUTPUT_FILE_BUFFER_SIZE = 16 * 1024;
+
+	// Buffered writer that replaces its target atomically: data goes to a temporary file next to the
+	// target, Commit flushes it to disk and renames it into place, so readers see the old file or the
+	// complete new one. Can also write to the standard output, which may be a pipe.
+	// Usable as a rapidjson output stream. With compression enabled the content is written as a
+	// checksummed block stream, see CStreamCompressor.
+	class COutputFile
+	{
+	public:
+		using Ch = char; // rapidjson stream interface
+
+		COutputFile() = default;
+		~COutputFile();
+
+		COutputFile(const COutputFile&) = delete;
+		COutputFile& operator=(const COutputFile&) = delete;
+
+		bool Open(const std::string& stFileName);
+		bool OpenStandardOutput();
+		// Must be set before the first write, Open resets it
+		void SetCompression(bool bEnabled);
+		// Flushes, syncs and renames the temporary file over the target
+		bool Commit();
+		// Drops the temporary file, the target is left untouched
+		void Abort();
+
+		bool Write(const char* pData, size_t nSize);
+		void Put(char c)
+		{
+			if (m_nBuffered == OUTPUT_FILE_BUFFER_SIZE)
+				Flush();
+			m_arBuffer[m_nBuffered++] = c;
+		};
+		// Errors are sticky, checked by Commit
+		void Flush();
+
+		bool IsFailed() const { return m_bFailed; };
+		bool IsCompressed() const { return m_pCompressor != nullptr; };
+		// Content bytes, before compression
+		uint64_t GetWrittenSize() const { return m_nWritten + m_nBuffered; };
+		// Bytes that reached the file so far, the compressed size once committed
+		uint64_t GetStoredSize() const { return m_nStored; };
+
+	protected:
+		void __Emit(const char* pData, size_t nSize);
+		// Flushes the buffer and closes the compressed stream
+		bool __Finish();
+		bool __WriteRaw(const char* pData, size_t nSize);
+		void __Close();
+
+	private:
+#ifdef _WIN32
+		void* m_hFile{ nullptr };
+#else
+		int m_nFile{ -1 };
+#endif
+		bool m_bStandardOutput{ false };
+		bool m_bFailed{ false };
+		std::string m_stFileName;
+		std::string m_stTempFileName;
+		uint64_t m_nWritten{ 0 };
+		uint64_t m_nStored{ 0 };
+		std::unique_ptr <CStreamCompressor> m_pCompressor;
+		std::string m_stCompressed;
+		size_t m_nBuffered{ 0 };
+		char m_arBuffer[OUTPUT_FILE_BUFFER_SIZE];
+	};
+};
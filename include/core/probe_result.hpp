@@ -0,0 +1,169 @@
+#pragma once
+#include "probe_types.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	// Mirrors FIRMWARE_TYPE
+	enum class EFirmwareType : uint8_t
+	{
+		FIRMWARE_UNKNOWN,
+		FIRMWARE_BIOS,
+		FIRMWARE_UEFI
+	};
+
+	// Mirrors PARTITION_STYLE, unknown is used when the drive layout could not be read
+	enum class EPartitionStyle : uint8_t
+	{
+		PARTITION_MBR,
+		PARTITION_GPT,
+		PARTITION_RAW,
+		PARTITION_UNKNOWN
+	};
+
+	// Mirrors PROCESSOR_ARCHITECTURE_*
+	enum class EProcessorArchitecture : uint16_t
+	{
+		ARCHITECTURE_INTEL = 0,
+		ARCHITECTURE_ARM = 5,
+		ARCHITECTURE_IA64 = 6,
+		ARCHITECTURE_AMD64 = 9,
+		ARCHITECTURE_ARM64 = 12,
+		ARCHITECTURE_UNKNOWN = 0xFFFF
+	};
+
+	struct SOSFacts
+	{
+		uint32_t nMajorVersion{ 0 };
+		uint32_t nMinorVersion{ 0 };
+		uint16_t nServicePackMajor{ 0 };
+		uint16_t nServicePackMinor{ 0 };
+		uint32_t nBuildNumber{ 0 };
+		uint32_t nPlatformId{ 0 };
+		uint32_t nProductType{ 0 };
+	};
+
+	struct SBootFacts
+	{
+		EFirmwareType nFirmwareType{ EFirmwareType::FIRMWARE_UNKNOWN };
+		uint64_t nBootFlags{ 0 };
+		bool bSecureBootCapable{ false };
+		bool bSecureBootEnabled{ false };
+		bool bTpmPresent{ false };
+		uint32_t nTpmVersion{ 0 };
+	};
+
+	struct SCPUFacts
+	{
+		std::string stVendor;
+		std::string stName;
+		EProcessorArchitecture nArchitecture{ EProcessorArchitecture::ARCHITECTURE_UNKNOWN };
+		uint16_t nFamily{ 0 };
+		uint16_t nModel{ 0 };
+		uint8_t nStepping{ 0 };
+		uint32_t nPlatformSpecificField{ 0 };
+		uint32_t nActiveProcessorCount{ 0 };
+		uint32_t nProcessorCount{ 0 };
+		uint32_t nMaxMhz{ 0 };
+		uint32_t nFastProcessorCount{ 0 }; // Logical processors rated at 1 GHz or more
+		bool bArmV81Atomics{ false };
+		uint64_t nFeatures{ 0 }; // CPUID feature bits, see CCPUFeatureSet; zero when not read
+	};
+
+	struct SRAMFacts
+	{
+		uint64_t nTotalPhysical{ 0 };
+		uint64_t nAvailablePhysical{ 0 };
+	};
+
+	struct SVolumeFacts
+	{
+		std::string stPath;
+		std::string stDeviceName;
+		std::string stVolumeName;
+		std::string stFileSystem;
+		EPartitionStyle nPartitionStyle{ EPartitionStyle::PARTITION_UNKNOWN };
+		uint64_t nTotalBytes{ 0 };
+		uint64_t nFreeBytes{ 0 };
+	};
+
+	struct SDiskFacts
+	{
+		std::vector <SVolumeFacts> vVolumes;
+	};
+
+	struct SMonitorFacts
+	{
+		std::string stDeviceID;
+		std::string stDeviceName;
+		std::string stDeviceString;
+		bool bPrimary{ false };
+		uint32_t nBitsPerPixel{ 0 };
+		int32_t nWidth{ 0 };
+		int32_t nHeight{ 0 };
+	};
+
+	// Physical panel size as reported by the EDID block
+	struct SPanelFacts
+	{
+		std::string stRegistryPath;
+		uint16_t nWidthCm{ 0 };
+		uint16_t nHeightCm{ 0 };
+	};
+
+	struct SGraphicsAdapterFacts
+	{
+		std::string stDescription;
+		std::string stDriverModel;
+	};
+
+	struct SDisplayFacts
+	{
+		std::vector <SMonitorFacts> vMonitors;
+		std::vector <SPanelFacts> vPanels;
+		std::vector <SGraphicsAdapterFacts> vAdapters;
+		uint32_t nDirectXMajor{ 0 };
+		uint32_t nDirectXMinor{ 0 };
+		// DxDiag was skipped for hardware on the known good filter: adapters and DirectX are unread but vouched for.
+		// Never exported, the probe reads them before an export.
+		bool bDxDiagSkipped{ false };
+	};
+
+	struct SInternetFacts
+	{
+		bool bConnected{ false };
+		bool bReachable{ false };
+	};
+
+	struct SProbeResult
+	{
+		SOSFacts os;
+		SBootFacts boot;
+		SCPUFacts cpu;
+		SRAMFacts ram;
+		SDiskFacts disk;
+		SDisplayFacts display;
+		SInternetFacts internet;
+		std::array <EStatus, static_cast<size_t>(EMenuType::MENU_TYPE_MAX)> arStatuses{};
+		uint64_t nMachineId{ 0 }; // Identity of the machine, not of its hardware; zero when the export carries none
+
+		EStatus GetStatus(EMenuType nType) const { return arStatuses[static_cast<size_t>(nType)]; };
+		void SetStatus(EMenuType nType, EStatus nStatus) { arStatuses[static_cast<size_t>(nType)] = nStatus; };
+	};
+
+	bool IsX64Architecture(EProcessorArchitecture nArchitecture);
+	double GetPanelDiagonalInches(const SPanelFacts& panel);
+	// "WDDM 2.7" -> 27, zero when the driver model string does not carry a WDDM version
+	uint32_t GetWDDMVersion(const std::string& stDriverModel);
+
+	std::string GetFirmwareName(EFirmwareType nType);
+	std::string GetPartitionName(EPartitionStyle nStyle);
+
+	// Locale independent identifiers, used by the result schema
+	std::string GetFirmwareKey(EFirmwareType nType);
+	std::string GetPartitionKey(EPartitionStyle nStyle);
+	std::string GetArchitectureKey(EProcessorArchitecture nArchitecture);
+};
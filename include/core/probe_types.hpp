@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace Win11SysCheck
+{
+	enum class EStatus : uint8_t
+	{
+		STATUS_UNKNOWN,
+		STATUS_INITIALIZING,
+		STATUS_OK,
+		STATUS_FAIL
+	};
+
+	enum class EMenuType : uint8_t
+	{
+		MENU_TYPE_UNKNOWN,
+		MENU_TYPE_SUMMARY,
+		MENU_TYPE_OS,
+		MENU_TYPE_BOOT,
+		MENU_TYPE_CPU,
+		MENU_TYPE_RAM,
+		MENU_TYPE_DISK,
+		MENU_TYPE_DISPLAY,
+		MENU_TYPE_INTERNET,
+		MENU_TYPE_MAX
+	};
+
+	// Locale independent identifiers, used as metric labels and machine readable keys
+	std::string GetMenuTypeKey(EMenuType nType);
+	std::string GetStatusKey(EStatus nStatus);
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include "hardware_fingerprint.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	// Per machine remainder once the hardware profile is factored out
+	struct SProfileMachine
+	{
+		uint64_t nMachineId{ 0 };
+		uint32_t nProfile{ 0 };
+		SInternetFacts internet;
+	};
+
+	// Distinct hardware profiles stored once, machines keep a reference and their volatile facts.
+	// Hardware sections are evaluated once per profile, connectivity once per machine.
+	class CProfileCatalog
+	{
+		struct SProfile
+		{
+			SHardwareFingerprint fingerprint;
+			std::string stEncoding;
+			SProbeResult result; // Decoded from stEncoding, statuses filled by EvaluateProfiles
+			uint64_t nMachineCount{ 0 };
+		};
+
+	public:
+		CProfileCatalog() = default;
+		~CProfileCatalog() = default;
+
+		// Returns the profile index of the machine
+		uint32_t Add(const SProbeResult& result, uint64_t nMachineId);
+		void Merge(const CProfileCatalog& other);
+
+		void EvaluateProfiles();
+		bool IsMachineReady(size_t nMachine) const;
+		// Profile facts and statuses combined with the machine's own connectivity
+		SProbeResult GetMachineResult(size_t nMachine) const;
+
+		size_t GetProfileCount() const { return m_vProfiles.size(); };
+		size_t GetMachineCount() const { return m_vMachines.size(); };
+		const SProfileMachine& GetMachine(size_t nMachine) const { return m_vMachines[nMachine]; };
+		const SProbeResult& GetProfile(size_t nProfile) const { return m_vProfiles[nProfile].result; };
+		const SHardwareFingerprint& GetFingerprint(size_t nProfile) const { return m_vProfiles[nProfile].fingerprint; };
+		uint64_t GetProfileMachineCount(size_t nProfile) const { return m_vProfiles[nProfile].nMachineCount; };
+
+		bool Save(const std::string& stFileName) const;
+		bool Load(const std::string& stFileName);
+
+	protected:
+		uint32_t __AddProfile(const SHardwareFingerprint& fingerprint, std::string&& stEncoding);
+
+	private:
+		std::vector <SProfile> m_vProfiles;
+		std::vector <SProfileMachine> m_vMachines;
+		std::unordered_map <SHardwareFingerprint, uint32_t, SHardwareFingerprintHash> m_mapProfiles;
+	};
+};
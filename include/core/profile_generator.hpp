@@ -0,0 +1,53 @@
+#pragma once
+#include "probe_result.hpp"
+
+namespace Win11SysCheck
+{
+	// xoshiro256** seeded through splitmix64
+	class CRandom
+	{
+	public:
+		explicit CRandom(uint64_t nSeed);
+		~CRandom() = default;
+
+		uint64_t Next();
+		// Uniform in [nMin, nMax]
+		uint64_t Range(uint64_t nMin, uint64_t nMax);
+		bool Chance(double dProbability);
+		template <class T, size_t N>
+		const T& Pick(const T(&arValues)[N]) { return arValues[Range(0, N - 1)]; };
+
+	private:
+		uint64_t m_arState[4];
+	};
+
+	// Builds realistic fleet machines, a profile only depends on the seed and its index
+	// so any slice of the fleet can be regenerated independently and in parallel.
+	// With a SKU count the hardware is drawn per SKU and only volatile facts vary per machine.
+	class CProfileGenerator
+	{
+	public:
+		explicit CProfileGenerator(uint64_t nSeed, uint64_t nSkuCount = 0);
+		~CProfileGenerator() = default;
+
+		// Machine n gets id n + 1, zero is left for exports without an id
+		SProbeResult Generate(uint64_t nIndex) const;
+		// The same machine at a later scan, scan zero is Generate. Volatile facts are drawn again every scan
+		// and each scan reconfigures about dChangeRate of the fleet: an OS update, Secure Boot toggled in the
+		// firmware setup, the TPM disabled or enabled, or a memory upgrade.
+		SProbeResult GenerateRescan(uint64_t nIndex, uint32_t nScan, double dChangeRate) const;
+
+	protected:
+		void __GenerateOS(CRandom& rng, SOSFacts& facts) const;
+		void __GenerateBoot(CRandom& rng, SBootFacts& facts) const;
+		void __GenerateCPU(CRandom& rng, SCPUFacts& facts) const;
+		void __GenerateRAM(CRandom& rng, SRAMFacts& facts) const;
+		void __GenerateDisk(CRandom& rng, SDiskFacts& facts) const;
+		void __GenerateDisplay(CRandom& rng, SDisplayFacts& facts) const;
+		void __GenerateInternet(CRandom& rng, SInternetFacts& facts) const;
+
+	private:
+		uint64_t m_nSeed;
+		uint64_t m_nSkuCount;
+	};
+};
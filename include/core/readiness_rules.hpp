@@ -0,0 +1,26 @@
+#pragma once
+#include "probe_result.hpp"
+
+namespace Win11SysCheck
+{
+	// Section verdicts, shared by the local scanner and the fleet side tooling
+	EStatus EvaluateOSReadiness(const SOSFacts& facts);
+	EStatus EvaluateBootReadiness(const SBootFacts& facts);
+	EStatus EvaluateCPUReadiness(const SCPUFacts& facts);
+	EStatus EvaluateRAMReadiness(const SRAMFacts& facts);
+	EStatus EvaluateDiskReadiness(const SDiskFacts& facts);
+	EStatus EvaluateDisplayReadiness(const SDisplayFacts& facts);
+	EStatus EvaluateInternetReadiness(const SInternetFacts& facts);
+
+	bool IsSupportedProcessor(const SCPUFacts& facts);
+	// Feature bits of CPU_FEATURES_24H2_REQUIRED an x64 processor lacks, zero when CPUID was not read
+	uint64_t GetMissingInstructions(const SCPUFacts& facts);
+
+	// Fills every section status of the result
+	void EvaluateReadiness(SProbeResult& result);
+	bool CanSystemUpgrade(const SProbeResult& result);
+
+	// Appends one "<section>.<blocker>" key per failed check, e.g. "boot.tpm_missing" or
+	// "cpu.unsupported_model:Intel(R) Core(TM) i5-7200U CPU @ 2.50GHz", nothing for a ready machine
+	void ExplainReadiness(const SProbeResult& result, std::vector <std::string>& vReasons);
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include "binary_report.hpp"
+#include "report_frame.hpp"
+#include <array>
+#include <mutex>
+
+namespace Win11SysCheck
+{
+	// Volatile amounts are compared at this granularity, ordinary drift is not a change worth sending
+	static constexpr uint64_t REPORT_DELTA_RAM_QUANTUM = 256ull * 1024 * 1024;
+	static constexpr uint64_t REPORT_DELTA_DISK_QUANTUM = 1024ull * 1024 * 1024;
+
+	struct SSectionDigests
+	{
+		std::array <uint64_t, static_cast<size_t>(EMenuType::MENU_TYPE_MAX)> arDigests{};
+
+		// Digest of the whole report, the base a delta is applied to
+		uint64_t GetStateDigest() const;
+		bool operator==(const SSectionDigests& other) const { return arDigests == other.arDigests; };
+	};
+
+	// Per section hash of the binary encoding, statuses are left out since the collector evaluates them again
+	SSectionDigests ComputeSectionDigests(const SProbeResult& result);
+	uint16_t GetChangedSections(const SSectionDigests& current, const SSectionDigests& base);
+
+	// Agent side: remembers the digests of the last acknowledged report and sends only what differs from
+	// it, a heartbeat when nothing does. Without an acknowledged base the full report goes out.
+	class CDeltaReporter
+	{
+	public:
+		CDeltaReporter() = default;
+		~CDeltaReporter() = default;
+
+		// Returns the sections written, BINARY_REPORT_DELTA is set unless the report is full
+		uint16_t Add(CBinaryReportWriter& writer, const SProbeResult& result, uint64_t nMachineId);
+		// Committed: the sent report becomes the base; resync: the base is dropped
+		void OnAck(EReportAck nAck);
+
+		bool HasBase() const { return m_bHasBase; };
+
+		bool Save(const std::string& stFileName) const;
+		bool Load(const std::string& stFileName);
+
+	private:
+		bool m_bHasBase{ false };
+		SSectionDigests m_base;
+		bool m_bPending{ false };
+		SSectionDigests m_pending;
+	};
+
+	enum class EDeltaApply : uint8_t
+	{
+		DELTA_APPLY_FULL,		// Full report, stored as the new state
+		DELTA_APPLY_CHANGED,	// Delta merged into the stored state
+		DELTA_APPLY_UNCHANGED,	// Heartbeat matching the stored state
+		DELTA_APPLY_RESYNC		// Unknown machine or a base other than the stored state
+	};
+
+	// Collector side: last known state of every machine, kept binary encoded. Sharded by machine id so
+	// the I/O threads rarely contend.
+	class CDeltaStateStore
+	{
+		struct SMachineState
+		{
+			uint64_t nStateDigest{ 0 };
+			std::string stEncoding;
+		};
+
+		struct SShard
+		{
+			std::mutex mtx;
+			std::unordered_map <uint64_t, SMachineState> mapMachines;
+		};
+
+	public:
+		CDeltaStateStore() = default;
+		~CDeltaStateStore() = default;
+
+		// result holds the decoded report, on return the complete state unless a resync is needed
+		EDeltaApply Apply(uint64_t nMachineId, uint16_t nSectionMask, uint64_t nBaseDigest, SProbeResult& result);
+
+		size_t GetMachineCount() const;
+		bool Save(const std::string& stFileName) const;
+		bool Load(const std::string& stFileName);
+
+	protected:
+		SShard& __GetShard(uint64_t nMachineId) const { return m_arShards[nMachineId % m_arShards.size()]; };
+
+	private:
+		mutable std::array <SShard, 64> m_arShards;
+	};
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace Win11SysCheck
+{
+	static constexpr uint32_t REPORT_FRAME_HEADER_SIZE = 8;
+	static constexpr uint32_t REPORT_FRAME_MAX_PAYLOAD = 16 * 1024 * 1024;
+
+	enum class EFrameType : uint8_t
+	{
+		FRAME_UNKNOWN,
+		FRAME_REPORT_JSON,	// [machine id u64][legacy JSON document]
+		FRAME_ACK,			// [machine id u64][EReportAck u8]
+		FRAME_REPORT_BATCH	// Binary report batch, see CBinaryReportWriter
+	};
+
+	enum class EReportAck : uint8_t
+	{
+		REPORT_ACK_COMMITTED,	// Durable in the fleet store
+		REPORT_ACK_REJECTED,	// Could not be decoded, resending will not help
+		REPORT_ACK_RESYNC		// Delta against a base the collector does not hold, send the full report
+	};
+
+	// Agent to collector stream framing: [payload length u32][type u8][flags u8][reserved u16][payload]
+	struct SReportFrame
+	{
+		EFrameType nType{ EFrameType::FRAME_UNKNOWN };
+		uint8_t nFlags{ 0 };
+		const char* pPayload{ nullptr };
+		uint32_t nPayloadSize{ 0 };
+	};
+
+	void AppendReportFrame(std::string& stBuffer, EFrameType nType, const char* pPayload, uint32_t nPayloadSize, uint8_t nFlags = 0);
+	void AppendJsonReportFrame(std::string& stBuffer, uint64_t nMachineId, const std::string& stDocument);
+	void AppendAckFrame(std::string& stBuffer, uint64_t nMachineId, EReportAck nAck);
+	bool ParseAckFrame(const SReportFrame& frame, uint64_t& nMachineId, EReportAck& nAck);
+
+	// Reassembles frames from a byte stream read in arbitrary pieces
+	class CReportFrameReader
+	{
+	public:
+		CReportFrameReader() = default;
+		~CReportFrameReader() = default;
+
+		// Returned frames point into the reader and stay valid until the next Append
+		void Append(const char* pData, size_t nSize);
+		bool Next(SReportFrame& frame);
+
+		// Set once a header announces an oversized payload, the stream can not be resynchronized
+		bool IsCorrupt() const { return m_bCorrupt; };
+		size_t GetBufferedSize() const { return m_stBuffer.size() - m_nOffset; };
+
+	private:
+		std::string m_stBuffer;
+		size_t m_nOffset{ 0 };
+		bool m_bCorrupt{ false };
+	};
+};
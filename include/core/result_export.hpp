@@ -0,0 +1,50 @@
+#pragma once
+#include "legacy_export.hpp"
+
+namespace Win11SysCheck
+{
+	static constexpr const char* RESULT_SCHEMA_ID = "win11syscheck.result";
+	// Bumped when a field changes meaning or type, new fields are added without a bump
+	static constexpr uint32_t RESULT_SCHEMA_VERSION = 1;
+
+	// Machine oriented result document, keys and enum values are locale independent and facts keep
+	// their native JSON type:
+	// { "schema": "win11syscheck.result", "version": 1, "machine_id": 42, "summary": { "status": "ok" },
+	//   "os": { "status": "ok", "build": 22621, ... }, "boot": { "firmware": "uefi", ... }, ... }
+	std::string SerializeResultJson(const SProbeResult& result);
+	bool WriteResultJson(const SProbeResult& result, COutputFile& file);
+	// One section as a standalone object carrying the schema, machine id, section key and status,
+	// followed by the members of that section in the full document
+	bool WriteResultSectionJson(const SProbeResult& result, uint64_t nMachineId, EMenuType nType, COutputFile& file);
+	// Reads every fact and section status, missing fields keep their defaults. Fails for another
+	// schema, a newer version or a field of the wrong type.
+	bool ParseResultJson(const char* pData, size_t nSize, SProbeResult& result);
+
+	// The schema identifier is the first member of the documents written by SerializeResultJson,
+	// deltas carry their own and are not result documents
+	bool IsResultJson(const char* pData, size_t nSize);
+	// Reads either export layout, legacy labels are only used for the localized one; fails for deltas
+	bool ParseExportedJson(const char* pData, size_t nSize, SProbeResult& result, const SLegacyLabels& labels = {});
+
+	static constexpr const char* RESULT_DELTA_SCHEMA_ID = "win11syscheck.result.delta";
+	static constexpr const char* RESULT_DELTA_FILE_SUFFIX = ".delta.json";
+	// Longest chain of deltas a reader follows back to a full export
+	static constexpr size_t RESULT_DELTA_MAX_CHAIN = 16;
+
+	// Digest of the serialized result schema document, what a delta is checked against
+	uint64_t ComputeResultDigest(const SProbeResult& result);
+	// Result schema document holding only the statuses and facts that differ from the base, arrays
+	// are written whole. The base is referenced by file name, relative to the delta:
+	// { "schema": "win11syscheck.result.delta", "version": 1, "base": "result_1.json",
+	//   "base_digest": "...", "digest": "...", "ram": { "available": 4294967296 } }
+	bool WriteResultDeltaJson(const SProbeResult& base, const std::string& stBaseFile, const SProbeResult& result, COutputFile& file, size_t& nChangedCount);
+	bool IsResultDeltaJson(const char* pData, size_t nSize);
+	bool ReadResultDeltaBase(const char* pData, size_t nSize, std::string& stBaseFile);
+	// The result must be the base, fails unless both digests match
+	bool ApplyResultDeltaJson(const char* pData, size_t nSize, SProbeResult& result);
+
+	// Reads an export, compressed or not; a delta is rebuilt from the chain of files it is based on.
+	// Legacy documents are evaluated by the readiness rules, so a delta against one diffs real statuses.
+	bool ParseResultExport(const char* pData, size_t nSize, const std::string& stFileName, SProbeResult& result, const SLegacyLabels& labels = {});
+	bool LoadResultExport(const std::string& stFileName, SProbeResult& result, const SLegacyLabels& labels = {});
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include "result_export.hpp"
+#include <memory>
+
+namespace Win11SysCheck
+{
+	enum class EExportFormat : uint8_t
+	{
+		EXPORT_FORMAT_JSON,		// Result schema document per machine, one per line
+		EXPORT_FORMAT_LEGACY,	// Localized, pretty printed document per machine
+		EXPORT_FORMAT_CSV,		// Header and a row per machine, the fleet record columns
+		EXPORT_FORMAT_NDJSON,	// A result schema line per machine and section
+		EXPORT_FORMAT_BINARY,	// Report batch frames, as sent to the collector
+		EXPORT_FORMAT_IMAGE,	// Memory mappable result image, read in place
+		EXPORT_FORMAT_MAX
+	};
+
+	static constexpr size_t EXPORT_BINARY_BATCH_SIZE = 1024;
+
+	std::string GetExportFormatKey(EExportFormat nFormat);
+	std::string GetExportFileExtension(EExportFormat nFormat);
+	// EXPORT_FORMAT_MAX when the key is unknown
+	EExportFormat FindExportFormat(const std::string& stKey);
+
+	// Quotes the value when it holds a separator, quote or line break
+	void AppendCsvField(std::string& stLine, const std::string& stValue);
+
+	// Writes probe results of one or more machines to an output file in one format. Results are
+	// expected to carry evaluated section statuses; the caller commits the file after Finish.
+	class CResultExporter
+	{
+	public:
+		explicit CResultExporter(COutputFile& file) : m_file(file) {};
+		virtual ~CResultExporter() = default;
+
+		CResultExporter(const CResultExporter&) = delete;
+		CResultExporter& operator=(const CResultExporter&) = delete;
+
+		virtual bool Add(const SProbeResult& result, uint64_t nMachineId) = 0;
+		// Writes what the back-end still buffers
+		virtual bool Finish() { return !m_file.IsFailed(); };
+
+	protected:
+		COutputFile& m_file;
+	};
+
+	std::unique_ptr <CResultExporter> CreateResultExporter(EExportFormat nFormat, COutputFile& file, const SLegacyLabels& labels = {});
+};
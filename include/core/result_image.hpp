@@ -0,0 +1,241 @@
+#pragma once
+#include "mapped_file.hpp"
+#include "output_file.hpp"
+#include "probe_result.hpp"
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+
+namespace Win11SysCheck
+{
+	// Bumped only for layout changes old readers cannot skip, new fields and sections keep the version
+	static constexpr uint16_t RESULT_IMAGE_VERSION = 1;
+	static constexpr size_t RESULT_IMAGE_ALIGNMENT = 8;
+
+	enum class EResultImageSection : uint32_t
+	{
+		IMAGE_SECTION_MACHINES = 1,
+		IMAGE_SECTION_VOLUMES,
+		IMAGE_SECTION_MONITORS,
+		IMAGE_SECTION_PANELS,
+		IMAGE_SECTION_ADAPTERS,
+		IMAGE_SECTION_STRINGS,
+		IMAGE_SECTION_MAX
+	};
+
+	struct SResultImageHeader
+	{
+		char szMagic[8];
+		uint16_t nVersion;
+		uint16_t nHeaderSize;
+		uint32_t nSectionCount;
+		uint64_t nFileSize;
+	};
+
+	// Offsets table entry, the directory follows the header
+	struct SResultImageSection
+	{
+		uint32_t nType;
+		uint32_t nEntrySize; // Stride of the fixed width records, one for the string pool
+		uint64_t nOffset;
+		uint64_t nCount;
+	};
+
+	// Interned in the string pool, zero terminated there
+	struct SImageString
+	{
+		uint32_t nOffset;
+		uint32_t nLength;
+	};
+
+	// Records of a machine in one of the item sections
+	struct SImageRange
+	{
+		uint32_t nFirst;
+		uint32_t nCount;
+	};
+
+	// Fixed width records are read in place. Fields are only ever appended: readers stride by the
+	// entry size of the file, skip what they do not know and check IsImageFieldPresent before
+	// touching a field added after the record first shipped.
+	struct SImageMachine
+	{
+		uint64_t nMachineId;
+		uint64_t nBootFlags;
+		uint64_t nTotalPhysical;
+		uint64_t nAvailablePhysical;
+		uint32_t nMajorVersion;
+		uint32_t nMinorVersion;
+		uint32_t nBuildNumber;
+		uint32_t nPlatformId;
+		uint32_t nProductType;
+		uint16_t nServicePackMajor;
+		uint16_t nServicePackMinor;
+		uint32_t nTpmVersion;
+		uint32_t nPlatformSpecificField;
+		SImageString stCPUVendor;
+		SImageString stCPUName;
+		uint32_t nActiveProcessorCount;
+		uint32_t nProcessorCount;
+		uint32_t nMaxMhz;
+		uint32_t nFastProcessorCount;
+		uint16_t nArchitecture;
+		uint16_t nFamily;
+		uint16_t nModel;
+		uint8_t nStepping;
+		uint8_t nFirmwareType;
+		uint32_t nDirectXMajor;
+		uint32_t nDirectXMinor;
+		SImageRange volumes;
+		SImageRange monitors;
+		SImageRange panels;
+		SImageRange adapters;
+		uint8_t bSecureBootCapable;
+		uint8_t bSecureBootEnabled;
+		uint8_t bTpmPresent;
+		uint8_t bArmV81Atomics;
+		uint8_t bConnected;
+		uint8_t bReachable;
+		uint8_t arStatuses[static_cast<size_t>(EMenuType::MENU_TYPE_MAX)];
+		uint8_t nReserved;
+		uint64_t nCPUFeatures;
+	};
+
+	struct SImageVolume
+	{
+		SImageString stPath;
+		SImageString stDeviceName;
+		SImageString stVolumeName;
+		SImageString stFileSystem;
+		uint64_t nTotalBytes;
+		uint64_t nFreeBytes;
+		uint8_t nPartitionStyle;
+		uint8_t nReserved[7];
+	};
+
+	struct SImageMonitor
+	{
+		SImageString stDeviceID;
+		SImageString stDeviceName;
+		SImageString stDeviceString;
+		uint32_t nBitsPerPixel;
+		int32_t nWidth;
+		int32_t nHeight;
+		uint8_t bPrimary;
+		uint8_t nReserved[3];
+	};
+
+	struct SImagePanel
+	{
+		SImageString stRegistryPath;
+		uint16_t nWidthCm;
+		uint16_t nHeightCm;
+		uint32_t nReserved;
+	};
+
+	struct SImageAdapter
+	{
+		SImageString stDescription;
+		SImageString stDriverModel;
+	};
+
+	// Version 1 record sizes, the least a reader accepts
+	static_assert(sizeof(SResultImageHeader) == 24 && sizeof(SResultImageSection) == 24);
+	static constexpr uint32_t RESULT_IMAGE_MACHINE_V1_SIZE = 160;
+	static_assert(offsetof(SImageMachine, nCPUFeatures) == RESULT_IMAGE_MACHINE_V1_SIZE && sizeof(SImageVolume) == 56 && sizeof(SImageMonitor) == 40);
+	static_assert(sizeof(SImagePanel) == 16 && sizeof(SImageAdapter) == 16);
+
+	constexpr bool IsImageFieldPresent(uint32_t nEntrySize, size_t nFieldOffset, size_t nFieldSize)
+	{
+		return nFieldOffset + nFieldSize <= nEntrySize;
+	}
+
+	// Bounds checked view of the records of one machine, the stride is the entry size of the file
+	template <class T>
+	class CImageSpan
+	{
+	public:
+		CImageSpan() = default;
+		CImageSpan(const char* pData, uint32_t nStride, uint32_t nCount) : m_pData(pData), m_nStride(nStride), m_nCount(nCount) {};
+
+		uint32_t size() const { return m_nCount; };
+		bool empty() const { return !m_nCount; };
+		const T& operator[](size_t nIndex) const { return *reinterpret_cast<const T*>(m_pData + nIndex * m_nStride); };
+
+	private:
+		const char* m_pData{ nullptr };
+		uint32_t m_nStride{ 0 };
+		uint32_t m_nCount{ 0 };
+	};
+
+	// File layout: header, section directory, then each section aligned to RESULT_IMAGE_ALIGNMENT.
+	// Machines are sorted by id; strings are interned once per image. Little endian only.
+	class CResultImageWriter
+	{
+	public:
+		CResultImageWriter() = default;
+		~CResultImageWriter() = default;
+
+		void Add(const SProbeResult& result, uint64_t nMachineId);
+		// Fails when a section outgrows the 32 bit references
+		bool Finish(std::string& stImage) const;
+		bool Write(COutputFile& file) const;
+		void Clear();
+
+		size_t GetMachineCount() const { return m_vMachines.size(); };
+
+	protected:
+		SImageString __Intern(const std::string& stValue);
+
+	private:
+		std::vector <SImageMachine> m_vMachines;
+		std::vector <SImageVolume> m_vVolumes;
+		std::vector <SImageMonitor> m_vMonitors;
+		std::vector <SImagePanel> m_vPanels;
+		std::vector <SImageAdapter> m_vAdapters;
+		std::string m_stStrings;
+		std::unordered_map <std::string, SImageString> m_mapStrings;
+	};
+
+	// Validates the header and directory on open, records are accessed in place afterwards. Item
+	// ranges and string references are checked on access, broken ones read as empty.
+	class CResultImageReader
+	{
+	public:
+		CResultImageReader() = default;
+		~CResultImageReader() = default;
+
+		CResultImageReader(const CResultImageReader&) = delete;
+		CResultImageReader& operator=(const CResultImageReader&) = delete;
+
+		// A compressed image is decoded into memory first
+		bool Open(const std::string& stFileName);
+		// The buffer must be aligned and outlive the reader
+		bool Attach(const char* pData, size_t nSize);
+
+		size_t GetMachineCount() const { return static_cast<size_t>(m_arSections[0].nCount); };
+		const SImageMachine& GetMachine(size_t nIndex) const;
+		const SImageMachine* FindMachine(uint64_t nMachineId) const;
+		uint32_t GetEntrySize(EResultImageSection nSection) const;
+
+		CImageSpan<SImageVolume> GetVolumes(const SImageMachine& machine) const;
+		CImageSpan<SImageMonitor> GetMonitors(const SImageMachine& machine) const;
+		CImageSpan<SImagePanel> GetPanels(const SImageMachine& machine) const;
+		CImageSpan<SImageAdapter> GetAdapters(const SImageMachine& machine) const;
+		std::string_view GetString(const SImageString& stValue) const;
+
+		// Copies the machine into the probe result used by the rules and exporters
+		void ReadResult(const SImageMachine& machine, SProbeResult& result) const;
+
+	protected:
+		template <class T>
+		CImageSpan<T> __GetSpan(EResultImageSection nSection, const SImageRange& range) const;
+
+	private:
+		CMappedFile m_file;
+		std::string m_stDecompressed;
+		const char* m_pData{ nullptr };
+		size_t m_nSize{ 0 };
+		std::array <SResultImageSection, static_cast<size_t>(EResultImageSection::IMAGE_SECTION_MAX) - 1> m_arSections{};
+	};
+};
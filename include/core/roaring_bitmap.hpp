@@ -0,0 +1,84 @@
+#pragma once
+#include "simd_support.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	// Roaring style compressed set of 32 bit row numbers: rows are split by their high 16 bits
+	// into containers which hold either a sorted array (up to 4096 entries) or a 65536 bit bitmap
+	class CRoaringBitmap
+	{
+		struct SContainer
+		{
+			uint16_t nKey{ 0 };
+			uint32_t nCardinality{ 0 };
+			std::vector <uint16_t> vArray;	// Sorted, used while the container is sparse
+			std::vector <uint64_t> vBitmap; // 1024 words once dense
+
+			bool IsBitmap() const { return !vBitmap.empty(); };
+		};
+
+	public:
+		CRoaringBitmap() = default;
+		~CRoaringBitmap() = default;
+
+		// Rows added in increasing order take the append fast path
+		void Add(uint32_t nRow);
+		bool Contains(uint32_t nRow) const;
+		uint64_t Cardinality() const;
+		bool IsEmpty() const { return m_vContainers.empty(); };
+
+		static CRoaringBitmap And(const CRoaringBitmap& lhs, const CRoaringBitmap& rhs);
+		static CRoaringBitmap Or(const CRoaringBitmap& lhs, const CRoaringBitmap& rhs);
+
+		// Calls fnVisit(row) in increasing order until it returns false
+		template <class F>
+		void ForEach(F&& fnVisit) const
+		{
+			for (const auto& container : m_vContainers)
+			{
+				const auto nHigh = static_cast<uint32_t>(container.nKey) << 16;
+				if (!container.IsBitmap())
+				{
+					for (const auto nLow : container.vArray)
+					{
+						if (!fnVisit(nHigh | nLow))
+							return;
+					}
+					continue;
+				}
+				for (uint32_t i = 0; i < container.vBitmap.size(); ++i)
+				{
+					auto nWord = container.vBitmap[i];
+					while (nWord)
+					{
+						const auto nBit = PopCount64((nWord & (0 - nWord)) - 1);
+						if (!fnVisit(nHigh | (i * 64 + nBit)))
+							return;
+						nWord &= nWord - 1;
+					}
+				}
+			}
+		}
+
+		void Serialize(std::string& stBuffer) const;
+		// Advances nOffset past the bitmap, false on truncated or malformed input
+		bool Deserialize(const char* pData, size_t nSize, size_t& nOffset);
+
+		size_t GetSizeInBytes() const;
+
+	protected:
+		SContainer& __GetContainer(uint16_t nKey);
+		const SContainer* __FindContainer(uint16_t nKey) const;
+
+		static void __ToBitmap(SContainer& container);
+		static void __Optimize(SContainer& container);
+		static SContainer __AndContainers(const SContainer& lhs, const SContainer& rhs);
+		static SContainer __OrContainers(const SContainer& lhs, const SContainer& rhs);
+
+	private:
+		std::vector <SContainer> m_vContainers; // Sorted by key
+	};
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define WIN11SYSCHECK_X86 1
+#endif
+
+// GCC and Clang only emit wider instructions for functions that ask for them, MSVC always does
+#if defined(WIN11SYSCHECK_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#else
+#define SIMD_TARGET_SSE42
+#define SIMD_TARGET_AVX2
+#endif
+
+namespace Win11SysCheck
+{
+	enum class ESimdLevel : uint8_t
+	{
+		SIMD_SCALAR,
+		SIMD_SSE42,
+		SIMD_AVX2
+	};
+
+	// Highest level the processor and the OS (saved YMM state) both support, detected once
+	ESimdLevel GetSupportedSimdLevel();
+	const char* GetSimdLevelName(ESimdLevel nLevel);
+	// Unknown names fall back to the supported level, requested levels above it are clamped
+	ESimdLevel ParseSimdLevel(const char* szName);
+
+	// Branch free bit count, portable across compilers that do not assume the POPCNT instruction
+	inline uint32_t PopCount64(uint64_t nValue)
+	{
+		nValue = nValue - ((nValue >> 1) & 0x5555555555555555ull);
+		nValue = (nValue & 0x3333333333333333ull) + ((nValue >> 2) & 0x3333333333333333ull);
+		nValue = (nValue + (nValue >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return static_cast<uint32_t>((nValue * 0x0101010101010101ull) >> 56);
+	}
+
+	// Leading zero count through the same popcount, 64 for zero
+	inline uint32_t LeadingZeros64(uint64_t nValue)
+	{
+		nValue |= nValue >> 1;
+		nValue |= nValue >> 2;
+		nValue |= nValue >> 4;
+		nValue |= nValue >> 8;
+		nValue |= nValue >> 16;
+		nValue |= nValue >> 32;
+		return 64 - PopCount64(nValue);
+	}
+};
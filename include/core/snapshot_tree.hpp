@@ -0,0 +1,122 @@
+#pragma once
+#include "mapped_file.hpp"
+#include "probe_result.hpp"
+#include <array>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	struct SSnapshotFact
+	{
+		std::string stName;		// Path below the group, "secure_boot_enabled"
+		std::string stValue;
+		uint64_t nHash{ 0 };	// Over the full path and the value
+	};
+
+	// A scalar section or one element of a list, "boot" or "disk.volumes[1]"
+	struct SSnapshotGroup
+	{
+		std::string stName;
+		uint64_t nHash{ 0 };
+		std::vector <SSnapshotFact> vFacts; // Sorted by name
+	};
+
+	struct SSnapshotSection
+	{
+		uint64_t nHash{ 0 };
+		std::vector <SSnapshotGroup> vGroups; // Sorted by name
+	};
+
+	struct SFactChange
+	{
+		std::string stPath;
+		std::string stBefore;	// Empty when the fact was added
+		std::string stAfter;	// Empty when the fact was removed
+	};
+
+	// Merkle tree of one scan: root -> sections -> groups -> facts. Statuses form the summary section so a
+	// readiness flip shows up next to the facts that caused it. Volatile amounts (available memory, free
+	// space) are left out unless asked for, they differ between any two scans.
+	class CSnapshotTree
+	{
+	public:
+		CSnapshotTree() = default;
+		explicit CSnapshotTree(const SProbeResult& result, bool bIncludeVolatile = false);
+		~CSnapshotTree() = default;
+
+		uint64_t GetRootHash() const { return m_nRootHash; };
+		const SSnapshotSection& GetSection(EMenuType nType) const { return m_arSections[static_cast<size_t>(nType)]; };
+
+		// Hashes are not written, Deserialize recomputes them
+		void Serialize(std::string& stBuffer) const;
+		bool Deserialize(const char* pData, size_t nSize);
+
+	protected:
+		SSnapshotGroup& __AddGroup(EMenuType nType, std::string stName);
+		void __AddFact(SSnapshotGroup& group, const char* szName, std::string stValue);
+		void __UpdateHashes();
+
+	private:
+		uint64_t m_nRootHash{ 0 };
+		std::array <SSnapshotSection, static_cast<size_t>(EMenuType::MENU_TYPE_MAX)> m_arSections;
+	};
+
+	// Descends only into subtrees whose hashes differ, so equal scans cost one comparison
+	size_t DiffSnapshots(const CSnapshotTree& before, const CSnapshotTree& after, std::vector <SFactChange>& vChanges);
+
+	// Snapshot of a fleet: a machine index sorted by id with root hashes, then the serialized trees.
+	// Root hashes are compared straight from the mapping, only changed machines are decoded.
+	class CSnapshotFileWriter
+	{
+	public:
+		explicit CSnapshotFileWriter(bool bIncludeVolatile = false) : m_bIncludeVolatile(bIncludeVolatile) {};
+		~CSnapshotFileWriter() = default;
+
+		// Fails for an id added before, a scan holds each machine once
+		bool Add(uint64_t nMachineId, const SProbeResult& result);
+		// Compressed snapshots are decoded into memory by the reader
+		bool Save(const std::string& stFileName, bool bCompressed = false);
+
+		size_t GetMachineCount() const { return m_vMachines.size(); };
+
+	private:
+		struct SMachine
+		{
+			uint64_t nMachineId;
+			uint64_t nRootHash;
+			std::string stTree;
+		};
+
+		bool m_bIncludeVolatile;
+		std::vector <SMachine> m_vMachines;
+		std::unordered_set <uint64_t> m_setMachineIds;
+	};
+
+	class CSnapshotFileReader
+	{
+	public:
+		CSnapshotFileReader() = default;
+		~CSnapshotFileReader() = default;
+
+		bool Open(const std::string& stFileName);
+
+		size_t GetMachineCount() const { return m_nMachineCount; };
+		bool IncludesVolatile() const { return m_bIncludeVolatile; };
+		uint64_t GetMachineId(size_t nIndex) const;
+		uint64_t GetRootHash(size_t nIndex) const;
+		// Index of the machine, GetMachineCount when missing
+		size_t Find(uint64_t nMachineId) const;
+		bool ReadTree(size_t nIndex, CSnapshotTree& tree) const;
+
+	private:
+		CMappedFile m_file;
+		std::string m_stDecompressed;
+		bool m_bIncludeVolatile{ false };
+		size_t m_nMachineCount{ 0 };
+		const char* m_pIndex{ nullptr };
+		const char* m_pTrees{ nullptr };
+		size_t m_nTreesSize{ 0 };
+	};
+};
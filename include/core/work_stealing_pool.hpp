@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	// Every worker owns a task deque; owners run their newest task first while idle workers
+	// steal the oldest task of a sibling, so uneven batches still keep all cores busy
+	class CWorkStealingPool
+	{
+		using TTask = std::function <void()>;
+
+		struct SWorkerQueue
+		{
+			std::mutex mtx;
+			std::deque <TTask> dqTasks;
+		};
+
+	public:
+		explicit CWorkStealingPool(uint32_t nThreadCount = 0);
+		~CWorkStealingPool();
+
+		CWorkStealingPool(const CWorkStealingPool&) = delete;
+		CWorkStealingPool& operator=(const CWorkStealingPool&) = delete;
+
+		// Tasks submitted from a worker go to its own queue, external submissions are spread round robin
+		void Submit(TTask task);
+		// Blocks until every submitted task, including the ones submitted by tasks, has finished
+		void Wait();
+
+		uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_vThreads.size()); };
+		// Index of the calling worker in [0, GetThreadCount()), -1 outside of the pool
+		static int32_t GetWorkerIndex();
+
+	protected:
+		void __WorkerRoutine(uint32_t nIndex);
+		bool __PopTask(uint32_t nIndex, TTask& task);
+
+	private:
+		std::vector <std::unique_ptr <SWorkerQueue>> m_vQueues;
+		std::vector <std::thread> m_vThreads;
+		std::atomic <uint32_t> m_nNextQueue{ 0 };
+		std::atomic <uint64_t> m_nPendingCount{ 0 }; // Queued and running
+		std::atomic <uint64_t> m_nQueuedCount{ 0 };
+		std::atomic <bool> m_bStopping{ false };
+
+		std::mutex m_mtxSignal;
+		std::condition_variable m_cvWork;
+		std::condition_variable m_cvIdle;
+	};
+};
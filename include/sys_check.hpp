@@ -1,45 +1,20 @@
 #pragma once
 #include "abstract_singleton.hpp"
 #include "pch.hpp"
+#include "core/probe_types.hpp"
+#include "core/metrics.hpp"
+#include "core/probe_result.hpp"
+#include "core/result_exporter.hpp"
+#include "core/bloom_filter.hpp"
 
 namespace Win11SysCheck
 {
-	enum class EStatus : uint8_t
-	{
-		STATUS_UNKNOWN,
-		STATUS_INITIALIZING,
-		STATUS_OK,
-		STATUS_FAIL
-	};
-
-	enum class EMenuType : uint8_t
-	{
-		MENU_TYPE_UNKNOWN,
-		MENU_TYPE_SUMMARY,
-		MENU_TYPE_OS,
-		MENU_TYPE_BOOT,
-		MENU_TYPE_CPU,
-		MENU_TYPE_RAM,
-		MENU_TYPE_DISK,
-		MENU_TYPE_DISPLAY,
-		MENU_TYPE_INTERNET,
-		MENU_TYPE_MAX
-	};
-
 	struct SSystemDetails
 	{
 		std::string stTitle;
 		std::vector <std::string> vecTexts;
 	};
 
-	struct SDiskContext
-	{
-		std::string stPath;
-		std::string stDeviceName;
-		std::string stVolumeName;
-		std::string stFileSystem;
-	};
-
 	class CSysCheck : public CSingleton <CSysCheck>
 	{
 		typedef NTSTATUS(NTAPI* TNtQuerySystemInformation)(UINT SystemInformationClass, PVOID SystemInformation, ULONG SystemInformationLength, PULONG ReturnLength);
@@ -53,12 +28,16 @@ namespace Win11SysCheck
 		void Destroy();
 
 		bool ExportResult(std::string& stFileName);
+		EExportFormat GetExportFormat() const { return m_nExportFormat; };
+		// Persisted to the config
+		void SetExportFormat(EExportFormat nFormat);
 
-		void AddMonitorInformation(const std::string& stInfo);
 		bool LoadSystemInformations();
 		SSystemDetails GetSystemDetails(EMenuType nType);
 		bool CanSystemUpgradable();
 
+		const auto& GetProbeResult() const { return m_probeResult; };
+
 		EStatus GetMenuStatus(EMenuType nMenuType);
 		void SetMenuStatus(EMenuType nMenuType, EStatus nStatus);
 
@@ -73,12 +52,20 @@ namespace Win11SysCheck
 		bool __LoadRAMInformations();
 		bool __LoadDiskInformations();
 		bool __LoadDisplayInformations();
+		bool __LoadDxDiagInformations(SDisplayFacts& display);
 		bool __LoadInternetInformations();
 
-		std::string __GetFirmwareName(const uint8_t type);
-		std::string __GetPartitionName(const uint8_t type);
 		std::string __GetVolumePath(PCHAR VolumeName);
 
+		void __BuildLegacyLabels();
+		void __CommitSection(EMenuType nType, EStatus nStatus);
+
+		void __PublishMetrics(uint64_t nScanDurationUs);
+
+		uint64_t __GetMachineId();
+		bool __LoadExportBase(SProbeResult& base, std::string& stBaseFile);
+		void __SaveExportBase(const std::string& stFileName, bool bDelta);
+
 	protected:
 		DWORD					__ThreadRoutine(void);
 		static DWORD WINAPI		__StartThreadRoutine(LPVOID lpParam);
@@ -87,8 +74,15 @@ namespace Win11SysCheck
 		HMODULE m_hNtdll;
 		TNtQuerySystemInformation m_fnNtQuerySystemInformation;
 		TRtlGetVersion m_fnRtlGetVersion;
+		uint32_t m_nProbeTimeoutMs;
+		EExportFormat m_nExportFormat;
+		bool m_bExportCompressed;
+		bool m_bExportDelta;
+		std::string m_stMetricsFile;
 		std::map <EMenuType, EStatus> m_mapStatuses;
 		std::map <EMenuType, SSystemDetails> m_mapSystemDetails;
-		std::vector <std::string> m_vMonitorInfos;
+		SProbeResult m_probeResult;
+		SLegacyLabels m_labels;
+		CBloomFilter m_knownGoodFilter;
 	};
 };
@@ -46,6 +46,9 @@ namespace Win11SysCheck
 		m_spSysCheck = std::make_shared<CSysCheck>();
 		assert(m_spSysCheck || m_spSysCheck.get());
 
+		m_spMetrics = std::make_shared<CMetricsRegistry>();
+		assert(m_spMetrics || m_spMetrics.get());
+
 		// Initialize
 		do
 		{
@@ -0,0 +1,498 @@
+#include "../../include/core/binary_report.hpp"
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+
+namespace Win11SysCheck
+{
+	static constexpr uint64_t BINARY_REPORT_MAX_STRINGS = 1u << 20;
+
+	static uint64_t ZigZagEncode(int64_t nValue)
+	{
+		return (static_cast<uint64_t>(nValue) << 1) ^ static_cast<uint64_t>(nValue >> 63);
+	}
+
+	static int64_t ZigZagDecode(uint64_t nValue)
+	{
+		return static_cast<int64_t>(nValue >> 1) ^ -static_cast<int64_t>(nValue & 1);
+	}
+
+	static size_t GetVarintSize(uint64_t nValue)
+	{
+		size_t nSize = 1;
+		while (nValue >= 0x80)
+		{
+			nValue >>= 7;
+			nSize++;
+		}
+		return nSize;
+	}
+
+	void AppendVarint(std::string& stBuffer, uint64_t nValue)
+	{
+		char arBytes[10];
+		size_t nSize = 0;
+		while (nValue >= 0x80)
+		{
+			arBytes[nSize++] = static_cast<char>((nValue & 0x7F) | 0x80);
+			nValue >>= 7;
+		}
+		arBytes[nSize++] = static_cast<char>(nValue);
+		stBuffer.append(arBytes, nSize);
+	}
+
+	bool ReadVarint(const char*& pData, const char* pEnd, uint64_t& nValue)
+	{
+		nValue = 0;
+		for (uint32_t nShift = 0; nShift < 64 && pData < pEnd; nShift += 7)
+		{
+			const auto nByte = static_cast<uint8_t>(*pData++);
+			nValue |= static_cast<uint64_t>(nByte & 0x7F) << nShift;
+			if (!(nByte & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	bool ParseSectionMask(const std::string& stSections, uint16_t& nSectionMask)
+	{
+		nSectionMask = 0;
+
+		std::istringstream iss(stSections);
+		std::string stName;
+		while (std::getline(iss, stName, ','))
+		{
+			auto bFound = false;
+			for (auto i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+			{
+				if (GetMenuTypeKey(static_cast<EMenuType>(i)) == stName)
+				{
+					nSectionMask |= GetSectionBit(static_cast<EMenuType>(i));
+					bFound = true;
+				}
+			}
+			if (!bFound)
+				return false;
+		}
+		return nSectionMask != 0;
+	}
+
+	CBinaryReportWriter::CBinaryReportWriter(uint16_t nSectionMask) :
+		m_nSectionMask(nSectionMask & BINARY_REPORT_ALL_SECTIONS)
+	{
+	}
+
+	void CBinaryReportWriter::Add(const SProbeResult& result, uint64_t nMachineId)
+	{
+		Add(result, nMachineId, m_nSectionMask);
+	}
+
+	void CBinaryReportWriter::Add(const SProbeResult& result, uint64_t nMachineId, uint16_t nSectionMask)
+	{
+		__AddReport(result, nMachineId, nSectionMask & BINARY_REPORT_ALL_SECTIONS, 0);
+	}
+
+	void CBinaryReportWriter::AddDelta(const SProbeResult& result, uint64_t nMachineId, uint16_t nChangedSections, uint64_t nBaseDigest)
+	{
+		__AddReport(result, nMachineId, (nChangedSections & BINARY_REPORT_ALL_SECTIONS) | BINARY_REPORT_DELTA, nBaseDigest);
+	}
+
+	void CBinaryReportWriter::__AddReport(const SProbeResult& result, uint64_t nMachineId, uint16_t nSectionMask, uint64_t nBaseDigest)
+	{
+		const auto HasSection = [nSectionMask](EMenuType nType) {
+			return (nSectionMask & GetSectionBit(nType)) != 0;
+		};
+
+		AppendVarint(m_stBody, nMachineId);
+		AppendVarint(m_stBody, nSectionMask);
+
+		uint64_t nStatusBits = 0;
+		for (size_t i = 0; i < result.arStatuses.size(); ++i)
+			nStatusBits |= static_cast<uint64_t>(static_cast<uint8_t>(result.arStatuses[i]) & 3) << (i * 2);
+		AppendVarint(m_stBody, nStatusBits);
+		// Digests are uniformly distributed, a varint would only grow them
+		if (nSectionMask & BINARY_REPORT_DELTA)
+			m_stBody.append(reinterpret_cast<const char*>(&nBaseDigest), sizeof(nBaseDigest));
+
+		if (HasSection(EMenuType::MENU_TYPE_OS))
+		{
+			const auto& os = result.os;
+			AppendVarint(m_stBody, os.nMajorVersion);
+			AppendVarint(m_stBody, os.nMinorVersion);
+			AppendVarint(m_stBody, os.nServicePackMajor);
+			AppendVarint(m_stBody, os.nServicePackMinor);
+			AppendVarint(m_stBody, os.nBuildNumber);
+			AppendVarint(m_stBody, os.nPlatformId);
+			AppendVarint(m_stBody, os.nProductType);
+		}
+		if (HasSection(EMenuType::MENU_TYPE_BOOT))
+		{
+			const auto& boot = result.boot;
+			AppendVarint(m_stBody, static_cast<uint8_t>(boot.nFirmwareType));
+			AppendVarint(m_stBody, boot.nBootFlags);
+			AppendVarint(m_stBody, boot.bSecureBootCapable | (boot.bSecureBootEnabled << 1) | (boot.bTpmPresent << 2));
+			AppendVarint(m_stBody, boot.nTpmVersion);
+		}
+		if (HasSection(EMenuType::MENU_TYPE_CPU))
+		{
+			const auto& cpu = result.cpu;
+			__AppendString(cpu.stVendor);
+			__AppendString(cpu.stName);
+			AppendVarint(m_stBody, static_cast<uint16_t>(cpu.nArchitecture));
+			AppendVarint(m_stBody, cpu.nFamily);
+			AppendVarint(m_stBody, cpu.nModel);
+			AppendVarint(m_stBody, cpu.nStepping);
+			AppendVarint(m_stBody, cpu.nPlatformSpecificField);
+			AppendVarint(m_stBody, cpu.nActiveProcessorCount);
+			AppendVarint(m_stBody, cpu.nProcessorCount);
+			AppendVarint(m_stBody, cpu.nMaxMhz);
+			AppendVarint(m_stBody, cpu.nFastProcessorCount);
+			AppendVarint(m_stBody, cpu.bArmV81Atomics);
+			AppendVarint(m_stBody, cpu.nFeatures);
+		}
+		if (HasSection(EMenuType::MENU_TYPE_RAM))
+		{
+			AppendVarint(m_stBody, result.ram.nTotalPhysical);
+			AppendVarint(m_stBody, result.ram.nAvailablePhysical);
+		}
+		if (HasSection(EMenuType::MENU_TYPE_DISK))
+		{
+			AppendVarint(m_stBody, result.disk.vVolumes.size());
+			for (const auto& volume : result.disk.vVolumes)
+			{
+				__AppendString(volume.stPath);
+				__AppendString(volume.stDeviceName);
+				__AppendString(volume.stVolumeName);
+				__AppendString(volume.stFileSystem);
+				AppendVarint(m_stBody, static_cast<uint8_t>(volume.nPartitionStyle));
+				AppendVarint(m_stBody, volume.nTotalBytes);
+				AppendVarint(m_stBody, volume.nFreeBytes);
+			}
+		}
+		if (HasSection(EMenuType::MENU_TYPE_DISPLAY))
+		{
+			const auto& display = result.display;
+			AppendVarint(m_stBody, display.vMonitors.size());
+			for (const auto& monitor : display.vMonitors)
+			{
+				__AppendString(monitor.stDeviceID);
+				__AppendString(monitor.stDeviceName);
+				__AppendString(monitor.stDeviceString);
+				AppendVarint(m_stBody, monitor.bPrimary);
+				AppendVarint(m_stBody, monitor.nBitsPerPixel);
+				AppendVarint(m_stBody, ZigZagEncode(monitor.nWidth));
+				AppendVarint(m_stBody, ZigZagEncode(monitor.nHeight));
+			}
+			AppendVarint(m_stBody, display.vPanels.size());
+			for (const auto& panel : display.vPanels)
+			{
+				__AppendString(panel.stRegistryPath);
+				AppendVarint(m_stBody, panel.nWidthCm);
+				AppendVarint(m_stBody, panel.nHeightCm);
+			}
+			AppendVarint(m_stBody, display.vAdapters.size());
+			for (const auto& adapter : display.vAdapters)
+			{
+				__AppendString(adapter.stDescription);
+				__AppendString(adapter.stDriverModel);
+			}
+			AppendVarint(m_stBody, display.nDirectXMajor);
+			AppendVarint(m_stBody, display.nDirectXMinor);
+		}
+		if (HasSection(EMenuType::MENU_TYPE_INTERNET))
+			AppendVarint(m_stBody, result.internet.bConnected | (result.internet.bReachable << 1));
+
+		m_nReportCount++;
+	}
+
+	size_t CBinaryReportWriter::GetEncodedSize() const
+	{
+		return 1 + GetVarintSize(m_nReportCount) + GetVarintSize(m_vStrings.size()) + m_nStringBytes + m_stBody.size();
+	}
+
+	void CBinaryReportWriter::Finish(std::string& stBuffer)
+	{
+		stBuffer.reserve(stBuffer.size() + GetEncodedSize());
+		stBuffer.push_back(static_cast<char>(BINARY_REPORT_VERSION));
+		AppendVarint(stBuffer, m_nReportCount);
+		AppendVarint(stBuffer, m_vStrings.size());
+		for (const auto& stValue : m_vStrings)
+		{
+			AppendVarint(stBuffer, stValue.size());
+			stBuffer.append(stValue);
+		}
+		stBuffer.append(m_stBody);
+
+		m_nReportCount = 0;
+		m_stBody.clear();
+		m_vStrings.clear();
+		m_mapStrings.clear();
+		m_nStringBytes = 0;
+	}
+
+	void CBinaryReportWriter::__AppendString(const std::string& stValue)
+	{
+		const auto [it, bInserted] = m_mapStrings.emplace(stValue, static_cast<uint32_t>(m_vStrings.size()));
+		if (bInserted)
+		{
+			m_vStrings.emplace_back(stValue);
+			m_nStringBytes += GetVarintSize(stValue.size()) + stValue.size();
+		}
+		AppendVarint(m_stBody, it->second);
+	}
+
+	bool CBinaryReportReader::Open(const char* pData, size_t nSize)
+	{
+		m_pCursor = pData;
+		m_pEnd = pData + nSize;
+		m_nReportCount = 0;
+		m_nReadCount = 0;
+		m_vStrings.clear();
+		m_bCorrupt = true;
+
+		if (!nSize || static_cast<uint8_t>(*m_pCursor++) != BINARY_REPORT_VERSION)
+			return false;
+
+		uint64_t nReportCount = 0, nStringCount = 0;
+		if (!__ReadNumber(nReportCount) || !__ReadNumber(nStringCount) || nStringCount > BINARY_REPORT_MAX_STRINGS)
+			return false;
+
+		m_vStrings.reserve(static_cast<size_t>(nStringCount));
+		for (uint64_t i = 0; i < nStringCount; ++i)
+		{
+			uint64_t nLength = 0;
+			if (!__ReadNumber(nLength) || nLength > static_cast<uint64_t>(m_pEnd - m_pCursor))
+				return false;
+			m_vStrings.emplace_back(m_pCursor, static_cast<size_t>(nLength));
+			m_pCursor += nLength;
+		}
+
+		// Every report takes at least three bytes
+		if (nReportCount > static_cast<uint64_t>(m_pEnd - m_pCursor) / 3)
+			return false;
+
+		m_nReportCount = static_cast<size_t>(nReportCount);
+		m_bCorrupt = false;
+		return true;
+	}
+
+	bool CBinaryReportReader::Next(SProbeResult& result, uint64_t& nMachineId, uint16_t* pnSectionMask, uint64_t* pnBaseDigest)
+	{
+		if (m_bCorrupt)
+			return false;
+		if (m_nReadCount == m_nReportCount)
+		{
+			// Trailing bytes mean the counts were wrong
+			m_bCorrupt = m_pCursor != m_pEnd;
+			return false;
+		}
+
+		result = {};
+		uint64_t nSectionMask = 0, nStatusBits = 0, nBaseDigest = 0;
+		if (!__ReadNumber(nMachineId) || !__ReadNumber(nSectionMask) || !__ReadNumber(nStatusBits) ||
+			(nSectionMask & ~static_cast<uint64_t>(BINARY_REPORT_ALL_SECTIONS | BINARY_REPORT_DELTA)))
+		{
+			m_bCorrupt = true;
+			return false;
+		}
+		if (nSectionMask & BINARY_REPORT_DELTA)
+		{
+			if (static_cast<size_t>(m_pEnd - m_pCursor) < sizeof(nBaseDigest))
+			{
+				m_bCorrupt = true;
+				return false;
+			}
+			std::memcpy(&nBaseDigest, m_pCursor, sizeof(nBaseDigest));
+			m_pCursor += sizeof(nBaseDigest);
+		}
+		result.nMachineId = nMachineId;
+		if (!__ReadSections(result, static_cast<uint16_t>(nSectionMask)))
+		{
+			m_bCorrupt = true;
+			return false;
+		}
+
+		for (size_t i = 0; i < result.arStatuses.size(); ++i)
+			result.arStatuses[i] = static_cast<EStatus>((nStatusBits >> (i * 2)) & 3);
+
+		if (pnSectionMask)
+			*pnSectionMask = static_cast<uint16_t>(nSectionMask);
+		if (pnBaseDigest)
+			*pnBaseDigest = nBaseDigest;
+		m_nReadCount++;
+		return true;
+	}
+
+	bool CBinaryReportReader::__ReadNumber(uint64_t& nValue)
+	{
+		return ReadVarint(m_pCursor, m_pEnd, nValue);
+	}
+
+	template <class T>
+	bool CBinaryReportReader::__Read(T& value)
+	{
+		uint64_t nValue = 0;
+		if (!__ReadNumber(nValue))
+			return false;
+
+		if constexpr (std::is_enum_v<T>)
+		{
+			using TUnderlying = std::underlying_type_t<T>;
+			if (nValue > (std::numeric_limits<TUnderlying>::max)())
+				return false;
+			value = static_cast<T>(nValue);
+		}
+		else if constexpr (std::is_same_v<T, bool>)
+		{
+			if (nValue > 1)
+				return false;
+			value = nValue != 0;
+		}
+		else if constexpr (std::is_signed_v<T>)
+		{
+			const auto nSigned = ZigZagDecode(nValue);
+			if (nSigned < (std::numeric_limits<T>::min)() || nSigned > (std::numeric_limits<T>::max)())
+				return false;
+			value = static_cast<T>(nSigned);
+		}
+		else
+		{
+			if (nValue > (std::numeric_limits<T>::max)())
+				return false;
+			value = static_cast<T>(nValue);
+		}
+		return true;
+	}
+
+	bool CBinaryReportReader::__ReadString(std::string& stValue)
+	{
+		uint64_t nIndex = 0;
+		if (!__ReadNumber(nIndex) || nIndex >= m_vStrings.size())
+			return false;
+		stValue = m_vStrings[static_cast<size_t>(nIndex)];
+		return true;
+	}
+
+	bool CBinaryReportReader::__ReadSections(SProbeResult& result, uint16_t nSectionMask)
+	{
+		const auto HasSection = [nSectionMask](EMenuType nType) {
+			return (nSectionMask & GetSectionBit(nType)) != 0;
+		};
+		// Counts are bounded by the remaining bytes, each element takes at least one
+		const auto ReadCount = [this](size_t& nCount) {
+			uint64_t nValue = 0;
+			if (!__ReadNumber(nValue) || nValue > static_cast<uint64_t>(m_pEnd - m_pCursor))
+				return false;
+			nCount = static_cast<size_t>(nValue);
+			return true;
+		};
+		size_t nCount = 0;
+
+		if (HasSection(EMenuType::MENU_TYPE_OS))
+		{
+			auto& os = result.os;
+			if (!__Read(os.nMajorVersion) || !__Read(os.nMinorVersion) || !__Read(os.nServicePackMajor) || !__Read(os.nServicePackMinor) ||
+				!__Read(os.nBuildNumber) || !__Read(os.nPlatformId) || !__Read(os.nProductType))
+				return false;
+		}
+		if (HasSection(EMenuType::MENU_TYPE_BOOT))
+		{
+			auto& boot = result.boot;
+			uint8_t nBootBits = 0;
+			if (!__Read(boot.nFirmwareType) || !__Read(boot.nBootFlags) || !__Read(nBootBits) || !__Read(boot.nTpmVersion))
+				return false;
+			boot.bSecureBootCapable = nBootBits & 1;
+			boot.bSecureBootEnabled = (nBootBits >> 1) & 1;
+			boot.bTpmPresent = (nBootBits >> 2) & 1;
+		}
+		if (HasSection(EMenuType::MENU_TYPE_CPU))
+		{
+			auto& cpu = result.cpu;
+			if (!__ReadString(cpu.stVendor) || !__ReadString(cpu.stName) || !__Read(cpu.nArchitecture) || !__Read(cpu.nFamily) ||
+				!__Read(cpu.nModel) || !__Read(cpu.nStepping) || !__Read(cpu.nPlatformSpecificField) || !__Read(cpu.nActiveProcessorCount) ||
+				!__Read(cpu.nProcessorCount) || !__Read(cpu.nMaxMhz) || !__Read(cpu.nFastProcessorCount) || !__Read(cpu.bArmV81Atomics) ||
+				!__Read(cpu.nFeatures))
+				return false;
+		}
+		if (HasSection(EMenuType::MENU_TYPE_RAM))
+		{
+			if (!__Read(result.ram.nTotalPhysical) || !__Read(result.ram.nAvailablePhysical))
+				return false;
+		}
+		if (HasSection(EMenuType::MENU_TYPE_DISK))
+		{
+			if (!ReadCount(nCount))
+				return false;
+			result.disk.vVolumes.resize(nCount);
+			for (auto& volume : result.disk.vVolumes)
+			{
+				if (!__ReadString(volume.stPath) || !__ReadString(volume.stDeviceName) || !__ReadString(volume.stVolumeName) ||
+					!__ReadString(volume.stFileSystem) || !__Read(volume.nPartitionStyle) || !__Read(volume.nTotalBytes) || !__Read(volume.nFreeBytes))
+					return false;
+			}
+		}
+		if (HasSection(EMenuType::MENU_TYPE_DISPLAY))
+		{
+			auto& display = result.display;
+			if (!ReadCount(nCount))
+				return false;
+			display.vMonitors.resize(nCount);
+			for (auto& monitor : display.vMonitors)
+			{
+				if (!__ReadString(monitor.stDeviceID) || !__ReadString(monitor.stDeviceName) || !__ReadString(monitor.stDeviceString) ||
+					!__Read(monitor.bPrimary) || !__Read(monitor.nBitsPerPixel) || !__Read(monitor.nWidth) || !__Read(monitor.nHeight))
+					return false;
+			}
+
+			if (!ReadCount(nCount))
+				return false;
+			display.vPanels.resize(nCount);
+			for (auto& panel : display.vPanels)
+			{
+				if (!__ReadString(panel.stRegistryPath) || !__Read(panel.nWidthCm) || !__Read(panel.nHeightCm))
+					return false;
+			}
+
+			if (!ReadCount(nCount))
+				return false;
+			display.vAdapters.resize(nCount);
+			for (auto& adapter : display.vAdapters)
+			{
+				if (!__ReadString(adapter.stDescription) || !__ReadString(adapter.stDriverModel))
+					return false;
+			}
+
+			if (!__Read(display.nDirectXMajor) || !__Read(display.nDirectXMinor))
+				return false;
+		}
+		if (HasSection(EMenuType::MENU_TYPE_INTERNET))
+		{
+			uint8_t nInternetBits = 0;
+			if (!__Read(nInternetBits))
+				return false;
+			result.internet.bConnected = nInternetBits & 1;
+			result.internet.bReachable = (nInternetBits >> 1) & 1;
+		}
+		return true;
+	}
+
+	void EncodeBinaryReport(const SProbeResult& result, uint64_t nMachineId, std::string& stBuffer, uint16_t nSectionMask)
+	{
+		CBinaryReportWriter writer(nSectionMask);
+		writer.Add(result, nMachineId);
+		writer.Finish(stBuffer);
+	}
+
+	bool DecodeBinaryReport(const char* pData, size_t nSize, SProbeResult& result, uint64_t& nMachineId)
+	{
+		CBinaryReportReader reader;
+		if (!reader.Open(pData, nSize) || reader.GetReportCount() != 1 || !reader.Next(result, nMachineId))
+			return false;
+
+		// Also validates there are no trailing bytes
+		SProbeResult extra;
+		uint64_t nExtraId = 0;
+		return !reader.Next(extra, nExtraId) && !reader.IsCorrupt();
+	}
+};
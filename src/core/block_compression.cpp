@@ -0,0 +1,508 @@
+#include "../../include/core/block_compression.hpp"
+#include "../../include/core/simd_support.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#ifdef WIN11SYSCHECK_X86
+#include <immintrin.h>
+#endif
+
+namespace Win11SysCheck
+{
+	static constexpr char COMPRESSION_STREAM_MAGIC[4]{ 'W', '1', '1', 'Z' };
+	static constexpr uint8_t COMPRESSION_STREAM_VERSION = 1;
+	static constexpr uint32_t COMPRESSION_BLOCK_RAW = 0x80000000u;
+	static constexpr uint32_t COMPRESSION_MIN_BLOCK_LOG = 12;
+	static constexpr uint32_t COMPRESSION_MAX_BLOCK_LOG = 22;
+
+	static constexpr uint32_t LZ_HASH_LOG = 14;
+	static constexpr size_t LZ_MIN_MATCH = 4;
+	static constexpr size_t LZ_LAST_LITERALS = 5;	// The format ends every block with literals
+	static constexpr size_t LZ_MATCH_SEARCH_END = 12;	// and lets no match start closer to the end
+	static constexpr size_t LZ_MAX_OFFSET = 65535;
+
+	static uint32_t Read32(const char* pData)
+	{
+		uint32_t nValue;
+		std::memcpy(&nValue, pData, sizeof(nValue));
+		return nValue;
+	}
+
+	static uint64_t Read64(const char* pData)
+	{
+		uint64_t nValue;
+		std::memcpy(&nValue, pData, sizeof(nValue));
+		return nValue;
+	}
+
+	template <class T>
+	static void AppendValue(std::string& stBuffer, T value)
+	{
+		stBuffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	// Slicing by eight, table k advances a byte through k further zero bytes
+	static const std::array <std::array <uint32_t, 256>, 8>& GetCrc32cTables()
+	{
+		static const auto s_arTables = [] {
+			std::array <std::array <uint32_t, 256>, 8> arTables{};
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				auto nCrc = i;
+				for (auto j = 0; j < 8; ++j)
+					nCrc = (nCrc >> 1) ^ (0x82F63B78u & (0u - (nCrc & 1)));
+				arTables[0][i] = nCrc;
+			}
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				for (size_t j = 1; j < arTables.size(); ++j)
+					arTables[j][i] = (arTables[j - 1][i] >> 8) ^ arTables[0][arTables[j - 1][i] & 0xFF];
+			}
+			return arTables;
+		}();
+		return s_arTables;
+	}
+
+	static uint32_t Crc32cScalar(const char* pData, size_t nSize, uint32_t nCrc)
+	{
+		const auto& arTables = GetCrc32cTables();
+		for (; nSize >= 8; pData += 8, nSize -= 8)
+		{
+			const auto nValue = Read64(pData) ^ nCrc;
+			nCrc = arTables[7][nValue & 0xFF] ^ arTables[6][(nValue >> 8) & 0xFF] ^ arTables[5][(nValue >> 16) & 0xFF] ^ arTables[4][(nValue >> 24) & 0xFF] ^
+				arTables[3][(nValue >> 32) & 0xFF] ^ arTables[2][(nValue >> 40) & 0xFF] ^ arTables[1][(nValue >> 48) & 0xFF] ^ arTables[0][nValue >> 56];
+		}
+		for (; nSize; --nSize)
+			nCrc = (nCrc >> 8) ^ arTables[0][(nCrc ^ static_cast<uint8_t>(*pData++)) & 0xFF];
+		return nCrc;
+	}
+
+#ifdef WIN11SYSCHECK_X86
+	SIMD_TARGET_SSE42 static uint32_t Crc32cSSE42(const char* pData, size_t nSize, uint32_t nCrc)
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+		uint64_t nWide = nCrc;
+		for (; nSize >= 8; pData += 8, nSize -= 8)
+			nWide = _mm_crc32_u64(nWide, Read64(pData));
+		nCrc = static_cast<uint32_t>(nWide);
+#endif
+		for (; nSize >= 4; pData += 4, nSize -= 4)
+			nCrc = _mm_crc32_u32(nCrc, Read32(pData));
+		for (; nSize; --nSize)
+			nCrc = _mm_crc32_u8(nCrc, static_cast<uint8_t>(*pData++));
+		return nCrc;
+	}
+#endif
+
+	uint32_t ComputeCrc32c(const char* pData, size_t nSize, uint32_t nCrc)
+	{
+#ifdef WIN11SYSCHECK_X86
+		static const auto s_bHardware = GetSupportedSimdLevel() >= ESimdLevel::SIMD_SSE42;
+		if (s_bHardware)
+			return ~Crc32cSSE42(pData, nSize, ~nCrc);
+#endif
+		return ~Crc32cScalar(pData, nSize, ~nCrc);
+	}
+
+	static uint32_t HashSequence(uint32_t nSequence)
+	{
+		return (nSequence * 2654435761u) >> (32 - LZ_HASH_LOG);
+	}
+
+	static char* WriteLength(char* pOutput, size_t nLength)
+	{
+		for (; nLength >= 255; nLength -= 255)
+			*pOutput++ = static_cast<char>(255);
+		*pOutput++ = static_cast<char>(nLength);
+		return pOutput;
+	}
+
+	// A zero match length writes the closing literals only
+	static char* WriteSequence(char* pOutput, const char* pLiterals, size_t nLiterals, size_t nOffset, size_t nMatch)
+	{
+		const auto pToken = pOutput++;
+		uint8_t nToken = 0;
+		if (nLiterals >= 15)
+		{
+			nToken = 0xF0;
+			pOutput = WriteLength(pOutput, nLiterals - 15);
+		}
+		else
+		{
+			nToken = static_cast<uint8_t>(nLiterals << 4);
+		}
+		std::memcpy(pOutput, pLiterals, nLiterals);
+		pOutput += nLiterals;
+
+		if (nMatch)
+		{
+			*pOutput++ = static_cast<char>(nOffset & 0xFF);
+			*pOutput++ = static_cast<char>(nOffset >> 8);
+			const auto nCode = nMatch - LZ_MIN_MATCH;
+			if (nCode >= 15)
+			{
+				nToken |= 0x0F;
+				pOutput = WriteLength(pOutput, nCode - 15);
+			}
+			else
+			{
+				nToken |= static_cast<uint8_t>(nCode);
+			}
+		}
+		*pToken = static_cast<char>(nToken);
+		return pOutput;
+	}
+
+	static const char* ExtendMatch(const char* pMatch, const char* pReference, const char* pEnd)
+	{
+		while (pMatch + 8 <= pEnd)
+		{
+			const auto nDiff = Read64(pMatch) ^ Read64(pReference);
+			if (nDiff)
+				return pMatch + PopCount64((nDiff & (0 - nDiff)) - 1) / 8;
+			pMatch += 8;
+			pReference += 8;
+		}
+		while (pMatch < pEnd && *pMatch == *pReference)
+		{
+			++pMatch;
+			++pReference;
+		}
+		return pMatch;
+	}
+
+	size_t CompressBlock(const char* pSource, size_t nSize, char* pDestination, std::vector <uint32_t>& vHashTable)
+	{
+		vHashTable.assign(size_t(1) << LZ_HASH_LOG, 0);
+
+		const auto pEnd = pSource + nSize;
+		auto pOutput = pDestination;
+		auto pAnchor = pSource;
+		if (nSize > LZ_MATCH_SEARCH_END)
+		{
+			const auto pSearchEnd = pEnd - LZ_MATCH_SEARCH_END;
+			const auto pMatchEnd = pEnd - LZ_LAST_LITERALS;
+
+			// Skips ahead faster the longer nothing matched
+			size_t nMisses = 0;
+			auto pInput = pSource;
+			while (pInput < pSearchEnd)
+			{
+				const auto nSequence = Read32(pInput);
+				auto& nSlot = vHashTable[HashSequence(nSequence)];
+				auto pReference = pSource + nSlot;
+				nSlot = static_cast<uint32_t>(pInput - pSource);
+
+				if (pReference >= pInput || static_cast<size_t>(pInput - pReference) > LZ_MAX_OFFSET || Read32(pReference) != nSequence)
+				{
+					pInput += 1 + (nMisses++ >> 6);
+					continue;
+				}
+
+				while (pInput > pAnchor && pReference > pSource && pInput[-1] == pReference[-1])
+				{
+					--pInput;
+					--pReference;
+				}
+				const auto pMatch = ExtendMatch(pInput + LZ_MIN_MATCH, pReference + LZ_MIN_MATCH, pMatchEnd);
+				pOutput = WriteSequence(pOutput, pAnchor, pInput - pAnchor, pInput - pReference, pMatch - pInput);
+
+				pInput = pAnchor = pMatch;
+				nMisses = 0;
+				if (pInput < pSearchEnd)
+					vHashTable[HashSequence(Read32(pInput - 2))] = static_cast<uint32_t>(pInput - 2 - pSource);
+			}
+		}
+		pOutput = WriteSequence(pOutput, pAnchor, pEnd - pAnchor, 0, 0);
+		return static_cast<size_t>(pOutput - pDestination);
+	}
+
+	static bool ReadLength(const uint8_t*& pInput, const uint8_t* pEnd, size_t& nLength)
+	{
+		uint8_t nByte;
+		do
+		{
+			if (pInput == pEnd)
+				return false;
+			nByte = *pInput++;
+			nLength += nByte;
+		} while (nByte == 255);
+		return true;
+	}
+
+	bool DecompressBlock(const char* pSource, size_t nSize, char* pDestination, size_t nCapacity, size_t& nWritten)
+	{
+		auto pInput = reinterpret_cast<const uint8_t*>(pSource);
+		const auto pInputEnd = pInput + nSize;
+		auto pOutput = pDestination;
+		const auto pOutputEnd = pDestination + nCapacity;
+
+		while (pInput < pInputEnd)
+		{
+			const auto nToken = *pInput++;
+
+			size_t nLiterals = nToken >> 4;
+			if (nLiterals == 15 && !ReadLength(pInput, pInputEnd, nLiterals))
+				return false;
+			if (nLiterals > static_cast<size_t>(pInputEnd - pInput) || nLiterals > static_cast<size_t>(pOutputEnd - pOutput))
+				return false;
+			std::memcpy(pOutput, pInput, nLiterals);
+			pInput += nLiterals;
+			pOutput += nLiterals;
+
+			// The last sequence has no match
+			if (pInput == pInputEnd)
+				break;
+
+			if (pInputEnd - pInput < 2)
+				return false;
+			const auto nOffset = static_cast<size_t>(pInput[0] | (pInput[1] << 8));
+			pInput += 2;
+			if (!nOffset || nOffset > static_cast<size_t>(pOutput - pDestination))
+				return false;
+
+			size_t nMatch = nToken & 0x0F;
+			if (nMatch == 15 && !ReadLength(pInput, pInputEnd, nMatch))
+				return false;
+			nMatch += LZ_MIN_MATCH;
+			if (nMatch > static_cast<size_t>(pOutputEnd - pOutput))
+				return false;
+
+			const auto pReference = pOutput - nOffset;
+			if (nOffset >= 8 && static_cast<size_t>(pOutputEnd - pOutput) >= nMatch + 8)
+			{
+				// Copies in words, may write up to 7 bytes past the match that the next sequence overwrites
+				for (size_t i = 0; i < nMatch; i += 8)
+					std::memcpy(pOutput + i, pReference + i, 8);
+			}
+			else if (nOffset >= nMatch)
+			{
+				std::memcpy(pOutput, pReference, nMatch);
+			}
+			else
+			{
+				for (size_t i = 0; i < nMatch; ++i)
+					pOutput[i] = pReference[i];
+			}
+			pOutput += nMatch;
+		}
+
+		nWritten = static_cast<size_t>(pOutput - pDestination);
+		return true;
+	}
+
+	bool IsCompressedStream(const char* pData, size_t nSize)
+	{
+		return nSize >= COMPRESSION_STREAM_HEADER_SIZE && !std::memcmp(pData, COMPRESSION_STREAM_MAGIC, sizeof(COMPRESSION_STREAM_MAGIC));
+	}
+
+	// Rounded up to a power of two inside the supported range
+	CStreamCompressor::CStreamCompressor(uint32_t nBlockSize) :
+		m_nBlockSize(uint32_t(1) << COMPRESSION_MIN_BLOCK_LOG)
+	{
+		while (m_nBlockSize < nBlockSize && m_nBlockSize < COMPRESSION_MAX_BLOCK_SIZE)
+			m_nBlockSize <<= 1;
+	}
+
+	void CStreamCompressor::__WriteHeader(std::string& stOutput)
+	{
+		uint8_t nBlockLog = 0;
+		while ((uint32_t(1) << nBlockLog) < m_nBlockSize)
+			nBlockLog++;
+
+		stOutput.append(COMPRESSION_STREAM_MAGIC, sizeof(COMPRESSION_STREAM_MAGIC));
+		AppendValue(stOutput, COMPRESSION_STREAM_VERSION);
+		AppendValue(stOutput, nBlockLog);
+		AppendValue(stOutput, uint16_t(0));
+		m_bStarted = true;
+	}
+
+	void CStreamCompressor::__CompressBlock(const char* pData, size_t nSize, std::string& stOutput)
+	{
+		const auto nCrc = ComputeCrc32c(pData, nSize);
+		const auto nHeaderOffset = stOutput.size();
+		stOutput.resize(nHeaderOffset + COMPRESSION_BLOCK_HEADER_SIZE + GetCompressBound(nSize));
+
+		const auto pPayload = &stOutput[nHeaderOffset + COMPRESSION_BLOCK_HEADER_SIZE];
+		auto nStoredSize = static_cast<uint32_t>(CompressBlock(pData, nSize, pPayload, m_vHashTable));
+		auto nStoredWord = nStoredSize;
+		if (nStoredSize >= nSize)
+		{
+			std::memcpy(pPayload, pData, nSize);
+			nStoredSize = static_cast<uint32_t>(nSize);
+			nStoredWord = nStoredSize | COMPRESSION_BLOCK_RAW;
+		}
+
+		const uint32_t arHeader[3]{ nStoredWord, static_cast<uint32_t>(nSize), nCrc };
+		std::memcpy(&stOutput[nHeaderOffset], arHeader, sizeof(arHeader));
+		stOutput.resize(nHeaderOffset + COMPRESSION_BLOCK_HEADER_SIZE + nStoredSize);
+	}
+
+	void CStreamCompressor::Append(const char* pData, size_t nSize, std::string& stOutput)
+	{
+		if (!m_bStarted)
+			__WriteHeader(stOutput);
+		m_nContentSize += nSize;
+
+		while (nSize)
+		{
+			// Whole blocks of the input skip the staging copy
+			if (m_stBlock.empty() && nSize >= m_nBlockSize)
+			{
+				__CompressBlock(pData, m_nBlockSize, stOutput);
+				pData += m_nBlockSize;
+				nSize -= m_nBlockSize;
+				continue;
+			}
+
+			const auto nCopy = (std::min)(nSize, m_nBlockSize - m_stBlock.size());
+			m_stBlock.append(pData, nCopy);
+			pData += nCopy;
+			nSize -= nCopy;
+			if (m_stBlock.size() == m_nBlockSize)
+			{
+				__CompressBlock(m_stBlock.data(), m_stBlock.size(), stOutput);
+				m_stBlock.clear();
+			}
+		}
+	}
+
+	void CStreamCompressor::Finish(std::string& stOutput)
+	{
+		if (!m_bStarted)
+			__WriteHeader(stOutput);
+		if (!m_stBlock.empty())
+		{
+			__CompressBlock(m_stBlock.data(), m_stBlock.size(), stOutput);
+			m_stBlock.clear();
+		}
+		AppendValue(stOutput, uint32_t(0));
+		AppendValue(stOutput, m_nContentSize);
+	}
+
+	void CStreamCompressor::Reset()
+	{
+		m_bStarted = false;
+		m_nContentSize = 0;
+		m_stBlock.clear();
+	}
+
+	bool CStreamDecompressor::Append(const char* pData, size_t nSize, std::string& stOutput)
+	{
+		if (m_bCorrupt)
+			return false;
+
+		// Decodes straight from the caller unless a partial block is pending
+		const auto bDirect = m_nOffset == m_stBuffer.size();
+		if (!bDirect)
+			m_stBuffer.append(pData, nSize);
+		const auto pInput = bDirect ? pData : m_stBuffer.data() + m_nOffset;
+		const auto nInput = bDirect ? nSize : m_stBuffer.size() - m_nOffset;
+
+		size_t nConsumed = 0;
+		while (!m_bCorrupt)
+		{
+			const auto pBuffered = pInput + nConsumed;
+			const auto nBuffered = nInput - nConsumed;
+			if (m_bFinished)
+			{
+				// Nothing may follow the trailer
+				m_bCorrupt = nBuffered != 0;
+				break;
+			}
+
+			if (!m_nBlockSize)
+			{
+				if (nBuffered < COMPRESSION_STREAM_HEADER_SIZE)
+					break;
+				const auto nBlockLog = static_cast<uint8_t>(pBuffered[5]);
+				if (!IsCompressedStream(pBuffered, nBuffered) || static_cast<uint8_t>(pBuffered[4]) != COMPRESSION_STREAM_VERSION ||
+					nBlockLog < COMPRESSION_MIN_BLOCK_LOG || nBlockLog > COMPRESSION_MAX_BLOCK_LOG)
+				{
+					m_bCorrupt = true;
+					break;
+				}
+				m_nBlockSize = uint32_t(1) << nBlockLog;
+				nConsumed += COMPRESSION_STREAM_HEADER_SIZE;
+				continue;
+			}
+
+			if (nBuffered < sizeof(uint32_t))
+				break;
+			const auto nStoredWord = Read32(pBuffered);
+			if (!nStoredWord)
+			{
+				if (nBuffered < COMPRESSION_STREAM_TRAILER_SIZE)
+					break;
+				m_bCorrupt = Read64(pBuffered + sizeof(uint32_t)) != m_nContentSize;
+				m_bFinished = true;
+				nConsumed += COMPRESSION_STREAM_TRAILER_SIZE;
+				continue;
+			}
+
+			if (nBuffered < COMPRESSION_BLOCK_HEADER_SIZE)
+				break;
+			const auto bRaw = (nStoredWord & COMPRESSION_BLOCK_RAW) != 0;
+			const auto nStoredSize = nStoredWord & ~COMPRESSION_BLOCK_RAW;
+			const auto nRawSize = Read32(pBuffered + 4);
+			if (nRawSize > m_nBlockSize || nStoredSize > GetCompressBound(m_nBlockSize) || (bRaw && nStoredSize != nRawSize))
+			{
+				m_bCorrupt = true;
+				break;
+			}
+			if (nBuffered < COMPRESSION_BLOCK_HEADER_SIZE + nStoredSize)
+				break;
+
+			const auto pPayload = pBuffered + COMPRESSION_BLOCK_HEADER_SIZE;
+			const auto nOutputOffset = stOutput.size();
+			stOutput.resize(nOutputOffset + nRawSize);
+			size_t nWritten = nRawSize;
+			if (bRaw)
+				std::memcpy(&stOutput[nOutputOffset], pPayload, nRawSize);
+			else if (!DecompressBlock(pPayload, nStoredSize, &stOutput[nOutputOffset], nRawSize, nWritten))
+				nWritten = 0;
+
+			if (nWritten != nRawSize || ComputeCrc32c(stOutput.data() + nOutputOffset, nRawSize) != Read32(pBuffered + 8))
+			{
+				stOutput.resize(nOutputOffset);
+				m_bCorrupt = true;
+				break;
+			}
+			m_nContentSize += nRawSize;
+			nConsumed += COMPRESSION_BLOCK_HEADER_SIZE + nStoredSize;
+		}
+
+		if (bDirect)
+		{
+			m_stBuffer.assign(pData + nConsumed, nSize - nConsumed);
+			m_nOffset = 0;
+			return !m_bCorrupt;
+		}
+
+		// Consumed input is dropped once it outweighs what is still pending
+		m_nOffset += nConsumed;
+		if (m_nOffset >= m_stBuffer.size() - m_nOffset)
+		{
+			m_stBuffer.erase(0, m_nOffset);
+			m_nOffset = 0;
+		}
+		return !m_bCorrupt;
+	}
+
+	void CStreamDecompressor::Reset()
+	{
+		m_stBuffer.clear();
+		m_nOffset = 0;
+		m_nBlockSize = 0;
+		m_nContentSize = 0;
+		m_bFinished = false;
+		m_bCorrupt = false;
+	}
+
+	bool DecompressStream(const char* pData, size_t nSize, std::string& stOutput)
+	{
+		CStreamDecompressor decompressor;
+		return decompressor.Append(pData, nSize, stOutput) && decompressor.IsFinished();
+	}
+};
@@ -0,0 +1,366 @@
+#include "../../include/core/blocker_sketch.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include "../../include/core/output_file.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace Win11SysCheck
+{
+	static constexpr char BLOCKER_SKETCH_MAGIC[8]{ 'W', '1', '1', 'T', 'O', 'P', 'K', '1' };
+
+	static bool ReadBytes(const char* pData, size_t nSize, size_t& nOffset, void* pOut, size_t nLength)
+	{
+		if (nOffset > nSize || nSize - nOffset < nLength)
+			return false;
+		std::memcpy(pOut, pData + nOffset, nLength);
+		nOffset += nLength;
+		return true;
+	}
+
+	template <class T>
+	static void AppendValue(std::string& stBuffer, T value)
+	{
+		stBuffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	CSpaceSaving::CSpaceSaving(uint32_t nCapacity) :
+		m_nCapacity((std::max)(nCapacity, 1u))
+	{
+		m_vHeap.reserve(m_nCapacity);
+		m_mapSlots.reserve(m_nCapacity);
+	}
+
+	void CSpaceSaving::Offer(const std::string& stKey, uint64_t nCount)
+	{
+		m_nTotal += nCount;
+
+		const auto it = m_mapSlots.find(stKey);
+		if (it != m_mapSlots.end())
+		{
+			m_vHeap[it->second].nCount += nCount;
+			__SiftDown(it->second);
+			return;
+		}
+
+		if (m_vHeap.size() < m_nCapacity)
+		{
+			m_vHeap.emplace_back(SHeavyHitter{ stKey, nCount, 0 });
+			m_mapSlots.emplace(stKey, m_vHeap.size() - 1);
+			__SiftUp(m_vHeap.size() - 1);
+			return;
+		}
+
+		// Evict the smallest counter, the newcomer may have been counted there all along
+		auto& slot = m_vHeap.front();
+		m_mapSlots.erase(slot.stKey);
+		slot.stKey = stKey;
+		slot.nError = slot.nCount;
+		slot.nCount += nCount;
+		m_mapSlots.emplace(stKey, 0);
+		__SiftDown(0);
+	}
+
+	void CSpaceSaving::Merge(const CSpaceSaving& other)
+	{
+		const auto nMinCount = __GetMinCount();
+		const auto nOtherMinCount = other.__GetMinCount();
+
+		std::vector <SHeavyHitter> vMerged;
+		vMerged.reserve(m_vHeap.size() + other.m_vHeap.size());
+
+		for (const auto& counter : m_vHeap)
+		{
+			const auto pOther = other.Find(counter.stKey);
+			vMerged.emplace_back(SHeavyHitter{
+				counter.stKey,
+				counter.nCount + (pOther ? pOther->nCount : nOtherMinCount),
+				counter.nError + (pOther ? pOther->nError : nOtherMinCount)
+			});
+		}
+		for (const auto& counter : other.m_vHeap)
+		{
+			if (m_mapSlots.find(counter.stKey) == m_mapSlots.end())
+				vMerged.emplace_back(SHeavyHitter{ counter.stKey, counter.nCount + nMinCount, counter.nError + nMinCount });
+		}
+
+		if (vMerged.size() > m_nCapacity)
+		{
+			std::nth_element(vMerged.begin(), vMerged.begin() + m_nCapacity, vMerged.end(), [](const auto& lhs, const auto& rhs) { return lhs.nCount > rhs.nCount; });
+			vMerged.resize(m_nCapacity);
+		}
+
+		m_nTotal += other.m_nTotal;
+		m_vHeap = std::move(vMerged);
+		m_mapSlots.clear();
+		for (size_t i = 0; i < m_vHeap.size(); ++i)
+			m_mapSlots.emplace(m_vHeap[i].stKey, i);
+		for (auto i = m_vHeap.size() / 2; i-- > 0;)
+			__SiftDown(i);
+	}
+
+	std::vector <SHeavyHitter> CSpaceSaving::GetTop(size_t nCount) const
+	{
+		auto vTop = m_vHeap;
+		std::sort(vTop.begin(), vTop.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.nCount != rhs.nCount ? lhs.nCount > rhs.nCount : lhs.stKey < rhs.stKey;
+		});
+		if (vTop.size() > nCount)
+			vTop.resize(nCount);
+		return vTop;
+	}
+
+	const SHeavyHitter* CSpaceSaving::Find(const std::string& stKey) const
+	{
+		const auto it = m_mapSlots.find(stKey);
+		if (it == m_mapSlots.end())
+			return nullptr;
+		return &m_vHeap[it->second];
+	}
+
+	// [capacity u32][total u64][counter count u32] then per counter [key length u16][key][count u64][error u64]
+	void CSpaceSaving::Serialize(std::string& stBuffer) const
+	{
+		AppendValue(stBuffer, m_nCapacity);
+		AppendValue(stBuffer, m_nTotal);
+		AppendValue(stBuffer, static_cast<uint32_t>(m_vHeap.size()));
+		for (const auto& counter : m_vHeap)
+		{
+			const auto nLength = static_cast<uint16_t>((std::min)(counter.stKey.size(), size_t(UINT16_MAX)));
+			AppendValue(stBuffer, nLength);
+			stBuffer.append(counter.stKey.data(), nLength);
+			AppendValue(stBuffer, counter.nCount);
+			AppendValue(stBuffer, counter.nError);
+		}
+	}
+
+	bool CSpaceSaving::Deserialize(const char* pData, size_t nSize, size_t& nOffset)
+	{
+		m_vHeap.clear();
+		m_mapSlots.clear();
+
+		uint32_t nCount = 0;
+		if (!ReadBytes(pData, nSize, nOffset, &m_nCapacity, sizeof(m_nCapacity)) || !ReadBytes(pData, nSize, nOffset, &m_nTotal, sizeof(m_nTotal)) ||
+			!ReadBytes(pData, nSize, nOffset, &nCount, sizeof(nCount)) || !m_nCapacity || nCount > m_nCapacity)
+			return false;
+
+		for (uint32_t i = 0; i < nCount; ++i)
+		{
+			SHeavyHitter counter{};
+			uint16_t nLength = 0;
+			if (!ReadBytes(pData, nSize, nOffset, &nLength, sizeof(nLength)))
+				return false;
+			counter.stKey.resize(nLength);
+			if (!ReadBytes(pData, nSize, nOffset, &counter.stKey[0], nLength) ||
+				!ReadBytes(pData, nSize, nOffset, &counter.nCount, sizeof(counter.nCount)) || !ReadBytes(pData, nSize, nOffset, &counter.nError, sizeof(counter.nError)))
+				return false;
+			if (!m_mapSlots.emplace(counter.stKey, m_vHeap.size()).second)
+				return false;
+			m_vHeap.emplace_back(std::move(counter));
+		}
+		for (auto i = m_vHeap.size() / 2; i-- > 0;)
+			__SiftDown(i);
+		return true;
+	}
+
+	// Keys never offered count zero until every counter is taken
+	uint64_t CSpaceSaving::__GetMinCount() const
+	{
+		if (m_vHeap.size() < m_nCapacity)
+			return 0;
+		return m_vHeap.front().nCount;
+	}
+
+	void CSpaceSaving::__SiftUp(size_t nIndex)
+	{
+		while (nIndex)
+		{
+			const auto nParent = (nIndex - 1) / 2;
+			if (m_vHeap[nParent].nCount <= m_vHeap[nIndex].nCount)
+				break;
+			__Swap(nParent, nIndex);
+			nIndex = nParent;
+		}
+	}
+
+	void CSpaceSaving::__SiftDown(size_t nIndex)
+	{
+		while (true)
+		{
+			const auto nLeft = nIndex * 2 + 1;
+			const auto nRight = nLeft + 1;
+			auto nSmallest = nIndex;
+			if (nLeft < m_vHeap.size() && m_vHeap[nLeft].nCount < m_vHeap[nSmallest].nCount)
+				nSmallest = nLeft;
+			if (nRight < m_vHeap.size() && m_vHeap[nRight].nCount < m_vHeap[nSmallest].nCount)
+				nSmallest = nRight;
+			if (nSmallest == nIndex)
+				break;
+			__Swap(nIndex, nSmallest);
+			nIndex = nSmallest;
+		}
+	}
+
+	void CSpaceSaving::__Swap(size_t nLeft, size_t nRight)
+	{
+		std::swap(m_vHeap[nLeft], m_vHeap[nRight]);
+		m_mapSlots[m_vHeap[nLeft].stKey] = nLeft;
+		m_mapSlots[m_vHeap[nRight].stKey] = nRight;
+	}
+
+	CCountMinSketch::CCountMinSketch(uint32_t nWidth, uint32_t nDepth) :
+		m_nWidth((std::max)(nWidth, 1u)), m_nDepth((std::max)(nDepth, 1u))
+	{
+		m_vCounters.resize(static_cast<size_t>(m_nWidth) * m_nDepth);
+	}
+
+	// Row hashes are derived as h1 + row * h2 from one 64 bit FNV-1a hash
+	void CCountMinSketch::Add(const std::string& stKey, uint64_t nCount)
+	{
+		const auto nHash = __Hash(stKey);
+		const auto nLow = static_cast<uint32_t>(nHash), nHigh = static_cast<uint32_t>(nHash >> 32) | 1;
+		for (uint32_t i = 0; i < m_nDepth; ++i)
+			m_vCounters[static_cast<size_t>(i) * m_nWidth + (nLow + i * nHigh) % m_nWidth] += nCount;
+	}
+
+	uint64_t CCountMinSketch::Estimate(const std::string& stKey) const
+	{
+		const auto nHash = __Hash(stKey);
+		const auto nLow = static_cast<uint32_t>(nHash), nHigh = static_cast<uint32_t>(nHash >> 32) | 1;
+
+		auto nEstimate = (std::numeric_limits<uint64_t>::max)();
+		for (uint32_t i = 0; i < m_nDepth; ++i)
+			nEstimate = (std::min)(nEstimate, m_vCounters[static_cast<size_t>(i) * m_nWidth + (nLow + i * nHigh) % m_nWidth]);
+		return nEstimate;
+	}
+
+	bool CCountMinSketch::Merge(const CCountMinSketch& other)
+	{
+		if (m_nWidth != other.m_nWidth || m_nDepth != other.m_nDepth)
+			return false;
+
+		for (size_t i = 0; i < m_vCounters.size(); ++i)
+			m_vCounters[i] += other.m_vCounters[i];
+		return true;
+	}
+
+	// [width u32][depth u32][width * depth counters u64]
+	void CCountMinSketch::Serialize(std::string& stBuffer) const
+	{
+		AppendValue(stBuffer, m_nWidth);
+		AppendValue(stBuffer, m_nDepth);
+		stBuffer.append(reinterpret_cast<const char*>(m_vCounters.data()), m_vCounters.size() * sizeof(uint64_t));
+	}
+
+	bool CCountMinSketch::Deserialize(const char* pData, size_t nSize, size_t& nOffset)
+	{
+		if (!ReadBytes(pData, nSize, nOffset, &m_nWidth, sizeof(m_nWidth)) || !ReadBytes(pData, nSize, nOffset, &m_nDepth, sizeof(m_nDepth)) || !m_nWidth || !m_nDepth)
+			return false;
+
+		const auto nCount = static_cast<size_t>(m_nWidth) * m_nDepth;
+		if ((nSize - nOffset) / sizeof(uint64_t) < nCount)
+			return false;
+		m_vCounters.resize(nCount);
+		return ReadBytes(pData, nSize, nOffset, m_vCounters.data(), nCount * sizeof(uint64_t));
+	}
+
+	uint64_t CCountMinSketch::__Hash(const std::string& stKey)
+	{
+		auto nHash = 0xCBF29CE484222325ull;
+		for (const auto c : stKey)
+			nHash = (nHash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+
+		// FNV alone leaves the low bits of similar keys correlated
+		nHash ^= nHash >> 33;
+		nHash *= 0xFF51AFD7ED558CCDull;
+		nHash ^= nHash >> 33;
+		return nHash;
+	}
+
+	CBlockerAggregator::CBlockerAggregator(uint32_t nCapacity, uint32_t nWidth, uint32_t nDepth) :
+		m_kTopK(nCapacity), m_kCounts(nWidth, nDepth)
+	{
+	}
+
+	void CBlockerAggregator::Add(const std::vector <std::string>& vReasons)
+	{
+		m_nMachineCount++;
+		if (!vReasons.empty())
+			m_nBlockedCount++;
+
+		for (const auto& stReason : vReasons)
+		{
+			m_kTopK.Offer(stReason);
+			m_kCounts.Add(stReason);
+		}
+	}
+
+	bool CBlockerAggregator::Merge(const CBlockerAggregator& other)
+	{
+		if (!m_kCounts.Merge(other.m_kCounts))
+			return false;
+
+		m_kTopK.Merge(other.m_kTopK);
+		m_nMachineCount += other.m_nMachineCount;
+		m_nBlockedCount += other.m_nBlockedCount;
+		return true;
+	}
+
+	std::vector <SHeavyHitter> CBlockerAggregator::GetTopBlockers(size_t nCount) const
+	{
+		// Rank on the full candidate set since tightening may reorder the tail
+		auto vTop = m_kTopK.GetTop(m_kTopK.GetCapacity());
+		for (auto& hitter : vTop)
+		{
+			const auto nEstimate = m_kCounts.Estimate(hitter.stKey);
+			if (nEstimate < hitter.nCount)
+			{
+				hitter.nError -= (std::min)(hitter.nError, hitter.nCount - nEstimate);
+				hitter.nCount = nEstimate;
+			}
+		}
+
+		std::sort(vTop.begin(), vTop.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.nCount != rhs.nCount ? lhs.nCount > rhs.nCount : lhs.stKey < rhs.stKey;
+		});
+		if (vTop.size() > nCount)
+			vTop.resize(nCount);
+		return vTop;
+	}
+
+	uint64_t CBlockerAggregator::EstimateBlocker(const std::string& stKey) const
+	{
+		const auto nEstimate = m_kCounts.Estimate(stKey);
+		if (const auto pHitter = m_kTopK.Find(stKey))
+			return (std::min)(nEstimate, pHitter->nCount);
+		return nEstimate;
+	}
+
+	bool CBlockerAggregator::Save(const std::string& stFileName) const
+	{
+		std::string stBuffer(BLOCKER_SKETCH_MAGIC, sizeof(BLOCKER_SKETCH_MAGIC));
+		AppendValue(stBuffer, m_nMachineCount);
+		AppendValue(stBuffer, m_nBlockedCount);
+		m_kTopK.Serialize(stBuffer);
+		m_kCounts.Serialize(stBuffer);
+
+		COutputFile file;
+		return file.Open(stFileName) && file.Write(stBuffer.data(), stBuffer.size()) && file.Commit();
+	}
+
+	bool CBlockerAggregator::Load(const std::string& stFileName)
+	{
+		CMappedFile file;
+		if (!file.Open(stFileName))
+			return false;
+
+		const auto pData = file.GetData();
+		const auto nSize = file.GetSize();
+		size_t nOffset = 0;
+
+		char szMagic[sizeof(BLOCKER_SKETCH_MAGIC)]{};
+		return ReadBytes(pData, nSize, nOffset, szMagic, sizeof(szMagic)) && !std::memcmp(szMagic, BLOCKER_SKETCH_MAGIC, sizeof(szMagic)) &&
+			ReadBytes(pData, nSize, nOffset, &m_nMachineCount, sizeof(m_nMachineCount)) && ReadBytes(pData, nSize, nOffset, &m_nBlockedCount, sizeof(m_nBlockedCount)) &&
+			m_kTopK.Deserialize(pData, nSize, nOffset) && m_kCounts.Deserialize(pData, nSize, nOffset) && nOffset == nSize;
+	}
+};
@@ -0,0 +1,136 @@
+#include "../../include/core/bloom_filter.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace Win11SysCheck
+{
+	static constexpr char BLOOM_FILTER_MAGIC[8]{ 'W', '1', '1', 'B', 'L', 'O', 'M', '1' };
+	static constexpr uint32_t BLOOM_FILTER_MAX_HASHES = 32;
+
+	template <class T>
+	static void AppendValue(std::string& stBuffer, T value)
+	{
+		stBuffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	CBloomFilter CBloomFilter::ForFalsePositiveRate(uint64_t nExpectedCount, double dFalsePositiveRate)
+	{
+		const auto dCount = static_cast<double>((std::max)(nExpectedCount, uint64_t(1)));
+		const auto dRate = (std::min)((std::max)(dFalsePositiveRate, 1e-12), 0.5);
+
+		// m = -n ln(p) / ln(2)^2
+		const auto dBits = std::ceil(-dCount * std::log(dRate) / (std::log(2.0) * std::log(2.0)));
+		return ForBitCount(static_cast<uint64_t>(dBits), nExpectedCount);
+	}
+
+	CBloomFilter CBloomFilter::ForBitCount(uint64_t nBitCount, uint64_t nExpectedCount)
+	{
+		nBitCount = (std::max)(nBitCount, uint64_t(64));
+
+		// k = m / n ln(2)
+		const auto dHashes = std::round(static_cast<double>(nBitCount) / (std::max)(nExpectedCount, uint64_t(1)) * std::log(2.0));
+		const auto nHashCount = static_cast<uint32_t>((std::min)((std::max)(dHashes, 1.0), double(BLOOM_FILTER_MAX_HASHES)));
+
+		CBloomFilter filter;
+		filter.__Init(nBitCount, nHashCount);
+		return filter;
+	}
+
+	void CBloomFilter::Insert(const SHardwareFingerprint& fingerprint)
+	{
+		if (IsEmpty())
+			return;
+
+		for (uint32_t i = 0; i < m_nHashCount; ++i)
+		{
+			const auto nBit = (fingerprint.nLow + i * fingerprint.nHigh) % m_nBitCount;
+			m_vWords[nBit / 64] |= uint64_t(1) << (nBit % 64);
+		}
+		m_nItemCount++;
+	}
+
+	bool CBloomFilter::MayContain(const SHardwareFingerprint& fingerprint) const
+	{
+		if (IsEmpty())
+			return false;
+
+		for (uint32_t i = 0; i < m_nHashCount; ++i)
+		{
+			const auto nBit = (fingerprint.nLow + i * fingerprint.nHigh) % m_nBitCount;
+			if (!(m_vWords[nBit / 64] & (uint64_t(1) << (nBit % 64))))
+				return false;
+		}
+		return true;
+	}
+
+	double CBloomFilter::GetEstimatedFalsePositiveRate() const
+	{
+		if (IsEmpty())
+			return 1.0;
+
+		// (1 - e^(-kn/m))^k
+		return std::pow(1.0 - std::exp(-static_cast<double>(m_nHashCount) * m_nItemCount / m_nBitCount), m_nHashCount);
+	}
+
+	// [version u64][profile encoding version u8][bit count u64][hash count u32][item count u64][words]
+	bool CBloomFilter::Save(const std::string& stFileName) const
+	{
+		std::string stBuffer(BLOOM_FILTER_MAGIC, sizeof(BLOOM_FILTER_MAGIC));
+		AppendValue(stBuffer, m_nVersion);
+		AppendValue(stBuffer, HARDWARE_PROFILE_VERSION);
+		AppendValue(stBuffer, m_nBitCount);
+		AppendValue(stBuffer, m_nHashCount);
+		AppendValue(stBuffer, m_nItemCount);
+		stBuffer.append(reinterpret_cast<const char*>(m_vWords.data()), m_vWords.size() * sizeof(uint64_t));
+
+		std::ofstream ofs(stFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+		return ofs && ofs.write(stBuffer.data(), stBuffer.size());
+	}
+
+	bool CBloomFilter::Load(const std::string& stFileName)
+	{
+		m_vWords.clear();
+
+		CMappedFile file;
+		if (!file.Open(stFileName))
+			return false;
+
+		const auto pData = file.GetData();
+		const auto nSize = file.GetSize();
+		size_t nOffset = 0;
+
+		auto Read = [&](void* pOut, size_t nLength) {
+			if (nSize - nOffset < nLength)
+				return false;
+			std::memcpy(pOut, pData + nOffset, nLength);
+			nOffset += nLength;
+			return true;
+		};
+
+		char szMagic[sizeof(BLOOM_FILTER_MAGIC)]{};
+		uint8_t nProfileVersion = 0;
+		uint64_t nBitCount = 0;
+		uint32_t nHashCount = 0;
+		if (!Read(szMagic, sizeof(szMagic)) || std::memcmp(szMagic, BLOOM_FILTER_MAGIC, sizeof(szMagic)) || !Read(&m_nVersion, sizeof(m_nVersion)) ||
+			!Read(&nProfileVersion, sizeof(nProfileVersion)) || nProfileVersion != HARDWARE_PROFILE_VERSION ||
+			!Read(&nBitCount, sizeof(nBitCount)) || !Read(&nHashCount, sizeof(nHashCount)) || !Read(&m_nItemCount, sizeof(m_nItemCount)) ||
+			!nBitCount || !nHashCount || nHashCount > BLOOM_FILTER_MAX_HASHES || (nSize - nOffset) / sizeof(uint64_t) != (nBitCount + 63) / 64)
+			return false;
+
+		const auto nItemCount = m_nItemCount;
+		__Init(nBitCount, nHashCount);
+		m_nItemCount = nItemCount;
+		return Read(m_vWords.data(), m_vWords.size() * sizeof(uint64_t));
+	}
+
+	void CBloomFilter::__Init(uint64_t nBitCount, uint32_t nHashCount)
+	{
+		m_nBitCount = nBitCount;
+		m_nHashCount = nHashCount;
+		m_nItemCount = 0;
+		m_vWords.assign(static_cast<size_t>((nBitCount + 63) / 64), 0);
+	}
+};
@@ -0,0 +1,54 @@
+#include "../../include/core/command_line.hpp"
+#include <cstdlib>
+
+namespace Win11SysCheck
+{
+	CCommandLine::CCommandLine(int argc, char* argv[], int nFirstArg)
+	{
+		for (auto i = nFirstArg; i < argc; ++i)
+		{
+			const std::string stArg = argv[i];
+			if (stArg.size() > 2 && stArg.compare(0, 2, "--") == 0)
+			{
+				const auto nPos = stArg.find('=');
+				if (nPos == std::string::npos)
+					m_mapOptions[stArg.substr(2)] = "";
+				else
+					m_mapOptions[stArg.substr(2, nPos - 2)] = stArg.substr(nPos + 1);
+			}
+			else
+			{
+				m_vPositionals.emplace_back(stArg);
+			}
+		}
+	}
+
+	bool CCommandLine::Has(const std::string& stName) const
+	{
+		return m_mapOptions.find(stName) != m_mapOptions.end();
+	}
+
+	std::string CCommandLine::Get(const std::string& stName, const std::string& stDefault) const
+	{
+		const auto it = m_mapOptions.find(stName);
+		if (it == m_mapOptions.end() || it->second.empty())
+			return stDefault;
+		return it->second;
+	}
+
+	uint64_t CCommandLine::GetNumber(const std::string& stName, uint64_t nDefault) const
+	{
+		const auto stValue = Get(stName);
+		if (stValue.empty())
+			return nDefault;
+		return std::strtoull(stValue.c_str(), nullptr, 0);
+	}
+
+	double CCommandLine::GetDouble(const std::string& stName, double dDefault) const
+	{
+		const auto stValue = Get(stName);
+		if (stValue.empty())
+			return dDefault;
+		return std::strtod(stValue.c_str(), nullptr);
+	}
+};
@@ -0,0 +1,94 @@
+#include "../../include/core/cpu_database.hpp"
+#include "../../include/core/cpu_name_matcher.hpp"
+#include "cpu_database_table.hpp"
+#include <cstring>
+
+namespace Win11SysCheck
+{
+	const SCPUModelEntry* FindCPUModel(ECPUVendor nVendor, const char* pKey, size_t nLength)
+	{
+		const auto nHash = HashCPUModelKey(nVendor, pKey, nLength);
+		const auto nSeed = gs_arCPUModelSeeds[GetPerfectHashBucket(nHash, CPU_MODEL_BUCKET_MASK)];
+		const auto& entry = gs_arCPUModelSlots[GetPerfectHashSlot(nHash, nSeed, CPU_MODEL_SLOT_MASK)];
+
+		// The slot of a key that is not in the table belongs to another key or is empty
+		if (entry.nVendor != nVendor || entry.nLength != nLength || std::memcmp(entry.szKey, pKey, nLength))
+			return nullptr;
+		return &entry;
+	}
+
+	static ECPUSupport FindCPUSignatureKey(uint64_t nKey)
+	{
+		const auto nHash = MixCPUKey(nKey);
+		const auto nSeed = gs_arCPUSignatureSeeds[GetPerfectHashBucket(nHash, CPU_SIGNATURE_BUCKET_MASK)];
+		const auto& entry = gs_arCPUSignatureSlots[GetPerfectHashSlot(nHash, nSeed, CPU_SIGNATURE_SLOT_MASK)];
+		return entry.nKey == nKey ? entry.nSupport : ECPUSupport::CPU_SUPPORT_UNKNOWN;
+	}
+
+	ECPUSupport FindCPUSignature(ECPUVendor nVendor, uint16_t nFamily, uint16_t nModel, uint8_t nStepping, bool* pbExactStepping)
+	{
+		auto nSupport = FindCPUSignatureKey(GetCPUSignatureKey(nVendor, nFamily, nModel, nStepping));
+		if (pbExactStepping)
+			*pbExactStepping = nSupport != ECPUSupport::CPU_SUPPORT_UNKNOWN;
+		if (nSupport == ECPUSupport::CPU_SUPPORT_UNKNOWN)
+			nSupport = FindCPUSignatureKey(GetCPUSignatureKey(nVendor, nFamily, nModel, CPU_SIGNATURE_ANY_STEPPING));
+		if (nSupport == ECPUSupport::CPU_SUPPORT_UNKNOWN)
+			nSupport = FindCPUSignatureKey(GetCPUSignatureKey(nVendor, nFamily, CPU_SIGNATURE_ANY_MODEL, CPU_SIGNATURE_ANY_STEPPING));
+		return nSupport;
+	}
+
+	size_t GetCPUModelCount()
+	{
+		return CPU_MODEL_COUNT;
+	}
+
+	const CCPUNameMatcher& GetCPUNameMatcher()
+	{
+		static const auto sc_matcher = [] {
+			CCPUNameMatcher matcher;
+			for (const auto& entry : gs_arCPUModelSlots)
+			{
+				if (entry.nVendor != ECPUVendor::CPU_VENDOR_UNKNOWN)
+					matcher.Add(entry);
+			}
+			matcher.Build();
+			return matcher;
+		}();
+		return sc_matcher;
+	}
+
+	SCPUClassification ClassifyProcessor(const SCPUFacts& facts)
+	{
+		SCPUClassification classification;
+		classification.nVendor = GetCPUVendor(facts.stVendor);
+		if (classification.nVendor == ECPUVendor::CPU_VENDOR_UNKNOWN)
+			return classification;
+
+		auto bExactStepping = false;
+		const auto nSignatureSupport = FindCPUSignature(classification.nVendor, facts.nFamily, facts.nModel, facts.nStepping, &bExactStepping);
+
+		SCPUNameMatch match;
+		if (GetCPUNameMatcher().Match(facts.stName, classification.nVendor, match))
+		{
+			classification.szModel = match.pModel->szName;
+			if (match.bWholeToken)
+			{
+				classification.nSupport = ECPUSupport::CPU_SUPPORT_SUPPORTED;
+				classification.nMatch = ECPUMatch::CPU_MATCH_MODEL_NAME;
+				classification.nConfidence = nSignatureSupport == ECPUSupport::CPU_SUPPORT_UNSUPPORTED ?
+					ECPUMatchConfidence::CPU_CONFIDENCE_MEDIUM : ECPUMatchConfidence::CPU_CONFIDENCE_HIGH;
+				return classification;
+			}
+			// A listed key inside a longer token, e.g. a variant the lists do not carry, does not decide
+			classification.nConfidence = ECPUMatchConfidence::CPU_CONFIDENCE_LOW;
+		}
+
+		classification.nSupport = nSignatureSupport;
+		if (classification.nSupport != ECPUSupport::CPU_SUPPORT_UNKNOWN)
+		{
+			classification.nMatch = ECPUMatch::CPU_MATCH_SIGNATURE;
+			classification.nConfidence = bExactStepping ? ECPUMatchConfidence::CPU_CONFIDENCE_MEDIUM : ECPUMatchConfidence::CPU_CONFIDENCE_LOW;
+		}
+		return classification;
+	}
+};
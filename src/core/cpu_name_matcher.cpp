@@ -0,0 +1,191 @@
+#include "../../include/core/cpu_name_matcher.hpp"
+#include <algorithm>
+#include <queue>
+
+namespace Win11SysCheck
+{
+	// Digits, letters, '+' and '.'; zero separates tokens
+	static constexpr size_t SYMBOL_COUNT = 38;
+
+	static constexpr uint8_t GetSymbol(char c)
+	{
+		if (c >= '0' && c <= '9')
+			return static_cast<uint8_t>(c - '0' + 1);
+		if (c >= 'A' && c <= 'Z')
+			return static_cast<uint8_t>(c - 'A' + 11);
+		if (c >= 'a' && c <= 'z')
+			return static_cast<uint8_t>(c - 'a' + 11);
+		if (c == '+')
+			return 37;
+		if (c == '.')
+			return 38;
+		return 0;
+	}
+
+	// Length of the "(R)", "(TM)" or "(C)" mark at the position, zero for anything else
+	static size_t GetNoiseMarkLength(std::string_view stName, size_t nPos)
+	{
+		for (const auto& stMark : { std::string_view("(R)"), std::string_view("(TM)"), std::string_view("(C)") })
+		{
+			if (stName.size() - nPos < stMark.size())
+				continue;
+
+			auto bEqual = true;
+			for (size_t i = 0; i < stMark.size() && bEqual; ++i)
+				bEqual = (stName[nPos + i] & ~0x20) == (stMark[i] & ~0x20);
+			if (bEqual)
+				return stMark.size();
+		}
+		return 0;
+	}
+
+	CCPUNameMatcher::CCPUNameMatcher()
+	{
+		__AddState();
+	}
+
+	uint16_t CCPUNameMatcher::__AddState()
+	{
+		m_vTransitions.resize(m_vTransitions.size() + SYMBOL_COUNT, 0);
+		m_vPatterns.emplace_back(-1);
+		m_vOutputLinks.emplace_back(0);
+		return static_cast<uint16_t>(m_vPatterns.size() - 1);
+	}
+
+	void CCPUNameMatcher::Add(const SCPUModelEntry& entry)
+	{
+		if (m_bBuilt || !entry.nLength || m_vPatterns.size() + entry.nLength > UINT16_MAX)
+			return;
+
+		uint16_t nState = 0;
+		for (size_t i = 0; i < entry.nLength; ++i)
+		{
+			const auto nSymbol = GetSymbol(entry.szKey[i]);
+			if (!nSymbol)
+				return;
+
+			const auto nIndex = nState * SYMBOL_COUNT + nSymbol - 1;
+			if (!m_vTransitions[nIndex])
+			{
+				const auto nNext = __AddState();
+				m_vTransitions[nIndex] = nNext;
+			}
+			nState = m_vTransitions[nIndex];
+		}
+
+		// Vendors listing the same key share the state
+		if (m_vPatterns[nState] < 0)
+		{
+			m_vPatterns[nState] = static_cast<int16_t>(m_vKeys.size());
+			m_vKeys.push_back({ entry.nLength, {} });
+		}
+		m_vKeys[m_vPatterns[nState]].arEntries[static_cast<size_t>(entry.nVendor)] = &entry;
+	}
+
+	// Breadth first, so the failure target of a state is complete before the state itself
+	bool CCPUNameMatcher::Build()
+	{
+		if (m_vPatterns.size() > UINT16_MAX || m_vKeys.size() > INT16_MAX)
+			return false;
+
+		std::vector <uint16_t> vFailures(m_vPatterns.size(), 0);
+		std::queue <uint16_t> queStates;
+		for (size_t nSymbol = 0; nSymbol < SYMBOL_COUNT; ++nSymbol)
+		{
+			if (m_vTransitions[nSymbol])
+				queStates.push(m_vTransitions[nSymbol]);
+		}
+
+		while (!queStates.empty())
+		{
+			const auto nState = queStates.front();
+			queStates.pop();
+
+			const auto nFailure = vFailures[nState];
+			m_vOutputLinks[nState] = m_vPatterns[nFailure] >= 0 ? nFailure : m_vOutputLinks[nFailure];
+
+			for (size_t nSymbol = 0; nSymbol < SYMBOL_COUNT; ++nSymbol)
+			{
+				auto& nNext = m_vTransitions[nState * SYMBOL_COUNT + nSymbol];
+				const auto nFallback = m_vTransitions[nFailure * SYMBOL_COUNT + nSymbol];
+				if (!nNext)
+				{
+					nNext = nFallback;
+					continue;
+				}
+				vFailures[nNext] = nFallback;
+				queStates.push(nNext);
+			}
+		}
+
+		m_bBuilt = true;
+		return true;
+	}
+
+	// A key is a whole token when it spans the token so far and the token ends after it, so only the
+	// keys ending at the previous character wait for the next one
+	bool CCPUNameMatcher::Match(std::string_view stName, ECPUVendor nVendor, SCPUNameMatch& match) const
+	{
+		match = {};
+		if (!m_bBuilt)
+			return false;
+
+		struct SPendingMatch
+		{
+			const SCPUModelEntry* pModel;
+			bool bTokenStart;
+		};
+
+		SPendingMatch arPending[CPU_MODEL_KEY_SIZE];
+		size_t nPendingCount = 0, nTokenLength = 0;
+		auto Resolve = [&](bool bTokenEnd) {
+			for (size_t i = 0; i < nPendingCount; ++i)
+			{
+				const auto& pending = arPending[i];
+				const auto bWholeToken = pending.bTokenStart && bTokenEnd;
+				if (match.pModel && (match.bWholeToken > bWholeToken || (match.bWholeToken == bWholeToken && match.pModel->nLength >= pending.pModel->nLength)))
+					continue;
+
+				match.pModel = pending.pModel;
+				match.bWholeToken = bWholeToken;
+			}
+			nPendingCount = 0;
+		};
+
+		uint16_t nState = 0;
+		for (size_t nPos = 0; nPos < stName.size(); ++nPos)
+		{
+			const auto c = stName[nPos];
+			if (c == '@')
+				break;
+			if (c == '-')
+				continue;
+
+			const auto nSymbol = GetSymbol(c);
+			if (!nSymbol)
+			{
+				if (c == '(')
+					nPos += (std::max)(GetNoiseMarkLength(stName, nPos), size_t(1)) - 1;
+				Resolve(true);
+				nState = 0;
+				nTokenLength = 0;
+				continue;
+			}
+
+			Resolve(false);
+			nTokenLength++;
+			nState = m_vTransitions[nState * SYMBOL_COUNT + nSymbol - 1];
+			for (auto nOutput = m_vPatterns[nState] >= 0 ? nState : m_vOutputLinks[nState]; nOutput; nOutput = m_vOutputLinks[nOutput])
+			{
+				const auto& key = m_vKeys[m_vPatterns[nOutput]];
+				auto pModel = nVendor != ECPUVendor::CPU_VENDOR_UNKNOWN ? key.arEntries[static_cast<size_t>(nVendor)] : nullptr;
+				for (size_t j = 1; nVendor == ECPUVendor::CPU_VENDOR_UNKNOWN && !pModel && j < key.arEntries.size(); ++j)
+					pModel = key.arEntries[j];
+				if (pModel)
+					arPending[nPendingCount++] = { pModel, key.nLength == nTokenLength };
+			}
+		}
+		Resolve(true);
+		return match.pModel != nullptr;
+	}
+};
@@ -0,0 +1,195 @@
+#include "../../include/core/cpuid_features.hpp"
+#include "../../include/core/simd_support.hpp"
+#include <cstring>
+
+#if defined(WIN11SYSCHECK_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(WIN11SYSCHECK_X86)
+#include <cpuid.h>
+#endif
+
+namespace Win11SysCheck
+{
+	enum ECPUIDRegister : uint8_t
+	{
+		CPUID_EAX,
+		CPUID_EBX,
+		CPUID_ECX,
+		CPUID_EDX
+	};
+
+	struct SCPUIDBit
+	{
+		uint32_t nLeaf;
+		ECPUIDRegister nRegister;
+		uint8_t nBit;
+		ECPUFeature nFeature;
+	};
+
+	// Sub-leaf zero everywhere
+	static constexpr SCPUIDBit gs_arCPUIDBits[] = {
+		{ 0x00000001, CPUID_EDX, 26, ECPUFeature::CPU_FEATURE_SSE2 },
+		{ 0x00000001, CPUID_ECX, 0, ECPUFeature::CPU_FEATURE_SSE3 },
+		{ 0x00000001, CPUID_ECX, 1, ECPUFeature::CPU_FEATURE_PCLMULQDQ },
+		{ 0x00000001, CPUID_ECX, 9, ECPUFeature::CPU_FEATURE_SSSE3 },
+		{ 0x00000001, CPUID_ECX, 12, ECPUFeature::CPU_FEATURE_FMA3 },
+		{ 0x00000001, CPUID_ECX, 13, ECPUFeature::CPU_FEATURE_CX16 },
+		{ 0x00000001, CPUID_ECX, 19, ECPUFeature::CPU_FEATURE_SSE41 },
+		{ 0x00000001, CPUID_ECX, 20, ECPUFeature::CPU_FEATURE_SSE42 },
+		{ 0x00000001, CPUID_ECX, 22, ECPUFeature::CPU_FEATURE_MOVBE },
+		{ 0x00000001, CPUID_ECX, 23, ECPUFeature::CPU_FEATURE_POPCNT },
+		{ 0x00000001, CPUID_ECX, 25, ECPUFeature::CPU_FEATURE_AES },
+		{ 0x00000001, CPUID_ECX, 26, ECPUFeature::CPU_FEATURE_XSAVE },
+		{ 0x00000001, CPUID_ECX, 27, ECPUFeature::CPU_FEATURE_OSXSAVE },
+		{ 0x00000001, CPUID_ECX, 28, ECPUFeature::CPU_FEATURE_AVX },
+		{ 0x00000001, CPUID_ECX, 29, ECPUFeature::CPU_FEATURE_F16C },
+		{ 0x00000001, CPUID_ECX, 30, ECPUFeature::CPU_FEATURE_RDRAND },
+		{ 0x00000001, CPUID_ECX, 31, ECPUFeature::CPU_FEATURE_HYPERVISOR },
+		{ 0x00000007, CPUID_EBX, 3, ECPUFeature::CPU_FEATURE_BMI1 },
+		{ 0x00000007, CPUID_EBX, 5, ECPUFeature::CPU_FEATURE_AVX2 },
+		{ 0x00000007, CPUID_EBX, 8, ECPUFeature::CPU_FEATURE_BMI2 },
+		{ 0x00000007, CPUID_EBX, 16, ECPUFeature::CPU_FEATURE_AVX512F },
+		{ 0x00000007, CPUID_EBX, 17, ECPUFeature::CPU_FEATURE_AVX512DQ },
+		{ 0x00000007, CPUID_EBX, 18, ECPUFeature::CPU_FEATURE_RDSEED },
+		{ 0x00000007, CPUID_EBX, 28, ECPUFeature::CPU_FEATURE_AVX512CD },
+		{ 0x00000007, CPUID_EBX, 29, ECPUFeature::CPU_FEATURE_SHA },
+		{ 0x00000007, CPUID_EBX, 30, ECPUFeature::CPU_FEATURE_AVX512BW },
+		{ 0x00000007, CPUID_EBX, 31, ECPUFeature::CPU_FEATURE_AVX512VL },
+		{ 0x80000001, CPUID_ECX, 0, ECPUFeature::CPU_FEATURE_LAHF_SAHF },
+		{ 0x80000001, CPUID_ECX, 5, ECPUFeature::CPU_FEATURE_LZCNT },
+		{ 0x80000001, CPUID_ECX, 8, ECPUFeature::CPU_FEATURE_PREFETCHW },
+		{ 0x80000001, CPUID_EDX, 20, ECPUFeature::CPU_FEATURE_NX },
+		{ 0x80000001, CPUID_EDX, 29, ECPUFeature::CPU_FEATURE_LONG_MODE }
+	};
+
+	static constexpr const char* gs_arCPUFeatureNames[] = {
+		"sse2", "sse3", "ssse3", "sse4.1", "sse4.2", "popcnt", "cx16", "lahf_sahf", "prefetchw", "lzcnt", "movbe",
+		"pclmulqdq", "aes", "sha", "rdrand", "rdseed", "xsave", "osxsave", "avx", "f16c", "fma3", "avx2", "bmi1", "bmi2",
+		"avx512f", "avx512dq", "avx512cd", "avx512bw", "avx512vl", "nx", "long_mode", "hypervisor"
+	};
+	static_assert(sizeof(gs_arCPUFeatureNames) / sizeof(gs_arCPUFeatureNames[0]) == static_cast<size_t>(ECPUFeature::CPU_FEATURE_MAX));
+
+#if defined(WIN11SYSCHECK_X86)
+	static void QueryCPUID(uint32_t nLeaf, uint32_t (&arRegisters)[4])
+	{
+#if defined(_MSC_VER)
+		int arCPUID[4]{ 0 };
+		__cpuidex(arCPUID, static_cast<int>(nLeaf), 0);
+		std::memcpy(arRegisters, arCPUID, sizeof(arRegisters));
+#else
+		__cpuid_count(nLeaf, 0, arRegisters[CPUID_EAX], arRegisters[CPUID_EBX], arRegisters[CPUID_ECX], arRegisters[CPUID_EDX]);
+#endif
+	}
+#endif
+
+	bool ReadCPUID(SCPUIDInfo& info)
+	{
+		info = {};
+#if defined(WIN11SYSCHECK_X86)
+#if !defined(_MSC_VER)
+		// 486 class processors without the instruction
+		if (!__get_cpuid_max(0, nullptr))
+			return false;
+#endif
+		uint32_t arRegisters[4]{ 0 };
+		QueryCPUID(0, arRegisters);
+		info.nMaxLeaf = arRegisters[CPUID_EAX];
+
+		char szVendor[12];
+		std::memcpy(szVendor, &arRegisters[CPUID_EBX], 4);
+		std::memcpy(szVendor + 4, &arRegisters[CPUID_EDX], 4);
+		std::memcpy(szVendor + 8, &arRegisters[CPUID_ECX], 4);
+		info.stVendor.assign(szVendor, sizeof(szVendor));
+
+		QueryCPUID(0x80000000, arRegisters);
+		info.nMaxExtendedLeaf = arRegisters[CPUID_EAX] & 0x80000000 ? arRegisters[CPUID_EAX] : 0;
+
+		// The table is ordered by leaf, each leaf is queried once
+		uint32_t nQueriedLeaf = 0;
+		uint64_t nFeatures = 0;
+		for (const auto& bit : gs_arCPUIDBits)
+		{
+			const auto nMaxLeaf = bit.nLeaf & 0x80000000 ? info.nMaxExtendedLeaf : info.nMaxLeaf;
+			if (bit.nLeaf > nMaxLeaf)
+				continue;
+
+			if (bit.nLeaf != nQueriedLeaf)
+			{
+				QueryCPUID(bit.nLeaf, arRegisters);
+				nQueriedLeaf = bit.nLeaf;
+				if (nQueriedLeaf == 1)
+				{
+					info.nSignature = arRegisters[CPUID_EAX];
+					DecodeCPUSignature(info.nSignature, info.nFamily, info.nModel, info.nStepping);
+				}
+			}
+			if ((arRegisters[bit.nRegister] >> bit.nBit) & 1)
+				nFeatures |= GetCPUFeatureBit(bit.nFeature);
+		}
+		info.features = CCPUFeatureSet(nFeatures);
+
+		if (info.nMaxExtendedLeaf >= 0x80000004)
+		{
+			char szBrand[49]{ '\0' };
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				QueryCPUID(0x80000002 + i, arRegisters);
+				std::memcpy(szBrand + i * sizeof(arRegisters), arRegisters, sizeof(arRegisters));
+			}
+			info.stBrand = szBrand;
+
+			const auto nStart = info.stBrand.find_first_not_of(' ');
+			info.stBrand.erase(0, nStart == std::string::npos ? info.stBrand.size() : nStart);
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	const char* GetCPUFeatureName(ECPUFeature nFeature)
+	{
+		if (nFeature >= ECPUFeature::CPU_FEATURE_MAX)
+			return "";
+		return gs_arCPUFeatureNames[static_cast<uint8_t>(nFeature)];
+	}
+
+	std::string FormatCPUFeatures(uint64_t nFeatures)
+	{
+		std::string stFeatures;
+		for (uint8_t i = 0; i < static_cast<uint8_t>(ECPUFeature::CPU_FEATURE_MAX); ++i)
+		{
+			if (!((nFeatures >> i) & 1))
+				continue;
+
+			if (!stFeatures.empty())
+				stFeatures += ' ';
+			stFeatures += gs_arCPUFeatureNames[i];
+		}
+		return stFeatures;
+	}
+
+	uint64_t ParseCPUFeatures(const std::string& stFeatures)
+	{
+		uint64_t nFeatures = 0;
+		size_t nPos = 0;
+		while (nPos < stFeatures.size())
+		{
+			auto nEnd = stFeatures.find(' ', nPos);
+			if (nEnd == std::string::npos)
+				nEnd = stFeatures.size();
+
+			const auto nLength = nEnd - nPos;
+			for (uint8_t i = 0; nLength && i < static_cast<uint8_t>(ECPUFeature::CPU_FEATURE_MAX); ++i)
+			{
+				if (std::strlen(gs_arCPUFeatureNames[i]) == nLength && !stFeatures.compare(nPos, nLength, gs_arCPUFeatureNames[i]))
+				{
+					nFeatures |= 1ull << i;
+					break;
+				}
+			}
+			nPos = nEnd + 1;
+		}
+		return nFeatures;
+	}
+};
@@ -0,0 +1,515 @@
+#include "../../include/core/fleet_eval.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#ifdef WIN11SYSCHECK_X86
+#include <immintrin.h>
+#endif
+
+namespace Win11SysCheck
+{
+	// Kernels compute "value == operand", "value > operand" or "operand > value" for 64 rows at a
+	// time; NE, LE and GE invert the result word
+	enum class ECompareKind : uint8_t
+	{
+		COMPARE_KIND_EQUAL,
+		COMPARE_KIND_GREATER,
+		COMPARE_KIND_LESS
+	};
+
+	static void GetCompareKind(ECompareOp nOp, ECompareKind& nKind, uint64_t& nInvert)
+	{
+		nInvert = 0;
+		switch (nOp)
+		{
+		case ECompareOp::COMPARE_NE:
+			nInvert = ~0ull;
+			[[fallthrough]];
+		case ECompareOp::COMPARE_EQ:
+			nKind = ECompareKind::COMPARE_KIND_EQUAL;
+			break;
+		case ECompareOp::COMPARE_LE:
+			nInvert = ~0ull;
+			[[fallthrough]];
+		case ECompareOp::COMPARE_GT:
+			nKind = ECompareKind::COMPARE_KIND_GREATER;
+			break;
+		case ECompareOp::COMPARE_GE:
+			nInvert = ~0ull;
+			[[fallthrough]];
+		default:
+			nKind = ECompareKind::COMPARE_KIND_LESS;
+			break;
+		}
+	}
+
+	template <ECompareKind Kind>
+	static uint64_t CompareWordScalar(const uint64_t* pValues, size_t nCount, uint64_t nOperand)
+	{
+		uint64_t nWord = 0;
+		for (size_t i = 0; i < nCount; ++i)
+		{
+			bool bResult;
+			if constexpr (Kind == ECompareKind::COMPARE_KIND_EQUAL)
+				bResult = pValues[i] == nOperand;
+			else if constexpr (Kind == ECompareKind::COMPARE_KIND_GREATER)
+				bResult = pValues[i] > nOperand;
+			else
+				bResult = pValues[i] < nOperand;
+			nWord |= static_cast<uint64_t>(bResult) << i;
+		}
+		return nWord;
+	}
+
+	template <ECompareKind Kind>
+	static void CompareScalar(const uint64_t* pValues, size_t nWordCount, uint64_t nOperand, uint64_t nInvert, uint64_t* pWords)
+	{
+		for (size_t i = 0; i < nWordCount; ++i)
+			pWords[i] = CompareWordScalar<Kind>(pValues + i * 64, 64, nOperand) ^ nInvert;
+	}
+
+#ifdef WIN11SYSCHECK_X86
+	// There are only signed 64 bit compares, flipping the sign bit of both sides makes them unsigned
+	template <ECompareKind Kind>
+	SIMD_TARGET_SSE42 static void CompareSSE42(const uint64_t* pValues, size_t nWordCount, uint64_t nOperand, uint64_t nInvert, uint64_t* pWords)
+	{
+		const auto xmmSign = _mm_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+		const auto xmmOperand = _mm_set1_epi64x(static_cast<long long>(nOperand));
+		const auto xmmBiased = _mm_xor_si128(xmmOperand, xmmSign);
+
+		for (size_t i = 0; i < nWordCount; ++i)
+		{
+			const auto pBlock = pValues + i * 64;
+
+			uint64_t nWord = 0;
+			for (size_t j = 0; j < 64; j += 2)
+			{
+				const auto xmmValue = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBlock + j));
+
+				__m128i xmmMask;
+				if constexpr (Kind == ECompareKind::COMPARE_KIND_EQUAL)
+					xmmMask = _mm_cmpeq_epi64(xmmValue, xmmOperand);
+				else if constexpr (Kind == ECompareKind::COMPARE_KIND_GREATER)
+					xmmMask = _mm_cmpgt_epi64(_mm_xor_si128(xmmValue, xmmSign), xmmBiased);
+				else
+					xmmMask = _mm_cmpgt_epi64(xmmBiased, _mm_xor_si128(xmmValue, xmmSign));
+
+				nWord |= static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(xmmMask))) << j;
+			}
+			pWords[i] = nWord ^ nInvert;
+		}
+	}
+
+	template <ECompareKind Kind>
+	SIMD_TARGET_AVX2 static void CompareAVX2(const uint64_t* pValues, size_t nWordCount, uint64_t nOperand, uint64_t nInvert, uint64_t* pWords)
+	{
+		const auto ymmSign = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+		const auto ymmOperand = _mm256_set1_epi64x(static_cast<long long>(nOperand));
+		const auto ymmBiased = _mm256_xor_si256(ymmOperand, ymmSign);
+
+		for (size_t i = 0; i < nWordCount; ++i)
+		{
+			const auto pBlock = pValues + i * 64;
+
+			uint64_t nWord = 0;
+			for (size_t j = 0; j < 64; j += 4)
+			{
+				const auto ymmValue = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBlock + j));
+
+				__m256i ymmMask;
+				if constexpr (Kind == ECompareKind::COMPARE_KIND_EQUAL)
+					ymmMask = _mm256_cmpeq_epi64(ymmValue, ymmOperand);
+				else if constexpr (Kind == ECompareKind::COMPARE_KIND_GREATER)
+					ymmMask = _mm256_cmpgt_epi64(_mm256_xor_si256(ymmValue, ymmSign), ymmBiased);
+				else
+					ymmMask = _mm256_cmpgt_epi64(ymmBiased, _mm256_xor_si256(ymmValue, ymmSign));
+
+				nWord |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(ymmMask))) << j;
+			}
+			pWords[i] = nWord ^ nInvert;
+		}
+	}
+#endif
+
+	template <ECompareKind Kind>
+	static void CompareFullWords(const uint64_t* pValues, size_t nWordCount, uint64_t nOperand, uint64_t nInvert, uint64_t* pWords, ESimdLevel nLevel)
+	{
+#ifdef WIN11SYSCHECK_X86
+		if (nLevel == ESimdLevel::SIMD_AVX2)
+			return CompareAVX2<Kind>(pValues, nWordCount, nOperand, nInvert, pWords);
+		if (nLevel == ESimdLevel::SIMD_SSE42)
+			return CompareSSE42<Kind>(pValues, nWordCount, nOperand, nInvert, pWords);
+#endif
+		CompareScalar<Kind>(pValues, nWordCount, nOperand, nInvert, pWords);
+	}
+
+	void CompareColumn(const uint64_t* pValues, size_t nCount, ECompareOp nOp, uint64_t nOperand, uint64_t* pWords, ESimdLevel nLevel)
+	{
+		ECompareKind nKind;
+		uint64_t nInvert;
+		GetCompareKind(nOp, nKind, nInvert);
+
+		const auto nFullWords = nCount / 64;
+		const auto nTail = nCount % 64;
+		const auto nTailMask = (1ull << nTail) - 1;
+
+		switch (nKind)
+		{
+		case ECompareKind::COMPARE_KIND_EQUAL:
+			CompareFullWords<ECompareKind::COMPARE_KIND_EQUAL>(pValues, nFullWords, nOperand, nInvert, pWords, nLevel);
+			if (nTail)
+				pWords[nFullWords] = (CompareWordScalar<ECompareKind::COMPARE_KIND_EQUAL>(pValues + nFullWords * 64, nTail, nOperand) ^ nInvert) & nTailMask;
+			break;
+		case ECompareKind::COMPARE_KIND_GREATER:
+			CompareFullWords<ECompareKind::COMPARE_KIND_GREATER>(pValues, nFullWords, nOperand, nInvert, pWords, nLevel);
+			if (nTail)
+				pWords[nFullWords] = (CompareWordScalar<ECompareKind::COMPARE_KIND_GREATER>(pValues + nFullWords * 64, nTail, nOperand) ^ nInvert) & nTailMask;
+			break;
+		default:
+			CompareFullWords<ECompareKind::COMPARE_KIND_LESS>(pValues, nFullWords, nOperand, nInvert, pWords, nLevel);
+			if (nTail)
+				pWords[nFullWords] = (CompareWordScalar<ECompareKind::COMPARE_KIND_LESS>(pValues + nFullWords * 64, nTail, nOperand) ^ nInvert) & nTailMask;
+			break;
+		}
+	}
+
+	void CSelectionBitmap::Reset(size_t nRowCount, bool bValue)
+	{
+		m_nRowCount = nRowCount;
+		m_vWords.assign((nRowCount + 63) / 64, bValue ? ~0ull : 0);
+		__ClearTail();
+	}
+
+	void CSelectionBitmap::__ClearTail()
+	{
+		if (m_nRowCount % 64)
+			m_vWords.back() &= (1ull << (m_nRowCount % 64)) - 1;
+	}
+
+	void CSelectionBitmap::And(const CSelectionBitmap& other)
+	{
+		for (size_t i = 0; i < m_vWords.size(); ++i)
+			m_vWords[i] &= other.m_vWords[i];
+	}
+	void CSelectionBitmap::Or(const CSelectionBitmap& other)
+	{
+		for (size_t i = 0; i < m_vWords.size(); ++i)
+			m_vWords[i] |= other.m_vWords[i];
+	}
+	void CSelectionBitmap::AndNot(const CSelectionBitmap& other)
+	{
+		for (size_t i = 0; i < m_vWords.size(); ++i)
+			m_vWords[i] &= ~other.m_vWords[i];
+	}
+	void CSelectionBitmap::Invert()
+	{
+		for (auto& nWord : m_vWords)
+			nWord = ~nWord;
+		__ClearTail();
+	}
+
+	uint64_t CSelectionBitmap::Count() const
+	{
+		uint64_t nCount = 0;
+		for (const auto nWord : m_vWords)
+			nCount += PopCount64(nWord);
+		return nCount;
+	}
+
+	CFleetEvaluator::CFleetEvaluator(std::vector <SFleetRule> vRules, ESimdLevel nLevel) :
+		m_vRules(std::move(vRules)), m_nLevel(nLevel)
+	{
+	}
+
+	void CFleetEvaluator::__EvaluatePredicate(const SFleetPredicate& predicate, const uint64_t* pValues, size_t nRowCount, CSelectionBitmap& bitmap)
+	{
+		if (predicate.nOp != ECompareOp::COMPARE_IN)
+		{
+			CompareColumn(pValues, nRowCount, predicate.nOp, predicate.vOperands.empty() ? 0 : predicate.vOperands.front(), bitmap.GetWords(), m_nLevel);
+			return;
+		}
+
+		bitmap.Reset(nRowCount, false);
+		m_scratchBitmap.Reset(nRowCount, false);
+		for (const auto nOperand : predicate.vOperands)
+		{
+			CompareColumn(pValues, nRowCount, ECompareOp::COMPARE_EQ, nOperand, m_scratchBitmap.GetWords(), m_nLevel);
+			bitmap.Or(m_scratchBitmap);
+		}
+	}
+
+	// Whether min/max alone decide the predicate for the whole row group: 1 all pass, 0 none, -1 undecided
+	static int32_t DecideByStats(const SFleetPredicate& predicate, const SFleetColumnStats& stats)
+	{
+		if (predicate.vOperands.empty())
+			return -1;
+
+		const auto nOperand = predicate.vOperands.front();
+		switch (predicate.nOp)
+		{
+		case ECompareOp::COMPARE_EQ:
+			if (stats.nMin == stats.nMax)
+				return stats.nMin == nOperand;
+			return (nOperand < stats.nMin || nOperand > stats.nMax) ? 0 : -1;
+		case ECompareOp::COMPARE_NE:
+			if (stats.nMin == stats.nMax)
+				return stats.nMin != nOperand;
+			return (nOperand < stats.nMin || nOperand > stats.nMax) ? 1 : -1;
+		case ECompareOp::COMPARE_LT:
+			return stats.nMax < nOperand ? 1 : (stats.nMin >= nOperand ? 0 : -1);
+		case ECompareOp::COMPARE_LE:
+			return stats.nMax <= nOperand ? 1 : (stats.nMin > nOperand ? 0 : -1);
+		case ECompareOp::COMPARE_GT:
+			return stats.nMin > nOperand ? 1 : (stats.nMax <= nOperand ? 0 : -1);
+		case ECompareOp::COMPARE_GE:
+			return stats.nMin >= nOperand ? 1 : (stats.nMax < nOperand ? 0 : -1);
+		default:
+			return -1;
+		}
+	}
+
+	bool CFleetEvaluator::EvaluateRowGroup(const CFleetStoreReader& reader, size_t nGroup, std::vector <CSelectionBitmap>& vRuleBitmaps, CSelectionBitmap& passBitmap)
+	{
+		const auto nRowCount = static_cast<size_t>(reader.GetRowGroupRowCount(nGroup));
+
+		// Every column is decoded at most once per row group
+		std::vector <std::vector <uint64_t>> vDecoded(static_cast<size_t>(EFleetColumn::COLUMN_MAX));
+		std::vector <bool> vIsDecoded(vDecoded.size(), false);
+
+		vRuleBitmaps.resize(m_vRules.size());
+		passBitmap.Reset(nRowCount, true);
+
+		for (size_t i = 0; i < m_vRules.size(); ++i)
+		{
+			auto& ruleBitmap = vRuleBitmaps[i];
+			ruleBitmap.Reset(nRowCount, true);
+
+			for (const auto& predicate : m_vRules[i].vPredicates)
+			{
+				if (!reader.HasColumn(predicate.nColumn))
+					return false;
+
+				const auto nDecision = DecideByStats(predicate, reader.GetColumnStats(nGroup, predicate.nColumn));
+				if (nDecision == 1)
+					continue;
+				if (nDecision == 0)
+				{
+					ruleBitmap.Reset(nRowCount, false);
+					break;
+				}
+
+				const auto nColumn = static_cast<size_t>(predicate.nColumn);
+				if (!vIsDecoded[nColumn])
+				{
+					if (!reader.ReadColumn(nGroup, predicate.nColumn, vDecoded[nColumn]))
+						return false;
+					vIsDecoded[nColumn] = true;
+				}
+
+				m_predicateBitmap.Reset(nRowCount, false);
+				__EvaluatePredicate(predicate, vDecoded[nColumn].data(), nRowCount, m_predicateBitmap);
+				ruleBitmap.And(m_predicateBitmap);
+			}
+
+			passBitmap.And(ruleBitmap);
+		}
+		return true;
+	}
+
+	void CFleetEvaluator::EvaluateColumns(const std::vector <const uint64_t*>& vColumns, size_t nRowCount, std::vector <CSelectionBitmap>& vRuleBitmaps, CSelectionBitmap& passBitmap)
+	{
+		vRuleBitmaps.resize(m_vRules.size());
+		passBitmap.Reset(nRowCount, true);
+
+		for (size_t i = 0; i < m_vRules.size(); ++i)
+		{
+			auto& ruleBitmap = vRuleBitmaps[i];
+			ruleBitmap.Reset(nRowCount, true);
+
+			for (const auto& predicate : m_vRules[i].vPredicates)
+			{
+				m_predicateBitmap.Reset(nRowCount, false);
+				__EvaluatePredicate(predicate, vColumns[static_cast<size_t>(predicate.nColumn)], nRowCount, m_predicateBitmap);
+				ruleBitmap.And(m_predicateBitmap);
+			}
+
+			passBitmap.And(ruleBitmap);
+		}
+	}
+
+	bool CFleetEvaluator::EvaluateStore(const CFleetStoreReader& reader, SFleetEvalResult& result)
+	{
+		result = {};
+		result.vRuleFailCounts.assign(m_vRules.size(), 0);
+
+		size_t nPredicateCount = 0;
+		for (const auto& rule : m_vRules)
+			nPredicateCount += rule.vPredicates.size();
+
+		std::vector <CSelectionBitmap> vRuleBitmaps;
+		CSelectionBitmap passBitmap;
+		for (size_t i = 0; i < reader.GetRowGroupCount(); ++i)
+		{
+			if (!EvaluateRowGroup(reader, i, vRuleBitmaps, passBitmap))
+				return false;
+
+			const auto nRowCount = reader.GetRowGroupRowCount(i);
+			result.nRowCount += nRowCount;
+			result.nPredicateCount += nRowCount * nPredicateCount;
+			result.nPassCount += passBitmap.Count();
+			for (size_t j = 0; j < m_vRules.size(); ++j)
+				result.vRuleFailCounts[j] += nRowCount - vRuleBitmaps[j].Count();
+		}
+		return true;
+	}
+
+	static SFleetPredicate MakePredicate(EFleetColumn nColumn, ECompareOp nOp, std::vector <uint64_t> vOperands)
+	{
+		return SFleetPredicate{ nColumn, nOp, std::move(vOperands) };
+	}
+
+	std::vector <SFleetRule> GetDefaultFleetPolicy()
+	{
+		return {
+			{ "os", {
+				MakePredicate(EFleetColumn::COLUMN_OS_PRODUCT_TYPE, ECompareOp::COMPARE_NE, { 0xB2 }),
+				MakePredicate(EFleetColumn::COLUMN_OS_PRODUCT_TYPE, ECompareOp::COMPARE_NE, { 0xB3 })
+			} },
+			{ "boot", {
+				MakePredicate(EFleetColumn::COLUMN_FIRMWARE_TYPE, ECompareOp::COMPARE_EQ, { static_cast<uint64_t>(EFirmwareType::FIRMWARE_UEFI) }),
+				MakePredicate(EFleetColumn::COLUMN_SECURE_BOOT_CAPABLE, ECompareOp::COMPARE_EQ, { 1 }),
+				MakePredicate(EFleetColumn::COLUMN_TPM_PRESENT, ECompareOp::COMPARE_EQ, { 1 }),
+				MakePredicate(EFleetColumn::COLUMN_TPM_VERSION, ECompareOp::COMPARE_EQ, { 2 })
+			} },
+			{ "cpu", {
+				MakePredicate(EFleetColumn::COLUMN_CPU_ARCHITECTURE, ECompareOp::COMPARE_IN, {
+					static_cast<uint64_t>(EProcessorArchitecture::ARCHITECTURE_AMD64),
+					static_cast<uint64_t>(EProcessorArchitecture::ARCHITECTURE_IA64),
+					static_cast<uint64_t>(EProcessorArchitecture::ARCHITECTURE_ARM64)
+				}),
+				MakePredicate(EFleetColumn::COLUMN_CPU_PROCESSOR_COUNT, ECompareOp::COMPARE_GE, { 2 }),
+				MakePredicate(EFleetColumn::COLUMN_CPU_FAST_PROCESSOR_COUNT, ECompareOp::COMPARE_GE, { 2 }),
+				MakePredicate(EFleetColumn::COLUMN_CPU_SUPPORTED, ECompareOp::COMPARE_EQ, { 1 }),
+				MakePredicate(EFleetColumn::COLUMN_CPU_MISSING_INSTRUCTIONS, ECompareOp::COMPARE_EQ, { 0 })
+			} },
+			{ "ram", {
+				MakePredicate(EFleetColumn::COLUMN_RAM_TOTAL_BYTES, ECompareOp::COMPARE_GE, { 4096000ull * 1024 })
+			} },
+			{ "disk", {
+				MakePredicate(EFleetColumn::COLUMN_LARGEST_VOLUME_BYTES, ECompareOp::COMPARE_GE, { 64001ull * 1024 * 1024 })
+			} },
+			{ "display", {
+				MakePredicate(EFleetColumn::COLUMN_MAX_MONITOR_HEIGHT, ECompareOp::COMPARE_GE, { 720 }),
+				MakePredicate(EFleetColumn::COLUMN_MAX_BITS_PER_PIXEL, ECompareOp::COMPARE_GE, { 8 }),
+				MakePredicate(EFleetColumn::COLUMN_MAX_PANEL_DIAGONAL, ECompareOp::COMPARE_GE, { 900 }),
+				MakePredicate(EFleetColumn::COLUMN_DIRECTX_MAJOR, ECompareOp::COMPARE_GE, { 12 }),
+				MakePredicate(EFleetColumn::COLUMN_MAX_WDDM_VERSION, ECompareOp::COMPARE_GE, { 20 })
+			} },
+			{ "internet", {
+				MakePredicate(EFleetColumn::COLUMN_INTERNET_CONNECTED, ECompareOp::COMPARE_EQ, { 1 }),
+				MakePredicate(EFleetColumn::COLUMN_INTERNET_REACHABLE, ECompareOp::COMPARE_EQ, { 1 })
+			} }
+		};
+	}
+
+	static const struct
+	{
+		const char* szToken;
+		ECompareOp nOp;
+	} gs_arCompareTokens[] = {
+		// Two character tokens first so "<=" is not read as "<"
+		{ "==", ECompareOp::COMPARE_EQ },
+		{ "!=", ECompareOp::COMPARE_NE },
+		{ "<=", ECompareOp::COMPARE_LE },
+		{ ">=", ECompareOp::COMPARE_GE },
+		{ "<", ECompareOp::COMPARE_LT },
+		{ ">", ECompareOp::COMPARE_GT }
+	};
+
+	bool ParseFleetPredicate(const std::string& stText, SFleetPredicate& predicate)
+	{
+		for (const auto& token : gs_arCompareTokens)
+		{
+			const auto nPos = stText.find(token.szToken);
+			if (nPos == std::string::npos)
+				continue;
+
+			predicate.nColumn = FindFleetColumn(stText.substr(0, nPos));
+			if (predicate.nColumn == EFleetColumn::COLUMN_MAX || GetFleetColumnInfo(predicate.nColumn).nKind != EFleetColumnKind::COLUMN_KIND_NUMBER)
+				return false;
+			predicate.nOp = token.nOp;
+
+			std::istringstream iss(stText.substr(nPos + std::char_traits<char>::length(token.szToken)));
+			std::string stValue;
+			while (std::getline(iss, stValue, '|'))
+			{
+				char* pEnd = nullptr;
+				predicate.vOperands.emplace_back(std::strtoull(stValue.c_str(), &pEnd, 0));
+				if (stValue.empty() || *pEnd)
+					return false;
+			}
+
+			if (predicate.vOperands.size() > 1)
+			{
+				if (predicate.nOp != ECompareOp::COMPARE_EQ)
+					return false;
+				predicate.nOp = ECompareOp::COMPARE_IN;
+			}
+			return !predicate.vOperands.empty();
+		}
+		return false;
+	}
+
+	bool ParseFleetRules(const std::string& stRules, std::vector <SFleetRule>& vRules)
+	{
+		std::istringstream issRules(stRules);
+		std::string stRule;
+		while (std::getline(issRules, stRule, ';'))
+		{
+			if (stRule.empty())
+				continue;
+
+			const auto nColon = stRule.find(':');
+			if (nColon == std::string::npos || !nColon)
+				return false;
+
+			SFleetRule rule{};
+			rule.stName = stRule.substr(0, nColon);
+
+			std::istringstream issPredicates(stRule.substr(nColon + 1));
+			std::string stPredicate;
+			while (std::getline(issPredicates, stPredicate, ','))
+			{
+				SFleetPredicate predicate{};
+				if (!ParseFleetPredicate(stPredicate, predicate))
+					return false;
+				rule.vPredicates.emplace_back(std::move(predicate));
+			}
+			vRules.emplace_back(std::move(rule));
+		}
+		return !vRules.empty();
+	}
+
+	std::string FormatFleetRule(const SFleetRule& rule)
+	{
+		static const char* s_arOps[] = { "==", "!=", "<", "<=", ">", ">=", "==" };
+
+		auto stText = rule.stName + ":";
+		for (size_t i = 0; i < rule.vPredicates.size(); ++i)
+		{
+			const auto& predicate = rule.vPredicates[i];
+			if (i)
+				stText += ',';
+			stText += GetFleetColumnInfo(predicate.nColumn).szName;
+			stText += s_arOps[static_cast<size_t>(predicate.nOp)];
+			for (size_t j = 0; j < predicate.vOperands.size(); ++j)
+			{
+				if (j)
+					stText += '|';
+				stText += std::to_string(predicate.vOperands[j]);
+			}
+		}
+		return stText;
+	}
+};
@@ -0,0 +1,333 @@
+#include "../../include/core/fleet_index.hpp"
+#include "../../include/core/output_file.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+namespace Win11SysCheck
+{
+	static constexpr char FLEET_INDEX_MAGIC[8]{ 'W', '1', '1', 'F', 'I', 'D', 'X', '1' };
+
+	std::vector <EFleetColumn> CFleetIndex::GetDefaultColumns()
+	{
+		return {
+			EFleetColumn::COLUMN_FIRMWARE_TYPE,
+			EFleetColumn::COLUMN_SECURE_BOOT_CAPABLE,
+			EFleetColumn::COLUMN_TPM_VERSION,
+			EFleetColumn::COLUMN_CPU_VENDOR,
+			EFleetColumn::COLUMN_CPU_NAME,
+			EFleetColumn::COLUMN_CPU_FAMILY,
+			EFleetColumn::COLUMN_CPU_MODEL,
+			EFleetColumn::COLUMN_CPU_STEPPING,
+			EFleetColumn::COLUMN_SYSTEM_PARTITION_STYLE,
+			EFleetColumn::COLUMN_ADAPTER_DRIVER_MODEL,
+			EFleetColumn::COLUMN_MAX_WDDM_VERSION,
+			EFleetColumn::COLUMN_DIRECTX_MAJOR,
+			EFleetColumn::COLUMN_OS_STATUS,
+			EFleetColumn::COLUMN_BOOT_STATUS,
+			EFleetColumn::COLUMN_CPU_STATUS,
+			EFleetColumn::COLUMN_RAM_STATUS,
+			EFleetColumn::COLUMN_DISK_STATUS,
+			EFleetColumn::COLUMN_DISPLAY_STATUS,
+			EFleetColumn::COLUMN_INTERNET_STATUS,
+			EFleetColumn::COLUMN_UPGRADE_READY
+		};
+	}
+
+	bool CFleetIndex::Build(const CFleetStoreReader& reader, const std::vector <EFleetColumn>& vColumns)
+	{
+		m_mapColumns.clear();
+		m_nRowCount = reader.GetRowCount();
+		if (m_nRowCount > UINT32_MAX)
+			return false;
+
+		std::vector <uint64_t> vValues;
+		std::vector <std::string> vDictionary;
+		for (const auto nColumn : vColumns)
+		{
+			if (!reader.HasColumn(nColumn))
+				return false;
+
+			const auto bString = GetFleetColumnInfo(nColumn).nKind == EFleetColumnKind::COLUMN_KIND_STRING;
+			auto& mapValues = m_mapColumns[nColumn];
+
+			uint32_t nFirstRow = 0;
+			for (size_t i = 0; i < reader.GetRowGroupCount(); ++i)
+			{
+				if (!reader.ReadColumn(i, nColumn, vValues) || (bString && !reader.ReadDictionary(i, nColumn, vDictionary)))
+					return false;
+
+				// Rows arrive in increasing order, so every bitmap takes the append path
+				std::unordered_map <uint64_t, CRoaringBitmap*> mapBitmaps;
+				for (size_t j = 0; j < vValues.size(); ++j)
+				{
+					auto& pBitmap = mapBitmaps[vValues[j]];
+					if (!pBitmap)
+					{
+						if (bString && vValues[j] >= vDictionary.size())
+							return false;
+						pBitmap = &mapValues[bString ? vDictionary[vValues[j]] : std::to_string(vValues[j])];
+					}
+					pBitmap->Add(nFirstRow + static_cast<uint32_t>(j));
+				}
+				nFirstRow += static_cast<uint32_t>(vValues.size());
+			}
+		}
+		return true;
+	}
+
+	// [magic][row count u64][column count u32] then per column [name length u8][name][value count u32]
+	// and per value [length u32][value][bitmap]
+	bool CFleetIndex::Save(const std::string& stFileName) const
+	{
+		std::string stBuffer(FLEET_INDEX_MAGIC, sizeof(FLEET_INDEX_MAGIC));
+		stBuffer.append(reinterpret_cast<const char*>(&m_nRowCount), sizeof(m_nRowCount));
+
+		const auto nColumnCount = static_cast<uint32_t>(m_mapColumns.size());
+		stBuffer.append(reinterpret_cast<const char*>(&nColumnCount), sizeof(nColumnCount));
+
+		for (const auto& [nColumn, mapValues] : m_mapColumns)
+		{
+			const auto szName = GetFleetColumnInfo(nColumn).szName;
+			const auto nNameLength = static_cast<uint8_t>(std::strlen(szName));
+			stBuffer.push_back(static_cast<char>(nNameLength));
+			stBuffer.append(szName, nNameLength);
+
+			const auto nValueCount = static_cast<uint32_t>(mapValues.size());
+			stBuffer.append(reinterpret_cast<const char*>(&nValueCount), sizeof(nValueCount));
+			for (const auto& [stValue, bitmap] : mapValues)
+			{
+				const auto nLength = static_cast<uint32_t>(stValue.size());
+				stBuffer.append(reinterpret_cast<const char*>(&nLength), sizeof(nLength));
+				stBuffer.append(stValue);
+				bitmap.Serialize(stBuffer);
+			}
+		}
+
+		COutputFile file;
+		return file.Open(stFileName) && file.Write(stBuffer.data(), stBuffer.size()) && file.Commit();
+	}
+
+	bool CFleetIndex::Load(const std::string& stFileName)
+	{
+		m_mapColumns.clear();
+		m_nRowCount = 0;
+
+		CMappedFile file;
+		if (!file.Open(stFileName))
+			return false;
+
+		const auto pData = file.GetData();
+		const auto nSize = file.GetSize();
+		size_t nOffset = 0;
+
+		auto Read = [&](void* pOut, size_t nLength) {
+			if (nSize - nOffset < nLength)
+				return false;
+			std::memcpy(pOut, pData + nOffset, nLength);
+			nOffset += nLength;
+			return true;
+		};
+
+		char szMagic[sizeof(FLEET_INDEX_MAGIC)]{};
+		uint32_t nColumnCount = 0;
+		if (!Read(szMagic, sizeof(szMagic)) || std::memcmp(szMagic, FLEET_INDEX_MAGIC, sizeof(szMagic)) ||
+			!Read(&m_nRowCount, sizeof(m_nRowCount)) || !Read(&nColumnCount, sizeof(nColumnCount)))
+			return false;
+
+		for (uint32_t i = 0; i < nColumnCount; ++i)
+		{
+			uint8_t nNameLength = 0;
+			std::string stName;
+			uint32_t nValueCount = 0;
+			if (!Read(&nNameLength, sizeof(nNameLength)))
+				return false;
+			stName.resize(nNameLength);
+			if (!Read(stName.data(), nNameLength) || !Read(&nValueCount, sizeof(nValueCount)))
+				return false;
+
+			// Columns unknown to this build are skipped but still have to be parsed
+			const auto nColumn = FindFleetColumn(stName);
+			TValueMap mapSkipped;
+			auto& mapValues = nColumn == EFleetColumn::COLUMN_MAX ? mapSkipped : m_mapColumns[nColumn];
+
+			for (uint32_t j = 0; j < nValueCount; ++j)
+			{
+				uint32_t nLength = 0;
+				std::string stValue;
+				if (!Read(&nLength, sizeof(nLength)) || nLength > nSize - nOffset)
+					return false;
+				stValue.assign(pData + nOffset, nLength);
+				nOffset += nLength;
+
+				if (!mapValues[stValue].Deserialize(pData, nSize, nOffset))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	const CFleetIndex::TValueMap* CFleetIndex::GetValues(EFleetColumn nColumn) const
+	{
+		const auto it = m_mapColumns.find(nColumn);
+		return it == m_mapColumns.end() ? nullptr : &it->second;
+	}
+
+	const CRoaringBitmap& CFleetIndex::Find(EFleetColumn nColumn, const std::string& stValue) const
+	{
+		static const CRoaringBitmap s_empty;
+
+		const auto pValues = GetValues(nColumn);
+		if (!pValues)
+			return s_empty;
+
+		const auto it = pValues->find(stValue);
+		return it == pValues->end() ? s_empty : it->second;
+	}
+
+	// Recursive descent over: expr := term ('|' term)*, term := factor ('&' factor)*,
+	// factor := '(' expr ')' | column ('=' | '==') value; '==' matches the whatif conditions
+	class CFleetQueryParser
+	{
+	public:
+		CFleetQueryParser(const CFleetIndex& index, const std::string& stExpression) :
+			m_index(index), m_stExpression(stExpression)
+		{
+		}
+
+		bool Parse(CRoaringBitmap& result, std::string& stError)
+		{
+			if (!__ParseExpression(result) || (__SkipSpaces(), m_nPos != m_stExpression.size()))
+			{
+				stError = m_stError.empty() ? "Unexpected input at offset " + std::to_string(m_nPos) : m_stError;
+				return false;
+			}
+			return true;
+		}
+
+	protected:
+		void __SkipSpaces()
+		{
+			while (m_nPos < m_stExpression.size() && std::isspace(static_cast<unsigned char>(m_stExpression[m_nPos])))
+				m_nPos++;
+		}
+		bool __Accept(char c)
+		{
+			__SkipSpaces();
+			if (m_nPos < m_stExpression.size() && m_stExpression[m_nPos] == c)
+			{
+				m_nPos++;
+				return true;
+			}
+			return false;
+		}
+
+		bool __ParseExpression(CRoaringBitmap& result)
+		{
+			if (!__ParseTerm(result))
+				return false;
+			while (__Accept('|'))
+			{
+				CRoaringBitmap rhs;
+				if (!__ParseTerm(rhs))
+					return false;
+				result = CRoaringBitmap::Or(result, rhs);
+			}
+			return true;
+		}
+
+		bool __ParseTerm(CRoaringBitmap& result)
+		{
+			if (!__ParseFactor(result))
+				return false;
+			while (__Accept('&'))
+			{
+				CRoaringBitmap rhs;
+				if (!__ParseFactor(rhs))
+					return false;
+				result = CRoaringBitmap::And(result, rhs);
+			}
+			return true;
+		}
+
+		bool __ParseFactor(CRoaringBitmap& result)
+		{
+			if (__Accept('('))
+				return __ParseExpression(result) && __Accept(')');
+
+			__SkipSpaces();
+			const auto nNameBegin = m_nPos;
+			while (m_nPos < m_stExpression.size() && (std::isalnum(static_cast<unsigned char>(m_stExpression[m_nPos])) || m_stExpression[m_nPos] == '_'))
+				m_nPos++;
+
+			const auto stName = m_stExpression.substr(nNameBegin, m_nPos - nNameBegin);
+			const auto nColumn = FindFleetColumn(stName);
+			if (nColumn == EFleetColumn::COLUMN_MAX || !m_index.HasColumn(nColumn))
+			{
+				m_stError = "Column: '" + stName + "' is not indexed";
+				return false;
+			}
+			if (!__Accept('='))
+				return false;
+			if (m_nPos < m_stExpression.size() && m_stExpression[m_nPos] == '=')
+				m_nPos++;
+
+			std::string stValue;
+			__SkipSpaces();
+			if (m_nPos < m_stExpression.size() && m_stExpression[m_nPos] == '"')
+			{
+				const auto nEnd = m_stExpression.find('"', m_nPos + 1);
+				if (nEnd == std::string::npos)
+				{
+					m_stError = "Unterminated quoted value";
+					return false;
+				}
+				stValue = m_stExpression.substr(m_nPos + 1, nEnd - m_nPos - 1);
+				m_nPos = nEnd + 1;
+			}
+			else
+			{
+				const auto nBegin = m_nPos;
+				while (m_nPos < m_stExpression.size() && !std::strchr("&|() \t", m_stExpression[m_nPos]))
+					m_nPos++;
+				stValue = m_stExpression.substr(nBegin, m_nPos - nBegin);
+
+				// A stray operator character would otherwise quietly match nothing
+				if (!stValue.empty() && std::strchr("=!<>", stValue.front()))
+				{
+					m_stError = "Value: '" + stValue + "' of " + stName + " starts with an operator, quote it to match it literally";
+					return false;
+				}
+			}
+
+			// Numbers are normalized so 0x8E and 142 find the same rows
+			if (GetFleetColumnInfo(nColumn).nKind == EFleetColumnKind::COLUMN_KIND_NUMBER)
+			{
+				char* pEnd = nullptr;
+				const auto nValue = std::strtoull(stValue.c_str(), &pEnd, 0);
+				if (stValue.empty() || *pEnd)
+				{
+					m_stError = "Value: '" + stValue + "' of " + stName + " is not a number";
+					return false;
+				}
+				stValue = std::to_string(nValue);
+			}
+
+			result = m_index.Find(nColumn, stValue);
+			return true;
+		}
+
+	private:
+		const CFleetIndex& m_index;
+		const std::string& m_stExpression;
+		size_t m_nPos{ 0 };
+		std::string m_stError;
+	};
+
+	bool CFleetIndex::Query(const std::string& stExpression, CRoaringBitmap& result, std::string& stError) const
+	{
+		CFleetQueryParser parser(*this, stExpression);
+		return parser.Parse(result, stError);
+	}
+};
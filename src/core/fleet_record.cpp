@@ -0,0 +1,171 @@
+#include "../../include/core/fleet_record.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+namespace Win11SysCheck
+{
+	template <auto Member>
+	static uint64_t GetNumberMember(const SFleetRecord& record)
+	{
+		return static_cast<uint64_t>(record.*Member);
+	}
+	template <auto Member>
+	static void SetNumberMember(SFleetRecord& record, uint64_t nValue)
+	{
+		using TValue = std::remove_reference_t<decltype(record.*Member)>;
+		record.*Member = static_cast<TValue>(nValue);
+	}
+
+	template <auto Member>
+	static constexpr SFleetColumnInfo NumberColumn(EFleetColumn nColumn, const char* szName)
+	{
+		return { nColumn, szName, EFleetColumnKind::COLUMN_KIND_NUMBER, &GetNumberMember<Member>, &SetNumberMember<Member>, nullptr };
+	}
+	static constexpr SFleetColumnInfo StringColumn(EFleetColumn nColumn, const char* szName, std::string SFleetRecord::* pString)
+	{
+		return { nColumn, szName, EFleetColumnKind::COLUMN_KIND_STRING, nullptr, nullptr, pString };
+	}
+
+	static const std::array <SFleetColumnInfo, static_cast<size_t>(EFleetColumn::COLUMN_MAX)> gs_arColumns{ {
+		NumberColumn<&SFleetRecord::nMachineId>(EFleetColumn::COLUMN_MACHINE_ID, "machine_id"),
+		NumberColumn<&SFleetRecord::nOSBuild>(EFleetColumn::COLUMN_OS_BUILD, "os_build"),
+		NumberColumn<&SFleetRecord::nOSProductType>(EFleetColumn::COLUMN_OS_PRODUCT_TYPE, "os_product_type"),
+		NumberColumn<&SFleetRecord::nFirmwareType>(EFleetColumn::COLUMN_FIRMWARE_TYPE, "firmware_type"),
+		NumberColumn<&SFleetRecord::bSecureBootCapable>(EFleetColumn::COLUMN_SECURE_BOOT_CAPABLE, "secure_boot_capable"),
+		NumberColumn<&SFleetRecord::bSecureBootEnabled>(EFleetColumn::COLUMN_SECURE_BOOT_ENABLED, "secure_boot_enabled"),
+		NumberColumn<&SFleetRecord::bTpmPresent>(EFleetColumn::COLUMN_TPM_PRESENT, "tpm_present"),
+		NumberColumn<&SFleetRecord::nTpmVersion>(EFleetColumn::COLUMN_TPM_VERSION, "tpm_version"),
+		StringColumn(EFleetColumn::COLUMN_CPU_VENDOR, "cpu_vendor", &SFleetRecord::stCPUVendor),
+		StringColumn(EFleetColumn::COLUMN_CPU_NAME, "cpu_name", &SFleetRecord::stCPUName),
+		NumberColumn<&SFleetRecord::nCPUArchitecture>(EFleetColumn::COLUMN_CPU_ARCHITECTURE, "cpu_architecture"),
+		NumberColumn<&SFleetRecord::nCPUFamily>(EFleetColumn::COLUMN_CPU_FAMILY, "cpu_family"),
+		NumberColumn<&SFleetRecord::nCPUModel>(EFleetColumn::COLUMN_CPU_MODEL, "cpu_model"),
+		NumberColumn<&SFleetRecord::nCPUStepping>(EFleetColumn::COLUMN_CPU_STEPPING, "cpu_stepping"),
+		NumberColumn<&SFleetRecord::nCPUPlatformField>(EFleetColumn::COLUMN_CPU_PLATFORM_FIELD, "cpu_platform_field"),
+		NumberColumn<&SFleetRecord::nCPUProcessorCount>(EFleetColumn::COLUMN_CPU_PROCESSOR_COUNT, "cpu_processor_count"),
+		NumberColumn<&SFleetRecord::nCPUFastProcessorCount>(EFleetColumn::COLUMN_CPU_FAST_PROCESSOR_COUNT, "cpu_fast_processor_count"),
+		NumberColumn<&SFleetRecord::nCPUMaxMhz>(EFleetColumn::COLUMN_CPU_MAX_MHZ, "cpu_max_mhz"),
+		NumberColumn<&SFleetRecord::bCPUArmV81Atomics>(EFleetColumn::COLUMN_CPU_ARM_V81_ATOMICS, "cpu_arm_v81_atomics"),
+		NumberColumn<&SFleetRecord::bCPUSupported>(EFleetColumn::COLUMN_CPU_SUPPORTED, "cpu_supported"),
+		NumberColumn<&SFleetRecord::nRAMTotalBytes>(EFleetColumn::COLUMN_RAM_TOTAL_BYTES, "ram_total_bytes"),
+		NumberColumn<&SFleetRecord::nRAMAvailableBytes>(EFleetColumn::COLUMN_RAM_AVAILABLE_BYTES, "ram_available_bytes"),
+		NumberColumn<&SFleetRecord::nVolumeCount>(EFleetColumn::COLUMN_VOLUME_COUNT, "volume_count"),
+		NumberColumn<&SFleetRecord::nSystemPartitionStyle>(EFleetColumn::COLUMN_SYSTEM_PARTITION_STYLE, "system_partition_style"),
+		NumberColumn<&SFleetRecord::nSystemFreeBytes>(EFleetColumn::COLUMN_SYSTEM_FREE_BYTES, "system_free_bytes"),
+		NumberColumn<&SFleetRecord::nLargestVolumeBytes>(EFleetColumn::COLUMN_LARGEST_VOLUME_BYTES, "largest_volume_bytes"),
+		NumberColumn<&SFleetRecord::nMonitorCount>(EFleetColumn::COLUMN_MONITOR_COUNT, "monitor_count"),
+		NumberColumn<&SFleetRecord::nMaxMonitorHeight>(EFleetColumn::COLUMN_MAX_MONITOR_HEIGHT, "max_monitor_height"),
+		NumberColumn<&SFleetRecord::nMaxBitsPerPixel>(EFleetColumn::COLUMN_MAX_BITS_PER_PIXEL, "max_bits_per_pixel"),
+		NumberColumn<&SFleetRecord::nMaxPanelDiagonal>(EFleetColumn::COLUMN_MAX_PANEL_DIAGONAL, "max_panel_diagonal"),
+		StringColumn(EFleetColumn::COLUMN_ADAPTER_DESCRIPTION, "adapter_description", &SFleetRecord::stAdapterDescription),
+		StringColumn(EFleetColumn::COLUMN_ADAPTER_DRIVER_MODEL, "adapter_driver_model", &SFleetRecord::stAdapterDriverModel),
+		NumberColumn<&SFleetRecord::nMaxWDDMVersion>(EFleetColumn::COLUMN_MAX_WDDM_VERSION, "max_wddm_version"),
+		NumberColumn<&SFleetRecord::nDirectXMajor>(EFleetColumn::COLUMN_DIRECTX_MAJOR, "directx_major"),
+		NumberColumn<&SFleetRecord::nDirectXMinor>(EFleetColumn::COLUMN_DIRECTX_MINOR, "directx_minor"),
+		NumberColumn<&SFleetRecord::bInternetConnected>(EFleetColumn::COLUMN_INTERNET_CONNECTED, "internet_connected"),
+		NumberColumn<&SFleetRecord::bInternetReachable>(EFleetColumn::COLUMN_INTERNET_REACHABLE, "internet_reachable"),
+		NumberColumn<&SFleetRecord::nOSStatus>(EFleetColumn::COLUMN_OS_STATUS, "os_status"),
+		NumberColumn<&SFleetRecord::nBootStatus>(EFleetColumn::COLUMN_BOOT_STATUS, "boot_status"),
+		NumberColumn<&SFleetRecord::nCPUStatus>(EFleetColumn::COLUMN_CPU_STATUS, "cpu_status"),
+		NumberColumn<&SFleetRecord::nRAMStatus>(EFleetColumn::COLUMN_RAM_STATUS, "ram_status"),
+		NumberColumn<&SFleetRecord::nDiskStatus>(EFleetColumn::COLUMN_DISK_STATUS, "disk_status"),
+		NumberColumn<&SFleetRecord::nDisplayStatus>(EFleetColumn::COLUMN_DISPLAY_STATUS, "display_status"),
+		NumberColumn<&SFleetRecord::nInternetStatus>(EFleetColumn::COLUMN_INTERNET_STATUS, "internet_status"),
+		NumberColumn<&SFleetRecord::bUpgradeReady>(EFleetColumn::COLUMN_UPGRADE_READY, "upgrade_ready"),
+		NumberColumn<&SFleetRecord::nCPUMissingInstructions>(EFleetColumn::COLUMN_CPU_MISSING_INSTRUCTIONS, "cpu_missing_instructions")
+	} };
+
+	const SFleetColumnInfo& GetFleetColumnInfo(EFleetColumn nColumn)
+	{
+		return gs_arColumns[static_cast<size_t>(nColumn)];
+	}
+
+	EFleetColumn FindFleetColumn(const std::string& stName)
+	{
+		for (const auto& column : gs_arColumns)
+		{
+			if (stName == column.szName)
+				return column.nColumn;
+		}
+		return EFleetColumn::COLUMN_MAX;
+	}
+
+	SFleetRecord MakeFleetRecord(const SProbeResult& result, uint64_t nMachineId)
+	{
+		SFleetRecord record{};
+		record.nMachineId = nMachineId;
+
+		record.nOSBuild = result.os.nBuildNumber;
+		record.nOSProductType = result.os.nProductType;
+
+		record.nFirmwareType = result.boot.nFirmwareType;
+		record.bSecureBootCapable = result.boot.bSecureBootCapable;
+		record.bSecureBootEnabled = result.boot.bSecureBootEnabled;
+		record.bTpmPresent = result.boot.bTpmPresent;
+		record.nTpmVersion = result.boot.nTpmVersion;
+
+		const auto& cpu = result.cpu;
+		record.stCPUVendor = cpu.stVendor;
+		record.stCPUName = cpu.stName;
+		record.nCPUArchitecture = cpu.nArchitecture;
+		record.nCPUFamily = cpu.nFamily;
+		record.nCPUModel = cpu.nModel;
+		record.nCPUStepping = cpu.nStepping;
+		record.nCPUPlatformField = cpu.nPlatformSpecificField;
+		record.nCPUProcessorCount = cpu.nProcessorCount;
+		record.nCPUFastProcessorCount = cpu.nFastProcessorCount;
+		record.nCPUMaxMhz = cpu.nMaxMhz;
+		record.bCPUArmV81Atomics = cpu.bArmV81Atomics;
+		record.bCPUSupported = IsSupportedProcessor(cpu);
+		// 0 when the facts carry no CPUID bits or nothing is missing
+		record.nCPUMissingInstructions = GetMissingInstructions(cpu);
+
+		record.nRAMTotalBytes = result.ram.nTotalPhysical;
+		record.nRAMAvailableBytes = result.ram.nAvailablePhysical;
+
+		const auto& vVolumes = result.disk.vVolumes;
+		record.nVolumeCount = static_cast<uint32_t>(vVolumes.size());
+		if (!vVolumes.empty())
+		{
+			record.nSystemPartitionStyle = vVolumes.front().nPartitionStyle;
+			record.nSystemFreeBytes = vVolumes.front().nFreeBytes;
+		}
+		for (const auto& volume : vVolumes)
+			record.nLargestVolumeBytes = (std::max)(record.nLargestVolumeBytes, volume.nTotalBytes);
+
+		const auto& display = result.display;
+		record.nMonitorCount = static_cast<uint32_t>(display.vMonitors.size());
+		for (const auto& monitor : display.vMonitors)
+		{
+			record.nMaxMonitorHeight = (std::max)(record.nMaxMonitorHeight, static_cast<uint32_t>((std::max)(monitor.nHeight, 0)));
+			record.nMaxBitsPerPixel = (std::max)(record.nMaxBitsPerPixel, monitor.nBitsPerPixel);
+		}
+		for (const auto& panel : display.vPanels)
+			record.nMaxPanelDiagonal = (std::max)(record.nMaxPanelDiagonal, static_cast<uint32_t>(std::floor(GetPanelDiagonalInches(panel) * 100.0)));
+		if (!display.vAdapters.empty())
+		{
+			record.stAdapterDescription = display.vAdapters.front().stDescription;
+			record.stAdapterDriverModel = display.vAdapters.front().stDriverModel;
+		}
+		for (const auto& adapter : display.vAdapters)
+			record.nMaxWDDMVersion = (std::max)(record.nMaxWDDMVersion, GetWDDMVersion(adapter.stDriverModel));
+		record.nDirectXMajor = display.nDirectXMajor;
+		record.nDirectXMinor = display.nDirectXMinor;
+
+		record.bInternetConnected = result.internet.bConnected;
+		record.bInternetReachable = result.internet.bReachable;
+
+		record.nOSStatus = result.GetStatus(EMenuType::MENU_TYPE_OS);
+		record.nBootStatus = result.GetStatus(EMenuType::MENU_TYPE_BOOT);
+		record.nCPUStatus = result.GetStatus(EMenuType::MENU_TYPE_CPU);
+		record.nRAMStatus = result.GetStatus(EMenuType::MENU_TYPE_RAM);
+		record.nDiskStatus = result.GetStatus(EMenuType::MENU_TYPE_DISK);
+		record.nDisplayStatus = result.GetStatus(EMenuType::MENU_TYPE_DISPLAY);
+		record.nInternetStatus = result.GetStatus(EMenuType::MENU_TYPE_INTERNET);
+		record.bUpgradeReady = CanSystemUpgrade(result);
+		return record;
+	}
+};
@@ -0,0 +1,621 @@
+#include "../../include/core/fleet_store.hpp"
+#include "../../include/core/block_compression.hpp"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Win11SysCheck
+{
+	static constexpr char FLEET_STORE_MAGIC[8]{ 'W', '1', '1', 'F', 'L', 'E', 'E', 'T' };
+	static constexpr char FLEET_STORE_GROUP_MAGIC[8]{ 'W', '1', '1', 'F', 'G', 'R', 'U', 'P' };
+	// Group magic, body size u64, crc32c u32 of the body
+	static constexpr size_t FLEET_STORE_GROUP_HEADER_SIZE = sizeof(FLEET_STORE_GROUP_MAGIC) + sizeof(uint64_t) + sizeof(uint32_t);
+	// Offset, size, min, max
+	static constexpr size_t FLEET_STORE_CHUNK_ENTRY_SIZE = 4 * sizeof(uint64_t);
+
+	static void PutU8(std::string& stBuffer, uint8_t nValue)
+	{
+		stBuffer.push_back(static_cast<char>(nValue));
+	}
+	static void PutU32(std::string& stBuffer, uint32_t nValue)
+	{
+		stBuffer.append(reinterpret_cast<const char*>(&nValue), sizeof(nValue));
+	}
+	static void PutU64(std::string& stBuffer, uint64_t nValue)
+	{
+		stBuffer.append(reinterpret_cast<const char*>(&nValue), sizeof(nValue));
+	}
+
+	// Bounds checked cursor over the mapped file
+	class CByteReader
+	{
+	public:
+		CByteReader(const char* pData, size_t nSize) :
+			m_pData(pData), m_nSize(nSize)
+		{
+		}
+
+		template <class T>
+		bool Read(T& value)
+		{
+			if (m_nSize - m_nOffset < sizeof(T))
+				return false;
+			std::memcpy(&value, m_pData + m_nOffset, sizeof(T));
+			m_nOffset += sizeof(T);
+			return true;
+		}
+		bool ReadBytes(size_t nLength, const char*& pBytes)
+		{
+			if (m_nSize - m_nOffset < nLength)
+				return false;
+			pBytes = m_pData + m_nOffset;
+			m_nOffset += nLength;
+			return true;
+		}
+
+		size_t GetOffset() const { return m_nOffset; };
+
+	private:
+		const char* m_pData;
+		size_t m_nSize;
+		size_t m_nOffset{ 0 };
+	};
+
+	static uint8_t GetBitWidth(uint64_t nValue)
+	{
+		uint8_t nWidth = 0;
+		while (nValue)
+		{
+			nWidth++;
+			nValue >>= 1;
+		}
+		return nWidth;
+	}
+
+	// [width u8][reference u64][ceil(n * width / 64) words]
+	static void PackValues(const std::vector <uint64_t>& vValues, std::string& stBuffer, SFleetColumnStats& stats)
+	{
+		stats = {};
+		if (!vValues.empty())
+		{
+			const auto pair = std::minmax_element(vValues.begin(), vValues.end());
+			stats.nMin = *pair.first;
+			stats.nMax = *pair.second;
+		}
+
+		const auto nWidth = GetBitWidth(stats.nMax - stats.nMin);
+		PutU8(stBuffer, nWidth);
+		PutU64(stBuffer, stats.nMin);
+		if (!nWidth)
+			return;
+
+		std::vector <uint64_t> vWords((vValues.size() * nWidth + 63) / 64, 0);
+		uint64_t nBit = 0;
+		for (const auto nValue : vValues)
+		{
+			const auto nDelta = nValue - stats.nMin;
+			const auto nWord = nBit >> 6;
+			const auto nShift = nBit & 63;
+			vWords[nWord] |= nDelta << nShift;
+			if (nShift + nWidth > 64)
+				vWords[nWord + 1] |= nDelta >> (64 - nShift);
+			nBit += nWidth;
+		}
+		stBuffer.append(reinterpret_cast<const char*>(vWords.data()), vWords.size() * sizeof(uint64_t));
+	}
+
+	static bool UnpackValues(CByteReader& reader, uint64_t nCount, std::vector <uint64_t>& vValues)
+	{
+		uint8_t nWidth = 0;
+		uint64_t nReference = 0;
+		if (!reader.Read(nWidth) || !reader.Read(nReference) || nWidth > 64)
+			return false;
+
+		vValues.assign(nCount, nReference);
+		if (!nWidth)
+			return true;
+
+		const auto nWordCount = (nCount * nWidth + 63) / 64;
+		const char* pWords = nullptr;
+		if (!reader.ReadBytes(nWordCount * sizeof(uint64_t), pWords))
+			return false;
+
+		std::vector <uint64_t> vWords(nWordCount);
+		std::memcpy(vWords.data(), pWords, nWordCount * sizeof(uint64_t));
+
+		const auto nMask = nWidth == 64 ? ~0ull : ((1ull << nWidth) - 1);
+		uint64_t nBit = 0;
+		for (auto& nValue : vValues)
+		{
+			const auto nWord = nBit >> 6;
+			const auto nShift = nBit & 63;
+			auto nDelta = vWords[nWord] >> nShift;
+			if (nShift + nWidth > 64)
+				nDelta |= vWords[nWord + 1] << (64 - nShift);
+			nValue += nDelta & nMask;
+			nBit += nWidth;
+		}
+		return true;
+	}
+
+	static void EncodeColumn(const SFleetColumnInfo& column, const std::vector <SFleetRecord>& vRecords, std::string& stBuffer, SFleetColumnStats& stats)
+	{
+		std::vector <uint64_t> vValues;
+		vValues.reserve(vRecords.size());
+
+		if (column.nKind == EFleetColumnKind::COLUMN_KIND_NUMBER)
+		{
+			for (const auto& record : vRecords)
+				vValues.emplace_back(column.pfnGetNumber(record));
+			PackValues(vValues, stBuffer, stats);
+			return;
+		}
+
+		// [entry count u32][(length u32, bytes)...][packed codes]
+		std::unordered_map <std::string, uint32_t> mapCodes;
+		std::vector <const std::string*> vEntries;
+		for (const auto& record : vRecords)
+		{
+			const auto& stValue = record.*column.pString;
+			const auto it = mapCodes.emplace(stValue, static_cast<uint32_t>(vEntries.size()));
+			if (it.second)
+				vEntries.emplace_back(&it.first->first);
+			vValues.emplace_back(it.first->second);
+		}
+
+		PutU32(stBuffer, static_cast<uint32_t>(vEntries.size()));
+		for (const auto pEntry : vEntries)
+		{
+			PutU32(stBuffer, static_cast<uint32_t>(pEntry->size()));
+			stBuffer.append(*pEntry);
+		}
+		PackValues(vValues, stBuffer, stats);
+	}
+
+	static bool DecodeDictionary(CByteReader& reader, std::vector <std::string>* pvDictionary)
+	{
+		uint32_t nEntryCount = 0;
+		if (!reader.Read(nEntryCount))
+			return false;
+
+		if (pvDictionary)
+		{
+			pvDictionary->clear();
+			pvDictionary->reserve(nEntryCount);
+		}
+		for (uint32_t i = 0; i < nEntryCount; ++i)
+		{
+			uint32_t nLength = 0;
+			const char* pBytes = nullptr;
+			if (!reader.Read(nLength) || !reader.ReadBytes(nLength, pBytes))
+				return false;
+			if (pvDictionary)
+				pvDictionary->emplace_back(pBytes, nLength);
+		}
+		return true;
+	}
+
+	static bool SyncFile(std::FILE* pFile)
+	{
+		if (std::fflush(pFile))
+			return false;
+#if defined(_WIN32)
+		return !_commit(_fileno(pFile));
+#elif defined(__APPLE__)
+		return !fsync(fileno(pFile));
+#else
+		return !fdatasync(fileno(pFile));
+#endif
+	}
+
+	// A new file is only durable once its directory entry is
+	static void SyncParentDirectory(const std::string& stFileName)
+	{
+#ifndef _WIN32
+		const auto nSeparator = stFileName.find_last_of('/');
+		const auto stDirectory = nSeparator == std::string::npos ? std::string(".") : stFileName.substr(0, nSeparator + 1);
+		const auto nDirectory = open(stDirectory.c_str(), O_RDONLY | O_CLOEXEC);
+		if (nDirectory >= 0)
+		{
+			fsync(nDirectory);
+			close(nDirectory);
+		}
+#else
+		(void)stFileName;
+#endif
+	}
+
+	CFleetStoreWriter::CFleetStoreWriter(uint32_t nRowGroupSize) :
+		m_nRowGroupSize((std::max)(nRowGroupSize, 1u))
+	{
+	}
+	CFleetStoreWriter::~CFleetStoreWriter()
+	{
+		Close();
+	}
+
+	bool CFleetStoreWriter::Open(const std::string& stFileName)
+	{
+		std::lock_guard <std::mutex> lock(m_mtxFile);
+
+		if (m_pFile)
+			return false;
+		m_pFile = std::fopen(stFileName.c_str(), "wb");
+		if (!m_pFile)
+			return false;
+
+		std::string stHeader(FLEET_STORE_MAGIC, sizeof(FLEET_STORE_MAGIC));
+		PutU32(stHeader, FLEET_STORE_VERSION);
+		PutU32(stHeader, m_nRowGroupSize);
+		PutU32(stHeader, static_cast<uint32_t>(EFleetColumn::COLUMN_MAX));
+		for (size_t i = 0; i < static_cast<size_t>(EFleetColumn::COLUMN_MAX); ++i)
+		{
+			const auto& column = GetFleetColumnInfo(static_cast<EFleetColumn>(i));
+			const auto nNameLength = std::strlen(column.szName);
+			PutU8(stHeader, static_cast<uint8_t>(column.nKind));
+			PutU8(stHeader, static_cast<uint8_t>(nNameLength));
+			stHeader.append(column.szName, nNameLength);
+		}
+
+		m_vRowGroups.clear();
+		m_nOffset = stHeader.size();
+		if (std::fwrite(stHeader.data(), 1, stHeader.size(), m_pFile) != stHeader.size() || !SyncFile(m_pFile))
+			return false;
+
+		SyncParentDirectory(stFileName);
+		return true;
+	}
+
+	bool CFleetStoreWriter::Append(const SFleetRecord& record)
+	{
+		m_vPending.emplace_back(record);
+		if (m_vPending.size() < m_nRowGroupSize)
+			return true;
+
+		const auto bRet = AppendRowGroup(m_vPending);
+		m_vPending.clear();
+		return bRet;
+	}
+
+	bool CFleetStoreWriter::AppendRowGroup(const std::vector <SFleetRecord>& vRecords)
+	{
+		if (vRecords.empty())
+			return true;
+		// Readers reject larger groups
+		if (vRecords.size() > m_nRowGroupSize)
+			return false;
+
+		// Encoding is the expensive part and runs outside of the file lock
+		SFleetRowGroup group{};
+		group.nRowCount = vRecords.size();
+
+		std::string stBuffer;
+		for (size_t i = 0; i < static_cast<size_t>(EFleetColumn::COLUMN_MAX); ++i)
+		{
+			SFleetColumnChunk chunk{};
+			chunk.nOffset = stBuffer.size();
+			EncodeColumn(GetFleetColumnInfo(static_cast<EFleetColumn>(i)), vRecords, stBuffer, chunk.stats);
+			chunk.nSize = stBuffer.size() - chunk.nOffset;
+			group.vChunks.emplace_back(chunk);
+		}
+
+		// [group magic][body size u64][crc32c u32] body: [row count u64][chunk entries, offsets from the first chunk][chunks]
+		std::string stFrame(FLEET_STORE_GROUP_MAGIC, sizeof(FLEET_STORE_GROUP_MAGIC));
+		PutU64(stFrame, sizeof(uint64_t) + group.vChunks.size() * FLEET_STORE_CHUNK_ENTRY_SIZE + stBuffer.size());
+		PutU32(stFrame, 0);
+		PutU64(stFrame, group.nRowCount);
+		for (const auto& chunk : group.vChunks)
+		{
+			PutU64(stFrame, chunk.nOffset);
+			PutU64(stFrame, chunk.nSize);
+			PutU64(stFrame, chunk.stats.nMin);
+			PutU64(stFrame, chunk.stats.nMax);
+		}
+		const auto nBodyOffset = FLEET_STORE_GROUP_HEADER_SIZE;
+		const auto nCrc = ComputeCrc32c(stBuffer.data(), stBuffer.size(), ComputeCrc32c(stFrame.data() + nBodyOffset, stFrame.size() - nBodyOffset));
+		std::memcpy(&stFrame[nBodyOffset - sizeof(nCrc)], &nCrc, sizeof(nCrc));
+
+		std::lock_guard <std::mutex> lock(m_mtxFile);
+		if (!m_pFile ||
+			std::fwrite(stFrame.data(), 1, stFrame.size(), m_pFile) != stFrame.size() ||
+			std::fwrite(stBuffer.data(), 1, stBuffer.size(), m_pFile) != stBuffer.size())
+			return false;
+
+		for (auto& chunk : group.vChunks)
+			chunk.nOffset += m_nOffset + stFrame.size();
+		m_nOffset += stFrame.size() + stBuffer.size();
+		m_vRowGroups.emplace_back(std::move(group));
+		return true;
+	}
+
+	bool CFleetStoreWriter::Flush()
+	{
+		std::lock_guard <std::mutex> lock(m_mtxFile);
+		return m_pFile && SyncFile(m_pFile);
+	}
+
+	bool CFleetStoreWriter::Close()
+	{
+		if (!m_pFile)
+			return true;
+
+		auto bRet = AppendRowGroup(m_vPending);
+		m_vPending.clear();
+
+		std::lock_guard <std::mutex> lock(m_mtxFile);
+
+		std::string stFooter;
+		PutU32(stFooter, static_cast<uint32_t>(m_vRowGroups.size()));
+		for (const auto& group : m_vRowGroups)
+		{
+			PutU64(stFooter, group.nRowCount);
+			for (const auto& chunk : group.vChunks)
+			{
+				PutU64(stFooter, chunk.nOffset);
+				PutU64(stFooter, chunk.nSize);
+				PutU64(stFooter, chunk.stats.nMin);
+				PutU64(stFooter, chunk.stats.nMax);
+			}
+		}
+		PutU64(stFooter, m_nOffset);
+		stFooter.append(FLEET_STORE_MAGIC, sizeof(FLEET_STORE_MAGIC));
+
+		bRet = std::fwrite(stFooter.data(), 1, stFooter.size(), m_pFile) == stFooter.size() && bRet;
+		bRet = SyncFile(m_pFile) && bRet;
+		bRet = !std::fclose(m_pFile) && bRet;
+		m_pFile = nullptr;
+		return bRet;
+	}
+
+	uint64_t CFleetStoreWriter::GetRowCount() const
+	{
+		std::lock_guard <std::mutex> lock(m_mtxFile);
+
+		uint64_t nCount = m_vPending.size();
+		for (const auto& group : m_vRowGroups)
+			nCount += group.nRowCount;
+		return nCount;
+	}
+
+	bool CFleetStoreReader::Open(const std::string& stFileName)
+	{
+		m_vRowGroups.clear();
+		m_arFileColumns.fill(-1);
+		m_nRowGroupSize = 0;
+		m_bRecovered = false;
+
+		if (!m_file.Open(stFileName))
+			return false;
+
+		const auto pData = m_file.GetData();
+		const auto nSize = m_file.GetSize();
+		if (nSize < sizeof(FLEET_STORE_MAGIC) || std::memcmp(pData, FLEET_STORE_MAGIC, sizeof(FLEET_STORE_MAGIC)))
+			return false;
+
+		CByteReader header(pData + sizeof(FLEET_STORE_MAGIC), nSize - sizeof(FLEET_STORE_MAGIC));
+		uint32_t nVersion = 0, nColumnCount = 0;
+		if (!header.Read(nVersion) || nVersion != FLEET_STORE_VERSION || !header.Read(m_nRowGroupSize) || !m_nRowGroupSize || !header.Read(nColumnCount))
+			return false;
+
+		for (uint32_t i = 0; i < nColumnCount; ++i)
+		{
+			uint8_t nKind = 0, nNameLength = 0;
+			const char* pName = nullptr;
+			if (!header.Read(nKind) || !header.Read(nNameLength) || !header.ReadBytes(nNameLength, pName))
+				return false;
+
+			const auto nColumn = FindFleetColumn(std::string(pName, nNameLength));
+			if (nColumn != EFleetColumn::COLUMN_MAX && static_cast<uint8_t>(GetFleetColumnInfo(nColumn).nKind) == nKind)
+				m_arFileColumns[static_cast<size_t>(nColumn)] = static_cast<int32_t>(i);
+		}
+
+		// A writer killed before Close leaves no footer, or only part of it
+		const auto nDataOffset = sizeof(FLEET_STORE_MAGIC) + header.GetOffset();
+		if (!__ReadFooter(nColumnCount, nDataOffset))
+		{
+			m_vRowGroups.clear();
+			__RecoverRowGroups(nColumnCount, nDataOffset);
+			m_bRecovered = true;
+		}
+		return true;
+	}
+
+	bool CFleetStoreReader::__ReadFooter(uint32_t nColumnCount, uint64_t nDataOffset)
+	{
+		const auto pData = m_file.GetData();
+		const auto nSize = m_file.GetSize();
+		constexpr auto nTrailerSize = sizeof(uint64_t) + sizeof(FLEET_STORE_MAGIC);
+		if (nSize < nDataOffset + nTrailerSize ||
+			std::memcmp(pData + nSize - sizeof(FLEET_STORE_MAGIC), FLEET_STORE_MAGIC, sizeof(FLEET_STORE_MAGIC)))
+			return false;
+
+		uint64_t nFooterOffset = 0;
+		std::memcpy(&nFooterOffset, pData + nSize - nTrailerSize, sizeof(nFooterOffset));
+		if (nFooterOffset < nDataOffset || nFooterOffset > nSize - nTrailerSize)
+			return false;
+
+		CByteReader footer(pData + nFooterOffset, nSize - nTrailerSize - nFooterOffset);
+		uint32_t nGroupCount = 0;
+		if (!footer.Read(nGroupCount))
+			return false;
+
+		for (uint32_t i = 0; i < nGroupCount; ++i)
+		{
+			SFleetRowGroup group{};
+			if (!footer.Read(group.nRowCount))
+				return false;
+
+			for (uint32_t j = 0; j < nColumnCount; ++j)
+			{
+				SFleetColumnChunk chunk{};
+				if (!footer.Read(chunk.nOffset) || !footer.Read(chunk.nSize) || !footer.Read(chunk.stats.nMin) || !footer.Read(chunk.stats.nMax))
+					return false;
+				if (chunk.nOffset < nDataOffset || chunk.nOffset > nFooterOffset || chunk.nSize > nFooterOffset - chunk.nOffset)
+					return false;
+				group.vChunks.emplace_back(chunk);
+			}
+			if (!__IsValidRowGroup(group))
+				return false;
+			m_vRowGroups.emplace_back(std::move(group));
+		}
+		return true;
+	}
+
+	bool CFleetStoreReader::__IsValidRowGroup(const SFleetRowGroup& group) const
+	{
+		if (!group.nRowCount || group.nRowCount > m_nRowGroupSize)
+			return false;
+
+		// [width u8][reference u64][ceil(n * width / 64) words] leaves no room for another row count
+		for (size_t i = 0; i < static_cast<size_t>(EFleetColumn::COLUMN_MAX); ++i)
+		{
+			const auto nFileColumn = m_arFileColumns[i];
+			if (nFileColumn < 0 || GetFleetColumnInfo(static_cast<EFleetColumn>(i)).nKind != EFleetColumnKind::COLUMN_KIND_NUMBER)
+				continue;
+
+			const auto& chunk = group.vChunks[nFileColumn];
+			if (chunk.nSize < sizeof(uint8_t) + sizeof(uint64_t))
+				return false;
+
+			const auto nWidth = static_cast<uint8_t>(m_file.GetData()[chunk.nOffset]);
+			if (nWidth > 64 || chunk.nSize != sizeof(uint8_t) + sizeof(uint64_t) + (group.nRowCount * nWidth + 63) / 64 * sizeof(uint64_t))
+				return false;
+		}
+		return true;
+	}
+
+	// Walks the row group frames up to the first torn or missing one, which is the tail that was never flushed
+	void CFleetStoreReader::__RecoverRowGroups(uint32_t nColumnCount, uint64_t nDataOffset)
+	{
+		const auto pData = m_file.GetData();
+		const auto nSize = m_file.GetSize();
+		const auto nDirectorySize = sizeof(uint64_t) + static_cast<uint64_t>(nColumnCount) * FLEET_STORE_CHUNK_ENTRY_SIZE;
+
+		auto nOffset = nDataOffset;
+		while (nSize - nOffset >= FLEET_STORE_GROUP_HEADER_SIZE && !std::memcmp(pData + nOffset, FLEET_STORE_GROUP_MAGIC, sizeof(FLEET_STORE_GROUP_MAGIC)))
+		{
+			uint64_t nBodySize = 0;
+			uint32_t nCrc = 0;
+			std::memcpy(&nBodySize, pData + nOffset + sizeof(FLEET_STORE_GROUP_MAGIC), sizeof(nBodySize));
+			std::memcpy(&nCrc, pData + nOffset + sizeof(FLEET_STORE_GROUP_MAGIC) + sizeof(nBodySize), sizeof(nCrc));
+
+			const auto nBodyOffset = nOffset + FLEET_STORE_GROUP_HEADER_SIZE;
+			if (nBodySize < nDirectorySize || nBodySize > nSize - nBodyOffset || ComputeCrc32c(pData + nBodyOffset, nBodySize) != nCrc)
+				break;
+
+			CByteReader body(pData + nBodyOffset, nBodySize);
+			const auto nChunksOffset = nBodyOffset + nDirectorySize;
+			const auto nChunksSize = nBodySize - nDirectorySize;
+
+			SFleetRowGroup group{};
+			body.Read(group.nRowCount);
+			for (uint32_t i = 0; i < nColumnCount; ++i)
+			{
+				SFleetColumnChunk chunk{};
+				body.Read(chunk.nOffset);
+				body.Read(chunk.nSize);
+				body.Read(chunk.stats.nMin);
+				body.Read(chunk.stats.nMax);
+				if (chunk.nOffset > nChunksSize || chunk.nSize > nChunksSize - chunk.nOffset)
+					return;
+				chunk.nOffset += nChunksOffset;
+				group.vChunks.emplace_back(chunk);
+			}
+			if (!__IsValidRowGroup(group))
+				break;
+			m_vRowGroups.emplace_back(std::move(group));
+			nOffset = nBodyOffset + nBodySize;
+		}
+	}
+
+	uint64_t CFleetStoreReader::GetRowCount() const
+	{
+		uint64_t nCount = 0;
+		for (const auto& group : m_vRowGroups)
+			nCount += group.nRowCount;
+		return nCount;
+	}
+
+	bool CFleetStoreReader::HasColumn(EFleetColumn nColumn) const
+	{
+		return m_arFileColumns[static_cast<size_t>(nColumn)] >= 0;
+	}
+
+	const SFleetColumnChunk* CFleetStoreReader::__GetChunk(size_t nGroup, EFleetColumn nColumn) const
+	{
+		if (nGroup >= m_vRowGroups.size() || nColumn >= EFleetColumn::COLUMN_MAX || !HasColumn(nColumn))
+			return nullptr;
+		return &m_vRowGroups[nGroup].vChunks[m_arFileColumns[static_cast<size_t>(nColumn)]];
+	}
+
+	SFleetColumnStats CFleetStoreReader::GetColumnStats(size_t nGroup, EFleetColumn nColumn) const
+	{
+		const auto pChunk = __GetChunk(nGroup, nColumn);
+		return pChunk ? pChunk->stats : SFleetColumnStats{};
+	}
+
+	bool CFleetStoreReader::ReadColumn(size_t nGroup, EFleetColumn nColumn, std::vector <uint64_t>& vValues) const
+	{
+		const auto pChunk = __GetChunk(nGroup, nColumn);
+		if (!pChunk)
+			return false;
+
+		CByteReader reader(m_file.GetData() + pChunk->nOffset, pChunk->nSize);
+		if (GetFleetColumnInfo(nColumn).nKind == EFleetColumnKind::COLUMN_KIND_STRING && !DecodeDictionary(reader, nullptr))
+			return false;
+		return UnpackValues(reader, m_vRowGroups[nGroup].nRowCount, vValues);
+	}
+
+	bool CFleetStoreReader::ReadDictionary(size_t nGroup, EFleetColumn nColumn, std::vector <std::string>& vDictionary) const
+	{
+		const auto pChunk = __GetChunk(nGroup, nColumn);
+		if (!pChunk || GetFleetColumnInfo(nColumn).nKind != EFleetColumnKind::COLUMN_KIND_STRING)
+			return false;
+
+		CByteReader reader(m_file.GetData() + pChunk->nOffset, pChunk->nSize);
+		return DecodeDictionary(reader, &vDictionary);
+	}
+
+	bool CFleetStoreReader::ReadRecords(size_t nGroup, const std::vector <EFleetColumn>& vProjection, std::vector <SFleetRecord>& vRecords) const
+	{
+		if (nGroup >= m_vRowGroups.size())
+			return false;
+
+		vRecords.assign(m_vRowGroups[nGroup].nRowCount, SFleetRecord{});
+
+		std::vector <uint64_t> vValues;
+		std::vector <std::string> vDictionary;
+		for (const auto nColumn : vProjection)
+		{
+			if (!HasColumn(nColumn))
+				continue;
+			if (!ReadColumn(nGroup, nColumn, vValues))
+				return false;
+
+			const auto& column = GetFleetColumnInfo(nColumn);
+			if (column.nKind == EFleetColumnKind::COLUMN_KIND_NUMBER)
+			{
+				for (size_t i = 0; i < vRecords.size(); ++i)
+					column.pfnSetNumber(vRecords[i], vValues[i]);
+				continue;
+			}
+
+			if (!ReadDictionary(nGroup, nColumn, vDictionary))
+				return false;
+			for (size_t i = 0; i < vRecords.size(); ++i)
+			{
+				if (vValues[i] >= vDictionary.size())
+					return false;
+				vRecords[i].*column.pString = vDictionary[vValues[i]];
+			}
+		}
+		return true;
+	}
+};
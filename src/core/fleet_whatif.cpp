@@ -0,0 +1,357 @@
+#include "../../include/core/fleet_whatif.hpp"
+#include "../../include/core/work_stealing_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+
+namespace Win11SysCheck
+{
+	static bool ParseAssignment(const std::string& stText, SFleetAssignment& assignment)
+	{
+		const auto nPos = stText.find('=');
+		if (nPos == std::string::npos || !nPos)
+			return false;
+
+		auto stColumn = stText.substr(0, nPos);
+		assignment.nOp = ETransformOp::TRANSFORM_SET;
+		if (stColumn.back() == '+')
+		{
+			assignment.nOp = ETransformOp::TRANSFORM_ADD;
+			stColumn.pop_back();
+		}
+
+		assignment.nColumn = FindFleetColumn(stColumn);
+		if (assignment.nColumn == EFleetColumn::COLUMN_MAX || GetFleetColumnInfo(assignment.nColumn).nKind != EFleetColumnKind::COLUMN_KIND_NUMBER)
+			return false;
+
+		const auto stValue = stText.substr(nPos + 1);
+		char* pEnd = nullptr;
+		assignment.nValue = std::strtoull(stValue.c_str(), &pEnd, 0);
+		return !stValue.empty() && !*pEnd;
+	}
+
+	static bool ParseCondition(const std::string& stText, SFleetPredicate& condition, std::string& stConditionText)
+	{
+		for (const auto szToken : { "==", "!=" })
+		{
+			const auto nPos = stText.find(szToken);
+			if (nPos == std::string::npos)
+				continue;
+
+			const auto nColumn = FindFleetColumn(stText.substr(0, nPos));
+			if (nColumn == EFleetColumn::COLUMN_MAX || GetFleetColumnInfo(nColumn).nKind != EFleetColumnKind::COLUMN_KIND_STRING)
+				break;
+
+			condition.nColumn = nColumn;
+			condition.nOp = szToken[0] == '=' ? ECompareOp::COMPARE_EQ : ECompareOp::COMPARE_NE;
+			stConditionText = stText.substr(nPos + 2);
+			return true;
+		}
+		stConditionText.clear();
+		return ParseFleetPredicate(stText, condition);
+	}
+
+	bool ParseFleetTransforms(const std::string& stText, std::vector <SFleetTransform>& vTransforms)
+	{
+		std::istringstream issTransforms(stText);
+		std::string stTransform;
+		while (std::getline(issTransforms, stTransform, ';'))
+		{
+			if (stTransform.empty())
+				continue;
+
+			SFleetTransform transform{};
+
+			const auto nIf = stTransform.find(" if ");
+			std::istringstream issAssignments(stTransform.substr(0, nIf));
+			std::string stAssignment;
+			while (std::getline(issAssignments, stAssignment, ','))
+			{
+				SFleetAssignment assignment{};
+				if (!ParseAssignment(stAssignment, assignment))
+					return false;
+				transform.vAssignments.emplace_back(assignment);
+			}
+			if (transform.vAssignments.empty())
+				return false;
+
+			if (nIf != std::string::npos)
+			{
+				std::istringstream issConditions(stTransform.substr(nIf + 4));
+				std::string stCondition;
+				while (std::getline(issConditions, stCondition, ','))
+				{
+					SFleetPredicate condition{};
+					std::string stConditionText;
+					if (!ParseCondition(stCondition, condition, stConditionText))
+						return false;
+					transform.vConditions.emplace_back(std::move(condition));
+					transform.vConditionTexts.emplace_back(std::move(stConditionText));
+				}
+			}
+			vTransforms.emplace_back(std::move(transform));
+		}
+		return !vTransforms.empty();
+	}
+
+	void SWhatIfResult::Merge(const SWhatIfResult& other)
+	{
+		nRowCount += other.nRowCount;
+		nTransformedCount += other.nTransformedCount;
+		nBaselinePassCount += other.nBaselinePassCount;
+		nScenarioPassCount += other.nScenarioPassCount;
+		nGainedCount += other.nGainedCount;
+		nLostCount += other.nLostCount;
+		nBaselinePredicateCount += other.nBaselinePredicateCount;
+		nScenarioPredicateCount += other.nScenarioPredicateCount;
+		nSkippedRowGroupCount += other.nSkippedRowGroupCount;
+
+		vRules.resize((std::max)(vRules.size(), other.vRules.size()));
+		for (size_t i = 0; i < other.vRules.size(); ++i)
+		{
+			vRules[i].nBaselineFailCount += other.vRules[i].nBaselineFailCount;
+			vRules[i].nScenarioFailCount += other.vRules[i].nScenarioFailCount;
+			vRules[i].nFixedCount += other.vRules[i].nFixedCount;
+			vRules[i].nBrokenCount += other.vRules[i].nBrokenCount;
+		}
+	}
+
+	CFleetSimulator::CFleetSimulator(std::vector <SFleetRule> vBaseline, const std::vector <SFleetRule>& vScenario, std::vector <SFleetTransform> vTransforms, ESimdLevel nLevel) :
+		m_vBaseline(std::move(vBaseline)), m_vTransforms(std::move(vTransforms)), m_vAssigned(static_cast<size_t>(EFleetColumn::COLUMN_MAX), false), m_nLevel(nLevel)
+	{
+		// A rule only the scenario has passes every machine of the baseline
+		for (const auto& rule : vScenario)
+		{
+			const auto it = std::find_if(m_vBaseline.begin(), m_vBaseline.end(), [&](const SFleetRule& baseline) { return baseline.stName == rule.stName; });
+			if (it == m_vBaseline.end())
+				m_vBaseline.emplace_back(SFleetRule{ rule.stName, {} });
+		}
+
+		for (const auto& transform : m_vTransforms)
+		{
+			for (const auto& assignment : transform.vAssignments)
+				m_vAssigned[static_cast<size_t>(assignment.nColumn)] = true;
+		}
+
+		for (size_t i = 0; i < m_vBaseline.size(); ++i)
+		{
+			const auto& baseline = m_vBaseline[i];
+			m_vRuleNames.emplace_back(baseline.stName);
+			m_nBaselinePredicateCount += baseline.vPredicates.size();
+
+			const auto it = std::find_if(vScenario.begin(), vScenario.end(), [&](const SFleetRule& rule) { return rule.stName == baseline.stName; });
+			const auto& rule = it != vScenario.end() ? *it : baseline;
+
+			auto bDirty = it != vScenario.end();
+			for (const auto& predicate : rule.vPredicates)
+				bDirty = bDirty || m_vAssigned[static_cast<size_t>(predicate.nColumn)];
+
+			m_vDirty.push_back(bDirty);
+			if (bDirty)
+			{
+				m_vScenario.emplace_back(rule);
+				m_vScenarioIndexes.emplace_back(i);
+				m_nScenarioPredicateCount += rule.vPredicates.size();
+			}
+			m_bPolicyChanged = m_bPolicyChanged || it != vScenario.end();
+		}
+	}
+
+	static uint64_t CountAndNot(const CSelectionBitmap& bitmap, const CSelectionBitmap& other)
+	{
+		uint64_t nCount = 0;
+		for (size_t i = 0; i < bitmap.GetWordCount(); ++i)
+			nCount += PopCount64(bitmap.GetWords()[i] & ~other.GetWords()[i]);
+		return nCount;
+	}
+
+	bool CFleetSimulator::__SimulateRowGroup(const CFleetStoreReader& reader, size_t nGroup, CFleetEvaluator& baseline, CFleetEvaluator& scenario, SWhatIfResult& result) const
+	{
+		const auto nRowCount = static_cast<size_t>(reader.GetRowGroupRowCount(nGroup));
+
+		std::vector <CSelectionBitmap> vBaselineBitmaps;
+		CSelectionBitmap baselinePass;
+		if (!baseline.EvaluateRowGroup(reader, nGroup, vBaselineBitmaps, baselinePass))
+			return false;
+		result.nRowCount += nRowCount;
+		result.nBaselinePredicateCount += nRowCount * m_nBaselinePredicateCount;
+
+		std::vector <std::vector <uint64_t>> vDecoded(static_cast<size_t>(EFleetColumn::COLUMN_MAX));
+		std::vector <bool> vIsDecoded(vDecoded.size(), false);
+		auto Decode = [&](EFleetColumn nColumn) -> const std::vector <uint64_t>* {
+			const auto nIndex = static_cast<size_t>(nColumn);
+			if (!vIsDecoded[nIndex])
+			{
+				if (!reader.HasColumn(nColumn) || !reader.ReadColumn(nGroup, nColumn, vDecoded[nIndex]))
+					return nullptr;
+				vIsDecoded[nIndex] = true;
+			}
+			return &vDecoded[nIndex];
+		};
+
+		// Conditions see the stored facts, not the output of earlier transforms
+		std::vector <CSelectionBitmap> vSelections(m_vTransforms.size());
+		CSelectionBitmap anySelection, conditionBitmap, operandBitmap;
+		anySelection.Reset(nRowCount, false);
+		std::vector <std::string> vDictionary;
+		for (size_t i = 0; i < m_vTransforms.size(); ++i)
+		{
+			const auto& transform = m_vTransforms[i];
+			auto& selection = vSelections[i];
+			selection.Reset(nRowCount, true);
+
+			for (size_t j = 0; j < transform.vConditions.size(); ++j)
+			{
+				const auto& condition = transform.vConditions[j];
+				const auto pValues = Decode(condition.nColumn);
+				if (!pValues)
+					return false;
+
+				auto vOperands = condition.vOperands;
+				if (GetFleetColumnInfo(condition.nColumn).nKind == EFleetColumnKind::COLUMN_KIND_STRING)
+				{
+					// Codes never reach the maximum, text missing from the dictionary matches no row
+					if (!reader.ReadDictionary(nGroup, condition.nColumn, vDictionary))
+						return false;
+					const auto it = std::find(vDictionary.begin(), vDictionary.end(), transform.vConditionTexts[j]);
+					vOperands = { it != vDictionary.end() ? static_cast<uint64_t>(it - vDictionary.begin()) : UINT64_MAX };
+				}
+
+				conditionBitmap.Reset(nRowCount, false);
+				if (condition.nOp == ECompareOp::COMPARE_IN)
+				{
+					operandBitmap.Reset(nRowCount, false);
+					for (const auto nOperand : vOperands)
+					{
+						CompareColumn(pValues->data(), nRowCount, ECompareOp::COMPARE_EQ, nOperand, operandBitmap.GetWords(), m_nLevel);
+						conditionBitmap.Or(operandBitmap);
+					}
+				}
+				else
+				{
+					CompareColumn(pValues->data(), nRowCount, condition.nOp, vOperands.empty() ? 0 : vOperands.front(), conditionBitmap.GetWords(), m_nLevel);
+				}
+				selection.And(conditionBitmap);
+			}
+			anySelection.Or(selection);
+		}
+		const auto nSelectedCount = anySelection.Count();
+		result.nTransformedCount += nSelectedCount;
+
+		std::vector <CSelectionBitmap> vScenarioBitmaps;
+		CSelectionBitmap scenarioPass;
+		if (m_vScenario.empty() || (!nSelectedCount && !m_bPolicyChanged))
+		{
+			result.nSkippedRowGroupCount++;
+		}
+		else if (!nSelectedCount)
+		{
+			// Only the policy changed, the stored columns and their statistics still apply
+			if (!scenario.EvaluateRowGroup(reader, nGroup, vScenarioBitmaps, scenarioPass))
+				return false;
+			result.nScenarioPredicateCount += nRowCount * m_nScenarioPredicateCount;
+		}
+		else
+		{
+			std::vector <std::vector <uint64_t>> vAssigned(vDecoded.size());
+			std::vector <const uint64_t*> vColumns(vDecoded.size(), nullptr);
+			for (size_t i = 0; i < m_vAssigned.size(); ++i)
+			{
+				if (!m_vAssigned[i])
+					continue;
+				const auto pValues = Decode(static_cast<EFleetColumn>(i));
+				if (!pValues)
+					return false;
+				vAssigned[i] = *pValues;
+				vColumns[i] = vAssigned[i].data();
+			}
+
+			for (size_t i = 0; i < m_vTransforms.size(); ++i)
+			{
+				const auto pWords = vSelections[i].GetWords();
+				for (size_t nWord = 0; nWord < vSelections[i].GetWordCount(); ++nWord)
+				{
+					for (auto nBits = pWords[nWord]; nBits; nBits &= nBits - 1)
+					{
+						const auto nRow = nWord * 64 + PopCount64((nBits & (0 - nBits)) - 1);
+						for (const auto& assignment : m_vTransforms[i].vAssignments)
+						{
+							auto& nValue = vAssigned[static_cast<size_t>(assignment.nColumn)][nRow];
+							nValue = assignment.nOp == ETransformOp::TRANSFORM_ADD ? nValue + assignment.nValue : assignment.nValue;
+						}
+					}
+				}
+			}
+
+			for (const auto& rule : m_vScenario)
+			{
+				for (const auto& predicate : rule.vPredicates)
+				{
+					const auto nColumn = static_cast<size_t>(predicate.nColumn);
+					if (vColumns[nColumn])
+						continue;
+					const auto pValues = Decode(predicate.nColumn);
+					if (!pValues)
+						return false;
+					vColumns[nColumn] = pValues->data();
+				}
+			}
+
+			scenario.EvaluateColumns(vColumns, nRowCount, vScenarioBitmaps, scenarioPass);
+			result.nScenarioPredicateCount += nRowCount * m_nScenarioPredicateCount;
+		}
+
+		// Rules that were not evaluated again keep their baseline verdict
+		std::vector <const CSelectionBitmap*> vRuleBitmaps(m_vBaseline.size());
+		for (size_t i = 0; i < m_vBaseline.size(); ++i)
+			vRuleBitmaps[i] = &vBaselineBitmaps[i];
+		for (size_t i = 0; i < vScenarioBitmaps.size(); ++i)
+			vRuleBitmaps[m_vScenarioIndexes[i]] = &vScenarioBitmaps[i];
+
+		scenarioPass.Reset(nRowCount, true);
+		result.vRules.resize(m_vBaseline.size());
+		for (size_t i = 0; i < m_vBaseline.size(); ++i)
+		{
+			auto& delta = result.vRules[i];
+			delta.nBaselineFailCount += nRowCount - vBaselineBitmaps[i].Count();
+			delta.nScenarioFailCount += nRowCount - vRuleBitmaps[i]->Count();
+			delta.nFixedCount += CountAndNot(*vRuleBitmaps[i], vBaselineBitmaps[i]);
+			delta.nBrokenCount += CountAndNot(vBaselineBitmaps[i], *vRuleBitmaps[i]);
+			scenarioPass.And(*vRuleBitmaps[i]);
+		}
+
+		result.nBaselinePassCount += baselinePass.Count();
+		result.nScenarioPassCount += scenarioPass.Count();
+		result.nGainedCount += CountAndNot(scenarioPass, baselinePass);
+		result.nLostCount += CountAndNot(baselinePass, scenarioPass);
+		return true;
+	}
+
+	bool CFleetSimulator::SimulateStore(const CFleetStoreReader& reader, SWhatIfResult& result, uint32_t nThreadCount) const
+	{
+		result = {};
+		result.vRules.resize(m_vBaseline.size());
+
+		CWorkStealingPool pool(nThreadCount);
+		std::vector <SWhatIfResult> vWorkerResults(pool.GetThreadCount());
+		std::atomic <bool> bFailed{ false };
+
+		for (size_t i = 0; i < reader.GetRowGroupCount(); ++i)
+		{
+			pool.Submit([&, i] {
+				// Evaluators keep scratch bitmaps, every task gets its own
+				CFleetEvaluator baseline(m_vBaseline, m_nLevel);
+				CFleetEvaluator scenario(m_vScenario, m_nLevel);
+				if (!__SimulateRowGroup(reader, i, baseline, scenario, vWorkerResults[CWorkStealingPool::GetWorkerIndex()]))
+					bFailed = true;
+			});
+		}
+		pool.Wait();
+
+		for (const auto& workerResult : vWorkerResults)
+			result.Merge(workerResult);
+		return !bFailed;
+	}
+};
@@ -0,0 +1,312 @@
+#include "../../include/core/hardware_fingerprint.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace Win11SysCheck
+{
+	static uint64_t RotateLeft(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+	static uint64_t FinalMix(uint64_t k)
+	{
+		k ^= k >> 33;
+		k *= 0xFF51AFD7ED558CCDull;
+		k ^= k >> 33;
+		k *= 0xC4CEB9FE1A85EC53ull;
+		k ^= k >> 33;
+		return k;
+	}
+
+	template <class T>
+	static void AppendValue(std::string& stBuffer, T value)
+	{
+		stBuffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	static void AppendString(std::string& stBuffer, const std::string& stValue)
+	{
+		const auto nLength = static_cast<uint16_t>((std::min)(stValue.size(), size_t(UINT16_MAX)));
+		AppendValue(stBuffer, nLength);
+		stBuffer.append(stValue.data(), nLength);
+	}
+
+	class CProfileDecoder
+	{
+	public:
+		CProfileDecoder(const char* pData, size_t nSize) :
+			m_pData(pData), m_nSize(nSize)
+		{
+		}
+
+		template <class T>
+		bool Read(T& value)
+		{
+			if (m_nSize - m_nOffset < sizeof(T))
+				return false;
+			std::memcpy(&value, m_pData + m_nOffset, sizeof(T));
+			m_nOffset += sizeof(T);
+			return true;
+		}
+
+		bool ReadString(std::string& stValue)
+		{
+			uint16_t nLength = 0;
+			if (!Read(nLength) || m_nSize - m_nOffset < nLength)
+				return false;
+			stValue.assign(m_pData + m_nOffset, nLength);
+			m_nOffset += nLength;
+			return true;
+		}
+
+		bool IsEnd() const { return m_nOffset == m_nSize; };
+
+	private:
+		const char* m_pData;
+		size_t m_nSize;
+		size_t m_nOffset{ 0 };
+	};
+
+	std::string SHardwareFingerprint::ToString() const
+	{
+		return fmt::format("{0:016x}{1:016x}", nHigh, nLow);
+	}
+
+	SHardwareFingerprint HashBytes128(const void* pData, size_t nSize, uint64_t nSeed)
+	{
+		constexpr auto c1 = 0x87C37B91114253D5ull;
+		constexpr auto c2 = 0x4CF5AD432745937Full;
+
+		const auto pBytes = static_cast<const uint8_t*>(pData);
+		const auto nBlocks = nSize / 16;
+
+		auto h1 = nSeed, h2 = nSeed;
+		for (size_t i = 0; i < nBlocks; ++i)
+		{
+			uint64_t k1, k2;
+			std::memcpy(&k1, pBytes + i * 16, sizeof(k1));
+			std::memcpy(&k2, pBytes + i * 16 + 8, sizeof(k2));
+
+			k1 *= c1; k1 = RotateLeft(k1, 31); k1 *= c2; h1 ^= k1;
+			h1 = RotateLeft(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52DCE729;
+			k2 *= c2; k2 = RotateLeft(k2, 33); k2 *= c1; h2 ^= k2;
+			h2 = RotateLeft(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495AB5;
+		}
+
+		const auto pTail = pBytes + nBlocks * 16;
+		uint64_t k1 = 0, k2 = 0;
+		switch (nSize & 15)
+		{
+			case 15: k2 ^= static_cast<uint64_t>(pTail[14]) << 48; [[fallthrough]];
+			case 14: k2 ^= static_cast<uint64_t>(pTail[13]) << 40; [[fallthrough]];
+			case 13: k2 ^= static_cast<uint64_t>(pTail[12]) << 32; [[fallthrough]];
+			case 12: k2 ^= static_cast<uint64_t>(pTail[11]) << 24; [[fallthrough]];
+			case 11: k2 ^= static_cast<uint64_t>(pTail[10]) << 16; [[fallthrough]];
+			case 10: k2 ^= static_cast<uint64_t>(pTail[9]) << 8; [[fallthrough]];
+			case 9:
+				k2 ^= static_cast<uint64_t>(pTail[8]);
+				k2 *= c2; k2 = RotateLeft(k2, 33); k2 *= c1; h2 ^= k2;
+				[[fallthrough]];
+			case 8: k1 ^= static_cast<uint64_t>(pTail[7]) << 56; [[fallthrough]];
+			case 7: k1 ^= static_cast<uint64_t>(pTail[6]) << 48; [[fallthrough]];
+			case 6: k1 ^= static_cast<uint64_t>(pTail[5]) << 40; [[fallthrough]];
+			case 5: k1 ^= static_cast<uint64_t>(pTail[4]) << 32; [[fallthrough]];
+			case 4: k1 ^= static_cast<uint64_t>(pTail[3]) << 24; [[fallthrough]];
+			case 3: k1 ^= static_cast<uint64_t>(pTail[2]) << 16; [[fallthrough]];
+			case 2: k1 ^= static_cast<uint64_t>(pTail[1]) << 8; [[fallthrough]];
+			case 1:
+				k1 ^= static_cast<uint64_t>(pTail[0]);
+				k1 *= c1; k1 = RotateLeft(k1, 31); k1 *= c2; h1 ^= k1;
+				break;
+			default:
+				break;
+		}
+
+		h1 ^= nSize;
+		h2 ^= nSize;
+		h1 += h2;
+		h2 += h1;
+		h1 = FinalMix(h1);
+		h2 = FinalMix(h2);
+		h1 += h2;
+		h2 += h1;
+		return SHardwareFingerprint{ h1, h2 };
+	}
+
+	void EncodeHardwareProfile(const SProbeResult& result, std::string& stBuffer, bool bIncludeDxDiag)
+	{
+		AppendValue(stBuffer, HARDWARE_PROFILE_VERSION);
+
+		const auto& os = result.os;
+		AppendValue(stBuffer, os.nMajorVersion);
+		AppendValue(stBuffer, os.nMinorVersion);
+		AppendValue(stBuffer, os.nServicePackMajor);
+		AppendValue(stBuffer, os.nServicePackMinor);
+		AppendValue(stBuffer, os.nBuildNumber);
+		AppendValue(stBuffer, os.nPlatformId);
+		AppendValue(stBuffer, os.nProductType);
+
+		const auto& boot = result.boot;
+		AppendValue(stBuffer, static_cast<uint8_t>(boot.nFirmwareType));
+		AppendValue(stBuffer, boot.nBootFlags);
+		AppendValue(stBuffer, static_cast<uint8_t>(boot.bSecureBootCapable | (boot.bSecureBootEnabled << 1) | (boot.bTpmPresent << 2)));
+		AppendValue(stBuffer, boot.nTpmVersion);
+
+		const auto& cpu = result.cpu;
+		AppendString(stBuffer, cpu.stVendor);
+		AppendString(stBuffer, cpu.stName);
+		AppendValue(stBuffer, static_cast<uint16_t>(cpu.nArchitecture));
+		AppendValue(stBuffer, cpu.nFamily);
+		AppendValue(stBuffer, cpu.nModel);
+		AppendValue(stBuffer, cpu.nStepping);
+		AppendValue(stBuffer, cpu.nPlatformSpecificField);
+		AppendValue(stBuffer, cpu.nActiveProcessorCount);
+		AppendValue(stBuffer, cpu.nProcessorCount);
+		AppendValue(stBuffer, cpu.nMaxMhz);
+		AppendValue(stBuffer, cpu.nFastProcessorCount);
+		AppendValue(stBuffer, static_cast<uint8_t>(cpu.bArmV81Atomics));
+		AppendValue(stBuffer, cpu.nFeatures);
+
+		AppendValue(stBuffer, result.ram.nTotalPhysical);
+
+		AppendValue(stBuffer, static_cast<uint16_t>(result.disk.vVolumes.size()));
+		for (const auto& volume : result.disk.vVolumes)
+		{
+			AppendString(stBuffer, volume.stFileSystem);
+			AppendValue(stBuffer, static_cast<uint8_t>(volume.nPartitionStyle));
+			AppendValue(stBuffer, volume.nTotalBytes);
+		}
+
+		const auto& display = result.display;
+		AppendValue(stBuffer, static_cast<uint16_t>(display.vMonitors.size()));
+		for (const auto& monitor : display.vMonitors)
+		{
+			AppendString(stBuffer, monitor.stDeviceString);
+			AppendValue(stBuffer, static_cast<uint8_t>(monitor.bPrimary));
+			AppendValue(stBuffer, monitor.nBitsPerPixel);
+			AppendValue(stBuffer, monitor.nWidth);
+			AppendValue(stBuffer, monitor.nHeight);
+		}
+		AppendValue(stBuffer, static_cast<uint16_t>(display.vPanels.size()));
+		for (const auto& panel : display.vPanels)
+		{
+			AppendValue(stBuffer, panel.nWidthCm);
+			AppendValue(stBuffer, panel.nHeightCm);
+		}
+		if (!bIncludeDxDiag)
+			return;
+
+		AppendValue(stBuffer, static_cast<uint16_t>(display.vAdapters.size()));
+		for (const auto& adapter : display.vAdapters)
+		{
+			AppendString(stBuffer, adapter.stDescription);
+			AppendString(stBuffer, adapter.stDriverModel);
+		}
+		AppendValue(stBuffer, display.nDirectXMajor);
+		AppendValue(stBuffer, display.nDirectXMinor);
+	}
+
+	bool DecodeHardwareProfile(const char* pData, size_t nSize, SProbeResult& result)
+	{
+		result = {};
+		CProfileDecoder decoder(pData, nSize);
+
+		uint8_t nVersion = 0;
+		if (!decoder.Read(nVersion) || nVersion != HARDWARE_PROFILE_VERSION)
+			return false;
+
+		auto& os = result.os;
+		if (!decoder.Read(os.nMajorVersion) || !decoder.Read(os.nMinorVersion) || !decoder.Read(os.nServicePackMajor) || !decoder.Read(os.nServicePackMinor) ||
+			!decoder.Read(os.nBuildNumber) || !decoder.Read(os.nPlatformId) || !decoder.Read(os.nProductType))
+			return false;
+
+		auto& boot = result.boot;
+		uint8_t nFirmwareType = 0, nBootBits = 0;
+		if (!decoder.Read(nFirmwareType) || !decoder.Read(boot.nBootFlags) || !decoder.Read(nBootBits) || !decoder.Read(boot.nTpmVersion))
+			return false;
+		boot.nFirmwareType = static_cast<EFirmwareType>(nFirmwareType);
+		boot.bSecureBootCapable = nBootBits & 1;
+		boot.bSecureBootEnabled = (nBootBits >> 1) & 1;
+		boot.bTpmPresent = (nBootBits >> 2) & 1;
+
+		auto& cpu = result.cpu;
+		uint16_t nArchitecture = 0;
+		uint8_t nAtomics = 0;
+		if (!decoder.ReadString(cpu.stVendor) || !decoder.ReadString(cpu.stName) || !decoder.Read(nArchitecture) ||
+			!decoder.Read(cpu.nFamily) || !decoder.Read(cpu.nModel) || !decoder.Read(cpu.nStepping) || !decoder.Read(cpu.nPlatformSpecificField) ||
+			!decoder.Read(cpu.nActiveProcessorCount) || !decoder.Read(cpu.nProcessorCount) || !decoder.Read(cpu.nMaxMhz) ||
+			!decoder.Read(cpu.nFastProcessorCount) || !decoder.Read(nAtomics) || !decoder.Read(cpu.nFeatures))
+			return false;
+		cpu.nArchitecture = static_cast<EProcessorArchitecture>(nArchitecture);
+		cpu.bArmV81Atomics = nAtomics != 0;
+
+		if (!decoder.Read(result.ram.nTotalPhysical))
+			return false;
+
+		uint16_t nCount = 0;
+		if (!decoder.Read(nCount))
+			return false;
+		for (uint16_t i = 0; i < nCount; ++i)
+		{
+			SVolumeFacts volume{};
+			uint8_t nPartitionStyle = 0;
+			if (!decoder.ReadString(volume.stFileSystem) || !decoder.Read(nPartitionStyle) || !decoder.Read(volume.nTotalBytes))
+				return false;
+			volume.nPartitionStyle = static_cast<EPartitionStyle>(nPartitionStyle);
+			result.disk.vVolumes.emplace_back(std::move(volume));
+		}
+
+		auto& display = result.display;
+		if (!decoder.Read(nCount))
+			return false;
+		for (uint16_t i = 0; i < nCount; ++i)
+		{
+			SMonitorFacts monitor{};
+			uint8_t nPrimary = 0;
+			if (!decoder.ReadString(monitor.stDeviceString) || !decoder.Read(nPrimary) || !decoder.Read(monitor.nBitsPerPixel) ||
+				!decoder.Read(monitor.nWidth) || !decoder.Read(monitor.nHeight))
+				return false;
+			monitor.bPrimary = nPrimary != 0;
+			display.vMonitors.emplace_back(std::move(monitor));
+		}
+		if (!decoder.Read(nCount))
+			return false;
+		for (uint16_t i = 0; i < nCount; ++i)
+		{
+			SPanelFacts panel{};
+			if (!decoder.Read(panel.nWidthCm) || !decoder.Read(panel.nHeightCm))
+				return false;
+			display.vPanels.emplace_back(std::move(panel));
+		}
+		if (!decoder.Read(nCount))
+			return false;
+		for (uint16_t i = 0; i < nCount; ++i)
+		{
+			SGraphicsAdapterFacts adapter{};
+			if (!decoder.ReadString(adapter.stDescription) || !decoder.ReadString(adapter.stDriverModel))
+				return false;
+			display.vAdapters.emplace_back(std::move(adapter));
+		}
+		return decoder.Read(display.nDirectXMajor) && decoder.Read(display.nDirectXMinor) && decoder.IsEnd();
+	}
+
+	SHardwareFingerprint ComputeHardwareFingerprint(const SProbeResult& result, bool bIncludeDxDiag)
+	{
+		std::string stBuffer;
+		EncodeHardwareProfile(result, stBuffer, bIncludeDxDiag);
+		return HashBytes128(stBuffer.data(), stBuffer.size());
+	}
+
+	bool ParseHardwareFingerprint(const std::string& stText, SHardwareFingerprint& fingerprint)
+	{
+		if (stText.size() != 32 || stText.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+			return false;
+
+		fingerprint.nHigh = std::strtoull(stText.substr(0, 16).c_str(), nullptr, 16);
+		fingerprint.nLow = std::strtoull(stText.substr(16).c_str(), nullptr, 16);
+		return true;
+	}
+};
@@ -0,0 +1,278 @@
+#include "../../include/core/hdr_histogram.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include "../../include/core/output_file.hpp"
+#include "../../include/core/simd_support.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Win11SysCheck
+{
+	static constexpr char FACT_HISTOGRAMS_MAGIC[8]{ 'W', '1', '1', 'H', 'I', 'S', 'T', '1' };
+
+	struct SFactHistogramInfo
+	{
+		EFactHistogram nFact;
+		const char* szName;
+		uint64_t nHighest;
+	};
+
+	static constexpr SFactHistogramInfo gs_arFactHistograms[] = {
+		{ EFactHistogram::FACT_HISTOGRAM_RAM_MB, "ram_mb", 1ull << 24 },
+		{ EFactHistogram::FACT_HISTOGRAM_DISK_FREE_MB, "disk_free_mb", 1ull << 32 },
+		{ EFactHistogram::FACT_HISTOGRAM_PANEL_DIAGONAL, "max_panel_diagonal", 100000 },
+		{ EFactHistogram::FACT_HISTOGRAM_CPU_MAX_MHZ, "cpu_max_mhz", 100000 },
+		{ EFactHistogram::FACT_HISTOGRAM_PROBE_LATENCY_US, "probe_latency_us", 3600000000ull }
+	};
+	static_assert(sizeof(gs_arFactHistograms) / sizeof(gs_arFactHistograms[0]) == static_cast<size_t>(EFactHistogram::FACT_HISTOGRAM_MAX), "Missing fact histogram");
+
+	static bool ReadBytes(const char* pData, size_t nSize, size_t& nOffset, void* pOut, size_t nLength)
+	{
+		if (nOffset > nSize || nSize - nOffset < nLength)
+			return false;
+		std::memcpy(pOut, pData + nOffset, nLength);
+		nOffset += nLength;
+		return true;
+	}
+
+	template <class T>
+	static void AppendValue(std::string& stBuffer, T value)
+	{
+		stBuffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	CHdrHistogram::CHdrHistogram(uint64_t nLowest, uint64_t nHighest, uint32_t nSignificantDigits)
+	{
+		__Init(nLowest, nHighest, nSignificantDigits);
+	}
+
+	void CHdrHistogram::Record(uint64_t nValue, uint64_t nCount)
+	{
+		nValue = (std::min)(nValue, m_nHighest);
+		m_vCounts[__GetCountsIndex(nValue)] += nCount;
+
+		m_nMin = m_nTotalCount ? (std::min)(m_nMin, nValue) : nValue;
+		m_nMax = (std::max)(m_nMax, nValue);
+		m_nTotalCount += nCount;
+		m_nSum += nValue * nCount;
+	}
+
+	bool CHdrHistogram::Merge(const CHdrHistogram& other)
+	{
+		if (m_nLowest != other.m_nLowest || m_nHighest != other.m_nHighest || m_nSignificantDigits != other.m_nSignificantDigits)
+			return false;
+		if (!other.m_nTotalCount)
+			return true;
+
+		for (size_t i = 0; i < m_vCounts.size(); ++i)
+			m_vCounts[i] += other.m_vCounts[i];
+
+		m_nMin = m_nTotalCount ? (std::min)(m_nMin, other.m_nMin) : other.m_nMin;
+		m_nMax = (std::max)(m_nMax, other.m_nMax);
+		m_nTotalCount += other.m_nTotalCount;
+		m_nSum += other.m_nSum;
+		return true;
+	}
+
+	void CHdrHistogram::Reset()
+	{
+		std::fill(m_vCounts.begin(), m_vCounts.end(), 0);
+		m_nTotalCount = m_nSum = m_nMin = m_nMax = 0;
+	}
+
+	uint64_t CHdrHistogram::GetValueAtPercentile(double dPercentile) const
+	{
+		if (!m_nTotalCount)
+			return 0;
+
+		const auto dClamped = (std::min)((std::max)(dPercentile, 0.0), 100.0);
+		const auto nTarget = (std::max)(static_cast<uint64_t>(dClamped / 100.0 * m_nTotalCount + 0.5), uint64_t(1));
+
+		uint64_t nRunning = 0;
+		for (size_t i = 0; i < m_vCounts.size(); ++i)
+		{
+			nRunning += m_vCounts[i];
+			if (nRunning >= nTarget)
+				return (std::min)((std::max)(__GetHighestEquivalent(i), m_nMin), m_nMax);
+		}
+		return m_nMax;
+	}
+
+	// [lowest u64][highest u64][digits u32][total u64][sum u64][min u64][max u64][used u32] then [index u32][count u64] pairs
+	void CHdrHistogram::Serialize(std::string& stBuffer) const
+	{
+		AppendValue(stBuffer, m_nLowest);
+		AppendValue(stBuffer, m_nHighest);
+		AppendValue(stBuffer, m_nSignificantDigits);
+		AppendValue(stBuffer, m_nTotalCount);
+		AppendValue(stBuffer, m_nSum);
+		AppendValue(stBuffer, m_nMin);
+		AppendValue(stBuffer, m_nMax);
+
+		const auto nUsed = static_cast<uint32_t>(m_vCounts.size() - std::count(m_vCounts.begin(), m_vCounts.end(), 0));
+		AppendValue(stBuffer, nUsed);
+		for (size_t i = 0; i < m_vCounts.size(); ++i)
+		{
+			if (!m_vCounts[i])
+				continue;
+			AppendValue(stBuffer, static_cast<uint32_t>(i));
+			AppendValue(stBuffer, m_vCounts[i]);
+		}
+	}
+
+	bool CHdrHistogram::Deserialize(const char* pData, size_t nSize, size_t& nOffset)
+	{
+		uint64_t nLowest = 0, nHighest = 0;
+		uint32_t nSignificantDigits = 0, nUsed = 0;
+		if (!ReadBytes(pData, nSize, nOffset, &nLowest, sizeof(nLowest)) || !ReadBytes(pData, nSize, nOffset, &nHighest, sizeof(nHighest)) ||
+			!ReadBytes(pData, nSize, nOffset, &nSignificantDigits, sizeof(nSignificantDigits)) ||
+			!nLowest || nHighest < 2 * nLowest || nSignificantDigits < 1 || nSignificantDigits > 5)
+			return false;
+
+		__Init(nLowest, nHighest, nSignificantDigits);
+		if (!ReadBytes(pData, nSize, nOffset, &m_nTotalCount, sizeof(m_nTotalCount)) || !ReadBytes(pData, nSize, nOffset, &m_nSum, sizeof(m_nSum)) ||
+			!ReadBytes(pData, nSize, nOffset, &m_nMin, sizeof(m_nMin)) || !ReadBytes(pData, nSize, nOffset, &m_nMax, sizeof(m_nMax)) ||
+			!ReadBytes(pData, nSize, nOffset, &nUsed, sizeof(nUsed)) || nUsed > m_vCounts.size())
+			return false;
+
+		for (uint32_t i = 0; i < nUsed; ++i)
+		{
+			uint32_t nIndex = 0;
+			uint64_t nCount = 0;
+			if (!ReadBytes(pData, nSize, nOffset, &nIndex, sizeof(nIndex)) || !ReadBytes(pData, nSize, nOffset, &nCount, sizeof(nCount)) || nIndex >= m_vCounts.size())
+				return false;
+			m_vCounts[nIndex] = nCount;
+		}
+		return true;
+	}
+
+	void CHdrHistogram::__Init(uint64_t nLowest, uint64_t nHighest, uint32_t nSignificantDigits)
+	{
+		m_nLowest = (std::max)(nLowest, uint64_t(1));
+		m_nHighest = (std::max)(nHighest, m_nLowest * 2);
+		m_nSignificantDigits = (std::min)((std::max)(nSignificantDigits, 1u), 5u);
+
+		// Enough linear sub buckets to tell apart every value up to 2 * 10^digits
+		const auto nSingleUnitLimit = 2 * static_cast<uint64_t>(std::pow(10, m_nSignificantDigits));
+		const auto nSubBucketCountMagnitude = 64 - LeadingZeros64(nSingleUnitLimit - 1);
+		m_nSubBucketHalfCountMagnitude = (std::max)(nSubBucketCountMagnitude, 1u) - 1;
+		m_nUnitMagnitude = 63 - LeadingZeros64(m_nLowest);
+
+		const auto nSubBucketCount = uint64_t(1) << (m_nSubBucketHalfCountMagnitude + 1);
+		m_nSubBucketHalfCount = nSubBucketCount / 2;
+		m_nSubBucketMask = (nSubBucketCount - 1) << m_nUnitMagnitude;
+
+		uint64_t nBucketCount = 1;
+		auto nSmallestUntrackable = nSubBucketCount << m_nUnitMagnitude;
+		while (nSmallestUntrackable <= m_nHighest)
+		{
+			if (nSmallestUntrackable > (UINT64_MAX >> 1))
+			{
+				nBucketCount++;
+				break;
+			}
+			nSmallestUntrackable <<= 1;
+			nBucketCount++;
+		}
+
+		m_vCounts.assign((nBucketCount + 1) * m_nSubBucketHalfCount, 0);
+		m_nTotalCount = m_nSum = m_nMin = m_nMax = 0;
+	}
+
+	size_t CHdrHistogram::__GetCountsIndex(uint64_t nValue) const
+	{
+		const auto nBucket = static_cast<int32_t>(64 - LeadingZeros64(nValue | m_nSubBucketMask)) - static_cast<int32_t>(m_nUnitMagnitude + m_nSubBucketHalfCountMagnitude + 1);
+		const auto nSubBucket = nValue >> (nBucket + m_nUnitMagnitude);
+		return static_cast<size_t>((static_cast<uint64_t>(nBucket + 1) << m_nSubBucketHalfCountMagnitude) + (nSubBucket - m_nSubBucketHalfCount));
+	}
+
+	uint64_t CHdrHistogram::__GetHighestEquivalent(size_t nIndex) const
+	{
+		auto nBucket = static_cast<int32_t>(nIndex >> m_nSubBucketHalfCountMagnitude) - 1;
+		auto nSubBucket = (nIndex & (m_nSubBucketHalfCount - 1)) + m_nSubBucketHalfCount;
+		if (nBucket < 0)
+		{
+			nSubBucket -= m_nSubBucketHalfCount;
+			nBucket = 0;
+		}
+
+		const auto nLowestEquivalent = nSubBucket << (nBucket + m_nUnitMagnitude);
+		const auto nRangeBucket = nBucket + (nSubBucket >= 2 * m_nSubBucketHalfCount ? 1 : 0);
+		return nLowestEquivalent + (uint64_t(1) << (m_nUnitMagnitude + nRangeBucket)) - 1;
+	}
+
+	const char* GetFactHistogramName(EFactHistogram nFact)
+	{
+		if (nFact >= EFactHistogram::FACT_HISTOGRAM_MAX)
+			return "unknown";
+		return gs_arFactHistograms[static_cast<size_t>(nFact)].szName;
+	}
+
+	CFactHistograms::CFactHistograms(uint32_t nSignificantDigits)
+	{
+		for (const auto& info : gs_arFactHistograms)
+			m_arHistograms[static_cast<size_t>(info.nFact)] = CHdrHistogram(1, info.nHighest, nSignificantDigits);
+	}
+
+	void CFactHistograms::Record(const SProbeResult& result)
+	{
+		Get(EFactHistogram::FACT_HISTOGRAM_RAM_MB).Record(result.ram.nTotalPhysical / 1024 / 1024);
+
+		uint64_t nFreeBytes = 0;
+		for (const auto& volume : result.disk.vVolumes)
+			nFreeBytes += volume.nFreeBytes;
+		Get(EFactHistogram::FACT_HISTOGRAM_DISK_FREE_MB).Record(nFreeBytes / 1024 / 1024);
+
+		double dDiagonal = 0.0;
+		for (const auto& panel : result.display.vPanels)
+			dDiagonal = (std::max)(dDiagonal, GetPanelDiagonalInches(panel));
+		Get(EFactHistogram::FACT_HISTOGRAM_PANEL_DIAGONAL).Record(static_cast<uint64_t>(std::floor(dDiagonal * 100.0)));
+
+		Get(EFactHistogram::FACT_HISTOGRAM_CPU_MAX_MHZ).Record(result.cpu.nMaxMhz);
+	}
+
+	bool CFactHistograms::Merge(const CFactHistograms& other)
+	{
+		for (size_t i = 0; i < m_arHistograms.size(); ++i)
+		{
+			if (!m_arHistograms[i].Merge(other.m_arHistograms[i]))
+				return false;
+		}
+		return true;
+	}
+
+	bool CFactHistograms::Save(const std::string& stFileName) const
+	{
+		std::string stBuffer(FACT_HISTOGRAMS_MAGIC, sizeof(FACT_HISTOGRAMS_MAGIC));
+		AppendValue(stBuffer, static_cast<uint32_t>(m_arHistograms.size()));
+		for (const auto& histogram : m_arHistograms)
+			histogram.Serialize(stBuffer);
+
+		COutputFile file;
+		return file.Open(stFileName) && file.Write(stBuffer.data(), stBuffer.size()) && file.Commit();
+	}
+
+	bool CFactHistograms::Load(const std::string& stFileName)
+	{
+		CMappedFile file;
+		if (!file.Open(stFileName))
+			return false;
+
+		const auto pData = file.GetData();
+		const auto nSize = file.GetSize();
+		size_t nOffset = 0;
+
+		char szMagic[sizeof(FACT_HISTOGRAMS_MAGIC)]{};
+		uint32_t nCount = 0;
+		if (!ReadBytes(pData, nSize, nOffset, szMagic, sizeof(szMagic)) || std::memcmp(szMagic, FACT_HISTOGRAMS_MAGIC, sizeof(szMagic)) ||
+			!ReadBytes(pData, nSize, nOffset, &nCount, sizeof(nCount)) || nCount != m_arHistograms.size())
+			return false;
+
+		for (auto& histogram : m_arHistograms)
+		{
+			if (!histogram.Deserialize(pData, nSize, nOffset))
+				return false;
+		}
+		return nOffset == nSize;
+	}
+};
@@ -0,0 +1,464 @@
+#include "../../include/core/legacy_export.hpp"
+#include "../../include/core/cpuid_features.hpp"
+#include <fmt/format.h>
+#include <charconv>
+#include <cstdlib>
+#include <string_view>
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+namespace Win11SysCheck
+{
+	std::string GetLegacySectionTitle(EMenuType nType, const SLegacyLabels& labels)
+	{
+		return fmt::format("{0} {1}:", labels.arMenuNames[static_cast<size_t>(nType)], labels.stDetails);
+	}
+
+	std::vector <std::string> FormatLegacySectionTexts(EMenuType nType, const SProbeResult& result, const SLegacyLabels& labels)
+	{
+		std::vector <std::string> vecTexts;
+
+		switch (nType)
+		{
+		case EMenuType::MENU_TYPE_OS:
+		{
+			const auto& os = result.os;
+			vecTexts.emplace_back(fmt::format("{0}: {1}.{2}", labels.stOSVersion, os.nMajorVersion, os.nMinorVersion));
+			vecTexts.emplace_back(fmt::format("{0}: {1}.{2}", labels.stOSServicePack, os.nServicePackMajor, os.nServicePackMinor));
+			vecTexts.emplace_back(fmt::format("{0}: {1}", labels.stOSBuild, os.nBuildNumber));
+			vecTexts.emplace_back(fmt::format("{0}: {1}", labels.stOSPlatform, os.nPlatformId));
+			vecTexts.emplace_back(fmt::format("{0}: {1}", labels.stOSProductType, os.nProductType));
+		} break;
+		case EMenuType::MENU_TYPE_BOOT:
+		{
+			const auto& boot = result.boot;
+			vecTexts.emplace_back(fmt::format("{0}:\n\t\tFirmware: {1}\n\t\tFlags: {2}",
+				labels.stBootFirmware, GetFirmwareName(boot.nFirmwareType), boot.nBootFlags
+			));
+			vecTexts.emplace_back(fmt::format("{0}:\n\t\t{1}: {2}\n\t\t{3}: {4}",
+				labels.stSecureBoot, labels.stCapable, boot.bSecureBootCapable, labels.stEnabled, boot.bSecureBootEnabled
+			));
+			vecTexts.emplace_back(fmt::format("{0}:\n\t\t{1}: {2}\n\t\t{3}: {4}",
+				labels.stTPM, labels.stStatus, boot.bTpmPresent ? labels.stEnabled : labels.stDisabled, labels.stVersion, boot.nTpmVersion
+			));
+		} break;
+		case EMenuType::MENU_TYPE_CPU:
+		{
+			const auto& cpu = result.cpu;
+			vecTexts.emplace_back(fmt::format("{0}:\n\t\t{1}", labels.stCPUName, cpu.stName));
+			vecTexts.emplace_back(fmt::format("{0}:\n\t\tVendor: {1}\n\t\tFamily: {2}\n\t\tModel: {3}\n\t\tStepping: {4}\n\t\tPlatform field: {5}\n\t\tMax clock: {6} MHz\n\t\t1 GHz+ processors: {7}\n\t\tFeatures: {8}",
+				labels.stCPUDetails, cpu.stVendor, cpu.nFamily, cpu.nModel, cpu.nStepping, cpu.nPlatformSpecificField, cpu.nMaxMhz, cpu.nFastProcessorCount, FormatCPUFeatures(cpu.nFeatures)
+			));
+			vecTexts.emplace_back(fmt::format("{0}:\n\t\tID: {1}\n\t\tx64: {2}\n\t\tARMv8.1 atomics: {3}",
+				labels.stCPUArchitecture, static_cast<uint16_t>(cpu.nArchitecture), IsX64Architecture(cpu.nArchitecture), cpu.bArmV81Atomics
+			));
+			vecTexts.emplace_back(fmt::format("{0}: {1}", labels.stActiveProcessorCount, cpu.nActiveProcessorCount));
+			vecTexts.emplace_back(fmt::format("{0}: {1}", labels.stProcessorCount, cpu.nProcessorCount));
+		} break;
+		case EMenuType::MENU_TYPE_RAM:
+		{
+			vecTexts.emplace_back(fmt::format("Physical memory:\n\t\tTotal:{0} MB\n\t\tAvailable: {1} MB",
+				result.ram.nTotalPhysical / 1024,
+				result.ram.nAvailablePhysical / 1024
+			));
+		} break;
+		case EMenuType::MENU_TYPE_DISK:
+		{
+			uint32_t idx = 0;
+			for (const auto& volume : result.disk.vVolumes)
+			{
+				vecTexts.emplace_back(fmt::format("Disk: {0}\n\t\tPath: {1}\n\t\tDevice Name: {2}\n\t\tVolume Name: {3}\n\t\tFile System: {4}\n\t\tPartition: {5}\n\t\tDisk space: {6} MB\n\t\tFree space: {7} MB",
+					++idx,
+					volume.stPath,
+					volume.stDeviceName,
+					volume.stVolumeName,
+					volume.stFileSystem,
+					GetPartitionName(volume.nPartitionStyle),
+					volume.nTotalBytes / 1024 / 1024,
+					volume.nFreeBytes / 1024 / 1024
+				));
+			}
+		} break;
+		case EMenuType::MENU_TYPE_DISPLAY:
+		{
+			const auto& display = result.display;
+
+			uint32_t idx = 0;
+			for (const auto& panel : display.vPanels)
+			{
+				vecTexts.emplace_back(fmt::format("Display device: {0}\n\t\tRegistry path: {1}\n\t\tDisplay size: {2:.2f} inches ({3}x{4} cm)",
+					++idx, panel.stRegistryPath, GetPanelDiagonalInches(panel), panel.nWidthCm, panel.nHeightCm
+				));
+			}
+
+			idx = 0;
+			for (const auto& adapter : display.vAdapters)
+			{
+				vecTexts.emplace_back(fmt::format("Display devices:\n\t\tDevice index: {0}\n\t\tDescription: {1}\n\t\tModel: {2}",
+					++idx, adapter.stDescription, adapter.stDriverModel
+				));
+			}
+
+			if (display.bDxDiagSkipped)
+				vecTexts.emplace_back("\n\tDirectX:\n\t\tNot read, known good hardware");
+			else
+				vecTexts.emplace_back(fmt::format("\n\tDirectX:\n\t\tVersion: {0}.{1}", display.nDirectXMajor, display.nDirectXMinor));
+
+			idx = 0;
+			for (const auto& monitor : display.vMonitors)
+			{
+				vecTexts.emplace_back(fmt::format("Monitor: {0}\n\t\tID: {1}\n\t\tName: {2} - {3}\n\t\tPrimary: {4}\n\t\tBPC: {5}\n\t\tResolution: {6}x{7}",
+					++idx, monitor.stDeviceID, monitor.stDeviceName, monitor.stDeviceString, monitor.bPrimary, monitor.nBitsPerPixel, monitor.nWidth, monitor.nHeight
+				));
+			}
+		} break;
+		case EMenuType::MENU_TYPE_INTERNET:
+		{
+			vecTexts.emplace_back(fmt::format("Network state: {0}\n\tInternet state: {1}",
+				result.internet.bConnected ? 1 : 0,
+				result.internet.bReachable ? 1 : 0
+			));
+		} break;
+		default:
+			break;
+		}
+
+		return vecTexts;
+	}
+
+	template <class TStream>
+	static void WriteLegacyDocument(const SProbeResult& result, const SLegacyLabels& labels, TStream& stream)
+	{
+		rapidjson::PrettyWriter <TStream> writer(stream);
+
+		writer.StartObject();
+
+		for (size_t i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			const auto nType = static_cast<EMenuType>(i);
+
+			writer.Key(labels.arMenuNames[i].c_str());
+			writer.StartObject();
+
+			writer.Key(GetLegacySectionTitle(nType, labels).c_str());
+			writer.StartArray();
+			for (const auto& stText : FormatLegacySectionTexts(nType, result, labels))
+			{
+				writer.String(stText.c_str());
+			}
+			writer.EndArray();
+
+			writer.EndObject();
+		}
+
+		writer.EndObject();
+	}
+
+	std::string SerializeLegacyJson(const SProbeResult& result, const SLegacyLabels& labels)
+	{
+		rapidjson::StringBuffer s;
+		WriteLegacyDocument(result, labels, s);
+		return std::string(s.GetString(), s.GetSize());
+	}
+
+	bool WriteLegacyJson(const SProbeResult& result, const SLegacyLabels& labels, COutputFile& file)
+	{
+		WriteLegacyDocument(result, labels, file);
+		return !file.IsFailed();
+	}
+
+	// One "Key: Value" pair per text line, lines without a separator keep their text as key
+	using TLegacyFields = std::vector <std::pair <std::string_view, std::string_view>>;
+
+	static std::string_view TrimView(std::string_view stView)
+	{
+		while (!stView.empty() && (stView.front() == ' ' || stView.front() == '\t'))
+			stView.remove_prefix(1);
+		while (!stView.empty() && (stView.back() == ' ' || stView.back() == '\t' || stView.back() == '\r'))
+			stView.remove_suffix(1);
+		return stView;
+	}
+
+	static void SplitLegacyFields(std::string_view stText, TLegacyFields& vFields)
+	{
+		vFields.clear();
+
+		while (!stText.empty())
+		{
+			const auto nLineEnd = stText.find('\n');
+			const auto stLine = TrimView(stText.substr(0, nLineEnd));
+			stText = nLineEnd == std::string_view::npos ? std::string_view{} : stText.substr(nLineEnd + 1);
+			if (stLine.empty())
+				continue;
+
+			const auto nSeparator = stLine.find(':');
+			if (nSeparator == std::string_view::npos)
+				vFields.emplace_back(stLine, std::string_view{});
+			else
+				vFields.emplace_back(TrimView(stLine.substr(0, nSeparator)), TrimView(stLine.substr(nSeparator + 1)));
+		}
+	}
+
+	static std::string_view GetField(const TLegacyFields& vFields, std::string_view stKey)
+	{
+		for (const auto& field : vFields)
+		{
+			if (field.first == stKey)
+				return field.second;
+		}
+		return {};
+	}
+	static std::string_view GetField(const TLegacyFields& vFields, size_t nIndex)
+	{
+		return nIndex < vFields.size() ? vFields[nIndex].second : std::string_view{};
+	}
+
+	template <class T>
+	static T ToNumber(std::string_view stValue)
+	{
+		uint64_t nValue = 0;
+		std::from_chars(stValue.data(), stValue.data() + stValue.size(), nValue);
+		return static_cast<T>(nValue);
+	}
+	static double ToDouble(std::string_view stValue)
+	{
+		// Older exports used the user locale for the panel size
+		std::string stBuffer(stValue);
+		for (auto& c : stBuffer)
+		{
+			if (c == ',')
+				c = '.';
+		}
+		return std::strtod(stBuffer.c_str(), nullptr);
+	}
+	static bool ToBool(std::string_view stValue)
+	{
+		return stValue == "true" || stValue == "1";
+	}
+	// "a.b" -> a, b
+	static void ToVersion(std::string_view stValue, uint32_t& nMajor, uint32_t& nMinor)
+	{
+		const auto nDot = stValue.find('.');
+		nMajor = ToNumber<uint32_t>(stValue.substr(0, nDot));
+		nMinor = nDot == std::string_view::npos ? 0 : ToNumber<uint32_t>(stValue.substr(nDot + 1));
+	}
+
+	static void ParseLegacySection(EMenuType nType, const std::vector <std::string_view>& vTexts, SProbeResult& result, const SLegacyLabels& labels)
+	{
+		TLegacyFields vFields;
+		auto Fields = [&](size_t nIndex) -> const TLegacyFields& {
+			SplitLegacyFields(nIndex < vTexts.size() ? vTexts[nIndex] : std::string_view{}, vFields);
+			return vFields;
+		};
+
+		switch (nType)
+		{
+		case EMenuType::MENU_TYPE_OS:
+		{
+			auto& os = result.os;
+			ToVersion(GetField(Fields(0), size_t(0)), os.nMajorVersion, os.nMinorVersion);
+
+			uint32_t nMajor = 0, nMinor = 0;
+			ToVersion(GetField(Fields(1), size_t(0)), nMajor, nMinor);
+			os.nServicePackMajor = static_cast<uint16_t>(nMajor);
+			os.nServicePackMinor = static_cast<uint16_t>(nMinor);
+
+			os.nBuildNumber = ToNumber<uint32_t>(GetField(Fields(2), size_t(0)));
+			os.nPlatformId = ToNumber<uint32_t>(GetField(Fields(3), size_t(0)));
+			os.nProductType = ToNumber<uint32_t>(GetField(Fields(4), size_t(0)));
+		} break;
+		case EMenuType::MENU_TYPE_BOOT:
+		{
+			auto& boot = result.boot;
+
+			Fields(0);
+			const auto stFirmware = GetField(vFields, "Firmware");
+			if (stFirmware == "UEFI")
+				boot.nFirmwareType = EFirmwareType::FIRMWARE_UEFI;
+			else if (stFirmware == "Legacy/Bios")
+				boot.nFirmwareType = EFirmwareType::FIRMWARE_BIOS;
+			boot.nBootFlags = ToNumber<uint64_t>(GetField(vFields, "Flags"));
+
+			// Labels of these lines are localized, values are positional
+			Fields(1);
+			boot.bSecureBootCapable = ToBool(GetField(vFields, 1));
+			boot.bSecureBootEnabled = ToBool(GetField(vFields, 2));
+
+			Fields(2);
+			boot.bTpmPresent = GetField(vFields, 1) == labels.stEnabled;
+			boot.nTpmVersion = ToNumber<uint32_t>(GetField(vFields, 2));
+		} break;
+		case EMenuType::MENU_TYPE_CPU:
+		{
+			auto& cpu = result.cpu;
+
+			Fields(0);
+			if (vFields.size() > 1)
+			{
+				// The processor name is a whole line and may contain the separator
+				const auto& stLine = vFields[1];
+				cpu.stName = stLine.second.empty() ? std::string(stLine.first) : std::string(stLine.first.data(), stLine.second.data() + stLine.second.size() - stLine.first.data());
+			}
+
+			Fields(1);
+			cpu.stVendor = std::string(GetField(vFields, "Vendor"));
+			cpu.nFamily = ToNumber<uint16_t>(GetField(vFields, "Family"));
+			cpu.nModel = ToNumber<uint16_t>(GetField(vFields, "Model"));
+			cpu.nStepping = ToNumber<uint8_t>(GetField(vFields, "Stepping"));
+			cpu.nPlatformSpecificField = ToNumber<uint32_t>(GetField(vFields, "Platform field"));
+			cpu.nMaxMhz = ToNumber<uint32_t>(GetField(vFields, "Max clock"));
+			cpu.nFastProcessorCount = ToNumber<uint32_t>(GetField(vFields, "1 GHz+ processors"));
+			cpu.nFeatures = ParseCPUFeatures(std::string(GetField(vFields, "Features")));
+
+			Fields(2);
+			cpu.nArchitecture = static_cast<EProcessorArchitecture>(ToNumber<uint16_t>(GetField(vFields, "ID")));
+			cpu.bArmV81Atomics = ToBool(GetField(vFields, "ARMv8.1 atomics"));
+
+			cpu.nActiveProcessorCount = ToNumber<uint32_t>(GetField(Fields(3), size_t(0)));
+			cpu.nProcessorCount = ToNumber<uint32_t>(GetField(Fields(4), size_t(0)));
+		} break;
+		case EMenuType::MENU_TYPE_RAM:
+		{
+			// Values are written in KB despite the unit text
+			Fields(0);
+			result.ram.nTotalPhysical = ToNumber<uint64_t>(GetField(vFields, "Total")) * 1024;
+			result.ram.nAvailablePhysical = ToNumber<uint64_t>(GetField(vFields, "Available")) * 1024;
+		} break;
+		case EMenuType::MENU_TYPE_DISK:
+		{
+			for (size_t i = 0; i < vTexts.size(); ++i)
+			{
+				Fields(i);
+
+				SVolumeFacts volume{};
+				volume.stPath = std::string(GetField(vFields, "Path"));
+				volume.stDeviceName = std::string(GetField(vFields, "Device Name"));
+				volume.stVolumeName = std::string(GetField(vFields, "Volume Name"));
+				volume.stFileSystem = std::string(GetField(vFields, "File System"));
+
+				const auto stPartition = GetField(vFields, "Partition");
+				if (stPartition == "MBR")
+					volume.nPartitionStyle = EPartitionStyle::PARTITION_MBR;
+				else if (stPartition == "GPT")
+					volume.nPartitionStyle = EPartitionStyle::PARTITION_GPT;
+				else if (stPartition == "RAW")
+					volume.nPartitionStyle = EPartitionStyle::PARTITION_RAW;
+
+				volume.nTotalBytes = ToNumber<uint64_t>(GetField(vFields, "Disk space")) * 1024 * 1024;
+				volume.nFreeBytes = ToNumber<uint64_t>(GetField(vFields, "Free space")) * 1024 * 1024;
+				result.disk.vVolumes.emplace_back(volume);
+			}
+		} break;
+		case EMenuType::MENU_TYPE_DISPLAY:
+		{
+			auto& display = result.display;
+
+			for (size_t i = 0; i < vTexts.size(); ++i)
+			{
+				Fields(i);
+				if (vFields.empty())
+					continue;
+
+				const auto stKind = vFields[0].first;
+				if (stKind == "Display device")
+				{
+					SPanelFacts panel{};
+					// Registry paths carry no separator, keep the whole remainder of the line
+					panel.stRegistryPath = std::string(GetField(vFields, "Registry path"));
+
+					const auto stSize = GetField(vFields, "Display size");
+					const auto nCm = stSize.find('(');
+					if (nCm != std::string_view::npos)
+					{
+						const auto stCm = stSize.substr(nCm + 1);
+						const auto nX = stCm.find('x');
+						panel.nWidthCm = ToNumber<uint16_t>(stCm.substr(0, nX));
+						panel.nHeightCm = nX == std::string_view::npos ? 0 : ToNumber<uint16_t>(stCm.substr(nX + 1));
+					}
+					else
+					{
+						// Exports without the EDID size only carry the diagonal, rounding down keeps borderline panels failing
+						panel.nWidthCm = static_cast<uint16_t>(ToDouble(stSize) / 0.393700787);
+					}
+					display.vPanels.emplace_back(panel);
+				}
+				else if (stKind == "Display devices")
+				{
+					SGraphicsAdapterFacts adapter{};
+					adapter.stDescription = std::string(GetField(vFields, "Description"));
+					adapter.stDriverModel = std::string(GetField(vFields, "Model"));
+					display.vAdapters.emplace_back(adapter);
+				}
+				else if (stKind == "DirectX")
+				{
+					ToVersion(GetField(vFields, "Version"), display.nDirectXMajor, display.nDirectXMinor);
+				}
+				else if (stKind == "Monitor")
+				{
+					SMonitorFacts monitor{};
+					monitor.stDeviceID = std::string(GetField(vFields, "ID"));
+
+					const auto stName = GetField(vFields, "Name");
+					const auto nDash = stName.find(" - ");
+					monitor.stDeviceName = std::string(stName.substr(0, nDash));
+					if (nDash != std::string_view::npos)
+						monitor.stDeviceString = std::string(stName.substr(nDash + 3));
+
+					monitor.bPrimary = ToBool(GetField(vFields, "Primary"));
+					monitor.nBitsPerPixel = ToNumber<uint32_t>(GetField(vFields, "BPC"));
+
+					const auto stResolution = GetField(vFields, "Resolution");
+					const auto nX = stResolution.find('x');
+					monitor.nWidth = ToNumber<int32_t>(stResolution.substr(0, nX));
+					monitor.nHeight = nX == std::string_view::npos ? 0 : ToNumber<int32_t>(stResolution.substr(nX + 1));
+					display.vMonitors.emplace_back(monitor);
+				}
+			}
+		} break;
+		case EMenuType::MENU_TYPE_INTERNET:
+		{
+			Fields(0);
+			result.internet.bConnected = ToBool(GetField(vFields, "Network state"));
+			result.internet.bReachable = ToBool(GetField(vFields, "Internet state"));
+		} break;
+		default:
+			break;
+		}
+	}
+
+	bool ParseLegacyJson(const char* pData, size_t nSize, SProbeResult& result, const SLegacyLabels& labels)
+	{
+		result = {};
+
+		rapidjson::Document document;
+		document.Parse(pData, nSize);
+		if (document.HasParseError() || !document.IsObject())
+			return false;
+
+		std::vector <std::string_view> vTexts;
+
+		auto nType = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS);
+		for (auto itSection = document.MemberBegin(); itSection != document.MemberEnd(); ++itSection, ++nType)
+		{
+			if (nType >= static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX))
+				return false;
+
+			const auto& section = itSection->value;
+			if (!section.IsObject() || section.MemberCount() != 1 || !section.MemberBegin()->value.IsArray())
+				return false;
+
+			vTexts.clear();
+			for (const auto& text : section.MemberBegin()->value.GetArray())
+			{
+				if (!text.IsString())
+					return false;
+				vTexts.emplace_back(text.GetString(), text.GetStringLength());
+			}
+
+			ParseLegacySection(static_cast<EMenuType>(nType), vTexts, result, labels);
+		}
+
+		return nType == static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX);
+	}
+};
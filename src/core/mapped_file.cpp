@@ -0,0 +1,115 @@
+#include "../../include/core/mapped_file.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Win11SysCheck
+{
+	CMappedFile::~CMappedFile()
+	{
+		Close();
+	}
+
+#ifdef _WIN32
+	bool CMappedFile::Open(const std::string& stFileName)
+	{
+		Close();
+
+		const auto hFile = CreateFileA(stFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+			return false;
+		m_hFile = hFile;
+
+		LARGE_INTEGER liSize{};
+		if (!GetFileSizeEx(hFile, &liSize))
+		{
+			Close();
+			return false;
+		}
+		m_nSize = static_cast<size_t>(liSize.QuadPart);
+		if (!m_nSize)
+			return true;
+
+		m_hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_hMapping)
+		{
+			Close();
+			return false;
+		}
+
+		m_pData = reinterpret_cast<const char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+		if (!m_pData)
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void CMappedFile::Close()
+	{
+		if (m_pData)
+			UnmapViewOfFile(m_pData);
+		if (m_hMapping)
+			CloseHandle(m_hMapping);
+		if (m_hFile)
+			CloseHandle(m_hFile);
+
+		m_pData = nullptr;
+		m_hMapping = nullptr;
+		m_hFile = nullptr;
+		m_nSize = 0;
+	}
+#else
+	bool CMappedFile::Open(const std::string& stFileName)
+	{
+		Close();
+
+		m_nFile = open(stFileName.c_str(), O_RDONLY | O_CLOEXEC);
+		if (m_nFile < 0)
+			return false;
+
+		struct stat st{};
+		if (fstat(m_nFile, &st) != 0)
+		{
+			Close();
+			return false;
+		}
+		m_nSize = static_cast<size_t>(st.st_size);
+		if (!m_nSize)
+			return true;
+
+		const auto pView = mmap(nullptr, m_nSize, PROT_READ, MAP_PRIVATE, m_nFile, 0);
+		if (pView == MAP_FAILED)
+		{
+			Close();
+			return false;
+		}
+		madvise(pView, m_nSize, MADV_SEQUENTIAL);
+
+		m_pData = reinterpret_cast<const char*>(pView);
+		return true;
+	}
+
+	void CMappedFile::Close()
+	{
+		if (m_pData)
+			munmap(const_cast<char*>(m_pData), m_nSize);
+		if (m_nFile >= 0)
+			close(m_nFile);
+
+		m_pData = nullptr;
+		m_nFile = -1;
+		m_nSize = 0;
+	}
+#endif
+};
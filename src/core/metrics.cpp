@@ -0,0 +1,232 @@
+#include "../../include/core/metrics.hpp"
+#include "../../include/core/output_file.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <fmt/format.h>
+
+namespace Win11SysCheck
+{
+	static uint64_t DoubleToBits(double dValue)
+	{
+		uint64_t nBits = 0;
+		std::memcpy(&nBits, &dValue, sizeof(nBits));
+		return nBits;
+	}
+	static double BitsToDouble(uint64_t nBits)
+	{
+		double dValue = 0;
+		std::memcpy(&dValue, &nBits, sizeof(dValue));
+		return dValue;
+	}
+	static std::string FormatValue(double dValue)
+	{
+		if (dValue != dValue)
+			return "NaN";
+		if (dValue == std::numeric_limits<double>::infinity())
+			return "+Inf";
+		if (dValue == -std::numeric_limits<double>::infinity())
+			return "-Inf";
+		return fmt::format("{}", dValue);
+	}
+	// Label values also escape the quotes around them, HELP text only backslashes and line feeds
+	static std::string EscapeText(const std::string& stValue, bool bLabelValue)
+	{
+		std::string stOut;
+		stOut.reserve(stValue.size());
+		for (const auto c : stValue)
+		{
+			switch (c)
+			{
+			case '\\':
+				stOut += "\\\\";
+				break;
+			case '"':
+				stOut += bLabelValue ? "\\\"" : "\"";
+				break;
+			case '\n':
+				stOut += "\\n";
+				break;
+			default:
+				stOut += c;
+				break;
+			}
+		}
+		return stOut;
+	}
+	static std::string WrapLabels(const std::string& stLabels, const std::string& stExtra = "")
+	{
+		if (stLabels.empty() && stExtra.empty())
+			return "";
+		if (stLabels.empty())
+			return "{" + stExtra + "}";
+		if (stExtra.empty())
+			return "{" + stLabels + "}";
+		return "{" + stLabels + "," + stExtra + "}";
+	}
+
+	void CGauge::Set(double dValue)
+	{
+		m_nBits.store(DoubleToBits(dValue), std::memory_order_relaxed);
+	}
+	void CGauge::Add(double dValue)
+	{
+		auto nExpected = m_nBits.load(std::memory_order_relaxed);
+		while (!m_nBits.compare_exchange_weak(nExpected, DoubleToBits(BitsToDouble(nExpected) + dValue), std::memory_order_relaxed))
+		{
+		}
+	}
+	double CGauge::Value() const
+	{
+		return BitsToDouble(m_nBits.load(std::memory_order_relaxed));
+	}
+
+	CHistogram::CHistogram(const std::vector <double>& vBounds) :
+		m_vBounds(vBounds), m_pBuckets(new std::atomic <uint64_t>[vBounds.size() + 1])
+	{
+		std::sort(m_vBounds.begin(), m_vBounds.end());
+		for (size_t i = 0; i <= m_vBounds.size(); ++i)
+			m_pBuckets[i].store(0, std::memory_order_relaxed);
+	}
+
+	void CHistogram::Observe(double dValue)
+	{
+		const auto it = std::lower_bound(m_vBounds.begin(), m_vBounds.end(), dValue);
+		m_pBuckets[std::distance(m_vBounds.begin(), it)].fetch_add(1, std::memory_order_relaxed);
+		m_nCount.fetch_add(1, std::memory_order_relaxed);
+		m_kSum.Add(dValue);
+	}
+
+	uint64_t CHistogram::GetBucketCount(size_t nIndex) const
+	{
+		if (nIndex > m_vBounds.size())
+			return 0;
+		return m_pBuckets[nIndex].load(std::memory_order_relaxed);
+	}
+
+	std::vector <double> CHistogram::DefaultLatencyBounds()
+	{
+		return { 0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0, 60.0 };
+	}
+
+	CMetricsRegistry::SMetricFamily& CMetricsRegistry::__GetFamily(const std::string& stName, const std::string& stHelp, EMetricType nType)
+	{
+		auto it = m_mapFamilies.find(stName);
+		if (it == m_mapFamilies.end())
+		{
+			SMetricFamily family{};
+			family.stHelp = stHelp;
+			family.nType = nType;
+			it = m_mapFamilies.emplace(stName, std::move(family)).first;
+		}
+
+		assert(it->second.nType == nType);
+		return it->second;
+	}
+
+	std::string CMetricsRegistry::__FormatLabels(const TMetricLabels& labels)
+	{
+		std::string stOut;
+		for (const auto& [stKey, stValue] : labels)
+		{
+			if (!stOut.empty())
+				stOut += ",";
+			stOut += fmt::format("{0}=\"{1}\"", stKey, EscapeText(stValue, true));
+		}
+		return stOut;
+	}
+
+	CCounter& CMetricsRegistry::Counter(const std::string& stName, const std::string& stHelp, const TMetricLabels& labels)
+	{
+		std::lock_guard <std::mutex> lock(m_mtxFamilies);
+
+		auto& family = __GetFamily(stName, stHelp, EMetricType::METRIC_TYPE_COUNTER);
+		auto& spCounter = family.mapCounters[__FormatLabels(labels)];
+		if (!spCounter)
+			spCounter = std::make_unique<CCounter>();
+		return *spCounter;
+	}
+
+	CGauge& CMetricsRegistry::Gauge(const std::string& stName, const std::string& stHelp, const TMetricLabels& labels)
+	{
+		std::lock_guard <std::mutex> lock(m_mtxFamilies);
+
+		auto& family = __GetFamily(stName, stHelp, EMetricType::METRIC_TYPE_GAUGE);
+		auto& spGauge = family.mapGauges[__FormatLabels(labels)];
+		if (!spGauge)
+			spGauge = std::make_unique<CGauge>();
+		return *spGauge;
+	}
+
+	CHistogram& CMetricsRegistry::Histogram(const std::string& stName, const std::string& stHelp, const std::vector <double>& vBounds, const TMetricLabels& labels)
+	{
+		std::lock_guard <std::mutex> lock(m_mtxFamilies);
+
+		auto& family = __GetFamily(stName, stHelp, EMetricType::METRIC_TYPE_HISTOGRAM);
+		if (family.vBounds.empty())
+			family.vBounds = vBounds;
+
+		// Every series of a family shares the bucket layout of the first registration
+		auto& spHistogram = family.mapHistograms[__FormatLabels(labels)];
+		if (!spHistogram)
+			spHistogram = std::make_unique<CHistogram>(family.vBounds);
+		return *spHistogram;
+	}
+
+	std::string CMetricsRegistry::Serialize() const
+	{
+		std::lock_guard <std::mutex> lock(m_mtxFamilies);
+
+		fmt::memory_buffer buf;
+		for (const auto& [stName, family] : m_mapFamilies)
+		{
+			fmt::format_to(buf, "# HELP {0} {1}\n", stName, EscapeText(family.stHelp, false));
+
+			switch (family.nType)
+			{
+			case EMetricType::METRIC_TYPE_COUNTER:
+			{
+				fmt::format_to(buf, "# TYPE {0} counter\n", stName);
+				for (const auto& [stLabels, spCounter] : family.mapCounters)
+					fmt::format_to(buf, "{0}{1} {2}\n", stName, WrapLabels(stLabels), spCounter->Value());
+			} break;
+			case EMetricType::METRIC_TYPE_GAUGE:
+			{
+				fmt::format_to(buf, "# TYPE {0} gauge\n", stName);
+				for (const auto& [stLabels, spGauge] : family.mapGauges)
+					fmt::format_to(buf, "{0}{1} {2}\n", stName, WrapLabels(stLabels), FormatValue(spGauge->Value()));
+			} break;
+			case EMetricType::METRIC_TYPE_HISTOGRAM:
+			{
+				fmt::format_to(buf, "# TYPE {0} histogram\n", stName);
+				for (const auto& [stLabels, spHistogram] : family.mapHistograms)
+				{
+					const auto& vBounds = spHistogram->GetBounds();
+
+					uint64_t nCumulative = 0;
+					for (size_t i = 0; i <= vBounds.size(); ++i)
+					{
+						nCumulative += spHistogram->GetBucketCount(i);
+
+						const auto stBound = i < vBounds.size() ? FormatValue(vBounds[i]) : "+Inf";
+						fmt::format_to(buf, "{0}_bucket{1} {2}\n", stName, WrapLabels(stLabels, fmt::format("le=\"{0}\"", stBound)), nCumulative);
+					}
+					fmt::format_to(buf, "{0}_sum{1} {2}\n", stName, WrapLabels(stLabels), FormatValue(spHistogram->GetSum()));
+					fmt::format_to(buf, "{0}_count{1} {2}\n", stName, WrapLabels(stLabels), spHistogram->GetCount());
+				}
+			} break;
+			}
+		}
+		return fmt::to_string(buf);
+	}
+
+	bool CMetricsRegistry::WriteTextFile(const std::string& stFileName) const
+	{
+		const auto stContent = Serialize();
+
+		// The textfile collector only picks up *.prom files so the temporary name is never scraped
+		COutputFile file;
+		return file.Open(stFileName) && file.Write(stContent.data(), stContent.size()) && file.Commit();
+	}
+};
@@ -0,0 +1,263 @@
+#include "../../include/core/output_file.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Win11SysCheck
+{
+	COutputFile::~COutputFile()
+	{
+		Abort();
+	}
+
+	bool COutputFile::Write(const char* pData, size_t nSize)
+	{
+		if (nSize > OUTPUT_FILE_BUFFER_SIZE - m_nBuffered)
+		{
+			Flush();
+			// Large blocks skip the buffer
+			if (nSize >= OUTPUT_FILE_BUFFER_SIZE)
+			{
+				__Emit(pData, nSize);
+				m_nWritten += nSize;
+				return !m_bFailed;
+			}
+		}
+		std::memcpy(m_arBuffer + m_nBuffered, pData, nSize);
+		m_nBuffered += nSize;
+		return !m_bFailed;
+	}
+
+	void COutputFile::Flush()
+	{
+		if (!m_nBuffered)
+			return;
+		__Emit(m_arBuffer, m_nBuffered);
+		m_nWritten += m_nBuffered;
+		m_nBuffered = 0;
+	}
+
+	void COutputFile::SetCompression(bool bEnabled)
+	{
+		if (bEnabled)
+			m_pCompressor = std::make_unique<CStreamCompressor>();
+		else
+			m_pCompressor.reset();
+	}
+
+	// Compressed blocks are written as they fill, the compressor buffers the rest
+	void COutputFile::__Emit(const char* pData, size_t nSize)
+	{
+		if (m_pCompressor)
+		{
+			m_stCompressed.clear();
+			m_pCompressor->Append(pData, nSize, m_stCompressed);
+			pData = m_stCompressed.data();
+			nSize = m_stCompressed.size();
+		}
+		if (!m_bFailed && nSize && !__WriteRaw(pData, nSize))
+			m_bFailed = true;
+		m_nStored += nSize;
+	}
+
+	bool COutputFile::__Finish()
+	{
+		Flush();
+		if (m_pCompressor && !m_bFailed)
+		{
+			m_stCompressed.clear();
+			m_pCompressor->Finish(m_stCompressed);
+			m_pCompressor.reset();
+			if (!__WriteRaw(m_stCompressed.data(), m_stCompressed.size()))
+				m_bFailed = true;
+			m_nStored += m_stCompressed.size();
+		}
+		return !m_bFailed;
+	}
+
+	void COutputFile::Abort()
+	{
+		__Close();
+		if (!m_stTempFileName.empty())
+			std::remove(m_stTempFileName.c_str());
+
+		m_stFileName.clear();
+		m_stTempFileName.clear();
+		m_bStandardOutput = false;
+		m_bFailed = false;
+		m_nWritten = 0;
+		m_nStored = 0;
+		m_nBuffered = 0;
+		m_pCompressor.reset();
+	}
+
+#ifdef _WIN32
+	bool COutputFile::Open(const std::string& stFileName)
+	{
+		Abort();
+
+		m_stFileName = stFileName;
+		m_stTempFileName = stFileName + ".tmp" + std::to_string(GetCurrentProcessId());
+
+		const auto hFile = CreateFileA(m_stTempFileName.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			m_stTempFileName.clear();
+			return false;
+		}
+		m_hFile = hFile;
+		return true;
+	}
+
+	bool COutputFile::OpenStandardOutput()
+	{
+		Abort();
+
+		const auto hFile = GetStdHandle(STD_OUTPUT_HANDLE);
+		if (hFile == INVALID_HANDLE_VALUE || !hFile)
+			return false;
+		m_hFile = hFile;
+		m_bStandardOutput = true;
+		return true;
+	}
+
+	bool COutputFile::Commit()
+	{
+		if (!m_hFile || !__Finish())
+			return false;
+
+		if (m_bStandardOutput)
+		{
+			m_hFile = nullptr;
+			m_bStandardOutput = false;
+			return true;
+		}
+
+		const auto bSynced = FlushFileBuffers(m_hFile) != FALSE;
+		__Close();
+		if (!bSynced || !MoveFileExA(m_stTempFileName.c_str(), m_stFileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+		{
+			Abort();
+			return false;
+		}
+		m_stTempFileName.clear();
+		return true;
+	}
+
+	bool COutputFile::__WriteRaw(const char* pData, size_t nSize)
+	{
+		while (nSize)
+		{
+			DWORD dwWritten = 0;
+			const auto dwChunk = static_cast<DWORD>((std::min)(nSize, size_t(1) << 30));
+			if (!WriteFile(m_hFile, pData, dwChunk, &dwWritten, nullptr) || !dwWritten)
+				return false;
+			pData += dwWritten;
+			nSize -= dwWritten;
+		}
+		return true;
+	}
+
+	void COutputFile::__Close()
+	{
+		if (m_hFile && !m_bStandardOutput)
+			CloseHandle(m_hFile);
+		m_hFile = nullptr;
+	}
+#else
+	bool COutputFile::Open(const std::string& stFileName)
+	{
+		Abort();
+
+		m_stFileName = stFileName;
+		m_stTempFileName = stFileName + ".tmp" + std::to_string(getpid());
+
+		m_nFile = open(m_stTempFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (m_nFile < 0)
+		{
+			m_stTempFileName.clear();
+			return false;
+		}
+		return true;
+	}
+
+	bool COutputFile::OpenStandardOutput()
+	{
+		Abort();
+
+		// C streams may hold buffered text for the same descriptor
+		std::fflush(stdout);
+		m_nFile = STDOUT_FILENO;
+		m_bStandardOutput = true;
+		return true;
+	}
+
+	bool COutputFile::Commit()
+	{
+		if (m_nFile < 0 || !__Finish())
+			return false;
+
+		if (m_bStandardOutput)
+		{
+			m_nFile = -1;
+			m_bStandardOutput = false;
+			return true;
+		}
+
+		const auto bSynced = fsync(m_nFile) == 0;
+		__Close();
+		if (!bSynced || rename(m_stTempFileName.c_str(), m_stFileName.c_str()) != 0)
+		{
+			Abort();
+			return false;
+		}
+		m_stTempFileName.clear();
+
+		// The rename itself is durable once the directory is synced
+		const auto nSeparator = m_stFileName.find_last_of('/');
+		const auto stDirectory = nSeparator == std::string::npos ? std::string(".") : m_stFileName.substr(0, nSeparator + 1);
+		const auto nDirectory = open(stDirectory.c_str(), O_RDONLY | O_CLOEXEC);
+		if (nDirectory >= 0)
+		{
+			fsync(nDirectory);
+			close(nDirectory);
+		}
+		return true;
+	}
+
+	bool COutputFile::__WriteRaw(const char* pData, size_t nSize)
+	{
+		while (nSize)
+		{
+			const auto nWritten = write(m_nFile, pData, nSize);
+			if (nWritten < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return false;
+			}
+			pData += nWritten;
+			nSize -= static_cast<size_t>(nWritten);
+		}
+		return true;
+	}
+
+	void COutputFile::__Close()
+	{
+		if (m_nFile >= 0 && !m_bStandardOutput)
+			close(m_nFile);
+		m_nFile = -1;
+	}
+#endif
+};
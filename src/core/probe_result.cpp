@@ -0,0 +1,113 @@
+#include "../../include/core/probe_result.hpp"
+#include <cctype>
+#include <cmath>
+
+namespace Win11SysCheck
+{
+	bool IsX64Architecture(EProcessorArchitecture nArchitecture)
+	{
+		return
+			nArchitecture == EProcessorArchitecture::ARCHITECTURE_AMD64 ||
+			nArchitecture == EProcessorArchitecture::ARCHITECTURE_IA64 ||
+			nArchitecture == EProcessorArchitecture::ARCHITECTURE_ARM64;
+	}
+
+	double GetPanelDiagonalInches(const SPanelFacts& panel)
+	{
+		const auto dDiagonalCm = std::sqrt(static_cast<double>(panel.nWidthCm * panel.nWidthCm + panel.nHeightCm * panel.nHeightCm));
+		return dDiagonalCm * 0.393700787;
+	}
+
+	uint32_t GetWDDMVersion(const std::string& stDriverModel)
+	{
+		const auto nPos = stDriverModel.find("WDDM ");
+		if (nPos == std::string::npos)
+			return 0;
+
+		uint32_t nMajor = 0, nMinor = 0;
+		auto p = stDriverModel.c_str() + nPos + 5;
+		if (!std::isdigit(static_cast<unsigned char>(*p)))
+			return 0;
+		while (std::isdigit(static_cast<unsigned char>(*p)))
+			nMajor = nMajor * 10 + (*p++ - '0');
+		if (*p == '.' && std::isdigit(static_cast<unsigned char>(p[1])))
+			nMinor = p[1] - '0';
+
+		return nMajor * 10 + nMinor;
+	}
+
+	std::string GetFirmwareName(EFirmwareType nType)
+	{
+		switch (nType)
+		{
+		case EFirmwareType::FIRMWARE_BIOS:
+			return "Legacy/Bios";
+		case EFirmwareType::FIRMWARE_UEFI:
+			return "UEFI";
+		default:
+			return "Unknown: " + std::to_string(static_cast<uint8_t>(nType));
+		}
+	}
+
+	std::string GetPartitionName(EPartitionStyle nStyle)
+	{
+		switch (nStyle)
+		{
+		case EPartitionStyle::PARTITION_MBR:
+			return "MBR";
+		case EPartitionStyle::PARTITION_GPT:
+			return "GPT";
+		case EPartitionStyle::PARTITION_RAW:
+			return "RAW";
+		default:
+			return "Unknown";
+		}
+	}
+
+	std::string GetFirmwareKey(EFirmwareType nType)
+	{
+		switch (nType)
+		{
+		case EFirmwareType::FIRMWARE_BIOS:
+			return "bios";
+		case EFirmwareType::FIRMWARE_UEFI:
+			return "uefi";
+		default:
+			return "unknown";
+		}
+	}
+
+	std::string GetPartitionKey(EPartitionStyle nStyle)
+	{
+		switch (nStyle)
+		{
+		case EPartitionStyle::PARTITION_MBR:
+			return "mbr";
+		case EPartitionStyle::PARTITION_GPT:
+			return "gpt";
+		case EPartitionStyle::PARTITION_RAW:
+			return "raw";
+		default:
+			return "unknown";
+		}
+	}
+
+	std::string GetArchitectureKey(EProcessorArchitecture nArchitecture)
+	{
+		switch (nArchitecture)
+		{
+		case EProcessorArchitecture::ARCHITECTURE_INTEL:
+			return "x86";
+		case EProcessorArchitecture::ARCHITECTURE_ARM:
+			return "arm";
+		case EProcessorArchitecture::ARCHITECTURE_IA64:
+			return "ia64";
+		case EProcessorArchitecture::ARCHITECTURE_AMD64:
+			return "amd64";
+		case EProcessorArchitecture::ARCHITECTURE_ARM64:
+			return "arm64";
+		default:
+			return "unknown";
+		}
+	}
+};
@@ -0,0 +1,44 @@
+#include "../../include/core/probe_types.hpp"
+
+namespace Win11SysCheck
+{
+	std::string GetMenuTypeKey(EMenuType nType)
+	{
+		switch (nType)
+		{
+		case EMenuType::MENU_TYPE_SUMMARY:
+			return "summary";
+		case EMenuType::MENU_TYPE_OS:
+			return "os";
+		case EMenuType::MENU_TYPE_BOOT:
+			return "boot";
+		case EMenuType::MENU_TYPE_CPU:
+			return "cpu";
+		case EMenuType::MENU_TYPE_RAM:
+			return "ram";
+		case EMenuType::MENU_TYPE_DISK:
+			return "disk";
+		case EMenuType::MENU_TYPE_DISPLAY:
+			return "display";
+		case EMenuType::MENU_TYPE_INTERNET:
+			return "internet";
+		default:
+			return "unknown";
+		}
+	}
+
+	std::string GetStatusKey(EStatus nStatus)
+	{
+		switch (nStatus)
+		{
+		case EStatus::STATUS_INITIALIZING:
+			return "initializing";
+		case EStatus::STATUS_OK:
+			return "ok";
+		case EStatus::STATUS_FAIL:
+			return "fail";
+		default:
+			return "unknown";
+		}
+	}
+};
@@ -0,0 +1,188 @@
+#include "../../include/core/profile_catalog.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace Win11SysCheck
+{
+	static constexpr char PROFILE_CATALOG_MAGIC[8]{ 'W', '1', '1', 'P', 'R', 'O', 'F', '1' };
+
+	template <class T>
+	static void AppendValue(std::string& stBuffer, T value)
+	{
+		stBuffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	uint32_t CProfileCatalog::Add(const SProbeResult& result, uint64_t nMachineId)
+	{
+		std::string stEncoding;
+		EncodeHardwareProfile(result, stEncoding);
+		const auto fingerprint = HashBytes128(stEncoding.data(), stEncoding.size());
+
+		uint32_t nProfile;
+		const auto it = m_mapProfiles.find(fingerprint);
+		if (it != m_mapProfiles.end() && m_vProfiles[it->second].stEncoding == stEncoding)
+			nProfile = it->second;
+		else
+			nProfile = __AddProfile(fingerprint, std::move(stEncoding));
+
+		m_vProfiles[nProfile].nMachineCount++;
+		m_vMachines.emplace_back(SProfileMachine{ nMachineId, nProfile, result.internet });
+		return nProfile;
+	}
+
+	void CProfileCatalog::Merge(const CProfileCatalog& other)
+	{
+		std::vector <uint32_t> vRemap(other.m_vProfiles.size());
+		for (size_t i = 0; i < other.m_vProfiles.size(); ++i)
+		{
+			const auto& profile = other.m_vProfiles[i];
+			const auto it = m_mapProfiles.find(profile.fingerprint);
+			if (it != m_mapProfiles.end() && m_vProfiles[it->second].stEncoding == profile.stEncoding)
+				vRemap[i] = it->second;
+			else
+				vRemap[i] = __AddProfile(profile.fingerprint, std::string(profile.stEncoding));
+			m_vProfiles[vRemap[i]].nMachineCount += profile.nMachineCount;
+		}
+
+		m_vMachines.reserve(m_vMachines.size() + other.m_vMachines.size());
+		for (const auto& machine : other.m_vMachines)
+			m_vMachines.emplace_back(SProfileMachine{ machine.nMachineId, vRemap[machine.nProfile], machine.internet });
+	}
+
+	void CProfileCatalog::EvaluateProfiles()
+	{
+		for (auto& profile : m_vProfiles)
+			EvaluateReadiness(profile.result);
+	}
+
+	bool CProfileCatalog::IsMachineReady(size_t nMachine) const
+	{
+		const auto& machine = m_vMachines[nMachine];
+		const auto& profile = m_vProfiles[machine.nProfile].result;
+
+		for (size_t i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			if (i != static_cast<size_t>(EMenuType::MENU_TYPE_INTERNET) && profile.arStatuses[i] != EStatus::STATUS_OK)
+				return false;
+		}
+		return EvaluateInternetReadiness(machine.internet) == EStatus::STATUS_OK;
+	}
+
+	SProbeResult CProfileCatalog::GetMachineResult(size_t nMachine) const
+	{
+		const auto& machine = m_vMachines[nMachine];
+
+		auto result = m_vProfiles[machine.nProfile].result;
+		result.internet = machine.internet;
+		result.SetStatus(EMenuType::MENU_TYPE_INTERNET, EvaluateInternetReadiness(machine.internet));
+		return result;
+	}
+
+	// [profile count u32] then [fingerprint 16][encoding length u32][encoding] per profile,
+	// [machine count u64] then [machine id u64][profile u32][connectivity bits u8] per machine
+	bool CProfileCatalog::Save(const std::string& stFileName) const
+	{
+		std::string stBuffer(PROFILE_CATALOG_MAGIC, sizeof(PROFILE_CATALOG_MAGIC));
+
+		AppendValue(stBuffer, static_cast<uint32_t>(m_vProfiles.size()));
+		for (const auto& profile : m_vProfiles)
+		{
+			AppendValue(stBuffer, profile.fingerprint.nLow);
+			AppendValue(stBuffer, profile.fingerprint.nHigh);
+			AppendValue(stBuffer, static_cast<uint32_t>(profile.stEncoding.size()));
+			stBuffer.append(profile.stEncoding);
+		}
+
+		AppendValue(stBuffer, static_cast<uint64_t>(m_vMachines.size()));
+		for (const auto& machine : m_vMachines)
+		{
+			AppendValue(stBuffer, machine.nMachineId);
+			AppendValue(stBuffer, machine.nProfile);
+			AppendValue(stBuffer, static_cast<uint8_t>(machine.internet.bConnected | (machine.internet.bReachable << 1)));
+		}
+
+		std::ofstream ofs(stFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+		return ofs && ofs.write(stBuffer.data(), stBuffer.size());
+	}
+
+	bool CProfileCatalog::Load(const std::string& stFileName)
+	{
+		m_vProfiles.clear();
+		m_vMachines.clear();
+		m_mapProfiles.clear();
+
+		CMappedFile file;
+		if (!file.Open(stFileName))
+			return false;
+
+		const auto pData = file.GetData();
+		const auto nSize = file.GetSize();
+		size_t nOffset = 0;
+
+		auto Read = [&](void* pOut, size_t nLength) {
+			if (nSize - nOffset < nLength)
+				return false;
+			std::memcpy(pOut, pData + nOffset, nLength);
+			nOffset += nLength;
+			return true;
+		};
+
+		char szMagic[sizeof(PROFILE_CATALOG_MAGIC)]{};
+		uint32_t nProfileCount = 0;
+		if (!Read(szMagic, sizeof(szMagic)) || std::memcmp(szMagic, PROFILE_CATALOG_MAGIC, sizeof(szMagic)) || !Read(&nProfileCount, sizeof(nProfileCount)))
+			return false;
+
+		for (uint32_t i = 0; i < nProfileCount; ++i)
+		{
+			SHardwareFingerprint fingerprint{};
+			uint32_t nLength = 0;
+			if (!Read(&fingerprint.nLow, sizeof(fingerprint.nLow)) || !Read(&fingerprint.nHigh, sizeof(fingerprint.nHigh)) ||
+				!Read(&nLength, sizeof(nLength)) || nSize - nOffset < nLength)
+				return false;
+
+			SProbeResult result;
+			std::string stEncoding(pData + nOffset, nLength);
+			nOffset += nLength;
+			if (HashBytes128(stEncoding.data(), stEncoding.size()) != fingerprint || !DecodeHardwareProfile(stEncoding.data(), stEncoding.size(), result))
+				return false;
+
+			__AddProfile(fingerprint, std::move(stEncoding));
+		}
+
+		uint64_t nMachineCount = 0;
+		if (!Read(&nMachineCount, sizeof(nMachineCount)) || (nSize - nOffset) / 13 < nMachineCount)
+			return false;
+
+		m_vMachines.reserve(static_cast<size_t>(nMachineCount));
+		for (uint64_t i = 0; i < nMachineCount; ++i)
+		{
+			SProfileMachine machine{};
+			uint8_t nBits = 0;
+			if (!Read(&machine.nMachineId, sizeof(machine.nMachineId)) || !Read(&machine.nProfile, sizeof(machine.nProfile)) || !Read(&nBits, sizeof(nBits)) ||
+				machine.nProfile >= m_vProfiles.size())
+				return false;
+
+			machine.internet.bConnected = nBits & 1;
+			machine.internet.bReachable = (nBits >> 1) & 1;
+			m_vProfiles[machine.nProfile].nMachineCount++;
+			m_vMachines.emplace_back(machine);
+		}
+		return nOffset == nSize;
+	}
+
+	// A 128 bit collision between different encodings only costs the dedup of the later profile
+	uint32_t CProfileCatalog::__AddProfile(const SHardwareFingerprint& fingerprint, std::string&& stEncoding)
+	{
+		const auto nProfile = static_cast<uint32_t>(m_vProfiles.size());
+
+		SProfile profile{};
+		profile.fingerprint = fingerprint;
+		DecodeHardwareProfile(stEncoding.data(), stEncoding.size(), profile.result);
+		profile.stEncoding = std::move(stEncoding);
+		m_vProfiles.emplace_back(std::move(profile));
+		m_mapProfiles.emplace(fingerprint, nProfile);
+		return nProfile;
+	}
+};
@@ -0,0 +1,423 @@
+#include "../../include/core/profile_generator.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/cpuid_features.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <iterator>
+
+namespace Win11SysCheck
+{
+	static uint64_t SplitMix64(uint64_t& nState)
+	{
+		auto z = (nState += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+	static uint64_t RotateLeft(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+	CRandom::CRandom(uint64_t nSeed)
+	{
+		for (auto& nState : m_arState)
+			nState = SplitMix64(nSeed);
+	}
+
+	uint64_t CRandom::Next()
+	{
+		const auto nResult = RotateLeft(m_arState[1] * 5, 7) * 9;
+		const auto t = m_arState[1] << 17;
+
+		m_arState[2] ^= m_arState[0];
+		m_arState[3] ^= m_arState[1];
+		m_arState[1] ^= m_arState[2];
+		m_arState[0] ^= m_arState[3];
+		m_arState[2] ^= t;
+		m_arState[3] = RotateLeft(m_arState[3], 45);
+
+		return nResult;
+	}
+
+	uint64_t CRandom::Range(uint64_t nMin, uint64_t nMax)
+	{
+		if (nMax <= nMin)
+			return nMin;
+		const auto nSpan = nMax - nMin + 1;
+		if (!nSpan)
+			return Next();
+		return nMin + Next() % nSpan;
+	}
+
+	bool CRandom::Chance(double dProbability)
+	{
+		return static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0) < dProbability;
+	}
+
+	struct SCPUModel
+	{
+		const char* szVendor;
+		const char* szName;
+		EProcessorArchitecture nArchitecture;
+		uint16_t nFamily;
+		uint16_t nModel;
+		uint8_t nStepping;
+		uint32_t nLogicalProcessors;
+		uint32_t nMaxMhz;
+		bool bArmV81Atomics;
+		uint64_t nFeatures;
+		uint32_t nWeight;
+	};
+
+	static constexpr auto ARCH_X64 = EProcessorArchitecture::ARCHITECTURE_AMD64;
+	static constexpr auto ARCH_ARM64 = EProcessorArchitecture::ARCHITECTURE_ARM64;
+
+	template <class... T>
+	static constexpr uint64_t GetFeatureBits(T... nFeatures)
+	{
+		return (GetCPUFeatureBit(nFeatures) | ...);
+	}
+
+	// Feature sets of the generations in the model table, ARM64 parts report none
+	static constexpr uint64_t FEATURES_CORE2 = GetFeatureBits(ECPUFeature::CPU_FEATURE_SSE2, ECPUFeature::CPU_FEATURE_SSE3,
+		ECPUFeature::CPU_FEATURE_SSSE3, ECPUFeature::CPU_FEATURE_CX16, ECPUFeature::CPU_FEATURE_LAHF_SAHF, ECPUFeature::CPU_FEATURE_NX,
+		ECPUFeature::CPU_FEATURE_LONG_MODE);
+	static constexpr uint64_t FEATURES_NEHALEM = FEATURES_CORE2 | GetFeatureBits(ECPUFeature::CPU_FEATURE_SSE41, ECPUFeature::CPU_FEATURE_SSE42,
+		ECPUFeature::CPU_FEATURE_POPCNT);
+	static constexpr uint64_t FEATURES_ATOM = FEATURES_NEHALEM | GetFeatureBits(ECPUFeature::CPU_FEATURE_PCLMULQDQ, ECPUFeature::CPU_FEATURE_AES,
+		ECPUFeature::CPU_FEATURE_MOVBE, ECPUFeature::CPU_FEATURE_RDRAND, ECPUFeature::CPU_FEATURE_PREFETCHW);
+	static constexpr uint64_t FEATURES_GOLDMONT_PLUS = FEATURES_ATOM | GetFeatureBits(ECPUFeature::CPU_FEATURE_RDSEED, ECPUFeature::CPU_FEATURE_SHA,
+		ECPUFeature::CPU_FEATURE_XSAVE, ECPUFeature::CPU_FEATURE_OSXSAVE);
+	static constexpr uint64_t FEATURES_IVY_BRIDGE = FEATURES_NEHALEM | GetFeatureBits(ECPUFeature::CPU_FEATURE_PCLMULQDQ, ECPUFeature::CPU_FEATURE_AES,
+		ECPUFeature::CPU_FEATURE_XSAVE, ECPUFeature::CPU_FEATURE_OSXSAVE, ECPUFeature::CPU_FEATURE_AVX, ECPUFeature::CPU_FEATURE_F16C,
+		ECPUFeature::CPU_FEATURE_RDRAND);
+	static constexpr uint64_t FEATURES_KAVERI = (FEATURES_IVY_BRIDGE & ~GetCPUFeatureBit(ECPUFeature::CPU_FEATURE_RDRAND)) |
+		GetFeatureBits(ECPUFeature::CPU_FEATURE_FMA3, ECPUFeature::CPU_FEATURE_BMI1, ECPUFeature::CPU_FEATURE_LZCNT, ECPUFeature::CPU_FEATURE_PREFETCHW);
+	static constexpr uint64_t FEATURES_HASWELL = FEATURES_IVY_BRIDGE | GetFeatureBits(ECPUFeature::CPU_FEATURE_AVX2, ECPUFeature::CPU_FEATURE_BMI1,
+		ECPUFeature::CPU_FEATURE_BMI2, ECPUFeature::CPU_FEATURE_FMA3, ECPUFeature::CPU_FEATURE_MOVBE, ECPUFeature::CPU_FEATURE_LZCNT);
+	static constexpr uint64_t FEATURES_SKYLAKE = FEATURES_HASWELL | GetFeatureBits(ECPUFeature::CPU_FEATURE_PREFETCHW, ECPUFeature::CPU_FEATURE_RDSEED);
+	static constexpr uint64_t FEATURES_AVX512 = GetFeatureBits(ECPUFeature::CPU_FEATURE_AVX512F, ECPUFeature::CPU_FEATURE_AVX512DQ,
+		ECPUFeature::CPU_FEATURE_AVX512CD, ECPUFeature::CPU_FEATURE_AVX512BW, ECPUFeature::CPU_FEATURE_AVX512VL);
+	static constexpr uint64_t FEATURES_SKYLAKE_X = FEATURES_SKYLAKE | FEATURES_AVX512;
+	static constexpr uint64_t FEATURES_TIGER_LAKE = FEATURES_SKYLAKE_X | GetCPUFeatureBit(ECPUFeature::CPU_FEATURE_SHA);
+	static constexpr uint64_t FEATURES_ALDER_LAKE = FEATURES_SKYLAKE | GetCPUFeatureBit(ECPUFeature::CPU_FEATURE_SHA);
+	static constexpr uint64_t FEATURES_ZEN = FEATURES_SKYLAKE | GetCPUFeatureBit(ECPUFeature::CPU_FEATURE_SHA);
+	static constexpr uint64_t FEATURES_NONE = 0;
+
+	static const SCPUModel gs_arCPUModels[] = {
+		{ "GenuineIntel", "Intel(R) Core(TM) i5-3470 CPU @ 3.20GHz", ARCH_X64, 6, 58, 9, 4, 3201, false, FEATURES_IVY_BRIDGE, 4 },
+		{ "GenuineIntel", "Intel(R) Core(TM) i7-4770 CPU @ 3.40GHz", ARCH_X64, 6, 60, 3, 8, 3401, false, FEATURES_HASWELL, 5 },
+		{ "GenuineIntel", "Intel(R) Core(TM) i5-6500 CPU @ 3.20GHz", ARCH_X64, 6, 94, 3, 4, 3192, false, FEATURES_SKYLAKE, 6 },
+		{ "GenuineIntel", "Intel(R) Core(TM) i5-7200U CPU @ 2.50GHz", ARCH_X64, 6, 142, 9, 4, 2712, false, FEATURES_SKYLAKE, 6 },
+		{ "GenuineIntel", "Intel(R) Core(TM) i7-8550U CPU @ 1.80GHz", ARCH_X64, 6, 142, 10, 8, 1992, false, FEATURES_SKYLAKE, 8 },
+		{ "GenuineIntel", "Intel(R) Core(TM) i7-7700K CPU @ 4.20GHz", ARCH_X64, 6, 158, 9, 8, 4200, false, FEATURES_SKYLAKE, 4 },
+		{ "GenuineIntel", "Intel(R) Core(TM) i7-9700 CPU @ 3.00GHz", ARCH_X64, 6, 158, 13, 8, 3000, false, FEATURES_SKYLAKE, 6 },
+		{ "GenuineIntel", "Intel(R) Core(TM) i5-10400 CPU @ 2.90GHz", ARCH_X64, 6, 165, 3, 12, 2904, false, FEATURES_SKYLAKE, 7 },
+		{ "GenuineIntel", "11th Gen Intel(R) Core(TM) i7-1165G7 @ 2.80GHz", ARCH_X64, 6, 140, 1, 8, 2803, false, FEATURES_TIGER_LAKE, 8 },
+		{ "GenuineIntel", "12th Gen Intel(R) Core(TM) i7-12700", ARCH_X64, 6, 151, 2, 20, 2100, false, FEATURES_ALDER_LAKE, 5 },
+		{ "GenuineIntel", "12th Gen Intel(R) Core(TM) i5-1235U", ARCH_X64, 6, 154, 4, 12, 1300, false, FEATURES_ALDER_LAKE, 6 },
+		{ "GenuineIntel", "Intel(R) Xeon(R) Gold 6130 CPU @ 2.10GHz", ARCH_X64, 6, 85, 4, 32, 2095, false, FEATURES_SKYLAKE_X, 2 },
+		{ "GenuineIntel", "Intel(R) Pentium(R) Silver N5000 CPU @ 1.10GHz", ARCH_X64, 6, 122, 1, 4, 1101, false, FEATURES_GOLDMONT_PLUS, 2 },
+		{ "GenuineIntel", "Intel(R) Celeron(R) CPU N3050 @ 1.60GHz", ARCH_X64, 6, 76, 3, 2, 1600, false, FEATURES_ATOM, 1 },
+		{ "AuthenticAMD", "AMD A10-7850K Radeon R7, 12 Compute Cores 4C+8G", ARCH_X64, 21, 48, 1, 4, 3700, false, FEATURES_KAVERI, 1 },
+		{ "AuthenticAMD", "AMD Ryzen 5 1600 Six-Core Processor", ARCH_X64, 23, 1, 1, 12, 3200, false, FEATURES_ZEN, 3 },
+		{ "AuthenticAMD", "AMD Ryzen 7 2700X Eight-Core Processor", ARCH_X64, 23, 8, 2, 16, 3700, false, FEATURES_ZEN, 3 },
+		{ "AuthenticAMD", "AMD Ryzen 5 2500U with Radeon Vega Mobile Gfx", ARCH_X64, 23, 17, 0, 8, 2000, false, FEATURES_ZEN, 3 },
+		{ "AuthenticAMD", "AMD Ryzen 5 3500U with Radeon Vega Mobile Gfx", ARCH_X64, 23, 24, 1, 8, 2100, false, FEATURES_ZEN, 3 },
+		{ "AuthenticAMD", "AMD Ryzen 5 4500U with Radeon Graphics", ARCH_X64, 23, 96, 1, 6, 2375, false, FEATURES_ZEN, 4 },
+		{ "AuthenticAMD", "AMD Ryzen 7 3700X 8-Core Processor", ARCH_X64, 23, 113, 0, 16, 3600, false, FEATURES_ZEN, 4 },
+		{ "AuthenticAMD", "AMD Ryzen 9 5900X 12-Core Processor", ARCH_X64, 25, 33, 0, 24, 3700, false, FEATURES_ZEN, 3 },
+		{ "AuthenticAMD", "AMD Ryzen 7 5800U with Radeon Graphics", ARCH_X64, 25, 80, 0, 16, 1900, false, FEATURES_ZEN, 4 },
+		{ "Qualcomm Technologies Inc", "Snapdragon (TM) 835 @ 2.21 GHz", ARCH_ARM64, 8, 0, 4, 8, 2208, false, FEATURES_NONE, 1 },
+		{ "Qualcomm Technologies Inc", "Snapdragon 850 @ 2.96 GHz", ARCH_ARM64, 8, 0, 13, 8, 2956, true, FEATURES_NONE, 1 },
+		{ "Qualcomm Technologies Inc", "Snapdragon (TM) 8cx @ 2.84 GHz", ARCH_ARM64, 8, 0, 14, 8, 2840, true, FEATURES_NONE, 1 }
+	};
+
+	struct SAdapterModel
+	{
+		const char* szDescription;
+		const char* szDriverModel;
+	};
+	static const SAdapterModel gs_arAdapterModels[] = {
+		{ "Intel(R) HD Graphics 4000", "WDDM 1.3" },
+		{ "Intel(R) HD Graphics 530", "WDDM 2.1" },
+		{ "Intel(R) UHD Graphics 620", "WDDM 2.7" },
+		{ "Intel(R) Iris(R) Xe Graphics", "WDDM 3.0" },
+		{ "NVIDIA GeForce GTX 1060 6GB", "WDDM 2.7" },
+		{ "NVIDIA GeForce RTX 3060", "WDDM 3.0" },
+		{ "AMD Radeon(TM) Vega 8 Graphics", "WDDM 2.6" },
+		{ "AMD Radeon RX 580 Series", "WDDM 2.7" },
+		{ "Qualcomm(R) Adreno(TM) 680 GPU", "WDDM 2.5" },
+		{ "Microsoft Basic Display Adapter", "WDDM 1.2" }
+	};
+
+	struct SResolution
+	{
+		int32_t nWidth;
+		int32_t nHeight;
+	};
+	static const SResolution gs_arResolutions[] = {
+		{ 1024, 768 }, { 1280, 720 }, { 1366, 768 }, { 1600, 900 }, { 1920, 1080 }, { 1920, 1200 }, { 2560, 1440 }, { 3840, 2160 }
+	};
+
+	// EDID panel sizes in cm, small panels mimic tablets and embedded screens
+	static const SPanelFacts gs_arPanelSizes[] = {
+		{ "", 15, 9 }, { "", 18, 10 }, { "", 26, 15 }, { "", 29, 17 }, { "", 31, 17 },
+		{ "", 34, 19 }, { "", 48, 27 }, { "", 53, 30 }, { "", 60, 34 }, { "", 70, 39 }
+	};
+
+	static const char* gs_arMonitorNames[] = {
+		"Generic PnP Monitor", "DELL U2419H", "LG ULTRAWIDE", "HP E243", "BenQ GW2480", "Samsung SyncMaster"
+	};
+
+	static const uint32_t gs_arBuildNumbers[] = {
+		10240, 10586, 14393, 15063, 16299, 17134, 17763, 18362, 18363, 19041, 19042, 19043, 19044, 19045
+	};
+
+	CProfileGenerator::CProfileGenerator(uint64_t nSeed, uint64_t nSkuCount) :
+		m_nSeed(nSeed), m_nSkuCount(nSkuCount)
+	{
+	}
+
+	SProbeResult CProfileGenerator::Generate(uint64_t nIndex) const
+	{
+		uint64_t nStream = m_nSeed ^ (nIndex * 0xD1B54A32D192ED03ull);
+		CRandom rng(SplitMix64(nStream));
+
+		// SKU popularity is skewed, low numbered SKUs take most of the fleet
+		uint64_t nSkuStream = 0;
+		if (m_nSkuCount)
+		{
+			const auto nSku = rng.Range(0, m_nSkuCount - 1) % (rng.Range(0, m_nSkuCount - 1) + 1);
+			nSkuStream = m_nSeed ^ ((nSku + 1) * 0x9E3779B97F4A7C15ull);
+		}
+		CRandom skuRng(SplitMix64(nSkuStream));
+		auto& hardwareRng = m_nSkuCount ? skuRng : rng;
+
+		SProbeResult result{};
+		result.nMachineId = nIndex + 1;
+		__GenerateOS(hardwareRng, result.os);
+		__GenerateBoot(hardwareRng, result.boot);
+		__GenerateCPU(hardwareRng, result.cpu);
+		__GenerateRAM(hardwareRng, result.ram);
+		__GenerateDisk(hardwareRng, result.disk);
+		__GenerateDisplay(hardwareRng, result.display);
+		__GenerateInternet(rng, result.internet);
+
+		if (m_nSkuCount)
+		{
+			result.ram.nAvailablePhysical = result.ram.nTotalPhysical / 100 * rng.Range(15, 75);
+			for (auto& volume : result.disk.vVolumes)
+				volume.nFreeBytes = volume.nTotalBytes / 100 * rng.Range(3, 80);
+		}
+
+		EvaluateReadiness(result);
+		return result;
+	}
+
+	SProbeResult CProfileGenerator::GenerateRescan(uint64_t nIndex, uint32_t nScan, double dChangeRate) const
+	{
+		auto result = Generate(nIndex);
+		if (!nScan)
+			return result;
+
+		// Changes accumulate, scan n replays the events of every scan before it
+		for (uint32_t i = 1; i <= nScan; ++i)
+		{
+			uint64_t nStream = m_nSeed ^ (nIndex * 0xD1B54A32D192ED03ull) ^ (i * 0x8CB92BA72F3D8DD7ull);
+			CRandom rng(SplitMix64(nStream));
+			if (!rng.Chance(dChangeRate))
+				continue;
+
+			switch (rng.Range(0, 3))
+			{
+			case 0:
+			{
+				const auto it = std::upper_bound(std::begin(gs_arBuildNumbers), std::end(gs_arBuildNumbers), result.os.nBuildNumber);
+				if (it != std::end(gs_arBuildNumbers))
+					result.os.nBuildNumber = *it;
+				break;
+			}
+			case 1:
+				if (result.boot.bSecureBootCapable)
+					result.boot.bSecureBootEnabled = !result.boot.bSecureBootEnabled;
+				break;
+			case 2:
+				result.boot.bTpmPresent = !result.boot.bTpmPresent;
+				result.boot.nTpmVersion = result.boot.bTpmPresent ? 2 : 0;
+				break;
+			default:
+				result.ram.nTotalPhysical *= 2;
+				break;
+			}
+		}
+
+		uint64_t nStream = m_nSeed ^ (nIndex * 0xD1B54A32D192ED03ull) ^ (nScan * 0xA0761D6478BD642Full);
+		CRandom rng(SplitMix64(nStream));
+		result.ram.nAvailablePhysical = result.ram.nTotalPhysical / 100 * rng.Range(15, 75);
+		for (auto& volume : result.disk.vVolumes)
+			volume.nFreeBytes = volume.nTotalBytes / 100 * rng.Range(3, 80);
+
+		EvaluateReadiness(result);
+		return result;
+	}
+
+	void CProfileGenerator::__GenerateOS(CRandom& rng, SOSFacts& facts) const
+	{
+		facts.nMajorVersion = 10;
+		facts.nMinorVersion = 0;
+		facts.nBuildNumber = rng.Pick(gs_arBuildNumbers);
+		facts.nPlatformId = 2;
+
+		// PRODUCT_PROFESSIONAL, PRODUCT_ENTERPRISE, PRODUCT_CORE, PRODUCT_EDUCATION, cloud editions are rare
+		static const uint32_t s_arProductTypes[] = { 0x30, 0x30, 0x30, 0x04, 0x04, 0x65, 0x65, 0x79 };
+		facts.nProductType = rng.Chance(0.01) ? static_cast<uint32_t>(rng.Range(0xB2, 0xB3)) : rng.Pick(s_arProductTypes);
+	}
+
+	void CProfileGenerator::__GenerateBoot(CRandom& rng, SBootFacts& facts) const
+	{
+		facts.nFirmwareType = rng.Chance(0.85) ? EFirmwareType::FIRMWARE_UEFI : EFirmwareType::FIRMWARE_BIOS;
+		facts.nBootFlags = rng.Chance(0.1) ? 1 : 0;
+
+		const auto bUEFI = facts.nFirmwareType == EFirmwareType::FIRMWARE_UEFI;
+		facts.bSecureBootCapable = bUEFI && rng.Chance(0.9);
+		facts.bSecureBootEnabled = facts.bSecureBootCapable && rng.Chance(0.75);
+
+		facts.bTpmPresent = rng.Chance(0.88);
+		if (facts.bTpmPresent)
+			facts.nTpmVersion = rng.Chance(0.85) ? 2 : 1;
+	}
+
+	void CProfileGenerator::__GenerateCPU(CRandom& rng, SCPUFacts& facts) const
+	{
+		static const auto s_nTotalWeight = [] {
+			uint32_t nTotal = 0;
+			for (const auto& model : gs_arCPUModels)
+				nTotal += model.nWeight;
+			return nTotal;
+		}();
+
+		auto nRoll = static_cast<uint32_t>(rng.Range(0, s_nTotalWeight - 1));
+		const SCPUModel* pModel = &gs_arCPUModels[0];
+		for (const auto& model : gs_arCPUModels)
+		{
+			if (nRoll < model.nWeight)
+			{
+				pModel = &model;
+				break;
+			}
+			nRoll -= model.nWeight;
+		}
+
+		facts.stVendor = pModel->szVendor;
+		facts.stName = pModel->szName;
+		facts.nArchitecture = pModel->nArchitecture;
+		facts.nFamily = pModel->nFamily;
+		facts.nModel = pModel->nModel;
+		facts.nStepping = pModel->nStepping;
+		facts.bArmV81Atomics = pModel->bArmV81Atomics;
+		facts.nFeatures = pModel->nFeatures;
+
+		// 32 bit Windows installs report x86 on x64 capable hardware
+		if (facts.nArchitecture == ARCH_X64 && rng.Chance(0.02))
+			facts.nArchitecture = EProcessorArchitecture::ARCHITECTURE_INTEL;
+
+		static const uint32_t s_arPlatformFields[] = { 2, 8, 16, 32 };
+		facts.nPlatformSpecificField = facts.stVendor == "GenuineIntel" ? rng.Pick(s_arPlatformFields) : 0;
+
+		facts.nProcessorCount = pModel->nLogicalProcessors;
+		facts.nActiveProcessorCount = facts.nProcessorCount;
+		// Virtual machines are commonly sized below the host
+		if (rng.Chance(0.05))
+		{
+			facts.nProcessorCount = static_cast<uint32_t>(rng.Range(1, 2));
+			facts.nActiveProcessorCount = facts.nProcessorCount;
+
+			// Hypervisors set their bit, some expose a baseline x64 model without SSE4.2 and POPCNT
+			if (facts.nFeatures)
+			{
+				facts.nFeatures = rng.Chance(0.2) ? FEATURES_CORE2 : facts.nFeatures;
+				facts.nFeatures |= GetCPUFeatureBit(ECPUFeature::CPU_FEATURE_HYPERVISOR);
+			}
+		}
+
+		facts.nMaxMhz = pModel->nMaxMhz;
+		facts.nFastProcessorCount = facts.nMaxMhz >= 1000 ? facts.nProcessorCount : 0;
+	}
+
+	void CProfileGenerator::__GenerateRAM(CRandom& rng, SRAMFacts& facts) const
+	{
+		static const uint64_t s_arInstalledGb[] = { 2, 4, 4, 8, 8, 8, 16, 16, 16, 32, 64 };
+		const auto nInstalled = rng.Pick(s_arInstalledGb) * 1024 * 1024 * 1024;
+
+		// Firmware and integrated graphics reservations
+		const auto nReserved = rng.Range(64, 900) * 1024 * 1024;
+		facts.nTotalPhysical = nInstalled - nReserved;
+		facts.nAvailablePhysical = facts.nTotalPhysical / 100 * rng.Range(15, 75);
+	}
+
+	void CProfileGenerator::__GenerateDisk(CRandom& rng, SDiskFacts& facts) const
+	{
+		static const uint64_t s_arDiskGb[] = { 32, 64, 120, 128, 240, 256, 480, 500, 512, 1000, 2000 };
+
+		const auto nVolumeCount = rng.Chance(0.7) ? 1 : rng.Range(2, 3);
+		for (uint64_t i = 0; i < nVolumeCount; ++i)
+		{
+			SVolumeFacts volume{};
+			volume.stPath = fmt::format("{0}:\\", static_cast<char>('C' + i));
+			volume.stDeviceName = fmt::format("\\Device\\HarddiskVolume{0}", 3 + i);
+			volume.stVolumeName = i ? fmt::format("Data{0}", i) : "Windows";
+			volume.stFileSystem = rng.Chance(0.97) ? "NTFS" : "ReFS";
+			volume.nPartitionStyle = rng.Chance(0.8) ? EPartitionStyle::PARTITION_GPT : EPartitionStyle::PARTITION_MBR;
+			volume.nTotalBytes = rng.Pick(s_arDiskGb) * 1000 * 1000 * 1000 / 100 * rng.Range(90, 99);
+			volume.nFreeBytes = volume.nTotalBytes / 100 * rng.Range(3, 80);
+			facts.vVolumes.emplace_back(volume);
+		}
+	}
+
+	void CProfileGenerator::__GenerateDisplay(CRandom& rng, SDisplayFacts& facts) const
+	{
+		const auto nMonitorCount = rng.Chance(0.65) ? 1 : rng.Range(2, 3);
+		for (uint64_t i = 0; i < nMonitorCount; ++i)
+		{
+			const auto& resolution = rng.Pick(gs_arResolutions);
+
+			SMonitorFacts monitor{};
+			monitor.stDeviceID = fmt::format("MONITOR\\GSM{0:04X}\\{{4d36e96e-e325-11ce-bfc1-08002be10318}}\\{1:04}", rng.Range(0, 0xFFFF), i);
+			monitor.stDeviceName = fmt::format("\\\\.\\DISPLAY{0}\\Monitor0", i + 1);
+			monitor.stDeviceString = rng.Pick(gs_arMonitorNames);
+			monitor.bPrimary = i == 0;
+			monitor.nBitsPerPixel = rng.Chance(0.98) ? 32 : 16;
+			monitor.nWidth = resolution.nWidth;
+			monitor.nHeight = resolution.nHeight;
+			facts.vMonitors.emplace_back(monitor);
+
+			// Headless and remote sessions do not expose an EDID
+			if (rng.Chance(0.95))
+			{
+				constexpr auto nSmallPanels = 2;
+				constexpr auto nPanels = sizeof(gs_arPanelSizes) / sizeof(gs_arPanelSizes[0]);
+				auto panel = rng.Chance(0.03) ? gs_arPanelSizes[rng.Range(0, nSmallPanels - 1)] : gs_arPanelSizes[rng.Range(nSmallPanels, nPanels - 1)];
+				panel.stRegistryPath = fmt::format("SYSTEM\\CurrentControlSet\\Enum\\DISPLAY\\GSM{0:04X}\\{1}&{2:x}&0&UID{3}", rng.Range(0, 0xFFFF), i + 4, rng.Range(0, 0xFFFFFFF), 4352 + i);
+				facts.vPanels.emplace_back(panel);
+			}
+		}
+
+		const auto nAdapterCount = rng.Chance(0.8) ? 1u : 2u;
+		for (uint64_t i = 0; i < nAdapterCount; ++i)
+		{
+			const auto& adapter = rng.Pick(gs_arAdapterModels);
+			facts.vAdapters.emplace_back(SGraphicsAdapterFacts{ adapter.szDescription, adapter.szDriverModel });
+		}
+
+		facts.nDirectXMajor = rng.Chance(0.93) ? 12 : 11;
+		facts.nDirectXMinor = facts.nDirectXMajor == 12 ? 0 : static_cast<uint32_t>(rng.Range(0, 1));
+	}
+
+	void CProfileGenerator::__GenerateInternet(CRandom& rng, SInternetFacts& facts) const
+	{
+		facts.bConnected = rng.Chance(0.97);
+		facts.bReachable = facts.bConnected && rng.Chance(0.98);
+	}
+};
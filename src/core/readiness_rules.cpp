@@ -0,0 +1,194 @@
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/cpu_database.hpp"
+#include "../../include/core/cpuid_features.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+
+namespace Win11SysCheck
+{
+	static constexpr uint32_t PRODUCT_TYPE_CLOUD = 0x000000B2;
+	static constexpr uint32_t PRODUCT_TYPE_CLOUDN = 0x000000B3;
+
+	static constexpr uint64_t MIN_PHYSICAL_MEMORY_KB = 4096000;
+	static constexpr uint64_t MIN_VOLUME_SIZE_MB = 64000;
+	static constexpr double MIN_PANEL_DIAGONAL_INCHES = 9.0;
+	static constexpr int32_t MIN_MONITOR_HEIGHT = 720;
+	static constexpr uint32_t MIN_MONITOR_BPC = 8;
+	static constexpr uint32_t MIN_DIRECTX_MAJOR = 12;
+	static constexpr uint32_t MIN_WDDM_VERSION = 20;
+	static constexpr uint32_t MIN_PROCESSOR_MHZ_COUNT = 2;
+
+	EStatus EvaluateOSReadiness(const SOSFacts& facts)
+	{
+		if (facts.nProductType != PRODUCT_TYPE_CLOUD && facts.nProductType != PRODUCT_TYPE_CLOUDN)
+			return EStatus::STATUS_OK;
+		return EStatus::STATUS_FAIL;
+	}
+
+	EStatus EvaluateBootReadiness(const SBootFacts& facts)
+	{
+		if (facts.nFirmwareType == EFirmwareType::FIRMWARE_UEFI && facts.bSecureBootCapable && facts.bTpmPresent && facts.nTpmVersion == 2)
+			return EStatus::STATUS_OK;
+		return EStatus::STATUS_FAIL;
+	}
+
+	// Listed in the supported-processor lists, or of a supported family, model and stepping. Qualcomm
+	// parts also need the ARMv8.1 atomics.
+	bool IsSupportedProcessor(const SCPUFacts& facts)
+	{
+		const auto classification = ClassifyProcessor(facts);
+		if (classification.nVendor == ECPUVendor::CPU_VENDOR_QUALCOMM && !facts.bArmV81Atomics)
+			return false;
+		return classification.nSupport == ECPUSupport::CPU_SUPPORT_SUPPORTED;
+	}
+
+	// Only AMD64 facts carry CPUID bits; an ARM64 machine emulating x64 reports the emulator's
+	uint64_t GetMissingInstructions(const SCPUFacts& facts)
+	{
+		if (facts.nArchitecture != EProcessorArchitecture::ARCHITECTURE_AMD64)
+			return 0;
+		return CCPUFeatureSet(facts.nFeatures).GetMissing(CPU_FEATURES_24H2_REQUIRED);
+	}
+
+	EStatus EvaluateCPUReadiness(const SCPUFacts& facts)
+	{
+		if (IsX64Architecture(facts.nArchitecture) && facts.nProcessorCount >= 2 && facts.nFastProcessorCount >= MIN_PROCESSOR_MHZ_COUNT && IsSupportedProcessor(facts) &&
+			!GetMissingInstructions(facts))
+			return EStatus::STATUS_OK;
+		return EStatus::STATUS_FAIL;
+	}
+
+	EStatus EvaluateRAMReadiness(const SRAMFacts& facts)
+	{
+		if (facts.nTotalPhysical / 1024 >= MIN_PHYSICAL_MEMORY_KB)
+			return EStatus::STATUS_OK;
+		return EStatus::STATUS_FAIL;
+	}
+
+	EStatus EvaluateDiskReadiness(const SDiskFacts& facts)
+	{
+		for (const auto& volume : facts.vVolumes)
+		{
+			if (volume.nTotalBytes / 1024 / 1024 > MIN_VOLUME_SIZE_MB)
+				return EStatus::STATUS_OK;
+		}
+		return EStatus::STATUS_FAIL;
+	}
+
+	EStatus EvaluateDisplayReadiness(const SDisplayFacts& facts)
+	{
+		auto bHasAvailableMonitor = false;
+		for (const auto& monitor : facts.vMonitors)
+		{
+			if (monitor.nHeight >= MIN_MONITOR_HEIGHT && monitor.nBitsPerPixel >= MIN_MONITOR_BPC)
+			{
+				bHasAvailableMonitor = true;
+				break;
+			}
+		}
+
+		auto bHasCompatibleDisplay = false;
+		for (const auto& panel : facts.vPanels)
+		{
+			if (GetPanelDiagonalInches(panel) >= MIN_PANEL_DIAGONAL_INCHES)
+			{
+				bHasCompatibleDisplay = true;
+				break;
+			}
+		}
+
+		auto bHasAvailableWDDM = facts.bDxDiagSkipped;
+		for (const auto& adapter : facts.vAdapters)
+		{
+			if (GetWDDMVersion(adapter.stDriverModel) >= MIN_WDDM_VERSION)
+			{
+				bHasAvailableWDDM = true;
+				break;
+			}
+		}
+
+		const auto bHasDirectX = facts.bDxDiagSkipped || facts.nDirectXMajor >= MIN_DIRECTX_MAJOR;
+		if (bHasAvailableMonitor && bHasCompatibleDisplay && bHasDirectX && bHasAvailableWDDM)
+			return EStatus::STATUS_OK;
+		return EStatus::STATUS_FAIL;
+	}
+
+	EStatus EvaluateInternetReadiness(const SInternetFacts& facts)
+	{
+		if (facts.bConnected && facts.bReachable)
+			return EStatus::STATUS_OK;
+		return EStatus::STATUS_FAIL;
+	}
+
+	void EvaluateReadiness(SProbeResult& result)
+	{
+		result.SetStatus(EMenuType::MENU_TYPE_OS, EvaluateOSReadiness(result.os));
+		result.SetStatus(EMenuType::MENU_TYPE_BOOT, EvaluateBootReadiness(result.boot));
+		result.SetStatus(EMenuType::MENU_TYPE_CPU, EvaluateCPUReadiness(result.cpu));
+		result.SetStatus(EMenuType::MENU_TYPE_RAM, EvaluateRAMReadiness(result.ram));
+		result.SetStatus(EMenuType::MENU_TYPE_DISK, EvaluateDiskReadiness(result.disk));
+		result.SetStatus(EMenuType::MENU_TYPE_DISPLAY, EvaluateDisplayReadiness(result.display));
+		result.SetStatus(EMenuType::MENU_TYPE_INTERNET, EvaluateInternetReadiness(result.internet));
+	}
+
+	bool CanSystemUpgrade(const SProbeResult& result)
+	{
+		for (size_t i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			if (result.arStatuses[i] != EStatus::STATUS_OK)
+				return false;
+		}
+		return true;
+	}
+
+	void ExplainReadiness(const SProbeResult& result, std::vector <std::string>& vReasons)
+	{
+		if (EvaluateOSReadiness(result.os) != EStatus::STATUS_OK)
+			vReasons.emplace_back("os.cloud_edition");
+
+		const auto& boot = result.boot;
+		if (boot.nFirmwareType != EFirmwareType::FIRMWARE_UEFI)
+			vReasons.emplace_back("boot.legacy_firmware");
+		if (!boot.bSecureBootCapable)
+			vReasons.emplace_back("boot.secure_boot_unsupported");
+		if (!boot.bTpmPresent)
+			vReasons.emplace_back("boot.tpm_missing");
+		else if (boot.nTpmVersion != 2)
+			vReasons.emplace_back(fmt::format("boot.tpm_version:{0}", boot.nTpmVersion));
+
+		const auto& cpu = result.cpu;
+		if (!IsX64Architecture(cpu.nArchitecture))
+			vReasons.emplace_back("cpu.architecture");
+		if (cpu.nProcessorCount < 2)
+			vReasons.emplace_back("cpu.single_processor");
+		if (cpu.nFastProcessorCount < MIN_PROCESSOR_MHZ_COUNT)
+			vReasons.emplace_back("cpu.slow_processors");
+		if (!IsSupportedProcessor(cpu))
+		{
+			if (!cpu.stName.empty())
+				vReasons.emplace_back("cpu.unsupported_model:" + cpu.stName);
+			else
+				vReasons.emplace_back(fmt::format("cpu.unsupported_model:{0} {1}/{2}/{3}", cpu.stVendor, cpu.nFamily, cpu.nModel, cpu.nStepping));
+		}
+		if (const auto nMissing = GetMissingInstructions(cpu))
+			vReasons.emplace_back("cpu.missing_instructions:" + FormatCPUFeatures(nMissing));
+
+		if (EvaluateRAMReadiness(result.ram) != EStatus::STATUS_OK)
+			vReasons.emplace_back("ram.below_4gb");
+		if (EvaluateDiskReadiness(result.disk) != EStatus::STATUS_OK)
+			vReasons.emplace_back("disk.no_64gb_volume");
+
+		const auto& display = result.display;
+		if (std::none_of(display.vMonitors.begin(), display.vMonitors.end(), [](const auto& monitor) { return monitor.nHeight >= MIN_MONITOR_HEIGHT && monitor.nBitsPerPixel >= MIN_MONITOR_BPC; }))
+			vReasons.emplace_back("display.no_hd_monitor");
+		if (std::none_of(display.vPanels.begin(), display.vPanels.end(), [](const auto& panel) { return GetPanelDiagonalInches(panel) >= MIN_PANEL_DIAGONAL_INCHES; }))
+			vReasons.emplace_back("display.small_panel");
+		if (!display.bDxDiagSkipped && display.nDirectXMajor < MIN_DIRECTX_MAJOR)
+			vReasons.emplace_back(fmt::format("display.directx:{0}", display.nDirectXMajor));
+		if (!display.bDxDiagSkipped && std::none_of(display.vAdapters.begin(), display.vAdapters.end(), [](const auto& adapter) { return GetWDDMVersion(adapter.stDriverModel) >= MIN_WDDM_VERSION; }))
+			vReasons.emplace_back("display.wddm_below_2.0");
+
+		if (EvaluateInternetReadiness(result.internet) != EStatus::STATUS_OK)
+			vReasons.emplace_back(result.internet.bConnected ? "internet.unreachable" : "internet.offline");
+	}
+};
@@ -0,0 +1,274 @@
+#include "../../include/core/report_delta.hpp"
+#include "../../include/core/hardware_fingerprint.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace Win11SysCheck
+{
+	static constexpr char DELTA_REPORTER_MAGIC[8]{ 'W', '1', '1', 'D', 'L', 'T', 'A', '1' };
+	static constexpr char DELTA_STATE_MAGIC[8]{ 'W', '1', '1', 'D', 'S', 'T', 'A', '1' };
+
+	template <class T>
+	static void AppendValue(std::string& stBuffer, T value)
+	{
+		stBuffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	static void CopySection(const SProbeResult& source, SProbeResult& target, EMenuType nType)
+	{
+		switch (nType)
+		{
+		case EMenuType::MENU_TYPE_OS:
+			target.os = source.os;
+			break;
+		case EMenuType::MENU_TYPE_BOOT:
+			target.boot = source.boot;
+			break;
+		case EMenuType::MENU_TYPE_CPU:
+			target.cpu = source.cpu;
+			break;
+		case EMenuType::MENU_TYPE_RAM:
+			target.ram = source.ram;
+			break;
+		case EMenuType::MENU_TYPE_DISK:
+			target.disk = source.disk;
+			break;
+		case EMenuType::MENU_TYPE_DISPLAY:
+			target.display = source.display;
+			break;
+		case EMenuType::MENU_TYPE_INTERNET:
+			target.internet = source.internet;
+			break;
+		default:
+			break;
+		}
+	}
+
+	uint64_t SSectionDigests::GetStateDigest() const
+	{
+		return HashBytes128(arDigests.data(), sizeof(arDigests)).Get64();
+	}
+
+	SSectionDigests ComputeSectionDigests(const SProbeResult& result)
+	{
+		SSectionDigests digests;
+		CBinaryReportWriter writer;
+		std::string stBuffer;
+
+		for (auto i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			const auto nType = static_cast<EMenuType>(i);
+
+			SProbeResult section{};
+			CopySection(result, section, nType);
+			section.ram.nAvailablePhysical -= section.ram.nAvailablePhysical % REPORT_DELTA_RAM_QUANTUM;
+			for (auto& volume : section.disk.vVolumes)
+				volume.nFreeBytes -= volume.nFreeBytes % REPORT_DELTA_DISK_QUANTUM;
+
+			stBuffer.clear();
+			writer.Add(section, 0, GetSectionBit(nType));
+			writer.Finish(stBuffer);
+			digests.arDigests[i] = HashBytes128(stBuffer.data(), stBuffer.size()).Get64();
+		}
+		return digests;
+	}
+
+	uint16_t GetChangedSections(const SSectionDigests& current, const SSectionDigests& base)
+	{
+		uint16_t nChanged = 0;
+		for (auto i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			if (current.arDigests[i] != base.arDigests[i])
+				nChanged |= GetSectionBit(static_cast<EMenuType>(i));
+		}
+		return nChanged;
+	}
+
+	uint16_t CDeltaReporter::Add(CBinaryReportWriter& writer, const SProbeResult& result, uint64_t nMachineId)
+	{
+		const auto current = ComputeSectionDigests(result);
+
+		uint16_t nSectionMask;
+		if (m_bHasBase)
+		{
+			nSectionMask = GetChangedSections(current, m_base);
+			writer.AddDelta(result, nMachineId, nSectionMask, m_base.GetStateDigest());
+			nSectionMask |= BINARY_REPORT_DELTA;
+		}
+		else
+		{
+			nSectionMask = BINARY_REPORT_ALL_SECTIONS;
+			writer.Add(result, nMachineId, nSectionMask);
+		}
+
+		// An unacknowledged report never becomes the base, the next one is still relative to the old base
+		m_pending = current;
+		m_bPending = true;
+		return nSectionMask;
+	}
+
+	void CDeltaReporter::OnAck(EReportAck nAck)
+	{
+		if (nAck == EReportAck::REPORT_ACK_COMMITTED && m_bPending)
+		{
+			m_base = m_pending;
+			m_bHasBase = true;
+		}
+		else if (nAck == EReportAck::REPORT_ACK_RESYNC)
+		{
+			m_bHasBase = false;
+		}
+		m_bPending = false;
+	}
+
+	bool CDeltaReporter::Save(const std::string& stFileName) const
+	{
+		std::string stBuffer(DELTA_REPORTER_MAGIC, sizeof(DELTA_REPORTER_MAGIC));
+		AppendValue(stBuffer, static_cast<uint8_t>(m_bHasBase));
+		for (const auto nDigest : m_base.arDigests)
+			AppendValue(stBuffer, nDigest);
+
+		std::ofstream ofs(stFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+		return ofs && ofs.write(stBuffer.data(), stBuffer.size());
+	}
+
+	bool CDeltaReporter::Load(const std::string& stFileName)
+	{
+		m_bHasBase = false;
+		m_bPending = false;
+
+		CMappedFile file;
+		if (!file.Open(stFileName) || file.GetSize() != sizeof(DELTA_REPORTER_MAGIC) + 1 + sizeof(m_base.arDigests) ||
+			std::memcmp(file.GetData(), DELTA_REPORTER_MAGIC, sizeof(DELTA_REPORTER_MAGIC)))
+			return false;
+
+		const auto pData = file.GetData() + sizeof(DELTA_REPORTER_MAGIC);
+		std::memcpy(m_base.arDigests.data(), pData + 1, sizeof(m_base.arDigests));
+		m_bHasBase = pData[0] != 0;
+		return true;
+	}
+
+	EDeltaApply CDeltaStateStore::Apply(uint64_t nMachineId, uint16_t nSectionMask, uint64_t nBaseDigest, SProbeResult& result)
+	{
+		auto& shard = __GetShard(nMachineId);
+
+		if (!(nSectionMask & BINARY_REPORT_DELTA))
+		{
+			SMachineState state;
+			state.nStateDigest = ComputeSectionDigests(result).GetStateDigest();
+			EncodeBinaryReport(result, nMachineId, state.stEncoding);
+
+			std::lock_guard <std::mutex> lock(shard.mtx);
+			shard.mapMachines[nMachineId] = std::move(state);
+			return EDeltaApply::DELTA_APPLY_FULL;
+		}
+
+		std::lock_guard <std::mutex> lock(shard.mtx);
+		const auto it = shard.mapMachines.find(nMachineId);
+		if (it == shard.mapMachines.end() || it->second.nStateDigest != nBaseDigest)
+			return EDeltaApply::DELTA_APPLY_RESYNC;
+
+		nSectionMask &= BINARY_REPORT_ALL_SECTIONS;
+		if (!nSectionMask)
+			return EDeltaApply::DELTA_APPLY_UNCHANGED;
+
+		auto& state = it->second;
+		SProbeResult stored;
+		uint64_t nStoredId = 0;
+		if (!DecodeBinaryReport(state.stEncoding.data(), state.stEncoding.size(), stored, nStoredId))
+			return EDeltaApply::DELTA_APPLY_RESYNC;
+
+		for (auto i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			if (nSectionMask & GetSectionBit(static_cast<EMenuType>(i)))
+				CopySection(result, stored, static_cast<EMenuType>(i));
+		}
+		result = std::move(stored);
+
+		state.nStateDigest = ComputeSectionDigests(result).GetStateDigest();
+		state.stEncoding.clear();
+		EncodeBinaryReport(result, nMachineId, state.stEncoding);
+		return EDeltaApply::DELTA_APPLY_CHANGED;
+	}
+
+	size_t CDeltaStateStore::GetMachineCount() const
+	{
+		size_t nCount = 0;
+		for (auto& shard : m_arShards)
+		{
+			std::lock_guard <std::mutex> lock(shard.mtx);
+			nCount += shard.mapMachines.size();
+		}
+		return nCount;
+	}
+
+	bool CDeltaStateStore::Save(const std::string& stFileName) const
+	{
+		std::string stBuffer(DELTA_STATE_MAGIC, sizeof(DELTA_STATE_MAGIC));
+		AppendValue(stBuffer, static_cast<uint64_t>(GetMachineCount()));
+
+		for (auto& shard : m_arShards)
+		{
+			std::lock_guard <std::mutex> lock(shard.mtx);
+			for (const auto& [nMachineId, state] : shard.mapMachines)
+			{
+				AppendValue(stBuffer, nMachineId);
+				AppendValue(stBuffer, state.nStateDigest);
+				AppendValue(stBuffer, static_cast<uint32_t>(state.stEncoding.size()));
+				stBuffer.append(state.stEncoding);
+			}
+		}
+
+		std::ofstream ofs(stFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+		return ofs && ofs.write(stBuffer.data(), stBuffer.size());
+	}
+
+	bool CDeltaStateStore::Load(const std::string& stFileName)
+	{
+		for (auto& shard : m_arShards)
+		{
+			std::lock_guard <std::mutex> lock(shard.mtx);
+			shard.mapMachines.clear();
+		}
+
+		CMappedFile file;
+		if (!file.Open(stFileName))
+			return false;
+
+		const auto pData = file.GetData();
+		const auto nSize = file.GetSize();
+		size_t nOffset = 0;
+
+		auto Read = [&](void* pOut, size_t nLength) {
+			if (nSize - nOffset < nLength)
+				return false;
+			std::memcpy(pOut, pData + nOffset, nLength);
+			nOffset += nLength;
+			return true;
+		};
+
+		char szMagic[sizeof(DELTA_STATE_MAGIC)]{};
+		uint64_t nCount = 0;
+		if (!Read(szMagic, sizeof(szMagic)) || std::memcmp(szMagic, DELTA_STATE_MAGIC, sizeof(szMagic)) || !Read(&nCount, sizeof(nCount)))
+			return false;
+
+		for (uint64_t i = 0; i < nCount; ++i)
+		{
+			uint64_t nMachineId = 0;
+			SMachineState state;
+			uint32_t nLength = 0;
+			if (!Read(&nMachineId, sizeof(nMachineId)) || !Read(&state.nStateDigest, sizeof(state.nStateDigest)) ||
+				!Read(&nLength, sizeof(nLength)) || nSize - nOffset < nLength)
+				return false;
+
+			state.stEncoding.assign(pData + nOffset, nLength);
+			nOffset += nLength;
+
+			auto& shard = __GetShard(nMachineId);
+			std::lock_guard <std::mutex> lock(shard.mtx);
+			shard.mapMachines[nMachineId] = std::move(state);
+		}
+		return nOffset == nSize;
+	}
+};
@@ -0,0 +1,76 @@
+#include "../../include/core/report_frame.hpp"
+#include <cstring>
+
+namespace Win11SysCheck
+{
+	void AppendReportFrame(std::string& stBuffer, EFrameType nType, const char* pPayload, uint32_t nPayloadSize, uint8_t nFlags)
+	{
+		char arHeader[REPORT_FRAME_HEADER_SIZE]{};
+		std::memcpy(arHeader, &nPayloadSize, sizeof(nPayloadSize));
+		arHeader[4] = static_cast<char>(nType);
+		arHeader[5] = static_cast<char>(nFlags);
+
+		stBuffer.append(arHeader, sizeof(arHeader));
+		stBuffer.append(pPayload, nPayloadSize);
+	}
+
+	void AppendJsonReportFrame(std::string& stBuffer, uint64_t nMachineId, const std::string& stDocument)
+	{
+		std::string stPayload(reinterpret_cast<const char*>(&nMachineId), sizeof(nMachineId));
+		stPayload.append(stDocument);
+		AppendReportFrame(stBuffer, EFrameType::FRAME_REPORT_JSON, stPayload.data(), static_cast<uint32_t>(stPayload.size()));
+	}
+
+	void AppendAckFrame(std::string& stBuffer, uint64_t nMachineId, EReportAck nAck)
+	{
+		char arPayload[sizeof(uint64_t) + 1]{};
+		std::memcpy(arPayload, &nMachineId, sizeof(nMachineId));
+		arPayload[sizeof(uint64_t)] = static_cast<char>(nAck);
+		AppendReportFrame(stBuffer, EFrameType::FRAME_ACK, arPayload, sizeof(arPayload));
+	}
+
+	bool ParseAckFrame(const SReportFrame& frame, uint64_t& nMachineId, EReportAck& nAck)
+	{
+		if (frame.nType != EFrameType::FRAME_ACK || frame.nPayloadSize != sizeof(uint64_t) + 1)
+			return false;
+
+		std::memcpy(&nMachineId, frame.pPayload, sizeof(nMachineId));
+		nAck = static_cast<EReportAck>(frame.pPayload[sizeof(uint64_t)]);
+		return true;
+	}
+
+	void CReportFrameReader::Append(const char* pData, size_t nSize)
+	{
+		// Consumed bytes are dropped lazily, once they dominate the buffer
+		if (m_nOffset && m_nOffset >= m_stBuffer.size() / 2)
+		{
+			m_stBuffer.erase(0, m_nOffset);
+			m_nOffset = 0;
+		}
+		m_stBuffer.append(pData, nSize);
+	}
+
+	bool CReportFrameReader::Next(SReportFrame& frame)
+	{
+		if (m_bCorrupt || GetBufferedSize() < REPORT_FRAME_HEADER_SIZE)
+			return false;
+
+		const auto pHeader = m_stBuffer.data() + m_nOffset;
+		uint32_t nPayloadSize = 0;
+		std::memcpy(&nPayloadSize, pHeader, sizeof(nPayloadSize));
+		if (nPayloadSize > REPORT_FRAME_MAX_PAYLOAD)
+		{
+			m_bCorrupt = true;
+			return false;
+		}
+		if (GetBufferedSize() - REPORT_FRAME_HEADER_SIZE < nPayloadSize)
+			return false;
+
+		frame.nType = static_cast<EFrameType>(pHeader[4]);
+		frame.nFlags = static_cast<uint8_t>(pHeader[5]);
+		frame.pPayload = pHeader + REPORT_FRAME_HEADER_SIZE;
+		frame.nPayloadSize = nPayloadSize;
+		m_nOffset += REPORT_FRAME_HEADER_SIZE + nPayloadSize;
+		return true;
+	}
+};
@@ -0,0 +1,687 @@
+#include "../../include/core/result_export.hpp"
+#include "../../include/core/block_compression.hpp"
+#include "../../include/core/cpuid_features.hpp"
+#include "../../include/core/hardware_fingerprint.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <type_traits>
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+namespace Win11SysCheck
+{
+	template <class TWriter>
+	static void WriteString(TWriter& writer, const char* szKey, const std::string& stValue)
+	{
+		writer.Key(szKey);
+		writer.String(stValue.c_str(), static_cast<rapidjson::SizeType>(stValue.size()));
+	}
+	template <class TWriter>
+	static void WriteUint(TWriter& writer, const char* szKey, uint64_t nValue)
+	{
+		writer.Key(szKey);
+		writer.Uint64(nValue);
+	}
+	template <class TWriter>
+	static void WriteInt(TWriter& writer, const char* szKey, int64_t nValue)
+	{
+		writer.Key(szKey);
+		writer.Int64(nValue);
+	}
+	template <class TWriter>
+	static void WriteBool(TWriter& writer, const char* szKey, bool bValue)
+	{
+		writer.Key(szKey);
+		writer.Bool(bValue);
+	}
+
+	// Members of a section object after its status
+	template <class TWriter>
+	static void WriteSectionFacts(TWriter& writer, const SProbeResult& result, EMenuType nType)
+	{
+		switch (nType)
+		{
+		case EMenuType::MENU_TYPE_OS:
+		{
+			const auto& os = result.os;
+			WriteUint(writer, "major_version", os.nMajorVersion);
+			WriteUint(writer, "minor_version", os.nMinorVersion);
+			WriteUint(writer, "service_pack_major", os.nServicePackMajor);
+			WriteUint(writer, "service_pack_minor", os.nServicePackMinor);
+			WriteUint(writer, "build", os.nBuildNumber);
+			WriteUint(writer, "platform_id", os.nPlatformId);
+			WriteUint(writer, "product_type", os.nProductType);
+		} break;
+		case EMenuType::MENU_TYPE_BOOT:
+		{
+			const auto& boot = result.boot;
+			WriteString(writer, "firmware", GetFirmwareKey(boot.nFirmwareType));
+			WriteUint(writer, "flags", boot.nBootFlags);
+			WriteBool(writer, "secure_boot_capable", boot.bSecureBootCapable);
+			WriteBool(writer, "secure_boot_enabled", boot.bSecureBootEnabled);
+			WriteBool(writer, "tpm_present", boot.bTpmPresent);
+			WriteUint(writer, "tpm_version", boot.nTpmVersion);
+		} break;
+		case EMenuType::MENU_TYPE_CPU:
+		{
+			const auto& cpu = result.cpu;
+			WriteString(writer, "vendor", cpu.stVendor);
+			WriteString(writer, "name", cpu.stName);
+			WriteString(writer, "architecture", GetArchitectureKey(cpu.nArchitecture));
+			WriteUint(writer, "family", cpu.nFamily);
+			WriteUint(writer, "model", cpu.nModel);
+			WriteUint(writer, "stepping", cpu.nStepping);
+			WriteUint(writer, "platform_field", cpu.nPlatformSpecificField);
+			WriteUint(writer, "active_processors", cpu.nActiveProcessorCount);
+			WriteUint(writer, "processors", cpu.nProcessorCount);
+			WriteUint(writer, "max_mhz", cpu.nMaxMhz);
+			WriteUint(writer, "fast_processors", cpu.nFastProcessorCount);
+			WriteBool(writer, "arm_v81_atomics", cpu.bArmV81Atomics);
+			WriteString(writer, "features", FormatCPUFeatures(cpu.nFeatures));
+		} break;
+		case EMenuType::MENU_TYPE_RAM:
+		{
+			WriteUint(writer, "total_bytes", result.ram.nTotalPhysical);
+			WriteUint(writer, "available_bytes", result.ram.nAvailablePhysical);
+		} break;
+		case EMenuType::MENU_TYPE_DISK:
+		{
+			writer.Key("volumes");
+			writer.StartArray();
+			for (const auto& volume : result.disk.vVolumes)
+			{
+				writer.StartObject();
+				WriteString(writer, "path", volume.stPath);
+				WriteString(writer, "device", volume.stDeviceName);
+				WriteString(writer, "label", volume.stVolumeName);
+				WriteString(writer, "file_system", volume.stFileSystem);
+				WriteString(writer, "partition_style", GetPartitionKey(volume.nPartitionStyle));
+				WriteUint(writer, "total_bytes", volume.nTotalBytes);
+				WriteUint(writer, "free_bytes", volume.nFreeBytes);
+				writer.EndObject();
+			}
+			writer.EndArray();
+		} break;
+		case EMenuType::MENU_TYPE_DISPLAY:
+		{
+			const auto& display = result.display;
+			WriteUint(writer, "directx_major", display.nDirectXMajor);
+			WriteUint(writer, "directx_minor", display.nDirectXMinor);
+			writer.Key("monitors");
+			writer.StartArray();
+			for (const auto& monitor : display.vMonitors)
+			{
+				writer.StartObject();
+				WriteString(writer, "device_id", monitor.stDeviceID);
+				WriteString(writer, "device_name", monitor.stDeviceName);
+				WriteString(writer, "device_string", monitor.stDeviceString);
+				WriteBool(writer, "primary", monitor.bPrimary);
+				WriteUint(writer, "bits_per_pixel", monitor.nBitsPerPixel);
+				WriteInt(writer, "width", monitor.nWidth);
+				WriteInt(writer, "height", monitor.nHeight);
+				writer.EndObject();
+			}
+			writer.EndArray();
+			writer.Key("panels");
+			writer.StartArray();
+			for (const auto& panel : display.vPanels)
+			{
+				writer.StartObject();
+				WriteString(writer, "registry_path", panel.stRegistryPath);
+				WriteUint(writer, "width_cm", panel.nWidthCm);
+				WriteUint(writer, "height_cm", panel.nHeightCm);
+				writer.EndObject();
+			}
+			writer.EndArray();
+			writer.Key("adapters");
+			writer.StartArray();
+			for (const auto& adapter : display.vAdapters)
+			{
+				writer.StartObject();
+				WriteString(writer, "description", adapter.stDescription);
+				WriteString(writer, "driver_model", adapter.stDriverModel);
+				writer.EndObject();
+			}
+			writer.EndArray();
+		} break;
+		case EMenuType::MENU_TYPE_INTERNET:
+		{
+			WriteBool(writer, "connected", result.internet.bConnected);
+			WriteBool(writer, "reachable", result.internet.bReachable);
+		} break;
+		default:
+			break;
+		}
+	}
+
+	template <class TStream>
+	static void WriteResultDocument(const SProbeResult& result, TStream& stream)
+	{
+		rapidjson::Writer <TStream> writer(stream);
+
+		writer.StartObject();
+		WriteString(writer, "schema", RESULT_SCHEMA_ID);
+		WriteUint(writer, "version", RESULT_SCHEMA_VERSION);
+		if (result.nMachineId)
+			WriteUint(writer, "machine_id", result.nMachineId);
+
+		for (auto i = static_cast<uint8_t>(EMenuType::MENU_TYPE_SUMMARY); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			const auto nType = static_cast<EMenuType>(i);
+			writer.Key(GetMenuTypeKey(nType).c_str());
+			writer.StartObject();
+			WriteString(writer, "status", GetStatusKey(result.GetStatus(nType)));
+			WriteSectionFacts(writer, result, nType);
+			writer.EndObject();
+		}
+
+		writer.EndObject();
+	}
+
+	std::string SerializeResultJson(const SProbeResult& result)
+	{
+		rapidjson::StringBuffer s;
+		WriteResultDocument(result, s);
+		return std::string(s.GetString(), s.GetSize());
+	}
+
+	bool WriteResultJson(const SProbeResult& result, COutputFile& file)
+	{
+		WriteResultDocument(result, file);
+		return !file.IsFailed();
+	}
+
+	bool WriteResultSectionJson(const SProbeResult& result, uint64_t nMachineId, EMenuType nType, COutputFile& file)
+	{
+		rapidjson::Writer <COutputFile> writer(file);
+
+		writer.StartObject();
+		WriteString(writer, "schema", RESULT_SCHEMA_ID);
+		WriteUint(writer, "version", RESULT_SCHEMA_VERSION);
+		WriteUint(writer, "machine_id", nMachineId);
+		WriteString(writer, "section", GetMenuTypeKey(nType));
+		WriteString(writer, "status", GetStatusKey(result.GetStatus(nType)));
+		WriteSectionFacts(writer, result, nType);
+		writer.EndObject();
+		return !file.IsFailed();
+	}
+
+	// Each reader leaves the value untouched for a missing member and fails for a mistyped one
+	static bool ReadField(const rapidjson::Value& object, const char* szKey, std::string& stValue)
+	{
+		const auto it = object.FindMember(szKey);
+		if (it == object.MemberEnd())
+			return true;
+		if (!it->value.IsString())
+			return false;
+		stValue.assign(it->value.GetString(), it->value.GetStringLength());
+		return true;
+	}
+	static bool ReadField(const rapidjson::Value& object, const char* szKey, bool& bValue)
+	{
+		const auto it = object.FindMember(szKey);
+		if (it == object.MemberEnd())
+			return true;
+		if (!it->value.IsBool())
+			return false;
+		bValue = it->value.GetBool();
+		return true;
+	}
+	template <class T>
+	static bool ReadField(const rapidjson::Value& object, const char* szKey, T& nValue)
+	{
+		static_assert(std::is_integral_v<T>, "Integral field expected");
+
+		const auto it = object.FindMember(szKey);
+		if (it == object.MemberEnd())
+			return true;
+
+		if constexpr (std::is_signed_v<T>)
+		{
+			if (!it->value.IsInt64())
+				return false;
+			const auto nRaw = it->value.GetInt64();
+			if (nRaw < (std::numeric_limits<T>::min)() || nRaw > (std::numeric_limits<T>::max)())
+				return false;
+			nValue = static_cast<T>(nRaw);
+		}
+		else
+		{
+			if (!it->value.IsUint64())
+				return false;
+			const auto nRaw = it->value.GetUint64();
+			if (nRaw > (std::numeric_limits<T>::max)())
+				return false;
+			nValue = static_cast<T>(nRaw);
+		}
+		return true;
+	}
+
+	// Enum values are written through their key function, unknown keys map to the fallback
+	template <class T, size_t N>
+	static bool ReadKeyField(const rapidjson::Value& object, const char* szKey, std::string(*pfnGetKey)(T), const T(&arValues)[N], T nFallback, T& nValue)
+	{
+		std::string stKey;
+		if (!object.HasMember(szKey))
+			return true;
+		if (!ReadField(object, szKey, stKey))
+			return false;
+
+		nValue = nFallback;
+		for (const auto nCandidate : arValues)
+		{
+			if (pfnGetKey(nCandidate) == stKey)
+			{
+				nValue = nCandidate;
+				break;
+			}
+		}
+		return true;
+	}
+
+	// Feature names, see FormatCPUFeatures
+	static bool ReadFeaturesField(const rapidjson::Value& object, const char* szKey, uint64_t& nFeatures)
+	{
+		std::string stFeatures;
+		if (!object.HasMember(szKey))
+			return true;
+		if (!ReadField(object, szKey, stFeatures))
+			return false;
+
+		nFeatures = ParseCPUFeatures(stFeatures);
+		return true;
+	}
+
+	static constexpr EFirmwareType gs_arFirmwareTypes[]{ EFirmwareType::FIRMWARE_BIOS, EFirmwareType::FIRMWARE_UEFI };
+	static constexpr EPartitionStyle gs_arPartitionStyles[]{ EPartitionStyle::PARTITION_MBR, EPartitionStyle::PARTITION_GPT, EPartitionStyle::PARTITION_RAW };
+	static constexpr EProcessorArchitecture gs_arArchitectures[]{
+		EProcessorArchitecture::ARCHITECTURE_INTEL, EProcessorArchitecture::ARCHITECTURE_ARM, EProcessorArchitecture::ARCHITECTURE_IA64,
+		EProcessorArchitecture::ARCHITECTURE_AMD64, EProcessorArchitecture::ARCHITECTURE_ARM64
+	};
+	static constexpr EStatus gs_arStatuses[]{ EStatus::STATUS_INITIALIZING, EStatus::STATUS_OK, EStatus::STATUS_FAIL };
+
+	// Missing sections read as an empty object, a missing status keeps the current one
+	static const rapidjson::Value& GetSection(const rapidjson::Value& document, EMenuType nType, SProbeResult& result, bool& bValid)
+	{
+		static const rapidjson::Value sc_emptyObject(rapidjson::kObjectType);
+
+		const auto it = document.FindMember(GetMenuTypeKey(nType).c_str());
+		if (it == document.MemberEnd())
+			return sc_emptyObject;
+		if (!it->value.IsObject())
+		{
+			bValid = false;
+			return sc_emptyObject;
+		}
+
+		auto nStatus = result.GetStatus(nType);
+		bValid = ReadKeyField(it->value, "status", &GetStatusKey, gs_arStatuses, EStatus::STATUS_UNKNOWN, nStatus) && bValid;
+		result.SetStatus(nType, nStatus);
+		return it->value;
+	}
+
+	template <class T, class TReader>
+	static bool ReadArray(const rapidjson::Value& section, const char* szKey, std::vector <T>& vItems, TReader&& reader)
+	{
+		const auto it = section.FindMember(szKey);
+		if (it == section.MemberEnd())
+			return true;
+		if (!it->value.IsArray())
+			return false;
+
+		vItems.clear();
+		vItems.reserve(it->value.Size());
+		for (const auto& item : it->value.GetArray())
+		{
+			if (!item.IsObject())
+				return false;
+			vItems.emplace_back();
+			if (!reader(item, vItems.back()))
+				return false;
+		}
+		return true;
+	}
+
+	static bool ParseSchemaDocument(const char* pData, size_t nSize, const char* szSchema, rapidjson::Document& document)
+	{
+		document.Parse(pData, nSize);
+		if (document.HasParseError() || !document.IsObject())
+			return false;
+
+		std::string stSchema;
+		uint32_t nVersion = 0;
+		if (!ReadField(document, "schema", stSchema) || stSchema != szSchema)
+			return false;
+		return ReadField(document, "version", nVersion) && nVersion && nVersion <= RESULT_SCHEMA_VERSION;
+	}
+
+	// Sections and members present in the document overwrite the result, arrays as a whole
+	static bool ReadResultSections(const rapidjson::Value& document, SProbeResult& result)
+	{
+		bool bValid = true;
+		GetSection(document, EMenuType::MENU_TYPE_SUMMARY, result, bValid);
+
+		const auto& os = GetSection(document, EMenuType::MENU_TYPE_OS, result, bValid);
+		bValid = bValid &&
+			ReadField(os, "major_version", result.os.nMajorVersion) &&
+			ReadField(os, "minor_version", result.os.nMinorVersion) &&
+			ReadField(os, "service_pack_major", result.os.nServicePackMajor) &&
+			ReadField(os, "service_pack_minor", result.os.nServicePackMinor) &&
+			ReadField(os, "build", result.os.nBuildNumber) &&
+			ReadField(os, "platform_id", result.os.nPlatformId) &&
+			ReadField(os, "product_type", result.os.nProductType);
+
+		const auto& boot = GetSection(document, EMenuType::MENU_TYPE_BOOT, result, bValid);
+		bValid = bValid &&
+			ReadKeyField(boot, "firmware", &GetFirmwareKey, gs_arFirmwareTypes, EFirmwareType::FIRMWARE_UNKNOWN, result.boot.nFirmwareType) &&
+			ReadField(boot, "flags", result.boot.nBootFlags) &&
+			ReadField(boot, "secure_boot_capable", result.boot.bSecureBootCapable) &&
+			ReadField(boot, "secure_boot_enabled", result.boot.bSecureBootEnabled) &&
+			ReadField(boot, "tpm_present", result.boot.bTpmPresent) &&
+			ReadField(boot, "tpm_version", result.boot.nTpmVersion);
+
+		const auto& cpu = GetSection(document, EMenuType::MENU_TYPE_CPU, result, bValid);
+		bValid = bValid &&
+			ReadField(cpu, "vendor", result.cpu.stVendor) &&
+			ReadField(cpu, "name", result.cpu.stName) &&
+			ReadKeyField(cpu, "architecture", &GetArchitectureKey, gs_arArchitectures, EProcessorArchitecture::ARCHITECTURE_UNKNOWN, result.cpu.nArchitecture) &&
+			ReadField(cpu, "family", result.cpu.nFamily) &&
+			ReadField(cpu, "model", result.cpu.nModel) &&
+			ReadField(cpu, "stepping", result.cpu.nStepping) &&
+			ReadField(cpu, "platform_field", result.cpu.nPlatformSpecificField) &&
+			ReadField(cpu, "active_processors", result.cpu.nActiveProcessorCount) &&
+			ReadField(cpu, "processors", result.cpu.nProcessorCount) &&
+			ReadField(cpu, "max_mhz", result.cpu.nMaxMhz) &&
+			ReadField(cpu, "fast_processors", result.cpu.nFastProcessorCount) &&
+			ReadField(cpu, "arm_v81_atomics", result.cpu.bArmV81Atomics) &&
+			ReadFeaturesField(cpu, "features", result.cpu.nFeatures);
+
+		const auto& ram = GetSection(document, EMenuType::MENU_TYPE_RAM, result, bValid);
+		bValid = bValid &&
+			ReadField(ram, "total_bytes", result.ram.nTotalPhysical) &&
+			ReadField(ram, "available_bytes", result.ram.nAvailablePhysical);
+
+		const auto& disk = GetSection(document, EMenuType::MENU_TYPE_DISK, result, bValid);
+		bValid = bValid && ReadArray(disk, "volumes", result.disk.vVolumes, [](const rapidjson::Value& item, SVolumeFacts& volume) {
+			return
+				ReadField(item, "path", volume.stPath) &&
+				ReadField(item, "device", volume.stDeviceName) &&
+				ReadField(item, "label", volume.stVolumeName) &&
+				ReadField(item, "file_system", volume.stFileSystem) &&
+				ReadKeyField(item, "partition_style", &GetPartitionKey, gs_arPartitionStyles, EPartitionStyle::PARTITION_UNKNOWN, volume.nPartitionStyle) &&
+				ReadField(item, "total_bytes", volume.nTotalBytes) &&
+				ReadField(item, "free_bytes", volume.nFreeBytes);
+		});
+
+		const auto& display = GetSection(document, EMenuType::MENU_TYPE_DISPLAY, result, bValid);
+		bValid = bValid &&
+			ReadField(display, "directx_major", result.display.nDirectXMajor) &&
+			ReadField(display, "directx_minor", result.display.nDirectXMinor) &&
+			ReadArray(display, "monitors", result.display.vMonitors, [](const rapidjson::Value& item, SMonitorFacts& monitor) {
+				return
+					ReadField(item, "device_id", monitor.stDeviceID) &&
+					ReadField(item, "device_name", monitor.stDeviceName) &&
+					ReadField(item, "device_string", monitor.stDeviceString) &&
+					ReadField(item, "primary", monitor.bPrimary) &&
+					ReadField(item, "bits_per_pixel", monitor.nBitsPerPixel) &&
+					ReadField(item, "width", monitor.nWidth) &&
+					ReadField(item, "height", monitor.nHeight);
+			}) &&
+			ReadArray(display, "panels", result.display.vPanels, [](const rapidjson::Value& item, SPanelFacts& panel) {
+				return
+					ReadField(item, "registry_path", panel.stRegistryPath) &&
+					ReadField(item, "width_cm", panel.nWidthCm) &&
+					ReadField(item, "height_cm", panel.nHeightCm);
+			}) &&
+			ReadArray(display, "adapters", result.display.vAdapters, [](const rapidjson::Value& item, SGraphicsAdapterFacts& adapter) {
+				return
+					ReadField(item, "description", adapter.stDescription) &&
+					ReadField(item, "driver_model", adapter.stDriverModel);
+			});
+
+		const auto& internet = GetSection(document, EMenuType::MENU_TYPE_INTERNET, result, bValid);
+		bValid = bValid &&
+			ReadField(internet, "connected", result.internet.bConnected) &&
+			ReadField(internet, "reachable", result.internet.bReachable);
+
+		return bValid;
+	}
+
+	bool ParseResultJson(const char* pData, size_t nSize, SProbeResult& result)
+	{
+		result = {};
+
+		rapidjson::Document document;
+		return ParseSchemaDocument(pData, nSize, RESULT_SCHEMA_ID, document) && ReadField(document, "machine_id", result.nMachineId) &&
+			ReadResultSections(document, result);
+	}
+
+	static size_t SkipWhitespace(const char* pData, size_t nSize, size_t nPos)
+	{
+		while (nPos < nSize && (pData[nPos] == ' ' || pData[nPos] == '\t' || pData[nPos] == '\n' || pData[nPos] == '\r'))
+			nPos++;
+		return nPos;
+	}
+
+	// Position after the leading schema key, zero when the document does not start with it
+	static size_t FindSchemaValue(const char* pData, size_t nSize)
+	{
+		static constexpr char sc_szSchemaKey[] = "\"schema\"";
+
+		auto nPos = SkipWhitespace(pData, nSize, 0);
+		if (nPos >= nSize || pData[nPos] != '{')
+			return 0;
+		nPos = SkipWhitespace(pData, nSize, nPos + 1);
+		if (nSize - nPos < sizeof(sc_szSchemaKey) - 1 || std::memcmp(pData + nPos, sc_szSchemaKey, sizeof(sc_szSchemaKey) - 1))
+			return 0;
+		return nPos + sizeof(sc_szSchemaKey) - 1;
+	}
+
+	// Exact match of the schema string, "win11syscheck.result" is a prefix of the delta schema
+	static bool HasSchemaValue(const char* pData, size_t nSize, const char* szSchema)
+	{
+		auto nPos = FindSchemaValue(pData, nSize);
+		if (!nPos)
+			return false;
+		nPos = SkipWhitespace(pData, nSize, nPos);
+		if (nPos >= nSize || pData[nPos] != ':')
+			return false;
+		nPos = SkipWhitespace(pData, nSize, nPos + 1);
+
+		const auto nLength = std::strlen(szSchema);
+		return nSize - nPos >= nLength + 2 && pData[nPos] == '"' && !std::memcmp(pData + nPos + 1, szSchema, nLength) && pData[nPos + 1 + nLength] == '"';
+	}
+
+	bool IsResultJson(const char* pData, size_t nSize)
+	{
+		return HasSchemaValue(pData, nSize, RESULT_SCHEMA_ID);
+	}
+
+	bool ParseExportedJson(const char* pData, size_t nSize, SProbeResult& result, const SLegacyLabels& labels)
+	{
+		if (IsResultJson(pData, nSize))
+			return ParseResultJson(pData, nSize, result);
+		// Deltas only mean something on top of their base, see LoadResultExport
+		if (IsResultDeltaJson(pData, nSize))
+			return false;
+		return ParseLegacyJson(pData, nSize, result, labels);
+	}
+
+	static std::string FormatDigest(uint64_t nDigest)
+	{
+		char szDigest[16]{};
+		const auto res = std::to_chars(szDigest, szDigest + sizeof(szDigest), nDigest, 16);
+		return std::string(sizeof(szDigest) - (res.ptr - szDigest), '0') + std::string(szDigest, res.ptr);
+	}
+
+	static uint64_t HashResultDocument(const std::string& stDocument)
+	{
+		return HashBytes128(stDocument.data(), stDocument.size()).Get64();
+	}
+
+	uint64_t ComputeResultDigest(const SProbeResult& result)
+	{
+		return HashResultDocument(SerializeResultJson(result));
+	}
+
+	// Both results go through the same writer, members are compared as parsed values
+	bool WriteResultDeltaJson(const SProbeResult& base, const std::string& stBaseFile, const SProbeResult& result, COutputFile& file, size_t& nChangedCount)
+	{
+		const auto stBase = SerializeResultJson(base);
+		const auto stCurrent = SerializeResultJson(result);
+
+		rapidjson::Document baseDocument, document;
+		baseDocument.Parse(stBase.data(), stBase.size());
+		document.Parse(stCurrent.data(), stCurrent.size());
+		if (baseDocument.HasParseError() || document.HasParseError())
+			return false;
+
+		rapidjson::Writer <COutputFile> writer(file);
+		writer.StartObject();
+		WriteString(writer, "schema", RESULT_DELTA_SCHEMA_ID);
+		WriteUint(writer, "version", RESULT_SCHEMA_VERSION);
+		WriteString(writer, "base", stBaseFile);
+		WriteString(writer, "base_digest", FormatDigest(HashResultDocument(stBase)));
+		WriteString(writer, "digest", FormatDigest(HashResultDocument(stCurrent)));
+		if (result.nMachineId != base.nMachineId)
+			WriteUint(writer, "machine_id", result.nMachineId);
+
+		nChangedCount = 0;
+		for (auto i = static_cast<uint8_t>(EMenuType::MENU_TYPE_SUMMARY); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			const auto stKey = GetMenuTypeKey(static_cast<EMenuType>(i));
+			const auto& section = document[stKey.c_str()];
+			const auto itBase = baseDocument.FindMember(stKey.c_str());
+
+			auto bStarted = false;
+			for (const auto& member : section.GetObject())
+			{
+				if (itBase != baseDocument.MemberEnd())
+				{
+					const auto itMember = itBase->value.FindMember(member.name);
+					if (itMember != itBase->value.MemberEnd() && itMember->value == member.value)
+						continue;
+				}
+				if (!bStarted)
+				{
+					writer.Key(stKey.c_str());
+					writer.StartObject();
+					bStarted = true;
+				}
+				writer.Key(member.name.GetString(), member.name.GetStringLength());
+				member.value.Accept(writer);
+				nChangedCount++;
+			}
+			if (bStarted)
+				writer.EndObject();
+		}
+
+		writer.EndObject();
+		return !file.IsFailed();
+	}
+
+	bool IsResultDeltaJson(const char* pData, size_t nSize)
+	{
+		return HasSchemaValue(pData, nSize, RESULT_DELTA_SCHEMA_ID);
+	}
+
+	bool ReadResultDeltaBase(const char* pData, size_t nSize, std::string& stBaseFile)
+	{
+		rapidjson::Document document;
+		if (!ParseSchemaDocument(pData, nSize, RESULT_DELTA_SCHEMA_ID, document))
+			return false;
+
+		stBaseFile.clear();
+		return ReadField(document, "base", stBaseFile) && !stBaseFile.empty();
+	}
+
+	bool ApplyResultDeltaJson(const char* pData, size_t nSize, SProbeResult& result)
+	{
+		rapidjson::Document document;
+		if (!ParseSchemaDocument(pData, nSize, RESULT_DELTA_SCHEMA_ID, document))
+			return false;
+
+		std::string stBaseDigest, stDigest;
+		if (!ReadField(document, "base_digest", stBaseDigest) || !ReadField(document, "digest", stDigest))
+			return false;
+		if (stBaseDigest != FormatDigest(ComputeResultDigest(result)))
+			return false;
+
+		return ReadField(document, "machine_id", result.nMachineId) && ReadResultSections(document, result) &&
+			stDigest == FormatDigest(ComputeResultDigest(result));
+	}
+
+	static bool ReadExportFile(const std::string& stFileName, std::string& stDocument)
+	{
+		CMappedFile input;
+		if (!input.Open(stFileName))
+			return false;
+
+		if (IsCompressedStream(input.GetData(), input.GetSize()))
+			return DecompressStream(input.GetData(), input.GetSize(), stDocument);
+
+		stDocument.assign(input.GetData(), input.GetSize());
+		return true;
+	}
+
+	// Walks from the delta back to the full export, then applies the deltas oldest first
+	// Statuses are part of every delta and digest, a legacy document gets them from the rules
+	static bool ParseBaseExport(const char* pData, size_t nSize, SProbeResult& result, const SLegacyLabels& labels)
+	{
+		if (!ParseExportedJson(pData, nSize, result, labels))
+			return false;
+		if (!IsResultJson(pData, nSize))
+			EvaluateReadiness(result);
+		return true;
+	}
+
+	bool ParseResultExport(const char* pData, size_t nSize, const std::string& stFileName, SProbeResult& result, const SLegacyLabels& labels)
+	{
+		std::string stDecompressed;
+		if (IsCompressedStream(pData, nSize))
+		{
+			if (!DecompressStream(pData, nSize, stDecompressed))
+				return false;
+			pData = stDecompressed.data();
+			nSize = stDecompressed.size();
+		}
+		if (!IsResultDeltaJson(pData, nSize))
+			return ParseBaseExport(pData, nSize, result, labels);
+
+		std::vector <std::string> vDeltas;
+		auto path = std::filesystem::path(stFileName);
+		std::string stDocument(pData, nSize);
+		while (IsResultDeltaJson(stDocument.data(), stDocument.size()))
+		{
+			std::string stBaseFile;
+			if (vDeltas.size() == RESULT_DELTA_MAX_CHAIN || !ReadResultDeltaBase(stDocument.data(), stDocument.size(), stBaseFile))
+				return false;
+			vDeltas.emplace_back(std::move(stDocument));
+
+			// Bases live next to their deltas, anything but a file name is ignored
+			path = path.parent_path() / std::filesystem::path(stBaseFile).filename();
+			if (!ReadExportFile(path.string(), stDocument))
+				return false;
+		}
+
+		if (!ParseBaseExport(stDocument.data(), stDocument.size(), result, labels))
+			return false;
+		for (auto it = vDeltas.rbegin(); it != vDeltas.rend(); ++it)
+		{
+			if (!ApplyResultDeltaJson(it->data(), it->size(), result))
+				return false;
+		}
+		return true;
+	}
+
+	bool LoadResultExport(const std::string& stFileName, SProbeResult& result, const SLegacyLabels& labels)
+	{
+		CMappedFile input;
+		return input.Open(stFileName) && ParseResultExport(input.GetData(), input.GetSize(), stFileName, result, labels);
+	}
+};
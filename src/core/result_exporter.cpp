@@ -0,0 +1,241 @@
+#include "../../include/core/result_exporter.hpp"
+#include "../../include/core/binary_report.hpp"
+#include "../../include/core/fleet_record.hpp"
+#include "../../include/core/report_frame.hpp"
+#include "../../include/core/result_image.hpp"
+#include <charconv>
+
+namespace Win11SysCheck
+{
+	std::string GetExportFormatKey(EExportFormat nFormat)
+	{
+		switch (nFormat)
+		{
+		case EExportFormat::EXPORT_FORMAT_JSON:
+			return "json";
+		case EExportFormat::EXPORT_FORMAT_LEGACY:
+			return "legacy";
+		case EExportFormat::EXPORT_FORMAT_CSV:
+			return "csv";
+		case EExportFormat::EXPORT_FORMAT_NDJSON:
+			return "ndjson";
+		case EExportFormat::EXPORT_FORMAT_BINARY:
+			return "binary";
+		case EExportFormat::EXPORT_FORMAT_IMAGE:
+			return "image";
+		default:
+			return "unknown";
+		}
+	}
+
+	std::string GetExportFileExtension(EExportFormat nFormat)
+	{
+		switch (nFormat)
+		{
+		case EExportFormat::EXPORT_FORMAT_CSV:
+			return "csv";
+		case EExportFormat::EXPORT_FORMAT_NDJSON:
+			return "ndjson";
+		case EExportFormat::EXPORT_FORMAT_BINARY:
+			return "bin";
+		case EExportFormat::EXPORT_FORMAT_IMAGE:
+			return "img";
+		default:
+			return "json";
+		}
+	}
+
+	EExportFormat FindExportFormat(const std::string& stKey)
+	{
+		for (auto i = 0; i < static_cast<int>(EExportFormat::EXPORT_FORMAT_MAX); ++i)
+		{
+			if (GetExportFormatKey(static_cast<EExportFormat>(i)) == stKey)
+				return static_cast<EExportFormat>(i);
+		}
+		return EExportFormat::EXPORT_FORMAT_MAX;
+	}
+
+	void AppendCsvField(std::string& stLine, const std::string& stValue)
+	{
+		if (stValue.find_first_of(",\"\r\n") == std::string::npos)
+		{
+			stLine += stValue;
+			return;
+		}
+
+		stLine += '"';
+		for (const auto c : stValue)
+		{
+			if (c == '"')
+				stLine += '"';
+			stLine += c;
+		}
+		stLine += '"';
+	}
+
+	class CJsonResultExporter : public CResultExporter
+	{
+	public:
+		explicit CJsonResultExporter(COutputFile& file) : CResultExporter(file) {};
+
+		bool Add(const SProbeResult& result, uint64_t) override
+		{
+			WriteResultJson(result, m_file);
+			m_file.Put('\n');
+			return !m_file.IsFailed();
+		}
+	};
+
+	class CLegacyResultExporter : public CResultExporter
+	{
+	public:
+		CLegacyResultExporter(COutputFile& file, const SLegacyLabels& labels) : CResultExporter(file), m_labels(labels) {};
+
+		bool Add(const SProbeResult& result, uint64_t) override
+		{
+			WriteLegacyJson(result, m_labels, m_file);
+			m_file.Put('\n');
+			return !m_file.IsFailed();
+		}
+
+	private:
+		SLegacyLabels m_labels;
+	};
+
+	class CNdjsonResultExporter : public CResultExporter
+	{
+	public:
+		explicit CNdjsonResultExporter(COutputFile& file) : CResultExporter(file) {};
+
+		bool Add(const SProbeResult& result, uint64_t nMachineId) override
+		{
+			for (auto i = static_cast<uint8_t>(EMenuType::MENU_TYPE_SUMMARY); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+			{
+				WriteResultSectionJson(result, nMachineId, static_cast<EMenuType>(i), m_file);
+				m_file.Put('\n');
+			}
+			return !m_file.IsFailed();
+		}
+	};
+
+	class CCsvResultExporter : public CResultExporter
+	{
+	public:
+		explicit CCsvResultExporter(COutputFile& file) : CResultExporter(file)
+		{
+			for (size_t i = 0; i < static_cast<size_t>(EFleetColumn::COLUMN_MAX); ++i)
+			{
+				if (i)
+					m_stLine += ',';
+				m_stLine += GetFleetColumnInfo(static_cast<EFleetColumn>(i)).szName;
+			}
+			m_stLine += '\n';
+			m_file.Write(m_stLine.data(), m_stLine.size());
+		};
+
+		bool Add(const SProbeResult& result, uint64_t nMachineId) override
+		{
+			const auto record = MakeFleetRecord(result, nMachineId);
+
+			m_stLine.clear();
+			for (size_t i = 0; i < static_cast<size_t>(EFleetColumn::COLUMN_MAX); ++i)
+			{
+				const auto& column = GetFleetColumnInfo(static_cast<EFleetColumn>(i));
+				if (i)
+					m_stLine += ',';
+				if (column.nKind == EFleetColumnKind::COLUMN_KIND_NUMBER)
+				{
+					char szNumber[24];
+					const auto res = std::to_chars(szNumber, szNumber + sizeof(szNumber), column.pfnGetNumber(record));
+					m_stLine.append(szNumber, res.ptr);
+				}
+				else
+				{
+					AppendCsvField(m_stLine, record.*column.pString);
+				}
+			}
+			m_stLine += '\n';
+			return m_file.Write(m_stLine.data(), m_stLine.size());
+		}
+
+	private:
+		std::string m_stLine;
+	};
+
+	// Batches are cut every EXPORT_BINARY_BATCH_SIZE reports so the string table stays bounded
+	class CBinaryResultExporter : public CResultExporter
+	{
+	public:
+		explicit CBinaryResultExporter(COutputFile& file) : CResultExporter(file) {};
+
+		bool Add(const SProbeResult& result, uint64_t nMachineId) override
+		{
+			m_writer.Add(result, nMachineId);
+			if (m_writer.GetReportCount() >= EXPORT_BINARY_BATCH_SIZE)
+				__WriteBatch();
+			return !m_file.IsFailed();
+		}
+		bool Finish() override
+		{
+			if (m_writer.GetReportCount())
+				__WriteBatch();
+			return !m_file.IsFailed();
+		}
+
+	protected:
+		void __WriteBatch()
+		{
+			m_stBatch.clear();
+			m_writer.Finish(m_stBatch);
+			m_stFrame.clear();
+			AppendReportFrame(m_stFrame, EFrameType::FRAME_REPORT_BATCH, m_stBatch.data(), static_cast<uint32_t>(m_stBatch.size()));
+			m_file.Write(m_stFrame.data(), m_stFrame.size());
+		}
+
+	private:
+		CBinaryReportWriter m_writer;
+		std::string m_stBatch;
+		std::string m_stFrame;
+	};
+
+	// The image is laid out once every machine is known
+	class CImageResultExporter : public CResultExporter
+	{
+	public:
+		explicit CImageResultExporter(COutputFile& file) : CResultExporter(file) {};
+
+		bool Add(const SProbeResult& result, uint64_t nMachineId) override
+		{
+			m_writer.Add(result, nMachineId);
+			return !m_file.IsFailed();
+		}
+		bool Finish() override
+		{
+			return m_writer.Write(m_file) && !m_file.IsFailed();
+		}
+
+	private:
+		CResultImageWriter m_writer;
+	};
+
+	std::unique_ptr <CResultExporter> CreateResultExporter(EExportFormat nFormat, COutputFile& file, const SLegacyLabels& labels)
+	{
+		switch (nFormat)
+		{
+		case EExportFormat::EXPORT_FORMAT_JSON:
+			return std::make_unique<CJsonResultExporter>(file);
+		case EExportFormat::EXPORT_FORMAT_LEGACY:
+			return std::make_unique<CLegacyResultExporter>(file, labels);
+		case EExportFormat::EXPORT_FORMAT_CSV:
+			return std::make_unique<CCsvResultExporter>(file);
+		case EExportFormat::EXPORT_FORMAT_NDJSON:
+			return std::make_unique<CNdjsonResultExporter>(file);
+		case EExportFormat::EXPORT_FORMAT_BINARY:
+			return std::make_unique<CBinaryResultExporter>(file);
+		case EExportFormat::EXPORT_FORMAT_IMAGE:
+			return std::make_unique<CImageResultExporter>(file);
+		default:
+			return nullptr;
+		}
+	}
+};
@@ -0,0 +1,421 @@
+#include "../../include/core/result_image.hpp"
+#include "../../include/core/block_compression.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace Win11SysCheck
+{
+	static constexpr char RESULT_IMAGE_MAGIC[8]{ 'W', '1', '1', 'R', 'I', 'M', 'G', '1' };
+	static constexpr size_t RESULT_IMAGE_SECTION_COUNT = static_cast<size_t>(EResultImageSection::IMAGE_SECTION_MAX) - 1;
+
+	static constexpr uint32_t gs_arMinEntrySizes[RESULT_IMAGE_SECTION_COUNT]{
+		RESULT_IMAGE_MACHINE_V1_SIZE, sizeof(SImageVolume), sizeof(SImageMonitor), sizeof(SImagePanel), sizeof(SImageAdapter), 1
+	};
+
+	static size_t GetSectionIndex(EResultImageSection nSection)
+	{
+		return static_cast<size_t>(nSection) - 1;
+	}
+
+	static size_t AlignImageOffset(size_t nOffset)
+	{
+		return (nOffset + RESULT_IMAGE_ALIGNMENT - 1) & ~(RESULT_IMAGE_ALIGNMENT - 1);
+	}
+
+	template <class T>
+	static SImageRange AppendRecords(std::vector <T>& vRecords, size_t nCount)
+	{
+		const SImageRange range{ static_cast<uint32_t>(vRecords.size()), static_cast<uint32_t>(nCount) };
+		vRecords.resize(vRecords.size() + nCount, T{});
+		return range;
+	}
+
+	SImageString CResultImageWriter::__Intern(const std::string& stValue)
+	{
+		if (stValue.empty())
+			return {};
+
+		const auto it = m_mapStrings.find(stValue);
+		if (it != m_mapStrings.end())
+			return it->second;
+
+		const SImageString stRef{ static_cast<uint32_t>(m_stStrings.size()), static_cast<uint32_t>(stValue.size()) };
+		m_stStrings.append(stValue);
+		m_stStrings += '\0';
+		m_mapStrings.emplace(stValue, stRef);
+		return stRef;
+	}
+
+	void CResultImageWriter::Add(const SProbeResult& result, uint64_t nMachineId)
+	{
+		SImageMachine machine{};
+		machine.nMachineId = nMachineId;
+
+		machine.nMajorVersion = result.os.nMajorVersion;
+		machine.nMinorVersion = result.os.nMinorVersion;
+		machine.nServicePackMajor = result.os.nServicePackMajor;
+		machine.nServicePackMinor = result.os.nServicePackMinor;
+		machine.nBuildNumber = result.os.nBuildNumber;
+		machine.nPlatformId = result.os.nPlatformId;
+		machine.nProductType = result.os.nProductType;
+
+		machine.nFirmwareType = static_cast<uint8_t>(result.boot.nFirmwareType);
+		machine.nBootFlags = result.boot.nBootFlags;
+		machine.bSecureBootCapable = result.boot.bSecureBootCapable;
+		machine.bSecureBootEnabled = result.boot.bSecureBootEnabled;
+		machine.bTpmPresent = result.boot.bTpmPresent;
+		machine.nTpmVersion = result.boot.nTpmVersion;
+
+		machine.stCPUVendor = __Intern(result.cpu.stVendor);
+		machine.stCPUName = __Intern(result.cpu.stName);
+		machine.nArchitecture = static_cast<uint16_t>(result.cpu.nArchitecture);
+		machine.nFamily = result.cpu.nFamily;
+		machine.nModel = result.cpu.nModel;
+		machine.nStepping = result.cpu.nStepping;
+		machine.nPlatformSpecificField = result.cpu.nPlatformSpecificField;
+		machine.nActiveProcessorCount = result.cpu.nActiveProcessorCount;
+		machine.nProcessorCount = result.cpu.nProcessorCount;
+		machine.nMaxMhz = result.cpu.nMaxMhz;
+		machine.nFastProcessorCount = result.cpu.nFastProcessorCount;
+		machine.bArmV81Atomics = result.cpu.bArmV81Atomics;
+		machine.nCPUFeatures = result.cpu.nFeatures;
+
+		machine.nTotalPhysical = result.ram.nTotalPhysical;
+		machine.nAvailablePhysical = result.ram.nAvailablePhysical;
+
+		machine.volumes = AppendRecords(m_vVolumes, result.disk.vVolumes.size());
+		for (size_t i = 0; i < result.disk.vVolumes.size(); ++i)
+		{
+			const auto& volume = result.disk.vVolumes[i];
+			auto& record = m_vVolumes[machine.volumes.nFirst + i];
+			record.stPath = __Intern(volume.stPath);
+			record.stDeviceName = __Intern(volume.stDeviceName);
+			record.stVolumeName = __Intern(volume.stVolumeName);
+			record.stFileSystem = __Intern(volume.stFileSystem);
+			record.nTotalBytes = volume.nTotalBytes;
+			record.nFreeBytes = volume.nFreeBytes;
+			record.nPartitionStyle = static_cast<uint8_t>(volume.nPartitionStyle);
+		}
+
+		machine.monitors = AppendRecords(m_vMonitors, result.display.vMonitors.size());
+		for (size_t i = 0; i < result.display.vMonitors.size(); ++i)
+		{
+			const auto& monitor = result.display.vMonitors[i];
+			auto& record = m_vMonitors[machine.monitors.nFirst + i];
+			record.stDeviceID = __Intern(monitor.stDeviceID);
+			record.stDeviceName = __Intern(monitor.stDeviceName);
+			record.stDeviceString = __Intern(monitor.stDeviceString);
+			record.nBitsPerPixel = monitor.nBitsPerPixel;
+			record.nWidth = monitor.nWidth;
+			record.nHeight = monitor.nHeight;
+			record.bPrimary = monitor.bPrimary;
+		}
+
+		machine.panels = AppendRecords(m_vPanels, result.display.vPanels.size());
+		for (size_t i = 0; i < result.display.vPanels.size(); ++i)
+		{
+			const auto& panel = result.display.vPanels[i];
+			auto& record = m_vPanels[machine.panels.nFirst + i];
+			record.stRegistryPath = __Intern(panel.stRegistryPath);
+			record.nWidthCm = panel.nWidthCm;
+			record.nHeightCm = panel.nHeightCm;
+		}
+
+		machine.adapters = AppendRecords(m_vAdapters, result.display.vAdapters.size());
+		for (size_t i = 0; i < result.display.vAdapters.size(); ++i)
+		{
+			const auto& adapter = result.display.vAdapters[i];
+			auto& record = m_vAdapters[machine.adapters.nFirst + i];
+			record.stDescription = __Intern(adapter.stDescription);
+			record.stDriverModel = __Intern(adapter.stDriverModel);
+		}
+		machine.nDirectXMajor = result.display.nDirectXMajor;
+		machine.nDirectXMinor = result.display.nDirectXMinor;
+
+		machine.bConnected = result.internet.bConnected;
+		machine.bReachable = result.internet.bReachable;
+
+		for (size_t i = 0; i < result.arStatuses.size(); ++i)
+			machine.arStatuses[i] = static_cast<uint8_t>(result.arStatuses[i]);
+
+		m_vMachines.emplace_back(machine);
+	}
+
+	bool CResultImageWriter::Finish(std::string& stImage) const
+	{
+		constexpr auto nMaxReference = static_cast<size_t>((std::numeric_limits<uint32_t>::max)());
+		if ((std::max)({ m_vVolumes.size(), m_vMonitors.size(), m_vPanels.size(), m_vAdapters.size(), m_stStrings.size() }) > nMaxReference)
+			return false;
+
+		// Sorted by id so readers can binary search, item ranges stay valid as they are absolute
+		auto vMachines = m_vMachines;
+		std::stable_sort(vMachines.begin(), vMachines.end(), [](const SImageMachine& lhs, const SImageMachine& rhs) {
+			return lhs.nMachineId < rhs.nMachineId;
+		});
+
+		const std::pair <const void*, SResultImageSection> arSections[RESULT_IMAGE_SECTION_COUNT]{
+			{ vMachines.data(), { static_cast<uint32_t>(EResultImageSection::IMAGE_SECTION_MACHINES), sizeof(SImageMachine), 0, vMachines.size() } },
+			{ m_vVolumes.data(), { static_cast<uint32_t>(EResultImageSection::IMAGE_SECTION_VOLUMES), sizeof(SImageVolume), 0, m_vVolumes.size() } },
+			{ m_vMonitors.data(), { static_cast<uint32_t>(EResultImageSection::IMAGE_SECTION_MONITORS), sizeof(SImageMonitor), 0, m_vMonitors.size() } },
+			{ m_vPanels.data(), { static_cast<uint32_t>(EResultImageSection::IMAGE_SECTION_PANELS), sizeof(SImagePanel), 0, m_vPanels.size() } },
+			{ m_vAdapters.data(), { static_cast<uint32_t>(EResultImageSection::IMAGE_SECTION_ADAPTERS), sizeof(SImageAdapter), 0, m_vAdapters.size() } },
+			{ m_stStrings.data(), { static_cast<uint32_t>(EResultImageSection::IMAGE_SECTION_STRINGS), 1, 0, m_stStrings.size() } }
+		};
+
+		auto nOffset = AlignImageOffset(sizeof(SResultImageHeader) + sizeof(SResultImageSection) * RESULT_IMAGE_SECTION_COUNT);
+		std::vector <SResultImageSection> vDirectory;
+		for (const auto& section : arSections)
+		{
+			vDirectory.emplace_back(section.second);
+			vDirectory.back().nOffset = nOffset;
+			nOffset = AlignImageOffset(nOffset + section.second.nEntrySize * section.second.nCount);
+		}
+
+		SResultImageHeader header{};
+		std::memcpy(header.szMagic, RESULT_IMAGE_MAGIC, sizeof(RESULT_IMAGE_MAGIC));
+		header.nVersion = RESULT_IMAGE_VERSION;
+		header.nHeaderSize = sizeof(SResultImageHeader);
+		header.nSectionCount = static_cast<uint32_t>(vDirectory.size());
+		header.nFileSize = nOffset;
+
+		stImage.assign(nOffset, '\0');
+		std::memcpy(stImage.data(), &header, sizeof(header));
+		std::memcpy(stImage.data() + sizeof(header), vDirectory.data(), sizeof(SResultImageSection) * vDirectory.size());
+		for (size_t i = 0; i < RESULT_IMAGE_SECTION_COUNT; ++i)
+		{
+			if (vDirectory[i].nCount)
+				std::memcpy(stImage.data() + vDirectory[i].nOffset, arSections[i].first, vDirectory[i].nEntrySize * vDirectory[i].nCount);
+		}
+		return true;
+	}
+
+	bool CResultImageWriter::Write(COutputFile& file) const
+	{
+		std::string stImage;
+		return Finish(stImage) && file.Write(stImage.data(), stImage.size());
+	}
+
+	void CResultImageWriter::Clear()
+	{
+		m_vMachines.clear();
+		m_vVolumes.clear();
+		m_vMonitors.clear();
+		m_vPanels.clear();
+		m_vAdapters.clear();
+		m_stStrings.clear();
+		m_mapStrings.clear();
+	}
+
+	bool CResultImageReader::Open(const std::string& stFileName)
+	{
+		m_pData = nullptr;
+		m_nSize = 0;
+		m_stDecompressed.clear();
+		if (!m_file.Open(stFileName))
+			return false;
+		if (!IsCompressedStream(m_file.GetData(), m_file.GetSize()))
+			return Attach(m_file.GetData(), m_file.GetSize());
+
+		// Heap blocks are aligned well beyond RESULT_IMAGE_ALIGNMENT
+		const auto bDecompressed = DecompressStream(m_file.GetData(), m_file.GetSize(), m_stDecompressed);
+		m_file.Close();
+		return bDecompressed && Attach(m_stDecompressed.data(), m_stDecompressed.size());
+	}
+
+	bool CResultImageReader::Attach(const char* pData, size_t nSize)
+	{
+		m_arSections = {};
+		m_pData = nullptr;
+		m_nSize = 0;
+
+		if (!pData || reinterpret_cast<uintptr_t>(pData) % RESULT_IMAGE_ALIGNMENT || nSize < sizeof(SResultImageHeader))
+			return false;
+
+		const auto& header = *reinterpret_cast<const SResultImageHeader*>(pData);
+		if (std::memcmp(header.szMagic, RESULT_IMAGE_MAGIC, sizeof(RESULT_IMAGE_MAGIC)) || header.nVersion > RESULT_IMAGE_VERSION ||
+			header.nHeaderSize < sizeof(SResultImageHeader) || header.nHeaderSize % RESULT_IMAGE_ALIGNMENT || header.nFileSize > nSize || header.nFileSize < header.nHeaderSize)
+			return false;
+
+		const auto nDirectorySize = static_cast<uint64_t>(header.nSectionCount) * sizeof(SResultImageSection);
+		if (nDirectorySize > header.nFileSize - header.nHeaderSize)
+			return false;
+
+		const auto pDirectory = reinterpret_cast<const SResultImageSection*>(pData + header.nHeaderSize);
+		for (uint32_t i = 0; i < header.nSectionCount; ++i)
+		{
+			const auto& section = pDirectory[i];
+			// Sections added by newer writers are skipped
+			if (!section.nType || section.nType >= static_cast<uint32_t>(EResultImageSection::IMAGE_SECTION_MAX))
+				continue;
+
+			const auto nIndex = GetSectionIndex(static_cast<EResultImageSection>(section.nType));
+			if (section.nEntrySize < gs_arMinEntrySizes[nIndex] || section.nOffset % RESULT_IMAGE_ALIGNMENT ||
+				(section.nEntrySize > 1 && section.nEntrySize % RESULT_IMAGE_ALIGNMENT) ||
+				section.nOffset > header.nFileSize || section.nCount > (header.nFileSize - section.nOffset) / section.nEntrySize)
+				return false;
+			m_arSections[nIndex] = section;
+		}
+
+		m_pData = pData;
+		m_nSize = static_cast<size_t>(header.nFileSize);
+		return true;
+	}
+
+	const SImageMachine& CResultImageReader::GetMachine(size_t nIndex) const
+	{
+		const auto& section = m_arSections[0];
+		return *reinterpret_cast<const SImageMachine*>(m_pData + section.nOffset + nIndex * section.nEntrySize);
+	}
+
+	const SImageMachine* CResultImageReader::FindMachine(uint64_t nMachineId) const
+	{
+		size_t nLow = 0, nHigh = GetMachineCount();
+		while (nLow < nHigh)
+		{
+			const auto nMid = nLow + (nHigh - nLow) / 2;
+			if (GetMachine(nMid).nMachineId < nMachineId)
+				nLow = nMid + 1;
+			else
+				nHigh = nMid;
+		}
+		if (nLow == GetMachineCount() || GetMachine(nLow).nMachineId != nMachineId)
+			return nullptr;
+		return &GetMachine(nLow);
+	}
+
+	uint32_t CResultImageReader::GetEntrySize(EResultImageSection nSection) const
+	{
+		return m_arSections[GetSectionIndex(nSection)].nEntrySize;
+	}
+
+	template <class T>
+	CImageSpan<T> CResultImageReader::__GetSpan(EResultImageSection nSection, const SImageRange& range) const
+	{
+		const auto& section = m_arSections[GetSectionIndex(nSection)];
+		if (!range.nCount || static_cast<uint64_t>(range.nFirst) + range.nCount > section.nCount)
+			return {};
+		return CImageSpan<T>(m_pData + section.nOffset + static_cast<uint64_t>(range.nFirst) * section.nEntrySize, section.nEntrySize, range.nCount);
+	}
+
+	CImageSpan<SImageVolume> CResultImageReader::GetVolumes(const SImageMachine& machine) const
+	{
+		return __GetSpan<SImageVolume>(EResultImageSection::IMAGE_SECTION_VOLUMES, machine.volumes);
+	}
+
+	CImageSpan<SImageMonitor> CResultImageReader::GetMonitors(const SImageMachine& machine) const
+	{
+		return __GetSpan<SImageMonitor>(EResultImageSection::IMAGE_SECTION_MONITORS, machine.monitors);
+	}
+
+	CImageSpan<SImagePanel> CResultImageReader::GetPanels(const SImageMachine& machine) const
+	{
+		return __GetSpan<SImagePanel>(EResultImageSection::IMAGE_SECTION_PANELS, machine.panels);
+	}
+
+	CImageSpan<SImageAdapter> CResultImageReader::GetAdapters(const SImageMachine& machine) const
+	{
+		return __GetSpan<SImageAdapter>(EResultImageSection::IMAGE_SECTION_ADAPTERS, machine.adapters);
+	}
+
+	std::string_view CResultImageReader::GetString(const SImageString& stValue) const
+	{
+		const auto& section = m_arSections[GetSectionIndex(EResultImageSection::IMAGE_SECTION_STRINGS)];
+		if (!stValue.nLength || static_cast<uint64_t>(stValue.nOffset) + stValue.nLength > section.nCount)
+			return {};
+		return std::string_view(m_pData + section.nOffset + stValue.nOffset, stValue.nLength);
+	}
+
+	void CResultImageReader::ReadResult(const SImageMachine& machine, SProbeResult& result) const
+	{
+		result.nMachineId = machine.nMachineId;
+		result.os.nMajorVersion = machine.nMajorVersion;
+		result.os.nMinorVersion = machine.nMinorVersion;
+		result.os.nServicePackMajor = machine.nServicePackMajor;
+		result.os.nServicePackMinor = machine.nServicePackMinor;
+		result.os.nBuildNumber = machine.nBuildNumber;
+		result.os.nPlatformId = machine.nPlatformId;
+		result.os.nProductType = machine.nProductType;
+
+		result.boot.nFirmwareType = static_cast<EFirmwareType>(machine.nFirmwareType);
+		result.boot.nBootFlags = machine.nBootFlags;
+		result.boot.bSecureBootCapable = machine.bSecureBootCapable;
+		result.boot.bSecureBootEnabled = machine.bSecureBootEnabled;
+		result.boot.bTpmPresent = machine.bTpmPresent;
+		result.boot.nTpmVersion = machine.nTpmVersion;
+
+		result.cpu.stVendor = GetString(machine.stCPUVendor);
+		result.cpu.stName = GetString(machine.stCPUName);
+		result.cpu.nArchitecture = static_cast<EProcessorArchitecture>(machine.nArchitecture);
+		result.cpu.nFamily = machine.nFamily;
+		result.cpu.nModel = machine.nModel;
+		result.cpu.nStepping = machine.nStepping;
+		result.cpu.nPlatformSpecificField = machine.nPlatformSpecificField;
+		result.cpu.nActiveProcessorCount = machine.nActiveProcessorCount;
+		result.cpu.nProcessorCount = machine.nProcessorCount;
+		result.cpu.nMaxMhz = machine.nMaxMhz;
+		result.cpu.nFastProcessorCount = machine.nFastProcessorCount;
+		result.cpu.bArmV81Atomics = machine.bArmV81Atomics;
+		result.cpu.nFeatures = 0;
+		if (IsImageFieldPresent(GetEntrySize(EResultImageSection::IMAGE_SECTION_MACHINES), offsetof(SImageMachine, nCPUFeatures), sizeof(machine.nCPUFeatures)))
+			result.cpu.nFeatures = machine.nCPUFeatures;
+
+		result.ram.nTotalPhysical = machine.nTotalPhysical;
+		result.ram.nAvailablePhysical = machine.nAvailablePhysical;
+
+		const auto volumes = GetVolumes(machine);
+		result.disk.vVolumes.resize(volumes.size());
+		for (uint32_t i = 0; i < volumes.size(); ++i)
+		{
+			auto& volume = result.disk.vVolumes[i];
+			volume.stPath = GetString(volumes[i].stPath);
+			volume.stDeviceName = GetString(volumes[i].stDeviceName);
+			volume.stVolumeName = GetString(volumes[i].stVolumeName);
+			volume.stFileSystem = GetString(volumes[i].stFileSystem);
+			volume.nPartitionStyle = static_cast<EPartitionStyle>(volumes[i].nPartitionStyle);
+			volume.nTotalBytes = volumes[i].nTotalBytes;
+			volume.nFreeBytes = volumes[i].nFreeBytes;
+		}
+
+		const auto monitors = GetMonitors(machine);
+		result.display.vMonitors.resize(monitors.size());
+		for (uint32_t i = 0; i < monitors.size(); ++i)
+		{
+			auto& monitor = result.display.vMonitors[i];
+			monitor.stDeviceID = GetString(monitors[i].stDeviceID);
+			monitor.stDeviceName = GetString(monitors[i].stDeviceName);
+			monitor.stDeviceString = GetString(monitors[i].stDeviceString);
+			monitor.bPrimary = monitors[i].bPrimary;
+			monitor.nBitsPerPixel = monitors[i].nBitsPerPixel;
+			monitor.nWidth = monitors[i].nWidth;
+			monitor.nHeight = monitors[i].nHeight;
+		}
+
+		const auto panels = GetPanels(machine);
+		result.display.vPanels.resize(panels.size());
+		for (uint32_t i = 0; i < panels.size(); ++i)
+		{
+			auto& panel = result.display.vPanels[i];
+			panel.stRegistryPath = GetString(panels[i].stRegistryPath);
+			panel.nWidthCm = panels[i].nWidthCm;
+			panel.nHeightCm = panels[i].nHeightCm;
+		}
+
+		const auto adapters = GetAdapters(machine);
+		result.display.vAdapters.resize(adapters.size());
+		for (uint32_t i = 0; i < adapters.size(); ++i)
+		{
+			auto& adapter = result.display.vAdapters[i];
+			adapter.stDescription = GetString(adapters[i].stDescription);
+			adapter.stDriverModel = GetString(adapters[i].stDriverModel);
+		}
+		result.display.nDirectXMajor = machine.nDirectXMajor;
+		result.display.nDirectXMinor = machine.nDirectXMinor;
+
+		result.internet.bConnected = machine.bConnected;
+		result.internet.bReachable = machine.bReachable;
+
+		for (size_t i = 0; i < result.arStatuses.size(); ++i)
+			result.arStatuses[i] = static_cast<EStatus>(machine.arStatuses[i]);
+	}
+};
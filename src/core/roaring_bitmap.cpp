@@ -0,0 +1,301 @@
+#include "../../include/core/roaring_bitmap.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace Win11SysCheck
+{
+	static constexpr uint32_t ARRAY_CONTAINER_LIMIT = 4096;
+	static constexpr size_t BITMAP_CONTAINER_WORDS = 65536 / 64;
+
+	CRoaringBitmap::SContainer& CRoaringBitmap::__GetContainer(uint16_t nKey)
+	{
+		if (m_vContainers.empty() || m_vContainers.back().nKey < nKey)
+		{
+			m_vContainers.emplace_back();
+			m_vContainers.back().nKey = nKey;
+			return m_vContainers.back();
+		}
+		if (m_vContainers.back().nKey == nKey)
+			return m_vContainers.back();
+
+		const auto it = std::lower_bound(m_vContainers.begin(), m_vContainers.end(), nKey, [](const SContainer& container, uint16_t nValue) {
+			return container.nKey < nValue;
+		});
+		if (it != m_vContainers.end() && it->nKey == nKey)
+			return *it;
+
+		SContainer container{};
+		container.nKey = nKey;
+		return *m_vContainers.insert(it, container);
+	}
+
+	const CRoaringBitmap::SContainer* CRoaringBitmap::__FindContainer(uint16_t nKey) const
+	{
+		const auto it = std::lower_bound(m_vContainers.begin(), m_vContainers.end(), nKey, [](const SContainer& container, uint16_t nValue) {
+			return container.nKey < nValue;
+		});
+		return (it != m_vContainers.end() && it->nKey == nKey) ? &*it : nullptr;
+	}
+
+	void CRoaringBitmap::__ToBitmap(SContainer& container)
+	{
+		container.vBitmap.assign(BITMAP_CONTAINER_WORDS, 0);
+		for (const auto nLow : container.vArray)
+			container.vBitmap[nLow >> 6] |= 1ull << (nLow & 63);
+		container.vArray.clear();
+		container.vArray.shrink_to_fit();
+	}
+
+	// Bitmaps that fell back under the array limit are converted back
+	void CRoaringBitmap::__Optimize(SContainer& container)
+	{
+		if (!container.IsBitmap() || container.nCardinality > ARRAY_CONTAINER_LIMIT)
+			return;
+
+		container.vArray.reserve(container.nCardinality);
+		for (uint32_t i = 0; i < BITMAP_CONTAINER_WORDS; ++i)
+		{
+			auto nWord = container.vBitmap[i];
+			while (nWord)
+			{
+				container.vArray.emplace_back(static_cast<uint16_t>(i * 64 + PopCount64((nWord & (0 - nWord)) - 1)));
+				nWord &= nWord - 1;
+			}
+		}
+		container.vBitmap.clear();
+		container.vBitmap.shrink_to_fit();
+	}
+
+	void CRoaringBitmap::Add(uint32_t nRow)
+	{
+		auto& container = __GetContainer(static_cast<uint16_t>(nRow >> 16));
+		const auto nLow = static_cast<uint16_t>(nRow & 0xFFFF);
+
+		if (container.IsBitmap())
+		{
+			auto& nWord = container.vBitmap[nLow >> 6];
+			const auto nBit = 1ull << (nLow & 63);
+			if (!(nWord & nBit))
+			{
+				nWord |= nBit;
+				container.nCardinality++;
+			}
+			return;
+		}
+
+		auto& vArray = container.vArray;
+		if (vArray.empty() || vArray.back() < nLow)
+		{
+			vArray.emplace_back(nLow);
+		}
+		else
+		{
+			const auto it = std::lower_bound(vArray.begin(), vArray.end(), nLow);
+			if (*it == nLow)
+				return;
+			vArray.insert(it, nLow);
+		}
+
+		if (++container.nCardinality > ARRAY_CONTAINER_LIMIT)
+			__ToBitmap(container);
+	}
+
+	bool CRoaringBitmap::Contains(uint32_t nRow) const
+	{
+		const auto pContainer = __FindContainer(static_cast<uint16_t>(nRow >> 16));
+		if (!pContainer)
+			return false;
+
+		const auto nLow = static_cast<uint16_t>(nRow & 0xFFFF);
+		if (pContainer->IsBitmap())
+			return (pContainer->vBitmap[nLow >> 6] >> (nLow & 63)) & 1;
+		return std::binary_search(pContainer->vArray.begin(), pContainer->vArray.end(), nLow);
+	}
+
+	uint64_t CRoaringBitmap::Cardinality() const
+	{
+		uint64_t nCount = 0;
+		for (const auto& container : m_vContainers)
+			nCount += container.nCardinality;
+		return nCount;
+	}
+
+	CRoaringBitmap::SContainer CRoaringBitmap::__AndContainers(const SContainer& lhs, const SContainer& rhs)
+	{
+		SContainer result{};
+		result.nKey = lhs.nKey;
+
+		if (lhs.IsBitmap() && rhs.IsBitmap())
+		{
+			result.vBitmap.resize(BITMAP_CONTAINER_WORDS);
+			for (size_t i = 0; i < BITMAP_CONTAINER_WORDS; ++i)
+			{
+				result.vBitmap[i] = lhs.vBitmap[i] & rhs.vBitmap[i];
+				result.nCardinality += PopCount64(result.vBitmap[i]);
+			}
+			__Optimize(result);
+			return result;
+		}
+
+		if (lhs.IsBitmap() || rhs.IsBitmap())
+		{
+			const auto& array = lhs.IsBitmap() ? rhs : lhs;
+			const auto& bitmap = lhs.IsBitmap() ? lhs : rhs;
+			for (const auto nLow : array.vArray)
+			{
+				if ((bitmap.vBitmap[nLow >> 6] >> (nLow & 63)) & 1)
+					result.vArray.emplace_back(nLow);
+			}
+		}
+		else
+		{
+			std::set_intersection(lhs.vArray.begin(), lhs.vArray.end(), rhs.vArray.begin(), rhs.vArray.end(), std::back_inserter(result.vArray));
+		}
+		result.nCardinality = static_cast<uint32_t>(result.vArray.size());
+		return result;
+	}
+
+	CRoaringBitmap::SContainer CRoaringBitmap::__OrContainers(const SContainer& lhs, const SContainer& rhs)
+	{
+		SContainer result{};
+		result.nKey = lhs.nKey;
+
+		if (!lhs.IsBitmap() && !rhs.IsBitmap() && lhs.nCardinality + rhs.nCardinality <= ARRAY_CONTAINER_LIMIT)
+		{
+			std::set_union(lhs.vArray.begin(), lhs.vArray.end(), rhs.vArray.begin(), rhs.vArray.end(), std::back_inserter(result.vArray));
+			result.nCardinality = static_cast<uint32_t>(result.vArray.size());
+			return result;
+		}
+
+		result.vBitmap.assign(BITMAP_CONTAINER_WORDS, 0);
+		for (const auto pSource : { &lhs, &rhs })
+		{
+			if (pSource->IsBitmap())
+			{
+				for (size_t i = 0; i < BITMAP_CONTAINER_WORDS; ++i)
+					result.vBitmap[i] |= pSource->vBitmap[i];
+			}
+			else
+			{
+				for (const auto nLow : pSource->vArray)
+					result.vBitmap[nLow >> 6] |= 1ull << (nLow & 63);
+			}
+		}
+		for (const auto nWord : result.vBitmap)
+			result.nCardinality += PopCount64(nWord);
+
+		__Optimize(result);
+		return result;
+	}
+
+	CRoaringBitmap CRoaringBitmap::And(const CRoaringBitmap& lhs, const CRoaringBitmap& rhs)
+	{
+		CRoaringBitmap result;
+
+		auto itLeft = lhs.m_vContainers.begin();
+		auto itRight = rhs.m_vContainers.begin();
+		while (itLeft != lhs.m_vContainers.end() && itRight != rhs.m_vContainers.end())
+		{
+			if (itLeft->nKey < itRight->nKey)
+			{
+				++itLeft;
+			}
+			else if (itRight->nKey < itLeft->nKey)
+			{
+				++itRight;
+			}
+			else
+			{
+				auto container = __AndContainers(*itLeft++, *itRight++);
+				if (container.nCardinality)
+					result.m_vContainers.emplace_back(std::move(container));
+			}
+		}
+		return result;
+	}
+
+	CRoaringBitmap CRoaringBitmap::Or(const CRoaringBitmap& lhs, const CRoaringBitmap& rhs)
+	{
+		CRoaringBitmap result;
+
+		auto itLeft = lhs.m_vContainers.begin();
+		auto itRight = rhs.m_vContainers.begin();
+		while (itLeft != lhs.m_vContainers.end() || itRight != rhs.m_vContainers.end())
+		{
+			if (itRight == rhs.m_vContainers.end() || (itLeft != lhs.m_vContainers.end() && itLeft->nKey < itRight->nKey))
+				result.m_vContainers.emplace_back(*itLeft++);
+			else if (itLeft == lhs.m_vContainers.end() || itRight->nKey < itLeft->nKey)
+				result.m_vContainers.emplace_back(*itRight++);
+			else
+				result.m_vContainers.emplace_back(__OrContainers(*itLeft++, *itRight++));
+		}
+		return result;
+	}
+
+	// [container count u32] then per container [key u16][cardinality u32] and either the sorted
+	// array (cardinality <= 4096) or the 1024 bitmap words
+	void CRoaringBitmap::Serialize(std::string& stBuffer) const
+	{
+		const auto nCount = static_cast<uint32_t>(m_vContainers.size());
+		stBuffer.append(reinterpret_cast<const char*>(&nCount), sizeof(nCount));
+
+		for (const auto& container : m_vContainers)
+		{
+			stBuffer.append(reinterpret_cast<const char*>(&container.nKey), sizeof(container.nKey));
+			stBuffer.append(reinterpret_cast<const char*>(&container.nCardinality), sizeof(container.nCardinality));
+			if (container.IsBitmap())
+				stBuffer.append(reinterpret_cast<const char*>(container.vBitmap.data()), container.vBitmap.size() * sizeof(uint64_t));
+			else
+				stBuffer.append(reinterpret_cast<const char*>(container.vArray.data()), container.vArray.size() * sizeof(uint16_t));
+		}
+	}
+
+	bool CRoaringBitmap::Deserialize(const char* pData, size_t nSize, size_t& nOffset)
+	{
+		m_vContainers.clear();
+
+		auto Read = [&](void* pOut, size_t nLength) {
+			if (nOffset > nSize || nSize - nOffset < nLength)
+				return false;
+			std::memcpy(pOut, pData + nOffset, nLength);
+			nOffset += nLength;
+			return true;
+		};
+
+		uint32_t nCount = 0;
+		if (!Read(&nCount, sizeof(nCount)))
+			return false;
+
+		for (uint32_t i = 0; i < nCount; ++i)
+		{
+			SContainer container{};
+			if (!Read(&container.nKey, sizeof(container.nKey)) || !Read(&container.nCardinality, sizeof(container.nCardinality)))
+				return false;
+			if (!container.nCardinality || container.nCardinality > 65536 || (!m_vContainers.empty() && m_vContainers.back().nKey >= container.nKey))
+				return false;
+
+			if (container.nCardinality > ARRAY_CONTAINER_LIMIT)
+			{
+				container.vBitmap.resize(BITMAP_CONTAINER_WORDS);
+				if (!Read(container.vBitmap.data(), BITMAP_CONTAINER_WORDS * sizeof(uint64_t)))
+					return false;
+			}
+			else
+			{
+				container.vArray.resize(container.nCardinality);
+				if (!Read(container.vArray.data(), container.nCardinality * sizeof(uint16_t)))
+					return false;
+			}
+			m_vContainers.emplace_back(std::move(container));
+		}
+		return true;
+	}
+
+	size_t CRoaringBitmap::GetSizeInBytes() const
+	{
+		auto nSize = sizeof(uint32_t);
+		for (const auto& container : m_vContainers)
+			nSize += sizeof(uint16_t) + sizeof(uint32_t) + (container.IsBitmap() ? BITMAP_CONTAINER_WORDS * sizeof(uint64_t) : container.vArray.size() * sizeof(uint16_t));
+		return nSize;
+	}
+};
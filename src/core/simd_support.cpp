@@ -0,0 +1,76 @@
+#include "../../include/core/simd_support.hpp"
+#include <cstring>
+
+#if defined(WIN11SYSCHECK_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace Win11SysCheck
+{
+	static ESimdLevel DetectSimdLevel()
+	{
+#if defined(WIN11SYSCHECK_X86) && defined(_MSC_VER)
+		int arCPUID[4]{ 0 };
+		__cpuid(arCPUID, 0);
+		const auto nMaxLeaf = arCPUID[0];
+
+		__cpuid(arCPUID, 1);
+		const auto bSSE42 = (arCPUID[2] & (1 << 20)) != 0;
+		const auto bPopcnt = (arCPUID[2] & (1 << 23)) != 0;
+		const auto bOSXSave = (arCPUID[2] & (1 << 27)) != 0;
+		const auto bAVX = (arCPUID[2] & (1 << 28)) != 0;
+		if (!bSSE42 || !bPopcnt)
+			return ESimdLevel::SIMD_SCALAR;
+
+		auto bAVX2 = false;
+		if (nMaxLeaf >= 7 && bOSXSave && bAVX && (_xgetbv(0) & 0x6) == 0x6)
+		{
+			__cpuidex(arCPUID, 7, 0);
+			bAVX2 = (arCPUID[1] & (1 << 5)) != 0;
+		}
+		return bAVX2 ? ESimdLevel::SIMD_AVX2 : ESimdLevel::SIMD_SSE42;
+#elif defined(WIN11SYSCHECK_X86)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+			return ESimdLevel::SIMD_AVX2;
+		if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+			return ESimdLevel::SIMD_SSE42;
+		return ESimdLevel::SIMD_SCALAR;
+#else
+		return ESimdLevel::SIMD_SCALAR;
+#endif
+	}
+
+	ESimdLevel GetSupportedSimdLevel()
+	{
+		static const auto s_nLevel = DetectSimdLevel();
+		return s_nLevel;
+	}
+
+	const char* GetSimdLevelName(ESimdLevel nLevel)
+	{
+		switch (nLevel)
+		{
+		case ESimdLevel::SIMD_SSE42:
+			return "sse4.2";
+		case ESimdLevel::SIMD_AVX2:
+			return "avx2";
+		default:
+			return "scalar";
+		}
+	}
+
+	ESimdLevel ParseSimdLevel(const char* szName)
+	{
+		auto nLevel = GetSupportedSimdLevel();
+		if (!std::strcmp(szName, "scalar"))
+			nLevel = ESimdLevel::SIMD_SCALAR;
+		else if (!std::strcmp(szName, "sse4.2"))
+			nLevel = ESimdLevel::SIMD_SSE42;
+		else if (!std::strcmp(szName, "avx2"))
+			nLevel = ESimdLevel::SIMD_AVX2;
+
+		return nLevel > GetSupportedSimdLevel() ? GetSupportedSimdLevel() : nLevel;
+	}
+};
@@ -0,0 +1,431 @@
+#include "../../include/core/snapshot_tree.hpp"
+#include "../../include/core/binary_report.hpp"
+#include "../../include/core/block_compression.hpp"
+#include "../../include/core/cpuid_features.hpp"
+#include "../../include/core/hardware_fingerprint.hpp"
+#include "../../include/core/output_file.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fmt/format.h>
+
+namespace Win11SysCheck
+{
+	static constexpr char SNAPSHOT_FILE_MAGIC[8]{ 'W', '1', '1', 'S', 'N', 'A', 'P', '1' };
+	static constexpr uint32_t SNAPSHOT_FLAG_VOLATILE = 1;
+
+	struct SSnapshotIndexEntry
+	{
+		uint64_t nMachineId;
+		uint64_t nRootHash;
+		uint64_t nOffset;
+		uint64_t nSize;
+	};
+	static constexpr size_t SNAPSHOT_HEADER_SIZE = sizeof(SNAPSHOT_FILE_MAGIC) + sizeof(uint32_t) + sizeof(uint64_t);
+
+	template <class T>
+	static void AppendValue(std::string& stBuffer, T value)
+	{
+		stBuffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	static void AppendString(std::string& stBuffer, const std::string& stValue)
+	{
+		AppendVarint(stBuffer, stValue.size());
+		stBuffer.append(stValue);
+	}
+
+	static bool ReadString(const char*& pData, const char* pEnd, std::string& stValue)
+	{
+		uint64_t nLength = 0;
+		if (!ReadVarint(pData, pEnd, nLength) || static_cast<uint64_t>(pEnd - pData) < nLength)
+			return false;
+		stValue.assign(pData, static_cast<size_t>(nLength));
+		pData += nLength;
+		return true;
+	}
+
+	static std::string FormatBool(bool bValue)
+	{
+		return bValue ? "true" : "false";
+	}
+
+	static std::string GetFactPath(const SSnapshotGroup& group, const SSnapshotFact& fact)
+	{
+		return group.stName + "." + fact.stName;
+	}
+
+	CSnapshotTree::CSnapshotTree(const SProbeResult& result, bool bIncludeVolatile)
+	{
+		auto& status = __AddGroup(EMenuType::MENU_TYPE_SUMMARY, "status");
+		for (auto i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			const auto nType = static_cast<EMenuType>(i);
+			__AddFact(status, GetMenuTypeKey(nType).c_str(), GetStatusKey(result.GetStatus(nType)));
+		}
+
+		auto& os = __AddGroup(EMenuType::MENU_TYPE_OS, "os");
+		__AddFact(os, "major_version", std::to_string(result.os.nMajorVersion));
+		__AddFact(os, "minor_version", std::to_string(result.os.nMinorVersion));
+		__AddFact(os, "service_pack_major", std::to_string(result.os.nServicePackMajor));
+		__AddFact(os, "service_pack_minor", std::to_string(result.os.nServicePackMinor));
+		__AddFact(os, "build", std::to_string(result.os.nBuildNumber));
+		__AddFact(os, "platform_id", std::to_string(result.os.nPlatformId));
+		__AddFact(os, "product_type", std::to_string(result.os.nProductType));
+
+		auto& boot = __AddGroup(EMenuType::MENU_TYPE_BOOT, "boot");
+		__AddFact(boot, "firmware", GetFirmwareName(result.boot.nFirmwareType));
+		__AddFact(boot, "flags", std::to_string(result.boot.nBootFlags));
+		__AddFact(boot, "secure_boot_capable", FormatBool(result.boot.bSecureBootCapable));
+		__AddFact(boot, "secure_boot_enabled", FormatBool(result.boot.bSecureBootEnabled));
+		__AddFact(boot, "tpm_present", FormatBool(result.boot.bTpmPresent));
+		__AddFact(boot, "tpm_version", std::to_string(result.boot.nTpmVersion));
+
+		auto& cpu = __AddGroup(EMenuType::MENU_TYPE_CPU, "cpu");
+		__AddFact(cpu, "vendor", result.cpu.stVendor);
+		__AddFact(cpu, "name", result.cpu.stName);
+		__AddFact(cpu, "architecture", std::to_string(static_cast<uint16_t>(result.cpu.nArchitecture)));
+		__AddFact(cpu, "family", std::to_string(result.cpu.nFamily));
+		__AddFact(cpu, "model", std::to_string(result.cpu.nModel));
+		__AddFact(cpu, "stepping", std::to_string(result.cpu.nStepping));
+		__AddFact(cpu, "platform_field", std::to_string(result.cpu.nPlatformSpecificField));
+		__AddFact(cpu, "active_processors", std::to_string(result.cpu.nActiveProcessorCount));
+		__AddFact(cpu, "processors", std::to_string(result.cpu.nProcessorCount));
+		__AddFact(cpu, "max_mhz", std::to_string(result.cpu.nMaxMhz));
+		__AddFact(cpu, "fast_processors", std::to_string(result.cpu.nFastProcessorCount));
+		__AddFact(cpu, "arm_v81_atomics", FormatBool(result.cpu.bArmV81Atomics));
+		__AddFact(cpu, "features", FormatCPUFeatures(result.cpu.nFeatures));
+
+		auto& ram = __AddGroup(EMenuType::MENU_TYPE_RAM, "ram");
+		__AddFact(ram, "total_bytes", std::to_string(result.ram.nTotalPhysical));
+		if (bIncludeVolatile)
+			__AddFact(ram, "available_bytes", std::to_string(result.ram.nAvailablePhysical));
+
+		for (size_t i = 0; i < result.disk.vVolumes.size(); ++i)
+		{
+			const auto& volume = result.disk.vVolumes[i];
+			auto& group = __AddGroup(EMenuType::MENU_TYPE_DISK, fmt::format("disk.volumes[{0}]", i));
+			__AddFact(group, "path", volume.stPath);
+			__AddFact(group, "device", volume.stDeviceName);
+			__AddFact(group, "label", volume.stVolumeName);
+			__AddFact(group, "file_system", volume.stFileSystem);
+			__AddFact(group, "partition_style", GetPartitionName(volume.nPartitionStyle));
+			__AddFact(group, "total_bytes", std::to_string(volume.nTotalBytes));
+			if (bIncludeVolatile)
+				__AddFact(group, "free_bytes", std::to_string(volume.nFreeBytes));
+		}
+
+		auto& display = __AddGroup(EMenuType::MENU_TYPE_DISPLAY, "display");
+		__AddFact(display, "directx_major", std::to_string(result.display.nDirectXMajor));
+		__AddFact(display, "directx_minor", std::to_string(result.display.nDirectXMinor));
+		for (size_t i = 0; i < result.display.vMonitors.size(); ++i)
+		{
+			const auto& monitor = result.display.vMonitors[i];
+			auto& group = __AddGroup(EMenuType::MENU_TYPE_DISPLAY, fmt::format("display.monitors[{0}]", i));
+			__AddFact(group, "device_id", monitor.stDeviceID);
+			__AddFact(group, "device_name", monitor.stDeviceName);
+			__AddFact(group, "device_string", monitor.stDeviceString);
+			__AddFact(group, "primary", FormatBool(monitor.bPrimary));
+			__AddFact(group, "bits_per_pixel", std::to_string(monitor.nBitsPerPixel));
+			__AddFact(group, "width", std::to_string(monitor.nWidth));
+			__AddFact(group, "height", std::to_string(monitor.nHeight));
+		}
+		for (size_t i = 0; i < result.display.vPanels.size(); ++i)
+		{
+			const auto& panel = result.display.vPanels[i];
+			auto& group = __AddGroup(EMenuType::MENU_TYPE_DISPLAY, fmt::format("display.panels[{0}]", i));
+			__AddFact(group, "registry_path", panel.stRegistryPath);
+			__AddFact(group, "width_cm", std::to_string(panel.nWidthCm));
+			__AddFact(group, "height_cm", std::to_string(panel.nHeightCm));
+		}
+		for (size_t i = 0; i < result.display.vAdapters.size(); ++i)
+		{
+			const auto& adapter = result.display.vAdapters[i];
+			auto& group = __AddGroup(EMenuType::MENU_TYPE_DISPLAY, fmt::format("display.adapters[{0}]", i));
+			__AddFact(group, "description", adapter.stDescription);
+			__AddFact(group, "driver_model", adapter.stDriverModel);
+		}
+
+		auto& internet = __AddGroup(EMenuType::MENU_TYPE_INTERNET, "internet");
+		__AddFact(internet, "connected", FormatBool(result.internet.bConnected));
+		__AddFact(internet, "reachable", FormatBool(result.internet.bReachable));
+
+		__UpdateHashes();
+	}
+
+	SSnapshotGroup& CSnapshotTree::__AddGroup(EMenuType nType, std::string stName)
+	{
+		auto& vGroups = m_arSections[static_cast<size_t>(nType)].vGroups;
+		vGroups.emplace_back();
+		vGroups.back().stName = std::move(stName);
+		return vGroups.back();
+	}
+
+	void CSnapshotTree::__AddFact(SSnapshotGroup& group, const char* szName, std::string stValue)
+	{
+		group.vFacts.emplace_back();
+		group.vFacts.back().stName = szName;
+		group.vFacts.back().stValue = std::move(stValue);
+	}
+
+	void CSnapshotTree::__UpdateHashes()
+	{
+		std::string stBuffer;
+		std::string stRoot;
+
+		for (size_t nSection = 0; nSection < m_arSections.size(); ++nSection)
+		{
+			auto& section = m_arSections[nSection];
+			std::sort(section.vGroups.begin(), section.vGroups.end(), [](const SSnapshotGroup& a, const SSnapshotGroup& b) {
+				return a.stName < b.stName;
+			});
+
+			std::string stSection;
+			AppendValue(stSection, static_cast<uint8_t>(nSection));
+			for (auto& group : section.vGroups)
+			{
+				std::sort(group.vFacts.begin(), group.vFacts.end(), [](const SSnapshotFact& a, const SSnapshotFact& b) {
+					return a.stName < b.stName;
+				});
+
+				std::string stGroup = group.stName;
+				for (auto& fact : group.vFacts)
+				{
+					stBuffer = GetFactPath(group, fact);
+					stBuffer.push_back('\0');
+					stBuffer.append(fact.stValue);
+					fact.nHash = HashBytes128(stBuffer.data(), stBuffer.size()).Get64();
+					AppendValue(stGroup, fact.nHash);
+				}
+				group.nHash = HashBytes128(stGroup.data(), stGroup.size()).Get64();
+				AppendValue(stSection, group.nHash);
+			}
+			section.nHash = HashBytes128(stSection.data(), stSection.size()).Get64();
+			AppendValue(stRoot, section.nHash);
+		}
+		m_nRootHash = HashBytes128(stRoot.data(), stRoot.size()).Get64();
+	}
+
+	void CSnapshotTree::Serialize(std::string& stBuffer) const
+	{
+		for (const auto& section : m_arSections)
+		{
+			AppendVarint(stBuffer, section.vGroups.size());
+			for (const auto& group : section.vGroups)
+			{
+				AppendString(stBuffer, group.stName);
+				AppendVarint(stBuffer, group.vFacts.size());
+				for (const auto& fact : group.vFacts)
+				{
+					AppendString(stBuffer, fact.stName);
+					AppendString(stBuffer, fact.stValue);
+				}
+			}
+		}
+	}
+
+	bool CSnapshotTree::Deserialize(const char* pData, size_t nSize)
+	{
+		const auto pEnd = pData + nSize;
+		for (auto& section : m_arSections)
+		{
+			uint64_t nGroupCount = 0;
+			if (!ReadVarint(pData, pEnd, nGroupCount) || nGroupCount > static_cast<uint64_t>(pEnd - pData))
+				return false;
+
+			section.vGroups.resize(static_cast<size_t>(nGroupCount));
+			for (auto& group : section.vGroups)
+			{
+				uint64_t nFactCount = 0;
+				if (!ReadString(pData, pEnd, group.stName) || !ReadVarint(pData, pEnd, nFactCount) ||
+					nFactCount > static_cast<uint64_t>(pEnd - pData))
+					return false;
+
+				group.vFacts.resize(static_cast<size_t>(nFactCount));
+				for (auto& fact : group.vFacts)
+				{
+					if (!ReadString(pData, pEnd, fact.stName) || !ReadString(pData, pEnd, fact.stValue))
+						return false;
+				}
+			}
+		}
+		if (pData != pEnd)
+			return false;
+
+		__UpdateHashes();
+		return true;
+	}
+
+	// Merge walk over name sorted children, matched pairs are only entered when their hashes differ
+	template <class T, class FnMatched, class FnUnmatched>
+	static void DiffChildren(const std::vector <T>& vBefore, const std::vector <T>& vAfter, FnMatched fnMatched, FnUnmatched fnUnmatched)
+	{
+		size_t i = 0, j = 0;
+		while (i < vBefore.size() || j < vAfter.size())
+		{
+			if (j == vAfter.size() || (i < vBefore.size() && vBefore[i].stName < vAfter[j].stName))
+			{
+				fnUnmatched(vBefore[i++], true);
+			}
+			else if (i == vBefore.size() || vAfter[j].stName < vBefore[i].stName)
+			{
+				fnUnmatched(vAfter[j++], false);
+			}
+			else
+			{
+				if (vBefore[i].nHash != vAfter[j].nHash)
+					fnMatched(vBefore[i], vAfter[j]);
+				++i;
+				++j;
+			}
+		}
+	}
+
+	size_t DiffSnapshots(const CSnapshotTree& before, const CSnapshotTree& after, std::vector <SFactChange>& vChanges)
+	{
+		if (before.GetRootHash() == after.GetRootHash())
+			return 0;
+
+		const auto nFirst = vChanges.size();
+		for (auto i = static_cast<uint8_t>(EMenuType::MENU_TYPE_UNKNOWN); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			const auto& sectionBefore = before.GetSection(static_cast<EMenuType>(i));
+			const auto& sectionAfter = after.GetSection(static_cast<EMenuType>(i));
+			if (sectionBefore.nHash == sectionAfter.nHash)
+				continue;
+
+			DiffChildren(sectionBefore.vGroups, sectionAfter.vGroups,
+				[&](const SSnapshotGroup& groupBefore, const SSnapshotGroup& groupAfter) {
+					DiffChildren(groupBefore.vFacts, groupAfter.vFacts,
+						[&](const SSnapshotFact& factBefore, const SSnapshotFact& factAfter) {
+							vChanges.emplace_back(SFactChange{ GetFactPath(groupBefore, factBefore), factBefore.stValue, factAfter.stValue });
+						},
+						[&](const SSnapshotFact& fact, bool bRemoved) {
+							const auto& group = bRemoved ? groupBefore : groupAfter;
+							vChanges.emplace_back(bRemoved ? SFactChange{ GetFactPath(group, fact), fact.stValue, "" } : SFactChange{ GetFactPath(group, fact), "", fact.stValue });
+						});
+				},
+				[&](const SSnapshotGroup& group, bool bRemoved) {
+					for (const auto& fact : group.vFacts)
+						vChanges.emplace_back(bRemoved ? SFactChange{ GetFactPath(group, fact), fact.stValue, "" } : SFactChange{ GetFactPath(group, fact), "", fact.stValue });
+				});
+		}
+		return vChanges.size() - nFirst;
+	}
+
+	bool CSnapshotFileWriter::Add(uint64_t nMachineId, const SProbeResult& result)
+	{
+		if (!m_setMachineIds.emplace(nMachineId).second)
+			return false;
+
+		const CSnapshotTree tree(result, m_bIncludeVolatile);
+
+		SMachine machine{ nMachineId, tree.GetRootHash(), {} };
+		tree.Serialize(machine.stTree);
+		m_vMachines.emplace_back(std::move(machine));
+		return true;
+	}
+
+	bool CSnapshotFileWriter::Save(const std::string& stFileName, bool bCompressed)
+	{
+		std::sort(m_vMachines.begin(), m_vMachines.end(), [](const SMachine& a, const SMachine& b) {
+			return a.nMachineId < b.nMachineId;
+		});
+
+		std::string stBuffer(SNAPSHOT_FILE_MAGIC, sizeof(SNAPSHOT_FILE_MAGIC));
+		AppendValue(stBuffer, m_bIncludeVolatile ? SNAPSHOT_FLAG_VOLATILE : uint32_t(0));
+		AppendValue(stBuffer, static_cast<uint64_t>(m_vMachines.size()));
+
+		uint64_t nOffset = 0;
+		for (const auto& machine : m_vMachines)
+		{
+			AppendValue(stBuffer, SSnapshotIndexEntry{ machine.nMachineId, machine.nRootHash, nOffset, machine.stTree.size() });
+			nOffset += machine.stTree.size();
+		}
+		for (const auto& machine : m_vMachines)
+			stBuffer.append(machine.stTree);
+
+		COutputFile file;
+		if (!file.Open(stFileName))
+			return false;
+		file.SetCompression(bCompressed);
+		return file.Write(stBuffer.data(), stBuffer.size()) && file.Commit();
+	}
+
+	bool CSnapshotFileReader::Open(const std::string& stFileName)
+	{
+		m_nMachineCount = 0;
+		m_stDecompressed.clear();
+		if (!m_file.Open(stFileName))
+			return false;
+
+		auto pData = m_file.GetData();
+		auto nSize = m_file.GetSize();
+		if (IsCompressedStream(pData, nSize))
+		{
+			if (!DecompressStream(pData, nSize, m_stDecompressed))
+				return false;
+			pData = m_stDecompressed.data();
+			nSize = m_stDecompressed.size();
+			m_file.Close();
+		}
+		if (nSize < SNAPSHOT_HEADER_SIZE || std::memcmp(pData, SNAPSHOT_FILE_MAGIC, sizeof(SNAPSHOT_FILE_MAGIC)))
+			return false;
+
+		uint32_t nFlags = 0;
+		uint64_t nCount = 0;
+		std::memcpy(&nFlags, pData + sizeof(SNAPSHOT_FILE_MAGIC), sizeof(nFlags));
+		std::memcpy(&nCount, pData + sizeof(SNAPSHOT_FILE_MAGIC) + sizeof(nFlags), sizeof(nCount));
+		if (nCount > (nSize - SNAPSHOT_HEADER_SIZE) / sizeof(SSnapshotIndexEntry))
+			return false;
+
+		m_bIncludeVolatile = (nFlags & SNAPSHOT_FLAG_VOLATILE) != 0;
+		m_nMachineCount = static_cast<size_t>(nCount);
+		m_pIndex = pData + SNAPSHOT_HEADER_SIZE;
+		m_pTrees = m_pIndex + m_nMachineCount * sizeof(SSnapshotIndexEntry);
+		m_nTreesSize = nSize - (m_pTrees - pData);
+		return true;
+	}
+
+	uint64_t CSnapshotFileReader::GetMachineId(size_t nIndex) const
+	{
+		uint64_t nMachineId = 0;
+		std::memcpy(&nMachineId, m_pIndex + nIndex * sizeof(SSnapshotIndexEntry) + offsetof(SSnapshotIndexEntry, nMachineId), sizeof(nMachineId));
+		return nMachineId;
+	}
+
+	uint64_t CSnapshotFileReader::GetRootHash(size_t nIndex) const
+	{
+		uint64_t nRootHash = 0;
+		std::memcpy(&nRootHash, m_pIndex + nIndex * sizeof(SSnapshotIndexEntry) + offsetof(SSnapshotIndexEntry, nRootHash), sizeof(nRootHash));
+		return nRootHash;
+	}
+
+	size_t CSnapshotFileReader::Find(uint64_t nMachineId) const
+	{
+		size_t nLow = 0, nHigh = m_nMachineCount;
+		while (nLow < nHigh)
+		{
+			const auto nMiddle = nLow + (nHigh - nLow) / 2;
+			if (GetMachineId(nMiddle) < nMachineId)
+				nLow = nMiddle + 1;
+			else
+				nHigh = nMiddle;
+		}
+		return nLow < m_nMachineCount && GetMachineId(nLow) == nMachineId ? nLow : m_nMachineCount;
+	}
+
+	bool CSnapshotFileReader::ReadTree(size_t nIndex, CSnapshotTree& tree) const
+	{
+		if (nIndex >= m_nMachineCount)
+			return false;
+
+		SSnapshotIndexEntry entry{};
+		std::memcpy(&entry, m_pIndex + nIndex * sizeof(SSnapshotIndexEntry), sizeof(entry));
+		if (entry.nOffset > m_nTreesSize || entry.nSize > m_nTreesSize - entry.nOffset)
+			return false;
+
+		// A tree that does not hash to its indexed root is as good as corrupt
+		return tree.Deserialize(m_pTrees + entry.nOffset, static_cast<size_t>(entry.nSize)) && tree.GetRootHash() == entry.nRootHash;
+	}
+};
@@ -0,0 +1,128 @@
+#include "../../include/core/work_stealing_pool.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace Win11SysCheck
+{
+	static thread_local int32_t gs_nWorkerIndex = -1;
+	static thread_local const void* gs_pWorkerPool = nullptr;
+
+	CWorkStealingPool::CWorkStealingPool(uint32_t nThreadCount)
+	{
+		if (!nThreadCount)
+			nThreadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+		for (uint32_t i = 0; i < nThreadCount; ++i)
+			m_vQueues.emplace_back(std::make_unique<SWorkerQueue>());
+		for (uint32_t i = 0; i < nThreadCount; ++i)
+			m_vThreads.emplace_back(&CWorkStealingPool::__WorkerRoutine, this, i);
+	}
+	CWorkStealingPool::~CWorkStealingPool()
+	{
+		Wait();
+
+		{
+			std::lock_guard <std::mutex> lock(m_mtxSignal);
+			m_bStopping = true;
+		}
+		m_cvWork.notify_all();
+
+		for (auto& thread : m_vThreads)
+			thread.join();
+	}
+
+	int32_t CWorkStealingPool::GetWorkerIndex()
+	{
+		return gs_nWorkerIndex;
+	}
+
+	void CWorkStealingPool::Submit(TTask task)
+	{
+		const auto nQueueCount = static_cast<uint32_t>(m_vQueues.size());
+		const auto nQueue = (gs_pWorkerPool == this) ?
+			static_cast<uint32_t>(gs_nWorkerIndex) :
+			m_nNextQueue.fetch_add(1, std::memory_order_relaxed) % nQueueCount;
+
+		m_nPendingCount.fetch_add(1);
+		m_nQueuedCount.fetch_add(1);
+		{
+			auto& queue = *m_vQueues[nQueue];
+			std::lock_guard <std::mutex> lock(queue.mtx);
+			queue.dqTasks.emplace_back(std::move(task));
+		}
+
+		// Taking the signal lock orders the push against a worker that is about to sleep
+		{
+			std::lock_guard <std::mutex> lock(m_mtxSignal);
+		}
+		m_cvWork.notify_one();
+	}
+
+	void CWorkStealingPool::Wait()
+	{
+		std::unique_lock <std::mutex> lock(m_mtxSignal);
+		m_cvIdle.wait(lock, [this] { return m_nPendingCount.load() == 0; });
+	}
+
+	bool CWorkStealingPool::__PopTask(uint32_t nIndex, TTask& task)
+	{
+		{
+			auto& queue = *m_vQueues[nIndex];
+			std::lock_guard <std::mutex> lock(queue.mtx);
+			if (!queue.dqTasks.empty())
+			{
+				task = std::move(queue.dqTasks.back());
+				queue.dqTasks.pop_back();
+				m_nQueuedCount.fetch_sub(1);
+				return true;
+			}
+		}
+
+		const auto nQueueCount = static_cast<uint32_t>(m_vQueues.size());
+		for (uint32_t i = 1; i < nQueueCount; ++i)
+		{
+			auto& victim = *m_vQueues[(nIndex + i) % nQueueCount];
+			std::unique_lock <std::mutex> lock(victim.mtx, std::try_to_lock);
+			if (lock.owns_lock() && !victim.dqTasks.empty())
+			{
+				task = std::move(victim.dqTasks.front());
+				victim.dqTasks.pop_front();
+				m_nQueuedCount.fetch_sub(1);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void CWorkStealingPool::__WorkerRoutine(uint32_t nIndex)
+	{
+		gs_nWorkerIndex = static_cast<int32_t>(nIndex);
+		gs_pWorkerPool = this;
+
+		TTask task;
+		while (true)
+		{
+			if (__PopTask(nIndex, task))
+			{
+				task();
+				task = nullptr;
+
+				if (m_nPendingCount.fetch_sub(1) == 1)
+				{
+					std::lock_guard <std::mutex> lock(m_mtxSignal);
+					m_cvIdle.notify_all();
+				}
+				continue;
+			}
+
+			std::unique_lock <std::mutex> lock(m_mtxSignal);
+			if (m_bStopping)
+				break;
+
+			// A victim may have been busy during the try_lock sweep, re-check before sleeping
+			m_cvWork.wait_for(lock, std::chrono::milliseconds(5), [this] { return m_bStopping.load() || m_nQueuedCount.load() != 0; });
+			if (m_bStopping)
+				break;
+		}
+	}
+};
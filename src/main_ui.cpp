@@ -279,12 +279,21 @@ namespace Win11SysCheck::gui
 
 			ImGui::SameLine();
 
-			ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 180);			
+			ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 180);
 
 			static const auto sc_stTooltipText = CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DARK_MODE);
 			if (ImGui::IsItemHovered())
 				ImGui::SetTooltip("%s", sc_stTooltipText.c_str());
 
+			// Indexed by EExportFormat
+			static const char* sc_arExportFormats[] = { "JSON", "Legacy JSON", "CSV", "NDJSON", "Binary", "Image" };
+			auto nExportFormat = static_cast<int>(CApplication::Instance().GetSysCheck()->GetExportFormat());
+			ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 290);
+			ImGui::SetNextItemWidth(100);
+			if (ImGui::Combo("##export_format", &nExportFormat, sc_arExportFormats, IM_ARRAYSIZE(sc_arExportFormats)))
+				CApplication::Instance().GetSysCheck()->SetExportFormat(static_cast<EExportFormat>(nExportFormat));
+			ImGui::SameLine();
+
 			static const auto sc_stExportButtonText = fmt::format("{0}  {1}", ICON_FA_SAVE, CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_SAVE_RESULT));
 			if (ImGui::Button(sc_stExportButtonText.c_str()))
 			{
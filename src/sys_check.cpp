@@ -4,11 +4,23 @@
 #include "../include/application.hpp"
 #include "../include/main_ui.hpp"
 #include "../include/simple_timer.hpp"
+#include "../include/core/readiness_rules.hpp"
+#include "../include/core/cpu_database.hpp"
+#include "../include/core/cpuid_features.hpp"
+#include "../include/core/hardware_fingerprint.hpp"
+#include "../include/core/result_exporter.hpp"
+#include "../include/core/block_compression.hpp"
+#include <random>
 
 namespace Win11SysCheck
 {
+	// Result of the last JSON export, the base the next delta is written against
+	static constexpr const char* EXPORT_BASE_FILE = "export_base.json";
+	// Deltas in a row before a full export, keeps readers well within RESULT_DELTA_MAX_CHAIN
+	static constexpr uint32_t EXPORT_DELTA_MAX_DEPTH = 8;
+
 	CSysCheck::CSysCheck() :
-		m_hNtdll(nullptr), m_fnNtQuerySystemInformation(nullptr), m_fnRtlGetVersion(nullptr)
+		m_hNtdll(nullptr), m_fnNtQuerySystemInformation(nullptr), m_fnRtlGetVersion(nullptr), m_nProbeTimeoutMs(0), m_nExportFormat(EExportFormat::EXPORT_FORMAT_JSON), m_bExportCompressed(false), m_bExportDelta(false)
 	{
 		for (size_t i = 0; i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
 		{
@@ -42,6 +54,49 @@ namespace Win11SysCheck
 			return false;
 		}
 
+		auto& ini = CApplication::Instance().GetConfigContext();
+		m_stMetricsFile = ini["metrics"]["textfile"];
+
+		const auto& stProbeTimeout = ini["metrics"]["probe_timeout_ms"];
+		m_nProbeTimeoutMs = stProbeTimeout.empty() ? 10000 : std::strtoul(stProbeTimeout.c_str(), nullptr, 10);
+
+		const auto nExportFormat = FindExportFormat(ini["export"]["format"]);
+		if (nExportFormat != EExportFormat::EXPORT_FORMAT_MAX)
+			m_nExportFormat = nExportFormat;
+		m_bExportCompressed = ini["export"]["compress"] == "1";
+		m_bExportDelta = ini["export"]["delta"] == "1";
+
+		const auto& stKnownGoodFilter = ini["fastpath"]["known_good_filter"];
+		if (!stKnownGoodFilter.empty())
+		{
+			if (m_knownGoodFilter.Load(stKnownGoodFilter))
+			{
+				// An older filter may still vouch for hardware a later one dropped
+				const auto nAcceptedVersion = std::strtoull(ini["fastpath"]["known_good_version"].c_str(), nullptr, 10);
+				if (m_knownGoodFilter.GetVersion() < nAcceptedVersion)
+				{
+					CLogHelper::Instance().Log(LL_WARN, fmt::format("Known good filter version: {0} is older than the accepted version: {1}, every probe will run", m_knownGoodFilter.GetVersion(), nAcceptedVersion));
+					m_knownGoodFilter = CBloomFilter();
+				}
+				else
+				{
+					CLogHelper::Instance().Log(LL_SYS, fmt::format("Known good filter version: {0} loaded with {1} fingerprints", m_knownGoodFilter.GetVersion(), m_knownGoodFilter.GetItemCount()));
+					if (m_knownGoodFilter.GetVersion() > nAcceptedVersion)
+					{
+						ini["fastpath"]["known_good_version"] = std::to_string(m_knownGoodFilter.GetVersion());
+						CApplication::Instance().GetConfigFile().write(ini);
+					}
+				}
+			}
+			else
+			{
+				CLogHelper::Instance().Log(LL_WARN, fmt::format("Known good filter: {0} could not be loaded, every probe will run", stKnownGoodFilter));
+			}
+		}
+
+		m_probeResult.nMachineId = __GetMachineId();
+
+		__BuildLegacyLabels();
 		return LoadSystemInformations();
 	}
 	void CSysCheck::Destroy()
@@ -49,54 +104,146 @@ namespace Win11SysCheck
 		FreeLibrary(m_hNtdll);
 	}
 
+	// The hardware fingerprint names a SKU shared by the whole batch, the export needs this machine
+	uint64_t CSysCheck::__GetMachineId()
+	{
+		std::string stIdentity;
+		HKEY hKey{ 0 };
+		if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "SOFTWARE\\Microsoft\\Cryptography", 0, KEY_READ | KEY_WOW64_64KEY, &hKey) == ERROR_SUCCESS)
+		{
+			DWORD dwType = REG_SZ;
+			char szBuffer[64]{ '\0' };
+			DWORD cbSize = sizeof(szBuffer) - 1;
+			if (RegQueryValueExA(hKey, "MachineGuid", nullptr, &dwType, (PBYTE)(&szBuffer), &cbSize) == ERROR_SUCCESS && dwType == REG_SZ)
+			{
+				stIdentity = szBuffer;
+			}
+			RegCloseKey(hKey);
+		}
+
+		// Otherwise an install id, generated once and kept in the config
+		if (stIdentity.empty())
+		{
+			auto& ini = CApplication::Instance().GetConfigContext();
+			stIdentity = ini["export"]["install_id"];
+			if (stIdentity.empty())
+			{
+				std::random_device rd;
+				stIdentity = fmt::format("{0:08x}{1:08x}{2:08x}{3:08x}", rd(), rd(), rd(), rd());
+				ini["export"]["install_id"] = stIdentity;
+				CApplication::Instance().GetConfigFile().write(ini);
+			}
+			CLogHelper::Instance().Log(LL_WARN, fmt::format("MachineGuid could not be read, install id: {0} identifies the exports", stIdentity));
+		}
+
+		const auto nMachineId = HashBytes128(stIdentity.data(), stIdentity.size()).Get64();
+		return nMachineId ? nMachineId : 1;
+	}
+
+	bool CSysCheck::__LoadExportBase(SProbeResult& base, std::string& stBaseFile)
+	{
+		auto& ini = CApplication::Instance().GetConfigContext();
+		stBaseFile = ini["export"]["delta_base"];
+		if (stBaseFile.empty() || std::strtoul(ini["export"]["delta_depth"].c_str(), nullptr, 10) >= EXPORT_DELTA_MAX_DEPTH)
+			return false;
+
+		// A delta is useless once the export it is based on is gone
+		std::error_code ec;
+		if (!std::filesystem::is_regular_file(stBaseFile, ec))
+			return false;
+		return LoadResultExport(EXPORT_BASE_FILE, base);
+	}
+
+	void CSysCheck::__SaveExportBase(const std::string& stFileName, bool bDelta)
+	{
+		auto& ini = CApplication::Instance().GetConfigContext();
+		auto nDepth = 0ul;
+		if (bDelta)
+			nDepth = std::strtoul(ini["export"]["delta_depth"].c_str(), nullptr, 10) + 1;
+
+		COutputFile file;
+		if (!file.Open(EXPORT_BASE_FILE) || !WriteResultJson(m_probeResult, file) || !file.Commit())
+		{
+			CLogHelper::Instance().Log(LL_WARN, "Export base could not be saved, the next export will be full");
+			ini["export"]["delta_base"] = "";
+		}
+		else
+		{
+			ini["export"]["delta_base"] = stFileName;
+		}
+		ini["export"]["delta_depth"] = std::to_string(nDepth);
+		CApplication::Instance().GetConfigFile().write(ini);
+	}
+
 	bool CSysCheck::ExportResult(std::string& stFileName)
 	{
 		time_t curTime = { 0 };
 		std::time(&curTime);
 
-		stFileName = fmt::format("result_{0}.json", static_cast<DWORD>(curTime));
+		// Exports are re-evaluated elsewhere and have no room for the fast path verdict, they carry the real facts
+		if (m_probeResult.display.bDxDiagSkipped)
+		{
+			if (!__LoadDxDiagInformations(m_probeResult.display))
+				CLogHelper::Instance().Log(LL_WARN, "DxDiag failed before the export, display is exported without adapters");
+			__CommitSection(EMenuType::MENU_TYPE_DISPLAY, EvaluateDisplayReadiness(m_probeResult.display));
+		}
 
-		if (std::filesystem::exists(stFileName))
-			std::filesystem::remove(stFileName);
+		// Deltas are only written between JSON exports, any other format starts the chain over
+		const auto bDeltaFormat = m_bExportDelta && m_nExportFormat == EExportFormat::EXPORT_FORMAT_JSON;
+		SProbeResult base;
+		std::string stBaseFile;
+		const auto bDelta = bDeltaFormat && __LoadExportBase(base, stBaseFile);
+
+		if (bDelta)
+			stFileName = fmt::format("result_{0}{1}", static_cast<DWORD>(curTime), RESULT_DELTA_FILE_SUFFIX);
+		else
+			stFileName = fmt::format("result_{0}.{1}", static_cast<DWORD>(curTime), GetExportFileExtension(m_nExportFormat));
+		if (m_bExportCompressed)
+			stFileName += COMPRESSED_FILE_SUFFIX;
 
-		std::ofstream ofs(stFileName);
-		if (!ofs)
+		// Streamed into a temporary file and renamed over the target once synced
+		COutputFile file;
+		if (!file.Open(stFileName))
 		{
 			CLogHelper::Instance().Log(LL_ERR, "Output file create failed!");
 			return false;
 		}
+		file.SetCompression(m_bExportCompressed);
 
-		StringBuffer s;
-		PrettyWriter <StringBuffer> writer(s);
-
-		writer.StartObject();
-
-		for (const auto& [type, details] : m_mapSystemDetails)
+		if (bDelta)
 		{
-			const auto c_stLocalizedName = CApplication::Instance().GetI18N()->GetMenuTypeLocalizedText(type);
-
-			writer.Key(c_stLocalizedName.c_str());
-			writer.StartObject();
-
-			const auto stTitle = details.stTitle.substr(5, details.stTitle.size()); // Remove icon characters from title
-			writer.Key(stTitle.c_str());
-			writer.StartArray();
-			for (const auto& detail : details.vecTexts)
+			size_t nChangedCount = 0;
+			if (!WriteResultDeltaJson(base, stBaseFile, m_probeResult, file, nChangedCount) || !file.Commit())
 			{
-				writer.String(detail.c_str());
+				CLogHelper::Instance().Log(LL_ERR, "Output file write failed!");
+				return false;
+			}
+			CLogHelper::Instance().Log(LL_SYS, fmt::format("Delta export: {0} facts changed since {1}", nChangedCount, stBaseFile));
+		}
+		else
+		{
+			const auto exporter = CreateResultExporter(m_nExportFormat, file, m_labels);
+			if (!exporter->Add(m_probeResult, m_probeResult.nMachineId) || !exporter->Finish() || !file.Commit())
+			{
+				CLogHelper::Instance().Log(LL_ERR, "Output file write failed!");
+				return false;
 			}
-			writer.EndArray();
-
-			writer.EndObject();
 		}
 
-		writer.EndObject();
-
-		ofs << std::setw(4) << s.GetString() << std::endl;
-		ofs.close();
+		if (bDeltaFormat)
+			__SaveExportBase(stFileName, bDelta);
 		return true;
 	}
 
+	void CSysCheck::SetExportFormat(EExportFormat nFormat)
+	{
+		m_nExportFormat = nFormat;
+
+		auto& ini = CApplication::Instance().GetConfigContext();
+		ini["export"]["format"] = GetExportFormatKey(nFormat);
+		CApplication::Instance().GetConfigFile().write(ini);
+	}
+
 	EStatus CSysCheck::GetMenuStatus(EMenuType nMenuType)
 	{
 		const auto it = m_mapStatuses.find(nMenuType);
@@ -112,32 +259,46 @@ namespace Win11SysCheck
 		it->second = nStatus;
 	}
 
-	std::string CSysCheck::__GetFirmwareName(const uint8_t type)
+	void CSysCheck::__BuildLegacyLabels()
 	{
-		switch (type)
-		{
-		case FirmwareTypeBios:
-			return "Legacy/Bios";
-		case FirmwareTypeUefi:
-			return "UEFI";
-		default:
-			return "Unknown: " + std::to_string(type);
-		}
+		const auto pI18N = CApplication::Instance().GetI18N();
+
+		for (size_t i = 0; i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+			m_labels.arMenuNames[i] = pI18N->GetMenuTypeLocalizedText(static_cast<EMenuType>(i));
+
+		m_labels.stDetails = pI18N->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DETAILS);
+		m_labels.stCapable = pI18N->GetCommonLocalizedText(ECommonTextID::TEXT_ID_CAPABLE);
+		m_labels.stEnabled = pI18N->GetCommonLocalizedText(ECommonTextID::TEXT_ID_ENABLED);
+		m_labels.stDisabled = pI18N->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DISABLED);
+		m_labels.stStatus = pI18N->GetCommonLocalizedText(ECommonTextID::TEXT_ID_STATUS);
+		m_labels.stVersion = pI18N->GetCommonLocalizedText(ECommonTextID::TEXT_ID_VERSION);
+
+		m_labels.stOSVersion = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_OS_VERSION);
+		m_labels.stOSServicePack = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_OS_SP_VERSION);
+		m_labels.stOSBuild = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_OS_BUILD_VERSION);
+		m_labels.stOSPlatform = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_OS_PLATFORM_ID);
+		m_labels.stOSProductType = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_OS_PRODUCT_TYPE);
+		m_labels.stBootFirmware = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_BOOT_ENVIRONMENT);
+		m_labels.stSecureBoot = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_BOOT_SECURE_BOOT);
+		m_labels.stTPM = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_BOOT_TPM);
+		m_labels.stCPUName = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_CPU_NAME);
+		m_labels.stCPUDetails = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_CPU_DETAILS);
+		m_labels.stCPUArchitecture = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_CPU_ARCH);
+		m_labels.stActiveProcessorCount = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_CPU_ACTIVE_PROCESSOR_COUNT);
+		m_labels.stProcessorCount = pI18N->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_CPU_PROCESSOR_COUNT);
 	}
 
-	std::string CSysCheck::__GetPartitionName(const uint8_t type)
+	void CSysCheck::__CommitSection(EMenuType nType, EStatus nStatus)
 	{
-		switch (type)
-		{
-		case PARTITION_STYLE_MBR:
-			return "MBR";
-		case PARTITION_STYLE_GPT:
-			return "GPT";
-		case PARTITION_STYLE_RAW:
-			return "RAW";
-		default:
-			return "Unknown";
-		}
+		const auto stIconText = CApplication::Instance().GetUI()->GetMenuTypeIconText(nType);
+
+		SSystemDetails sysDetails{};
+		sysDetails.stTitle = fmt::format("{0}  {1}", stIconText, GetLegacySectionTitle(nType, m_labels));
+		sysDetails.vecTexts = FormatLegacySectionTexts(nType, m_probeResult, m_labels);
+
+		m_probeResult.SetStatus(nType, nStatus);
+		m_mapSystemDetails[nType] = sysDetails;
+		m_mapStatuses[nType] = nStatus;
 	}
 
 	std::string CSysCheck::__GetVolumePath(PCHAR szVolumeName)
@@ -240,11 +401,6 @@ namespace Win11SysCheck
 		return true;
 	}
 
-	void CSysCheck::AddMonitorInformation(const std::string& stInfo)
-	{
-		m_vMonitorInfos.emplace_back(stInfo);
-	}
-
 	bool CSysCheck::__LoadOSInformations()
 	{
 		static auto timer = CSimpleTimer<std::chrono::milliseconds>();
@@ -272,39 +428,16 @@ namespace Win11SysCheck
 			return bRet;
 		}
 
-		SSystemDetails sysDetails{};
-		const auto stIconText = CApplication::Instance().GetUI()->GetMenuTypeIconText(nType);
-		sysDetails.stTitle = fmt::format("{0}  {1} {2}:", stIconText, CApplication::Instance().GetI18N()->GetMenuTypeLocalizedText(nType),
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DETAILS)
-		);
-
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}: {1}.{2}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_OS_VERSION),
-			osVerEx.dwMajorVersion, osVerEx.dwMinorVersion
-		));
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}: {1}.{2}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_OS_SP_VERSION),
-			osVerEx.wServicePackMajor, osVerEx.wServicePackMinor
-		));
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}: {1}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_OS_BUILD_VERSION),
-			osVerEx.dwBuildNumber
-		));
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}: {1}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_OS_PLATFORM_ID),
-			osVerEx.dwPlatformId
-		));
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}: {1}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_OS_PRODUCT_TYPE),
-			dwProductType
-		));
-
-		m_mapSystemDetails[nType] = sysDetails;
+		auto& os = m_probeResult.os;
+		os.nMajorVersion = osVerEx.dwMajorVersion;
+		os.nMinorVersion = osVerEx.dwMinorVersion;
+		os.nServicePackMajor = osVerEx.wServicePackMajor;
+		os.nServicePackMinor = osVerEx.wServicePackMinor;
+		os.nBuildNumber = osVerEx.dwBuildNumber;
+		os.nPlatformId = osVerEx.dwPlatformId;
+		os.nProductType = dwProductType;
 
-		if (dwProductType != PRODUCT_CLOUD && dwProductType != PRODUCT_CLOUDN)
-			m_mapStatuses[nType] = EStatus::STATUS_OK;
-		else
-			m_mapStatuses[nType] = EStatus::STATUS_FAIL;
+		__CommitSection(nType, EvaluateOSReadiness(os));
 
 		bRet = true;
 		CLogHelper::Instance().Log(LL_SYS, fmt::format("OS informations loaded in: {0} ms", timer.diff()));
@@ -351,40 +484,15 @@ namespace Win11SysCheck
 			return bRet;
 		}
 
-		SSystemDetails sysDetails{};
-		const auto stIconText = CApplication::Instance().GetUI()->GetMenuTypeIconText(nType);
-		sysDetails.stTitle = fmt::format("{0}  {1} {2}:", stIconText, CApplication::Instance().GetI18N()->GetMenuTypeLocalizedText(nType),
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DETAILS)
-		);
-
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}:\n\t\tFirmware: {1}\n\t\tFlags: {2}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_BOOT_ENVIRONMENT),
-			__GetFirmwareName(sbei.FirmwareType),
-			sbei.BootFlags
-		));
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}:\n\t\t{1}: {2}\n\t\t{3}: {4}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_BOOT_SECURE_BOOT),
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_CAPABLE),
-			ssbi.SecureBootCapable ? true : false,
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_ENABLED),
-			ssbi.SecureBootEnabled ? true : false
-		));
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}:\n\t\t{1}: {2}\n\t\t{3}: {4}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_BOOT_TPM),
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_STATUS),
-			bTpmEnabled ?
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_ENABLED) :
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DISABLED),
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_VERSION),
-			tpmDevInfo.tpmVersion
-		));
+		auto& boot = m_probeResult.boot;
+		boot.nFirmwareType = static_cast<EFirmwareType>(sbei.FirmwareType);
+		boot.nBootFlags = sbei.BootFlags;
+		boot.bSecureBootCapable = ssbi.SecureBootCapable ? true : false;
+		boot.bSecureBootEnabled = ssbi.SecureBootEnabled ? true : false;
+		boot.bTpmPresent = bTpmEnabled;
+		boot.nTpmVersion = tpmDevInfo.tpmVersion;
 
-		m_mapSystemDetails[nType] = sysDetails;
-
-		if (sbei.FirmwareType == FirmwareTypeUefi && ssbi.SecureBootCapable && bTpmEnabled && tpmDevInfo.tpmVersion == 2)
-			m_mapStatuses[nType] = EStatus::STATUS_OK;
-		else
-			m_mapStatuses[nType] = EStatus::STATUS_FAIL;
+		__CommitSection(nType, EvaluateBootReadiness(boot));
 
 		bRet = true;
 		CLogHelper::Instance().Log(LL_SYS, fmt::format("Boot informations loaded in: {0} ms", timer.diff()));
@@ -411,16 +519,23 @@ namespace Win11SysCheck
 		SYSTEM_INFO sysInfo{ 0 };
 		GetNativeSystemInfo(&sysInfo);
 
-		const auto nProcessorModel = sysInfo.wProcessorRevision >> 8;
-		const auto byProcessorStepping = LOBYTE(sysInfo.wProcessorRevision);
+		auto nProcessorFamily = sysInfo.wProcessorLevel;
+		auto nProcessorModel = static_cast<uint16_t>(sysInfo.wProcessorRevision >> 8);
+		auto byProcessorStepping = LOBYTE(sysInfo.wProcessorRevision);
 
-		int arCPUID[4]{ 0 };
-		__cpuid(arCPUID, 0);
+		// Under x64 emulation on ARM64 the CPUID leaves describe the emulator, not the silicon
+		SCPUIDInfo cpuid{};
+		const auto bHasCPUID = ReadCPUID(cpuid) && sysInfo.wProcessorArchitecture != PROCESSOR_ARCHITECTURE_ARM64;
+		if (bHasCPUID)
+		{
+			nProcessorFamily = cpuid.nFamily;
+			nProcessorModel = cpuid.nModel;
+			byProcessorStepping = cpuid.nStepping;
 
-		std::string stVendor{};
-		stVendor += std::string(reinterpret_cast<const char*>(&arCPUID[1]), sizeof(arCPUID[1]));
-		stVendor += std::string(reinterpret_cast<const char*>(&arCPUID[3]), sizeof(arCPUID[3]));
-		stVendor += std::string(reinterpret_cast<const char*>(&arCPUID[2]), sizeof(arCPUID[2]));
+			CLogHelper::Instance().Log(LL_SYS, fmt::format("CPUID signature: {0:#x} max leaf: {1:#x}/{2:#x} features: {3}{4}", cpuid.nSignature,
+				cpuid.nMaxLeaf, cpuid.nMaxExtendedLeaf, FormatCPUFeatures(cpuid.features.GetBits()), cpuid.features.IsHypervisorPresent() ? " (virtualized)" : ""));
+		}
+		auto stVendor = cpuid.stVendor;
 
 		std::string stProcessorName{};
 		DWORD dwPlatformSpecField = 0;
@@ -435,12 +550,19 @@ namespace Win11SysCheck
 				stProcessorName = szBuffer;
 			}
 
+			cbSize = sizeof(szBuffer);
+			if (!bHasCPUID && RegQueryValueExA(hKey, "VendorIdentifier", nullptr, &dwType, (PBYTE)(&szBuffer), &cbSize) == ERROR_SUCCESS)
+			{
+				stVendor = szBuffer;
+			}
+
 			dwType = REG_DWORD;
 			cbSize = sizeof(dwPlatformSpecField);
 			const auto lStatus = RegQueryValueExA(hKey, "Platform Specific Field 1", nullptr, &dwType, (PBYTE)(&dwPlatformSpecField), &cbSize);
 			if (lStatus != ERROR_SUCCESS)
 			{
 				CLogHelper::Instance().Log(LL_ERR, fmt::format("RegQueryValueExA(Platform Specific Field 1) failed with status: {0}", lStatus));
+				RegCloseKey(hKey);
 				return bRet;
 			}
 
@@ -471,7 +593,8 @@ namespace Win11SysCheck
 			return bRet;
 		}
 
-		auto nSpeedCheckCounter = 0;
+		auto nSpeedCheckCounter = 0u;
+		auto nMaxMhz = 0ul;
 		for (size_t i = 0; i < sysInfo.dwNumberOfProcessors; ++i)
 		{
 			const auto lpCurrProcessorInfo = *(reinterpret_cast<PROCESSOR_POWER_INFORMATION*>(reinterpret_cast<LPBYTE>(lpBuffer) + (sizeof(processorPowerInfo) * i)));
@@ -479,113 +602,53 @@ namespace Win11SysCheck
 			{
 				nSpeedCheckCounter++;
 			}
+			nMaxMhz = (std::max)(nMaxMhz, lpCurrProcessorInfo.MaxMhz);
 		}
 		HeapFree(hProcHeap, 0, lpBuffer);
 
-		const auto bIsX64 =
-			sysInfo.wProcessorArchitecture == PROCESSOR_ARCHITECTURE_AMD64 ||
-			sysInfo.wProcessorArchitecture == PROCESSOR_ARCHITECTURE_IA64 ||
-			sysInfo.wProcessorArchitecture == PROCESSOR_ARCHITECTURE_ARM64;
-
-		auto bIsSupportedCPU = true;
-		auto qwAtomicSuppVal = 0ull;
-		DWORD qwAtomicSuppValSize = sizeof(qwAtomicSuppVal);
-
-		// Reversed checks from Windows's tool
-		if (stVendor == "AuthenticAMD")
+		// Qualcomm CPUs are required to implement ARMv8.1 atomics, family is checked through the "CP 4030" register copy
+		auto bArmV81Atomics = false;
+		if (IsProcessorFeaturePresent(PF_ARM_V81_ATOMIC_INSTRUCTIONS_AVAILABLE))
 		{
-			if (sysInfo.wProcessorLevel < 0x17 || (sysInfo.wProcessorLevel == 23 && !((nProcessorModel - 1) & 0xFFFFFFEF)))
+			auto qwAtomicSuppVal = 0ull;
+			DWORD qwAtomicSuppValSize = sizeof(qwAtomicSuppVal);
+
+			lStatus = RegGetValueA(HKEY_LOCAL_MACHINE, "Hardware\\Description\\System\\CentralProcessor\\0", "CP 4030", RRF_RT_REG_QWORD, 0, &qwAtomicSuppVal, &qwAtomicSuppValSize);
+			if (lStatus != ERROR_SUCCESS)
 			{
-				CLogHelper::Instance().Log(LL_ERR, "Unsupported AMD CPU detected!");
-				bIsSupportedCPU = false;
+				CLogHelper::Instance().Log(LL_ERR, fmt::format("Atomic support registry read failed with status: {0}", lStatus));
 			}
-		}
-		else if (stVendor == "GenuineIntel")
-		{
-			if (sysInfo.wProcessorLevel == 6)
+			else
 			{
-				if (nProcessorModel > 0x5F)
-				{
-					if (nProcessorModel == 142)
-					{
-						if (byProcessorStepping != 9)
-						{
-							CLogHelper::Instance().Log(LL_ERR, "Unsupported Intel CPU detected!");
-							bIsSupportedCPU = false;
-						}
-						if (dwPlatformSpecField != 16)
-						{
-							CLogHelper::Instance().Log(LL_ERR, "Unsupported Intel CPU detected!");
-							bIsSupportedCPU = false;
-						}
-					}
-					if (nProcessorModel != 158 || byProcessorStepping != 9 || dwPlatformSpecField == 8)
-					{
-						CLogHelper::Instance().Log(LL_ERR, "Unsupported Intel CPU detected!");
-						bIsSupportedCPU = false;
-					}
-				}
-				if (nProcessorModel != 85)
-				{
-					CLogHelper::Instance().Log(LL_ERR, "Unsupported Intel CPU detected!");
-					bIsSupportedCPU = false;
-				}
+				bArmV81Atomics = ((qwAtomicSuppVal >> 20) & 0xF) >= 2;
 			}
 		}
-		else if (stVendor.find("Qualcomm") == std::string::npos)
-		{
-			CLogHelper::Instance().Log(LL_ERR, "Unknown CPU vendor detected!");
-			bIsSupportedCPU = false;
-		}
-		else if (!IsProcessorFeaturePresent(PF_ARM_V81_ATOMIC_INSTRUCTIONS_AVAILABLE))
-		{
-			CLogHelper::Instance().Log(LL_ERR, "Unsupported Qualcomm CPU detected!");
-			bIsSupportedCPU = false;
-		}
-		else if (lStatus = RegGetValueA(HKEY_LOCAL_MACHINE, "Hardware\\Description\\System\\CentralProcessor\\0", "CP 4030", RRF_RT_REG_QWORD, 0, &qwAtomicSuppVal, &qwAtomicSuppValSize) != ERROR_SUCCESS)
-		{
-			CLogHelper::Instance().Log(LL_ERR, fmt::format("Atomic support registry read failed with status: {0}", lStatus));
-			bIsSupportedCPU = false;
-		}
-		else if ((unsigned int)(qwAtomicSuppVal >> 20) & 0xF < 2)
-		{
-			CLogHelper::Instance().Log(LL_ERR, fmt::format("Qualcomm CPU family check failed, atomicsResult: {0}", (unsigned int)(qwAtomicSuppVal >> 20) & 0xF));
-			bIsSupportedCPU = false;
-		}
-
-		SSystemDetails sysDetails{};
-		const auto stIconText = CApplication::Instance().GetUI()->GetMenuTypeIconText(nType);
-		sysDetails.stTitle = fmt::format("{0}  {1} {2}:", stIconText, CApplication::Instance().GetI18N()->GetMenuTypeLocalizedText(nType),
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DETAILS)
-		);
-
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}:\n\t\t{1}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_CPU_NAME),
-			stProcessorName
-		));
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}:\n\t\tModel: {1}\n\t\tStepping: {2}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_CPU_DETAILS),
-			nProcessorModel, byProcessorStepping
-		));
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}:\n\t\tID: {1}\n\t\tx64: {2}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_CPU_ARCH),
-			sysInfo.wProcessorArchitecture, bIsX64
-		));
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}: {1}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_CPU_ACTIVE_PROCESSOR_COUNT),
-			dwActiveProcessorCount
-		));
-		sysDetails.vecTexts.emplace_back(fmt::format("{0}: {1}",
-			CApplication::Instance().GetI18N()->GetSystemDetailsLocalizedText(ESystemDetailID::SYSTEM_DETAIL_CPU_PROCESSOR_COUNT),
-			sysInfo.dwNumberOfProcessors
-		));
-
-		m_mapSystemDetails[nType] = sysDetails;
 
-		if (bIsX64 && sysInfo.dwNumberOfProcessors >= 2 && nSpeedCheckCounter >= 2 && bIsSupportedCPU)
-			m_mapStatuses[nType] = EStatus::STATUS_OK;
-		else
-			m_mapStatuses[nType] = EStatus::STATUS_FAIL;
+		auto& cpu = m_probeResult.cpu;
+		cpu.stVendor = stVendor;
+		cpu.stName = stProcessorName;
+		cpu.nArchitecture = static_cast<EProcessorArchitecture>(sysInfo.wProcessorArchitecture);
+		cpu.nFamily = nProcessorFamily;
+		cpu.nModel = nProcessorModel;
+		cpu.nStepping = byProcessorStepping;
+		cpu.nPlatformSpecificField = dwPlatformSpecField;
+		cpu.nActiveProcessorCount = dwActiveProcessorCount;
+		cpu.nProcessorCount = sysInfo.dwNumberOfProcessors;
+		cpu.nMaxMhz = nMaxMhz;
+		cpu.nFastProcessorCount = nSpeedCheckCounter;
+		cpu.bArmV81Atomics = bArmV81Atomics;
+		cpu.nFeatures = bHasCPUID ? cpuid.features.GetBits() : 0;
+
+		const auto classification = ClassifyProcessor(cpu);
+		if (classification.nMatch == ECPUMatch::CPU_MATCH_MODEL_NAME)
+			CLogHelper::Instance().Log(LL_SYS, fmt::format("CPU model: {0} is in the supported processor list{1}", classification.szModel,
+				classification.nConfidence == ECPUMatchConfidence::CPU_CONFIDENCE_HIGH ? "" : ", but its family/model/stepping is not"));
+		if (!IsSupportedProcessor(cpu))
+			CLogHelper::Instance().Log(LL_ERR, fmt::format("Unsupported CPU detected! Vendor: {0} Family: {1} Model: {2} Stepping: {3}", cpu.stVendor, cpu.nFamily, cpu.nModel, cpu.nStepping));
+		if (const auto nMissing = GetMissingInstructions(cpu))
+			CLogHelper::Instance().Log(LL_ERR, fmt::format("CPU lacks instructions required since 24H2: {0}", FormatCPUFeatures(nMissing)));
+
+		__CommitSection(nType, EvaluateCPUReadiness(cpu));
 
 		bRet = true;
 		CLogHelper::Instance().Log(LL_SYS, fmt::format("CPU informations loaded in: {0} ms", timer.diff()));
@@ -610,23 +673,10 @@ namespace Win11SysCheck
 			return bRet;
 		}
 
-		SSystemDetails sysDetails{};
-		const auto stIconText = CApplication::Instance().GetUI()->GetMenuTypeIconText(nType);
-		sysDetails.stTitle = fmt::format("{0}  {1} {2}:", stIconText, CApplication::Instance().GetI18N()->GetMenuTypeLocalizedText(nType),
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DETAILS)
-		);
-
-		sysDetails.vecTexts.emplace_back(fmt::format("Physical memory:\n\t\tTotal:{0} MB\n\t\tAvailable: {1} MB",
-			memInfo.ullTotalPhys / 1024,
-			memInfo.ullAvailPhys / 1024
-		));
+		m_probeResult.ram.nTotalPhysical = memInfo.ullTotalPhys;
+		m_probeResult.ram.nAvailablePhysical = memInfo.ullAvailPhys;
 
-		m_mapSystemDetails[nType] = sysDetails;
-
-		if (memInfo.ullTotalPhys / 1024 >= 4096000)
-			m_mapStatuses[nType] = EStatus::STATUS_OK;
-		else
-			m_mapStatuses[nType] = EStatus::STATUS_FAIL;
+		__CommitSection(nType, EvaluateRAMReadiness(m_probeResult.ram));
 
 		bRet = true;
 		CLogHelper::Instance().Log(LL_SYS, fmt::format("RAM informations loaded in: {0} ms", timer.diff()));
@@ -643,7 +693,7 @@ namespace Win11SysCheck
 
 		m_mapStatuses[nType] = EStatus::STATUS_INITIALIZING;
 
-		std::vector <SDiskContext> vDiskList;
+		std::vector <SVolumeFacts> vDiskList;
 
 		char szVolumeName[MAX_PATH]{ '\0' };
 		const auto FindHandle = FindFirstVolumeA(szVolumeName, ARRAYSIZE(szVolumeName));
@@ -687,7 +737,7 @@ namespace Win11SysCheck
 					CLogHelper::Instance().Log(LL_ERR, fmt::format("GetVolumeInformationA failed with error: {0}", GetLastError()));
 				}
 
-				SDiskContext diskCtx{};
+				SVolumeFacts diskCtx{};
 				diskCtx.stPath = stPath;
 				diskCtx.stDeviceName = szDeviceName;
 				diskCtx.stVolumeName = szVolumeName;
@@ -699,21 +749,10 @@ namespace Win11SysCheck
 		FindVolumeClose(FindHandle);
 
 
-		SSystemDetails sysDetails{};
-		const auto stIconText = CApplication::Instance().GetUI()->GetMenuTypeIconText(nType);
-		sysDetails.stTitle = fmt::format("{0}  {1} {2}:", stIconText, CApplication::Instance().GetI18N()->GetMenuTypeLocalizedText(nType),
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DETAILS)
-		);
-
-		auto bHaveAvailableDiskSpace = false;
-		uint8_t idx = 0;
 		for (auto& diskCtx : vDiskList)
 		{
-			idx++;
-
 			diskCtx.stVolumeName.pop_back();
 
-			auto nPartitionType = -1;
 			auto hDevice = CreateFileA(diskCtx.stVolumeName.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
 			if (hDevice && hDevice != INVALID_HANDLE_VALUE)
 			{
@@ -729,50 +768,175 @@ namespace Win11SysCheck
 					else
 					{
 						if (partInfo->PartitionCount)
-							nPartitionType = partInfo->PartitionEntry[0].PartitionStyle;
+							diskCtx.nPartitionStyle = static_cast<EPartitionStyle>(partInfo->PartitionEntry[0].PartitionStyle);
 					}
 
-					delete partInfo;
+					delete[] reinterpret_cast<BYTE*>(partInfo);
 					partInfo = nullptr;
 				}
 				CloseHandle(hDevice);
 			}
 
 			ULARGE_INTEGER uiTotalNumberOfBytes{ 0 };
-			if (!GetDiskFreeSpaceExA(diskCtx.stPath.c_str(), nullptr, &uiTotalNumberOfBytes, nullptr))
+			ULARGE_INTEGER uiTotalNumberOfFreeBytes{ 0 };
+			if (!GetDiskFreeSpaceExA(diskCtx.stPath.c_str(), nullptr, &uiTotalNumberOfBytes, &uiTotalNumberOfFreeBytes))
 			{
 				CLogHelper::Instance().Log(LL_ERR, fmt::format("'{0}' GetDiskFreeSpaceExA failed with error: {1}", diskCtx.stPath.c_str(), GetLastError()));
 			}
-			else
-			{
-				const auto c_dwFreeSpaceAsMB = uiTotalNumberOfBytes.QuadPart / 1024 / 1024;
-				if (c_dwFreeSpaceAsMB > 64000)
-				{
-					bHaveAvailableDiskSpace = true;
-				}
-			}
 
-			sysDetails.vecTexts.emplace_back(fmt::format("Disk: {0}\n\t\tPath: {1}\n\t\tDevice Name: {2}\n\t\tVolume Name: {3}\n\t\tFile System: {4}\n\t\tPartition: {5}\n\t\tDisk space: {6} MB",
-				idx,
-				diskCtx.stPath,
-				diskCtx.stDeviceName,
-				diskCtx.stVolumeName,
-				diskCtx.stFileSystem,
-				__GetPartitionName(nPartitionType),
-				uiTotalNumberOfBytes.QuadPart / 1024 / 1024
-			));
+			diskCtx.nTotalBytes = uiTotalNumberOfBytes.QuadPart;
+			diskCtx.nFreeBytes = uiTotalNumberOfFreeBytes.QuadPart;
 		}
-		m_mapSystemDetails[nType] = sysDetails;
+		m_probeResult.disk.vVolumes = vDiskList;
 
-		if (bHaveAvailableDiskSpace)
-			m_mapStatuses[nType] = EStatus::STATUS_OK;
-		else
-			m_mapStatuses[nType] = EStatus::STATUS_FAIL;
+		__CommitSection(nType, EvaluateDiskReadiness(m_probeResult.disk));
 
 		bRet = true;
 		CLogHelper::Instance().Log(LL_SYS, fmt::format("Disk informations loaded in: {0} ms", timer.diff()));
 		return bRet;
 	}
+	// Adapters and DirectX version from the DxDiag API, the slowest part of the display probe
+	bool CSysCheck::__LoadDxDiagInformations(SDisplayFacts& display)
+	{
+		display.vAdapters.clear();
+		display.nDirectXMajor = 0;
+		display.nDirectXMinor = 0;
+		display.bDxDiagSkipped = false;
+
+		DIRECTX_VERSION_INFORMATION dxVerInfo{};
+		auto bCompleted = false;
+		auto bComInitialized = false;
+		IDxDiagContainer* pObject = nullptr;
+		IDxDiagContainer* pContainer = nullptr;
+		IDxDiagProvider* pDxDiagProvider = nullptr;
+		IDxDiagContainer* pDxDiagRoot = nullptr;
+		IDxDiagContainer* pDxDiagSystemInfo = nullptr;
+
+		do
+		{
+			auto hr = CoInitialize(nullptr);
+			bComInitialized = SUCCEEDED(hr);
+
+			if (FAILED(hr = CoCreateInstance(CLSID_DxDiagProvider, nullptr, CLSCTX_INPROC_SERVER, IID_IDxDiagProvider, (LPVOID*)&pDxDiagProvider)))
+			{
+				CLogHelper::Instance().Log(LL_ERR, fmt::format("CoCreateInstance(CLSID_DxDiagProvider) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+				break;
+			}
+			if (!pDxDiagProvider)
+			{
+				CLogHelper::Instance().Log(LL_ERR, "CoCreateInstance(CLSID_DxDiagProvider) returned nullptr!");
+				hr = E_POINTER;
+				break;
+			}
+
+			DXDIAG_INIT_PARAMS dxDiagInitParam{ 0 };
+			dxDiagInitParam.dwSize = sizeof(dxDiagInitParam);
+			dxDiagInitParam.dwDxDiagHeaderVersion = DXDIAG_DX9_SDK_VERSION;
+			dxDiagInitParam.bAllowWHQLChecks = false;
+			dxDiagInitParam.pReserved = nullptr;
+
+			if (FAILED(hr = pDxDiagProvider->Initialize(&dxDiagInitParam)))
+			{
+				CLogHelper::Instance().Log(LL_ERR, fmt::format("pDxDiagProvider(Initialize) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+				break;
+			}
+
+			if (FAILED(hr = pDxDiagProvider->GetRootContainer(&pDxDiagRoot)))
+			{
+				CLogHelper::Instance().Log(LL_ERR, fmt::format("pDxDiagProvider(GetRootContainer) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+				break;
+			}
+
+			if (FAILED(hr = pDxDiagRoot->GetChildContainer(L"DxDiag_DisplayDevices", &pContainer)))
+			{
+				CLogHelper::Instance().Log(LL_ERR, fmt::format("pDxDiagRoot(GetChildContainer) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+				break;
+			}
+
+			DWORD dwInstanceCount = 0;
+			if (FAILED(hr = pContainer->GetNumberOfChildContainers(&dwInstanceCount)))
+			{
+				CLogHelper::Instance().Log(LL_ERR, fmt::format("pContainer(GetNumberOfChildContainers) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+				break;
+			}
+
+			CLogHelper::Instance().Log(LL_SYS, fmt::format("{0} instance found!", dwInstanceCount));
+
+			// Display devices
+			for (DWORD i = 0; i < dwInstanceCount; i++)
+			{
+				const auto devInfo = std::make_shared<DISPLAY_DEVICE_INFORMATION>();
+
+				wchar_t wszContainer[256]{ L'\0' };
+				if (FAILED(hr = pContainer->EnumChildContainerNames(i, wszContainer, 256)))
+				{
+					CLogHelper::Instance().Log(LL_ERR, fmt::format("pContainer(EnumChildContainerNames) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+					break;
+				}
+
+				if (FAILED(hr = pContainer->GetChildContainer(wszContainer, &pObject)) || !pObject)
+				{
+					CLogHelper::Instance().Log(LL_ERR, fmt::format("pContainer(GetChildContainer) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+					break;
+				}
+
+				if (FAILED(hr = __GetStringValue(pObject, L"szDescription", devInfo->szDescription, _countof(devInfo->szDescription))))
+				{
+					CLogHelper::Instance().Log(LL_ERR, fmt::format("__GetStringValue(szDescription) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+					break;
+				}
+
+				if (FAILED(hr = __GetStringValue(pObject, L"szDriverModelEnglish", devInfo->szDriverModel, _countof(devInfo->szDriverModel))))
+				{
+					CLogHelper::Instance().Log(LL_ERR, fmt::format("__GetStringValue(szDriverModelEnglish) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+					break;
+				}
+
+				SGraphicsAdapterFacts adapter{};
+				adapter.stDescription = devInfo->szDescription;
+				adapter.stDriverModel = devInfo->szDriverModel;
+				display.vAdapters.emplace_back(adapter);
+				SAFE_RELEASE(pObject);
+			}
+
+			// DirectX
+			if (FAILED(hr = pDxDiagRoot->GetChildContainer(L"DxDiag_SystemInfo", &pDxDiagSystemInfo)))
+			{
+				CLogHelper::Instance().Log(LL_ERR, fmt::format("GetChildContainer(DxDiag_SystemInfo) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+				break;
+			}
+
+			if (FAILED(hr = __GetIntValue(pDxDiagSystemInfo, L"dwDirectXVersionMajor", &dxVerInfo.nMajorVersion)))
+			{
+				CLogHelper::Instance().Log(LL_ERR, fmt::format("__GetIntValue(dwDirectXVersionMajor) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+				break;
+			}
+
+			if (FAILED(hr = __GetIntValue(pDxDiagSystemInfo, L"dwDirectXVersionMinor", &dxVerInfo.nMinorVersion)))
+			{
+				CLogHelper::Instance().Log(LL_ERR, fmt::format("__GetIntValue(dwDirectXVersionMinor) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
+				break;
+			}
+
+			display.nDirectXMajor = dxVerInfo.nMajorVersion;
+			display.nDirectXMinor = dxVerInfo.nMinorVersion;
+
+			bCompleted = true;
+		} while (FALSE);
+
+		SAFE_RELEASE(pObject);
+		SAFE_RELEASE(pContainer);
+		SAFE_RELEASE(pDxDiagSystemInfo);
+		SAFE_RELEASE(pDxDiagRoot);
+		SAFE_RELEASE(pDxDiagProvider);
+
+		if (bComInitialized)
+			CoUninitialize();
+
+		if (!bCompleted)
+			CLogHelper::Instance().Log(LL_ERR, "DirectX/WDDM check failed!");
+		return bCompleted;
+	}
 	bool CSysCheck::__LoadDisplayInformations()
 	{
 		static auto timer = CSimpleTimer<std::chrono::milliseconds>();
@@ -784,15 +948,10 @@ namespace Win11SysCheck
 
 		m_mapStatuses[nType] = EStatus::STATUS_INITIALIZING;
 
-
-		SSystemDetails sysDetails{};
-		const auto stIconText = CApplication::Instance().GetUI()->GetMenuTypeIconText(nType);
-		sysDetails.stTitle = fmt::format("{0}  {1} {2}:", stIconText, CApplication::Instance().GetI18N()->GetMenuTypeLocalizedText(nType),
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DETAILS)
-		);
+		auto& display = m_probeResult.display;
+		display = {};
 
 		// Enum monitors
-		BOOL bHasAvailableMonitor = FALSE;
 		{
 			const auto hDC = GetDC(nullptr);
 			if (!hDC)
@@ -802,10 +961,7 @@ namespace Win11SysCheck
 			}
 
 			auto OnMonitorEnum = [](HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor, LPARAM dwData) -> BOOL {
-				static auto s_nIdx = 0;
-				const auto c_pbHasAvailableMonitor = reinterpret_cast<BOOL*>(dwData);
-
-				s_nIdx++;
+				const auto c_pvMonitors = reinterpret_cast<std::vector <SMonitorFacts>*>(dwData);
 
 				MONITORINFOEX monInfo{ 0 };
 				monInfo.cbSize = sizeof(monInfo);
@@ -825,31 +981,23 @@ namespace Win11SysCheck
 					return TRUE;
 				}
 
-				const auto c_nBPC = GetDeviceCaps(hdcMonitor, BITSPIXEL);
-				const auto c_stIsPrimary = (monInfo.dwFlags & MONITORINFOF_PRIMARY) ? "true" : "false";
-
-				std::stringstream ss;
-				ss <<
-					"Monitor: " << s_nIdx <<
-					"\n\t\tID: " << displayDevice.DeviceID <<
-					"\n\t\tName: " << displayDevice.DeviceName << " - " << displayDevice.DeviceString <<
-					"\n\t\tPrimary: " << c_stIsPrimary <<
-					"\n\t\tBPC: " << c_nBPC <<
-					"\n\t\tResolution: " << monInfo.rcMonitor.right << "x" << monInfo.rcMonitor.bottom;
-				CApplication::Instance().GetSysCheck()->AddMonitorInformation(ss.str());
-
-				if (monInfo.rcMonitor.bottom >= 720 && c_nBPC >= 8)
-				{
-					*c_pbHasAvailableMonitor = TRUE;
-					return TRUE;
-				}
+				SMonitorFacts monitor{};
+				monitor.stDeviceID = displayDevice.DeviceID;
+				monitor.stDeviceName = displayDevice.DeviceName;
+				monitor.stDeviceString = displayDevice.DeviceString;
+				monitor.bPrimary = (monInfo.dwFlags & MONITORINFOF_PRIMARY) ? true : false;
+				monitor.nBitsPerPixel = GetDeviceCaps(hdcMonitor, BITSPIXEL);
+				monitor.nWidth = monInfo.rcMonitor.right;
+				monitor.nHeight = monInfo.rcMonitor.bottom;
+				c_pvMonitors->emplace_back(monitor);
 
 				return TRUE;
 			};
 
-			if (!EnumDisplayMonitors(hDC, nullptr, OnMonitorEnum, reinterpret_cast<LPARAM>(&bHasAvailableMonitor)))
+			if (!EnumDisplayMonitors(hDC, nullptr, OnMonitorEnum, reinterpret_cast<LPARAM>(&display.vMonitors)))
 			{
 				CLogHelper::Instance().Log(LL_ERR, fmt::format("EnumDisplayMonitors failed with error: {0}", GetLastError()));
+				ReleaseDC(nullptr, hDC);
 				return bRet;
 			}
 
@@ -857,9 +1005,9 @@ namespace Win11SysCheck
 		}
 
 		// Enum display devices from registry
-		auto bHasCompatibleDisplay = false;
-		std::vector <std::string> vDisplayDevRegDir;
 		{
+			std::vector <std::string> vDisplayDevRegDir;
+
 			HKEY hKey{};
 			auto lStatus = RegOpenKeyExA(HKEY_LOCAL_MACHINE, "SYSTEM\\CurrentControlSet\\Enum\\DISPLAY", 0, KEY_ENUMERATE_SUB_KEYS | KEY_QUERY_VALUE, &hKey);
 			if (lStatus == ERROR_SUCCESS)
@@ -905,14 +1053,13 @@ namespace Win11SysCheck
 							vDisplayDevRegDir.emplace_back(szParamPath);
 							dwIndex++;
 						}
+
+						RegCloseKey(hSubKey);
 					}
 				}
 
-				dwIndex = 0;
 				for (const auto& stDisplayDevRegPath : vDisplayDevRegDir)
 				{
-					dwIndex++;
-
 					HKEY hSubPathKey{};
 					lStatus = RegOpenKeyExA(HKEY_LOCAL_MACHINE, stDisplayDevRegPath.c_str(), 0, KEY_READ | KEY_QUERY_VALUE, &hSubPathKey);
 					if (lStatus == ERROR_SUCCESS)
@@ -921,194 +1068,41 @@ namespace Win11SysCheck
 						short sWidthCM = 0, sHeightCM = 0;
 						if (__GetMonitorSizeFromEDID(hSubPathKey, sWidthCM, sHeightCM))
 						{
-							// Convert to diagonal
-							const auto dDisplayCM = sqrt(sWidthCM * sWidthCM + sHeightCM * sHeightCM);
-
-							// CM to inches
-							const auto dDisplayInches = dDisplayCM * 0.393700787;
-
-							const auto stDetails = fmt::format("Display device: {0}\n\t\tRegistry path: {1}\n\t\tDisplay size: {2:L} inches", dwIndex, stDisplayDevRegPath, dDisplayInches);
-							sysDetails.vecTexts.emplace_back(stDetails);
+							SPanelFacts panel{};
+							panel.stRegistryPath = stDisplayDevRegPath;
+							panel.nWidthCm = static_cast<uint16_t>(sWidthCM);
+							panel.nHeightCm = static_cast<uint16_t>(sHeightCM);
+							display.vPanels.emplace_back(panel);
 
-							// Check size
-							if (dDisplayInches >= 9)
-							{
-								CLogHelper::Instance().Log(LL_SYS, fmt::format("Available display device with size: {0} detected!", dDisplayInches));
-								bHasCompatibleDisplay = true;
-								break;
-							}
+							CLogHelper::Instance().Log(LL_SYS, fmt::format("Display device with size: {0} detected!", GetPanelDiagonalInches(panel)));
 						}
 
 						RegCloseKey(hSubPathKey);
 					}
 				}
-			}
-		}
-
-		// Enum display devices from dxdiag API
-		DIRECTX_VERSION_INFORMATION dxVerInfo{};
-		std::vector <std::shared_ptr <DISPLAY_DEVICE_INFORMATION>> vDisplayDevices;
-		{
-			auto bCompleted = false;
-			auto bComInitialized = false;
-			IDxDiagContainer* pObject = nullptr;
-			IDxDiagContainer* pContainer = nullptr;
-			IDxDiagProvider* pDxDiagProvider = nullptr;
-			IDxDiagContainer* pDxDiagRoot = nullptr;
-			IDxDiagContainer* pDxDiagSystemInfo = nullptr;
-
-			do
-			{
-				auto hr = CoInitialize(nullptr);
-				bComInitialized = SUCCEEDED(hr);
-
-				if (FAILED(hr = CoCreateInstance(CLSID_DxDiagProvider, nullptr, CLSCTX_INPROC_SERVER, IID_IDxDiagProvider, (LPVOID*)&pDxDiagProvider)))
-				{
-					CLogHelper::Instance().Log(LL_ERR, fmt::format("CoCreateInstance(CLSID_DxDiagProvider) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-					break;
-				}
-				if (!pDxDiagProvider)
-				{
-					CLogHelper::Instance().Log(LL_ERR, "CoCreateInstance(CLSID_DxDiagProvider) returned nullptr!");
-					hr = E_POINTER;
-					break;
-				}
-
-				DXDIAG_INIT_PARAMS dxDiagInitParam{ 0 };
-				dxDiagInitParam.dwSize = sizeof(dxDiagInitParam);
-				dxDiagInitParam.dwDxDiagHeaderVersion = DXDIAG_DX9_SDK_VERSION;
-				dxDiagInitParam.bAllowWHQLChecks = false;
-				dxDiagInitParam.pReserved = nullptr;
-
-				if (FAILED(hr = pDxDiagProvider->Initialize(&dxDiagInitParam)))
-				{
-					CLogHelper::Instance().Log(LL_ERR, fmt::format("pDxDiagProvider(Initialize) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-					break;
-				}
-
-				if (FAILED(hr = pDxDiagProvider->GetRootContainer(&pDxDiagRoot)))
-				{
-					CLogHelper::Instance().Log(LL_ERR, fmt::format("pDxDiagProvider(GetRootContainer) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-					break;
-				}
-
-				if (FAILED(hr = pDxDiagRoot->GetChildContainer(L"DxDiag_DisplayDevices", &pContainer)))
-				{
-					CLogHelper::Instance().Log(LL_ERR, fmt::format("pDxDiagRoot(GetChildContainer) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-					break;
-				}
-
-				DWORD dwInstanceCount = 0;
-				if (FAILED(hr = pContainer->GetNumberOfChildContainers(&dwInstanceCount)))
-				{
-					CLogHelper::Instance().Log(LL_ERR, fmt::format("pContainer(GetNumberOfChildContainers) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-					break;
-				}
-
-				CLogHelper::Instance().Log(LL_SYS, fmt::format("{0} instance found!", dwInstanceCount));
-
-				// Display devices
-				for (DWORD i = 0; i < dwInstanceCount; i++)
-				{
-					const auto devInfo = std::make_shared<DISPLAY_DEVICE_INFORMATION>();
-
-					wchar_t wszContainer[256]{ L'\0' };
-					if (FAILED(hr = pContainer->EnumChildContainerNames(i, wszContainer, 256)))
-					{
-						CLogHelper::Instance().Log(LL_ERR, fmt::format("pContainer(EnumChildContainerNames) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-						break;
-					}
-
-					if (FAILED(hr = pContainer->GetChildContainer(wszContainer, &pObject)) || !pObject)
-					{
-						CLogHelper::Instance().Log(LL_ERR, fmt::format("pContainer(GetChildContainer) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-						break;
-					}
-
-					if (FAILED(hr = __GetStringValue(pObject, L"szDescription", devInfo->szDescription, _countof(devInfo->szDescription))))
-					{
-						CLogHelper::Instance().Log(LL_ERR, fmt::format("__GetStringValue(szDescription) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-						break;
-					}
-
-					if (FAILED(hr = __GetStringValue(pObject, L"szDriverModelEnglish", devInfo->szDriverModel, _countof(devInfo->szDriverModel))))
-					{
-						CLogHelper::Instance().Log(LL_ERR, fmt::format("__GetStringValue(szDriverModelEnglish) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-						break;
-					}
-
-					sysDetails.vecTexts.emplace_back(fmt::format("Display devices:\n\t\tDevice index: {0}\n\t\tDescription: {1}\n\t\tModel: {2}", i + 1, devInfo->szDescription, devInfo->szDriverModel));
-
-					vDisplayDevices.emplace_back(devInfo);
-					SAFE_RELEASE(pObject);
-				}
-
-				// DirectX
-				if (FAILED(hr = pDxDiagRoot->GetChildContainer(L"DxDiag_SystemInfo", &pDxDiagSystemInfo)))
-				{
-					CLogHelper::Instance().Log(LL_ERR, fmt::format("GetChildContainer(DxDiag_SystemInfo) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-					break;
-				}
-
-				if (FAILED(hr = __GetIntValue(pDxDiagSystemInfo, L"dwDirectXVersionMajor", &dxVerInfo.nMajorVersion)))
-				{
-					CLogHelper::Instance().Log(LL_ERR, fmt::format("__GetIntValue(dwDirectXVersionMajor) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-					break;
-				}
-
-				if (FAILED(hr = __GetIntValue(pDxDiagSystemInfo, L"dwDirectXVersionMinor", &dxVerInfo.nMinorVersion)))
-				{
-					CLogHelper::Instance().Log(LL_ERR, fmt::format("__GetIntValue(dwDirectXVersionMinor) failed with status: {0}", fmt::ptr(reinterpret_cast<void*>(hr))));
-					break;
-				}
-
-				sysDetails.vecTexts.emplace_back(fmt::format("\n\tDirectX:\n\t\tVersion: {0}.{1}", dxVerInfo.nMajorVersion, dxVerInfo.nMinorVersion));
-
-				bCompleted = true;
-			} while (FALSE);
-
-			SAFE_RELEASE(pObject);
-			SAFE_RELEASE(pContainer);
-			SAFE_RELEASE(pDxDiagSystemInfo);
-			SAFE_RELEASE(pDxDiagRoot);
-			SAFE_RELEASE(pDxDiagProvider);
-
-			if (bComInitialized)
-				CoUninitialize();
 
-			if (!bCompleted)
-			{
-				CLogHelper::Instance().Log(LL_ERR, "DirectX/WDDM check failed!");
-				return bRet;
+				RegCloseKey(hKey);
 			}
 		}
 
-		auto bHasAvailableWDDM = false;
-		for (const auto& spDeviceInfo : vDisplayDevices)
+		// Hardware validated across the fleet passes whatever adapter DxDiag would report
+		if (m_knownGoodFilter.MayContain(ComputeHardwareFingerprint(m_probeResult, false)))
 		{
-			if (spDeviceInfo)
-			{
-				const std::string c_stModelInfo = spDeviceInfo->szDriverModel;
-				if (c_stModelInfo.find("WDDM 2") != std::string::npos ||
-					c_stModelInfo.find("WDDM 3") != std::string::npos)
-				{
-					bHasAvailableWDDM = true;
-					break;
-				}
-			}
-		}
+			CApplication::Instance().GetMetrics()->Counter("win11syscheck_probe_cache_hits_total", "Probes answered without running the underlying system queries",
+				{ { "section", GetMenuTypeKey(nType) } }
+			).Increment();
 
-		for (const auto& stMonitorInfo : m_vMonitorInfos)
-		{
-			sysDetails.vecTexts.emplace_back(stMonitorInfo);
+			display.bDxDiagSkipped = true;
+			__CommitSection(nType, EvaluateDisplayReadiness(display));
+
+			CLogHelper::Instance().Log(LL_SYS, fmt::format("Display informations loaded in: {0} ms, DxDiag skipped for known good hardware", timer.diff()));
+			return true;
 		}
 
-		m_mapSystemDetails[nType] = sysDetails;
+		if (!__LoadDxDiagInformations(display))
+			return bRet;
 
-		if (bHasAvailableMonitor && (!vDisplayDevRegDir.empty() && bHasCompatibleDisplay) && dxVerInfo.nMajorVersion >= 12 && bHasAvailableWDDM)
-			m_mapStatuses[nType] = EStatus::STATUS_OK;
-		else
-			m_mapStatuses[nType] = EStatus::STATUS_FAIL;
+		__CommitSection(nType, EvaluateDisplayReadiness(display));
 
 		bRet = true;
 		CLogHelper::Instance().Log(LL_SYS, fmt::format("Display informations loaded in: {0} ms", timer.diff()));
@@ -1138,38 +1132,89 @@ namespace Win11SysCheck
 			CLogHelper::Instance().Log(LL_ERR, fmt::format("InternetAttemptConnect failed with error: {0}", GetLastError()));
 		}
 
-		SSystemDetails sysDetails{};
-		const auto stIconText = CApplication::Instance().GetUI()->GetMenuTypeIconText(nType);
-		sysDetails.stTitle = fmt::format("{0}  {1} {2}:", stIconText, CApplication::Instance().GetI18N()->GetMenuTypeLocalizedText(nType),
-			CApplication::Instance().GetI18N()->GetCommonLocalizedText(ECommonTextID::TEXT_ID_DETAILS)
-		);
-
-		sysDetails.vecTexts.emplace_back(fmt::format("Network state: {0}\n\tInternet state: {1}",
-			bNetworkState,
-			dwTestConnectionRet == ERROR_SUCCESS ? 1 : 0
-		));
+		m_probeResult.internet.bConnected = bNetworkState ? true : false;
+		m_probeResult.internet.bReachable = dwTestConnectionRet == ERROR_SUCCESS;
 
-		m_mapSystemDetails[nType] = sysDetails;
-
-		if (bNetworkState && dwTestConnectionRet == ERROR_SUCCESS)
-			m_mapStatuses[nType] = EStatus::STATUS_OK;
-		else
-			m_mapStatuses[nType] = EStatus::STATUS_FAIL;
+		__CommitSection(nType, EvaluateInternetReadiness(m_probeResult.internet));
 
 		bRet = true;
 		CLogHelper::Instance().Log(LL_SYS, fmt::format("Internet informations loaded in: {0} ms", timer.diff()));
 		return bRet;
 	}
 
+	void CSysCheck::__PublishMetrics(uint64_t nScanDurationUs)
+	{
+		const auto pMetrics = CApplication::Instance().GetMetrics();
+
+		for (size_t i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			const auto nType = static_cast<EMenuType>(i);
+			const auto nStatus = GetMenuStatus(nType);
+
+			pMetrics->Gauge("win11syscheck_section_ready", "Section readiness verdict, 1 compatible 0 not compatible -1 not evaluated",
+				{ { "section", GetMenuTypeKey(nType) } }
+			).Set(nStatus == EStatus::STATUS_OK ? 1 : nStatus == EStatus::STATUS_FAIL ? 0 : -1);
+		}
+
+		pMetrics->Gauge("win11syscheck_upgrade_ready", "Overall upgrade verdict for the target OS", { { "target", "windows11" } }).Set(CanSystemUpgradable() ? 1 : 0);
+		pMetrics->Gauge("win11syscheck_scan_duration_seconds", "Wall time of the last complete scan").Set(nScanDurationUs / 1e6);
+		pMetrics->Gauge("win11syscheck_scan_timestamp_seconds", "Unix time of the last scan completion").Set(static_cast<double>(std::time(nullptr)));
+		pMetrics->Counter("win11syscheck_scans_total", "Number of completed scans").Increment();
+
+		if (m_stMetricsFile.empty())
+			return;
+
+		if (!pMetrics->WriteTextFile(m_stMetricsFile))
+			CLogHelper::Instance().Log(LL_ERR, fmt::format("Metrics textfile: {0} could not be written", m_stMetricsFile));
+	}
+
 	DWORD CSysCheck::__ThreadRoutine(void)
 	{
-		const auto bStatus = __LoadOSInformations() &&
-			__LoadBootInformations() &&
-			__LoadCPUInformations() &&
-			__LoadRAMInformations() &&
-			__LoadDiskInformations() &&
-			__LoadDisplayInformations() &&
-			__LoadInternetInformations();
+		using TProbeRoutine = bool(CSysCheck::*)();
+		static const std::vector <std::pair <EMenuType, TProbeRoutine>> sc_vProbes = {
+			{ EMenuType::MENU_TYPE_OS, &CSysCheck::__LoadOSInformations },
+			{ EMenuType::MENU_TYPE_BOOT, &CSysCheck::__LoadBootInformations },
+			{ EMenuType::MENU_TYPE_CPU, &CSysCheck::__LoadCPUInformations },
+			{ EMenuType::MENU_TYPE_RAM, &CSysCheck::__LoadRAMInformations },
+			{ EMenuType::MENU_TYPE_DISK, &CSysCheck::__LoadDiskInformations },
+			{ EMenuType::MENU_TYPE_DISPLAY, &CSysCheck::__LoadDisplayInformations },
+			{ EMenuType::MENU_TYPE_INTERNET, &CSysCheck::__LoadInternetInformations }
+		};
+
+		const auto pMetrics = CApplication::Instance().GetMetrics();
+		auto scanTimer = CSimpleTimer<std::chrono::microseconds>();
+
+		auto bStatus = true;
+		for (const auto& [nType, fnProbe] : sc_vProbes)
+		{
+			const TMetricLabels labels = { { "section", GetMenuTypeKey(nType) } };
+
+			// Registered up front so every section exports a series, even while it is zero
+			auto& failures = pMetrics->Counter("win11syscheck_probe_failures_total", "Probes that could not collect their section", labels);
+			auto& timeouts = pMetrics->Counter("win11syscheck_probe_timeouts_total", "Probes that exceeded the configured time budget", labels);
+			pMetrics->Counter("win11syscheck_probe_cache_hits_total", "Probes answered without running the underlying system queries", labels);
+
+			auto probeTimer = CSimpleTimer<std::chrono::microseconds>();
+			const auto bProbeRet = (this->*fnProbe)();
+			const auto nElapsedUs = probeTimer.diff();
+
+			pMetrics->Histogram("win11syscheck_probe_duration_seconds", "Probe latency per section", CHistogram::DefaultLatencyBounds(), labels).Observe(nElapsedUs / 1e6);
+
+			if (m_nProbeTimeoutMs && nElapsedUs / 1000 > m_nProbeTimeoutMs)
+			{
+				CLogHelper::Instance().Log(LL_WARN, fmt::format("{0} probe exceeded its time budget: {1} ms", GetMenuTypeKey(nType), nElapsedUs / 1000));
+				timeouts.Increment();
+			}
+
+			if (!bProbeRet)
+			{
+				failures.Increment();
+				bStatus = false;
+				break;
+			}
+		}
+
+		__PublishMetrics(scanTimer.diff());
 
 		if (!bStatus)
 		{
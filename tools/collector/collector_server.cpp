@@ -0,0 +1,460 @@
+#include "collector_server.hpp"
+#include "../../include/core/binary_report.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/result_export.hpp"
+#include "../../include/simple_timer.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace Win11SysCheck
+{
+	static constexpr int COLLECTOR_LISTEN_BACKLOG = 1024;
+	static constexpr int COLLECTOR_MAX_EVENTS = 256;
+	static constexpr size_t COLLECTOR_READ_SIZE = 256 * 1024;
+
+	CCollectorServer::CCollectorServer(const SCollectorOptions& options, CStoreCommitter& committer, CMetricsRegistry& metrics) :
+		m_options(options), m_committer(committer),
+		m_connections(metrics.Gauge("win11syscheck_collector_connections", "Open agent connections")),
+		m_accepted(metrics.Counter("win11syscheck_collector_connections_total", "Agent connections accepted")),
+		m_received(metrics.Counter("win11syscheck_collector_reports_received_total", "Reports received, binary batches count every report")),
+		m_rejected(metrics.Counter("win11syscheck_collector_reports_rejected_total", "Reports that could not be decoded")),
+		m_protocolErrors(metrics.Counter("win11syscheck_collector_protocol_errors_total", "Connections closed on malformed framing")),
+		m_bytesReceived(metrics.Counter("win11syscheck_collector_received_bytes_total", "Bytes read from agent connections")),
+		m_decodeLatency(metrics.Histogram("win11syscheck_collector_decode_latency_seconds", "Report decoding and evaluation time", CHistogram::DefaultLatencyBounds())),
+		m_fullReports(metrics.Counter("win11syscheck_collector_reports_by_kind_total", "Reports received by kind", { { "kind", "full" } })),
+		m_deltaReports(metrics.Counter("win11syscheck_collector_reports_by_kind_total", "Reports received by kind", { { "kind", "delta" } })),
+		m_heartbeats(metrics.Counter("win11syscheck_collector_reports_by_kind_total", "Reports received by kind", { { "kind", "heartbeat" } })),
+		m_resyncs(metrics.Counter("win11syscheck_collector_reports_by_kind_total", "Reports received by kind", { { "kind", "resync" } }))
+	{
+		m_options.nThreads = (std::max)(m_options.nThreads, 1u);
+	}
+	CCollectorServer::~CCollectorServer()
+	{
+		Stop();
+	}
+
+	bool CCollectorServer::Start()
+	{
+		for (uint32_t i = 0; i < m_options.nThreads; ++i)
+		{
+			auto spWorker = std::make_unique<SWorker>();
+			spWorker->nIndex = i;
+			spWorker->nEpoll = epoll_create1(EPOLL_CLOEXEC);
+			spWorker->nMailboxEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+			// The first listener resolves an ephemeral port, the others join it
+			const auto bOpened = spWorker->nEpoll >= 0 && spWorker->nMailboxEvent >= 0 && __OpenListener(*spWorker);
+			m_vWorkers.emplace_back(std::move(spWorker));
+			if (!bOpened)
+			{
+				std::cerr << "Collector listener " << i << " could not be opened: " << std::strerror(errno) << std::endl;
+				Stop();
+				return false;
+			}
+		}
+
+		for (auto& spWorker : m_vWorkers)
+		{
+			auto& worker = *spWorker;
+			worker.thread = std::thread([this, &worker] { __Run(worker); });
+		}
+		return true;
+	}
+
+	void CCollectorServer::Stop()
+	{
+		m_bStopping = true;
+		for (auto& spWorker : m_vWorkers)
+		{
+			if (spWorker->nMailboxEvent >= 0)
+			{
+				const uint64_t nWake = 1;
+				[[maybe_unused]] const auto nWritten = write(spWorker->nMailboxEvent, &nWake, sizeof(nWake));
+			}
+		}
+
+		for (auto& spWorker : m_vWorkers)
+		{
+			if (spWorker->thread.joinable())
+				spWorker->thread.join();
+
+			for (auto& [nSocket, spConnection] : spWorker->mapConnections)
+			{
+				close(nSocket);
+				m_connections.Add(-1);
+			}
+			spWorker->mapConnections.clear();
+
+			for (auto pnHandle : { &spWorker->nListenSocket, &spWorker->nEpoll, &spWorker->nMailboxEvent })
+			{
+				if (*pnHandle >= 0)
+					close(*pnHandle);
+				*pnHandle = -1;
+			}
+		}
+	}
+
+	void CCollectorServer::OnCommitted(const std::vector <SPendingReport>& vReports, bool bCommitted)
+	{
+		std::vector <std::vector <SAck>> vRouted(m_vWorkers.size());
+		for (const auto& report : vReports)
+		{
+			vRouted[report.nWorker].emplace_back(SAck{
+				report.nSocket, report.nConnectionId, report.record.nMachineId,
+				bCommitted ? EReportAck::REPORT_ACK_COMMITTED : EReportAck::REPORT_ACK_REJECTED
+			});
+		}
+
+		for (size_t i = 0; i < vRouted.size(); ++i)
+		{
+			if (vRouted[i].empty())
+				continue;
+
+			auto& worker = *m_vWorkers[i];
+			{
+				std::lock_guard <std::mutex> lock(worker.mtxMailbox);
+				worker.vMailbox.insert(worker.vMailbox.end(), vRouted[i].begin(), vRouted[i].end());
+			}
+			const uint64_t nWake = 1;
+			[[maybe_unused]] const auto nWritten = write(worker.nMailboxEvent, &nWake, sizeof(nWake));
+		}
+	}
+
+	CFactHistograms CCollectorServer::GetHistograms() const
+	{
+		CFactHistograms histograms;
+		for (const auto& spWorker : m_vWorkers)
+			histograms.Merge(spWorker->histograms);
+		return histograms;
+	}
+
+	bool CCollectorServer::__OpenListener(SWorker& worker)
+	{
+		worker.nListenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (worker.nListenSocket < 0)
+			return false;
+
+		const int nEnable = 1;
+		setsockopt(worker.nListenSocket, SOL_SOCKET, SO_REUSEADDR, &nEnable, sizeof(nEnable));
+		if (setsockopt(worker.nListenSocket, SOL_SOCKET, SO_REUSEPORT, &nEnable, sizeof(nEnable)) < 0)
+			return false;
+
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(worker.nIndex ? m_nPort : m_options.nPort);
+		if (inet_pton(AF_INET, m_options.stBindAddress.c_str(), &address.sin_addr) != 1)
+		{
+			errno = EINVAL;
+			return false;
+		}
+		if (bind(worker.nListenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+			listen(worker.nListenSocket, COLLECTOR_LISTEN_BACKLOG) < 0)
+		{
+			return false;
+		}
+
+		if (!worker.nIndex)
+		{
+			socklen_t nLength = sizeof(address);
+			if (getsockname(worker.nListenSocket, reinterpret_cast<sockaddr*>(&address), &nLength) < 0)
+				return false;
+			m_nPort = ntohs(address.sin_port);
+		}
+
+		epoll_event listenEvent{};
+		listenEvent.events = EPOLLIN;
+		listenEvent.data.fd = worker.nListenSocket;
+
+		epoll_event mailboxEvent{};
+		mailboxEvent.events = EPOLLIN;
+		mailboxEvent.data.fd = worker.nMailboxEvent;
+
+		return epoll_ctl(worker.nEpoll, EPOLL_CTL_ADD, worker.nListenSocket, &listenEvent) == 0 &&
+			epoll_ctl(worker.nEpoll, EPOLL_CTL_ADD, worker.nMailboxEvent, &mailboxEvent) == 0;
+	}
+
+	void CCollectorServer::__Run(SWorker& worker)
+	{
+		epoll_event arEvents[COLLECTOR_MAX_EVENTS];
+
+		while (!m_bStopping)
+		{
+			const auto nCount = epoll_wait(worker.nEpoll, arEvents, COLLECTOR_MAX_EVENTS, -1);
+			if (nCount < 0)
+			{
+				if (errno == EINTR)
+					continue;
+
+				std::cerr << "Collector worker " << worker.nIndex << " epoll failed: " << std::strerror(errno) << std::endl;
+				break;
+			}
+
+			for (int i = 0; i < nCount; ++i)
+			{
+				const auto nSocket = arEvents[i].data.fd;
+				if (nSocket == worker.nListenSocket)
+				{
+					__Accept(worker);
+					continue;
+				}
+				if (nSocket == worker.nMailboxEvent)
+				{
+					uint64_t nWakeCount = 0;
+					[[maybe_unused]] const auto nRead = read(worker.nMailboxEvent, &nWakeCount, sizeof(nWakeCount));
+					__DeliverAcks(worker);
+					continue;
+				}
+
+				const auto it = worker.mapConnections.find(nSocket);
+				if (it == worker.mapConnections.end())
+					continue;
+
+				auto& connection = *it->second;
+				auto bOpen = !(arEvents[i].events & (EPOLLERR | EPOLLHUP));
+				if (bOpen && (arEvents[i].events & EPOLLIN))
+					bOpen = __Receive(worker, connection);
+				if (bOpen && (arEvents[i].events & EPOLLOUT))
+					bOpen = __Send(connection);
+
+				if (!bOpen)
+					__Close(worker, connection);
+			}
+		}
+	}
+
+	void CCollectorServer::__Accept(SWorker& worker)
+	{
+		while (true)
+		{
+			const auto nSocket = accept4(worker.nListenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (nSocket < 0)
+			{
+				if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+					std::cerr << "Collector accept failed: " << std::strerror(errno) << std::endl;
+				return;
+			}
+
+			// Acknowledgements are small and latency bound
+			const int nEnable = 1;
+			setsockopt(nSocket, IPPROTO_TCP, TCP_NODELAY, &nEnable, sizeof(nEnable));
+
+			// Edge triggered, so both directions are drained until EAGAIN
+			epoll_event event{};
+			event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+			event.data.fd = nSocket;
+			if (epoll_ctl(worker.nEpoll, EPOLL_CTL_ADD, nSocket, &event) < 0)
+			{
+				close(nSocket);
+				continue;
+			}
+
+			auto spConnection = std::make_unique<SConnection>();
+			spConnection->nSocket = nSocket;
+			spConnection->nId = m_nNextConnectionId++;
+			worker.mapConnections[nSocket] = std::move(spConnection);
+
+			m_accepted.Increment();
+			m_connections.Add(1);
+		}
+	}
+
+	bool CCollectorServer::__Receive(SWorker& worker, SConnection& connection)
+	{
+		char arBuffer[COLLECTOR_READ_SIZE];
+		while (true)
+		{
+			const auto nRead = recv(connection.nSocket, arBuffer, sizeof(arBuffer), 0);
+			if (nRead == 0)
+				return false;
+			if (nRead < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return errno == EAGAIN || errno == EWOULDBLOCK;
+			}
+
+			m_bytesReceived.Increment(static_cast<uint64_t>(nRead));
+			connection.reader.Append(arBuffer, static_cast<size_t>(nRead));
+
+			SReportFrame frame;
+			while (connection.reader.Next(frame))
+			{
+				if (!__HandleFrame(worker, connection, frame))
+				{
+					m_protocolErrors.Increment();
+					return false;
+				}
+			}
+			if (connection.reader.IsCorrupt())
+			{
+				m_protocolErrors.Increment();
+				return false;
+			}
+
+			// Rejections and heartbeats are answered right away
+			if (connection.nOutboxOffset < connection.stOutbox.size() && !__Send(connection))
+				return false;
+		}
+	}
+
+	bool CCollectorServer::__HandleFrame(SWorker& worker, SConnection& connection, const SReportFrame& frame)
+	{
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+
+		if (frame.nType == EFrameType::FRAME_REPORT_BATCH)
+		{
+			// Decoded in full first, a malformed batch is dropped without acknowledging any of it
+			CBinaryReportReader reader;
+			if (!reader.Open(frame.pPayload, frame.nPayloadSize))
+				return false;
+
+			auto& vBatch = worker.vBatch;
+			vBatch.resize(reader.GetReportCount());
+			for (auto& report : vBatch)
+			{
+				if (!reader.Next(report.result, report.nMachineId, &report.nSectionMask, &report.nBaseDigest))
+					return false;
+			}
+			SProbeResult extra;
+			uint64_t nExtraId = 0;
+			if (reader.Next(extra, nExtraId) || reader.IsCorrupt())
+				return false;
+
+			m_received.Increment(vBatch.size());
+			const auto nDecodeUs = timer.diff() / (std::max)(vBatch.size(), size_t(1));
+			for (auto& report : vBatch)
+				__Ingest(worker, connection, report, nDecodeUs);
+			return true;
+		}
+		if (frame.nType != EFrameType::FRAME_REPORT_JSON || frame.nPayloadSize < sizeof(uint64_t))
+			return false;
+
+		m_received.Increment();
+
+		uint64_t nMachineId = 0;
+		std::memcpy(&nMachineId, frame.pPayload, sizeof(nMachineId));
+
+		SDecodedReport report;
+		report.nMachineId = nMachineId;
+		if (!ParseExportedJson(frame.pPayload + sizeof(nMachineId), frame.nPayloadSize - sizeof(nMachineId), report.result))
+		{
+			m_rejected.Increment();
+			AppendAckFrame(connection.stOutbox, nMachineId, EReportAck::REPORT_ACK_REJECTED);
+			return true;
+		}
+		__Ingest(worker, connection, report, timer.diff());
+		return true;
+	}
+
+	void CCollectorServer::__Ingest(SWorker& worker, SConnection& connection, SDecodedReport& report, uint64_t nDecodeUs)
+	{
+		switch (m_stateStore.Apply(report.nMachineId, report.nSectionMask, report.nBaseDigest, report.result))
+		{
+		case EDeltaApply::DELTA_APPLY_FULL:
+			m_fullReports.Increment();
+			break;
+		case EDeltaApply::DELTA_APPLY_CHANGED:
+			m_deltaReports.Increment();
+			break;
+		case EDeltaApply::DELTA_APPLY_UNCHANGED:
+			// The state was committed when its report was acknowledged, nothing to write again
+			m_heartbeats.Increment();
+			AppendAckFrame(connection.stOutbox, report.nMachineId, EReportAck::REPORT_ACK_COMMITTED);
+			return;
+		case EDeltaApply::DELTA_APPLY_RESYNC:
+			m_resyncs.Increment();
+			AppendAckFrame(connection.stOutbox, report.nMachineId, EReportAck::REPORT_ACK_RESYNC);
+			return;
+		}
+		__Submit(worker, connection, report.result, report.nMachineId, nDecodeUs);
+	}
+
+	void CCollectorServer::__Submit(SWorker& worker, SConnection& connection, SProbeResult& result, uint64_t nMachineId, uint64_t nDecodeUs)
+	{
+		// Agent side statuses are not trusted, the collector evaluates with its own rules
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+		EvaluateReadiness(result);
+		nDecodeUs += timer.diff();
+
+		worker.histograms.RecordLatency(nDecodeUs);
+		worker.histograms.Record(result);
+		m_decodeLatency.Observe(static_cast<double>(nDecodeUs) / 1e6);
+
+		SPendingReport report;
+		report.record = MakeFleetRecord(result, nMachineId);
+		report.nWorker = worker.nIndex;
+		report.nSocket = connection.nSocket;
+		report.nConnectionId = connection.nId;
+		report.tReceived = std::chrono::steady_clock::now();
+		m_committer.Submit(std::move(report));
+	}
+
+	bool CCollectorServer::__Send(SConnection& connection)
+	{
+		while (connection.nOutboxOffset < connection.stOutbox.size())
+		{
+			const auto nSent = send(
+				connection.nSocket, connection.stOutbox.data() + connection.nOutboxOffset,
+				connection.stOutbox.size() - connection.nOutboxOffset, MSG_NOSIGNAL
+			);
+			if (nSent < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				// The rest goes out on the next EPOLLOUT edge
+				return errno == EAGAIN || errno == EWOULDBLOCK;
+			}
+			connection.nOutboxOffset += static_cast<size_t>(nSent);
+		}
+
+		connection.stOutbox.clear();
+		connection.nOutboxOffset = 0;
+		return true;
+	}
+
+	void CCollectorServer::__DeliverAcks(SWorker& worker)
+	{
+		std::vector <SAck> vAcks;
+		{
+			std::lock_guard <std::mutex> lock(worker.mtxMailbox);
+			vAcks.swap(worker.vMailbox);
+		}
+
+		std::vector <SConnection*> vTouched;
+		for (const auto& ack : vAcks)
+		{
+			// The agent may have disconnected and its descriptor been reused meanwhile
+			const auto it = worker.mapConnections.find(ack.nSocket);
+			if (it == worker.mapConnections.end() || it->second->nId != ack.nConnectionId)
+				continue;
+
+			auto& connection = *it->second;
+			if (connection.stOutbox.empty())
+				vTouched.emplace_back(&connection);
+			AppendAckFrame(connection.stOutbox, ack.nMachineId, ack.nAck);
+		}
+
+		for (const auto pConnection : vTouched)
+		{
+			if (!__Send(*pConnection))
+				__Close(worker, *pConnection);
+		}
+	}
+
+	void CCollectorServer::__Close(SWorker& worker, SConnection& connection)
+	{
+		const auto nSocket = connection.nSocket;
+		epoll_ctl(worker.nEpoll, EPOLL_CTL_DEL, nSocket, nullptr);
+		close(nSocket);
+		worker.mapConnections.erase(nSocket);
+		m_connections.Add(-1);
+	}
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include "store_committer.hpp"
+#include "../../include/core/report_delta.hpp"
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+namespace Win11SysCheck
+{
+	struct SCollectorOptions
+	{
+		std::string stBindAddress{ "127.0.0.1" };
+		uint16_t nPort{ 0 };		// 0 picks a free port, see GetPort
+		uint32_t nThreads{ 4 };		// I/O threads, each owns a listener and an epoll set
+	};
+
+	// Report ingest front end. Every I/O thread binds its own SO_REUSEPORT listener so the kernel spreads
+	// connections without a shared accept queue; a connection then stays on that thread for its lifetime.
+	// Reports are decoded, applied to the machine state and evaluated on the I/O thread, and acknowledged
+	// once the committer wrote them. Heartbeats and resync requests are answered without a commit.
+	class CCollectorServer
+	{
+		struct SConnection
+		{
+			int nSocket{ -1 };
+			uint64_t nId{ 0 };
+			CReportFrameReader reader;
+			std::string stOutbox;
+			size_t nOutboxOffset{ 0 };
+		};
+
+		struct SAck
+		{
+			int nSocket{ -1 };
+			uint64_t nConnectionId{ 0 };
+			uint64_t nMachineId{ 0 };
+			EReportAck nAck{ EReportAck::REPORT_ACK_COMMITTED };
+		};
+
+		struct SDecodedReport
+		{
+			uint64_t nMachineId{ 0 };
+			uint16_t nSectionMask{ BINARY_REPORT_ALL_SECTIONS };
+			uint64_t nBaseDigest{ 0 };
+			SProbeResult result;
+		};
+
+		struct SWorker
+		{
+			uint32_t nIndex{ 0 };
+			int nListenSocket{ -1 };
+			int nEpoll{ -1 };
+			int nMailboxEvent{ -1 };	// eventfd, wakes the thread for acknowledgements and shutdown
+			std::thread thread;
+			std::unordered_map <int, std::unique_ptr <SConnection>> mapConnections;
+
+			std::mutex mtxMailbox;
+			std::vector <SAck> vMailbox;
+
+			CFactHistograms histograms;
+			std::vector <SDecodedReport> vBatch;	// Reused decode buffer of binary batches
+		};
+
+	public:
+		CCollectorServer(const SCollectorOptions& options, CStoreCommitter& committer, CMetricsRegistry& metrics);
+		~CCollectorServer();
+
+		bool Start();
+		void Stop();
+
+		// Commit callback of the store committer, routes the acknowledgements to the owning I/O threads
+		void OnCommitted(const std::vector <SPendingReport>& vReports, bool bCommitted);
+
+		uint16_t GetPort() const { return m_nPort; };
+		// Facts and decode latency of every accepted report, read once the server is stopped
+		CFactHistograms GetHistograms() const;
+		// Last known state per machine, deltas are applied to it
+		CDeltaStateStore& GetStateStore() { return m_stateStore; };
+
+	protected:
+		bool __OpenListener(SWorker& worker);
+		void __Run(SWorker& worker);
+		void __Accept(SWorker& worker);
+		bool __Receive(SWorker& worker, SConnection& connection);
+		bool __HandleFrame(SWorker& worker, SConnection& connection, const SReportFrame& frame);
+		void __Ingest(SWorker& worker, SConnection& connection, SDecodedReport& report, uint64_t nDecodeUs);
+		void __Submit(SWorker& worker, SConnection& connection, SProbeResult& result, uint64_t nMachineId, uint64_t nDecodeUs);
+		bool __Send(SConnection& connection);
+		void __DeliverAcks(SWorker& worker);
+		void __Close(SWorker& worker, SConnection& connection);
+
+	private:
+		SCollectorOptions m_options;
+		CStoreCommitter& m_committer;
+		std::vector <std::unique_ptr <SWorker>> m_vWorkers;
+		std::atomic <bool> m_bStopping{ false };
+		std::atomic <uint64_t> m_nNextConnectionId{ 1 };
+		uint16_t m_nPort{ 0 };
+		CDeltaStateStore m_stateStore;
+
+		CGauge& m_connections;
+		CCounter& m_accepted;
+		CCounter& m_received;
+		CCounter& m_rejected;
+		CCounter& m_protocolErrors;
+		CCounter& m_bytesReceived;
+		CHistogram& m_decodeLatency;
+		CCounter& m_fullReports;
+		CCounter& m_deltaReports;
+		CCounter& m_heartbeats;
+		CCounter& m_resyncs;
+	};
+};
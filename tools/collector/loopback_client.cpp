@@ -0,0 +1,278 @@
+#include "loopback_client.hpp"
+#include "../../include/core/binary_report.hpp"
+#include "../../include/core/legacy_export.hpp"
+#include "../../include/core/profile_generator.hpp"
+#include "../../include/core/report_delta.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	// Generating is far slower than ingesting, reports reuse a pool of results under distinct machine ids
+	static constexpr uint64_t LOOPBACK_RESULT_POOL = 4096;
+
+	static int ConnectLoopback(const std::string& stHost, uint16_t nPort)
+	{
+		const auto nSocket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (nSocket < 0)
+			return -1;
+
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(nPort);
+		if (inet_pton(AF_INET, stHost.c_str(), &address.sin_addr) != 1 ||
+			connect(nSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+		{
+			close(nSocket);
+			return -1;
+		}
+
+		const int nEnable = 1;
+		setsockopt(nSocket, IPPROTO_TCP, TCP_NODELAY, &nEnable, sizeof(nEnable));
+		return nSocket;
+	}
+
+	static bool SendAll(int nSocket, const std::string& stBuffer)
+	{
+		size_t nOffset = 0;
+		while (nOffset < stBuffer.size())
+		{
+			const auto nSent = send(nSocket, stBuffer.data() + nOffset, stBuffer.size() - nOffset, MSG_NOSIGNAL);
+			if (nSent < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return false;
+			}
+			nOffset += static_cast<size_t>(nSent);
+		}
+		return true;
+	}
+
+	static uint64_t MixRound(uint64_t nMachineId, uint32_t nRound)
+	{
+		auto x = nMachineId * 0x9E3779B97F4A7C15ull + nRound;
+		x ^= x >> 31;
+		x *= 0xBF58476D1CE4E5B9ull;
+		x ^= x >> 29;
+		return x;
+	}
+
+	bool RunLoopbackClient(const std::string& stHost, uint16_t nPort, const SLoopbackOptions& options, SLoopbackResult& result)
+	{
+		const auto nConnections = (std::max)(options.nConnections, 1u);
+		const auto nRounds = (std::max)(options.nRounds, 1u);
+		const auto nBatchSize = (std::min)(options.bDelta ? (std::max)(options.nBatchSize, 1u) : options.nBatchSize, (std::max)(options.nWindow, 1u));
+		const auto nChangeThreshold = static_cast<uint64_t>(options.dChangeRate * 1e6);
+
+		const CProfileGenerator generator(options.nSeed, options.nSkuCount);
+		const SLegacyLabels labels{};
+		std::vector <SProbeResult> vResults((std::max)((std::min)(options.nReportCount, LOOPBACK_RESULT_POOL), uint64_t(1)));
+		std::vector <std::string> vDocuments(nBatchSize ? 0 : vResults.size());
+		for (size_t i = 0; i < vResults.size(); ++i)
+		{
+			vResults[i] = generator.Generate(i);
+			if (!nBatchSize)
+				vDocuments[i] = SerializeLegacyJson(vResults[i], labels);
+		}
+
+		std::vector <int> vSockets;
+		for (uint32_t i = 0; i < nConnections; ++i)
+		{
+			const auto nSocket = ConnectLoopback(stHost, nPort);
+			if (nSocket < 0)
+			{
+				std::cerr << "Loopback client could not connect to " << stHost << ":" << nPort << ": " << std::strerror(errno) << std::endl;
+				for (const auto nOpened : vSockets)
+					close(nOpened);
+				return false;
+			}
+			vSockets.emplace_back(nSocket);
+		}
+
+		std::mutex mtxResult;
+		std::atomic <bool> bFailed{ false };
+		const auto tStart = std::chrono::steady_clock::now();
+
+		std::vector <std::thread> vThreads;
+		for (uint32_t nConnection = 0; nConnection < nConnections; ++nConnection)
+		{
+			vThreads.emplace_back([&, nConnection] {
+				const auto nSocket = vSockets[nConnection];
+				// Connection c owns machine ids c, c + n, c + 2n, ... and reports each of them once per round
+				const auto nMachines = options.nReportCount / nConnections + (nConnection < options.nReportCount % nConnections);
+				const auto nAssigned = nMachines * nRounds;
+				const auto nWindow = static_cast<size_t>((std::min)(static_cast<uint64_t>((std::max)(options.nWindow, 1u)), (std::max)(nMachines, uint64_t(1))));
+
+				std::vector <CDeltaReporter> vReporters(options.bDelta ? nMachines : 0);
+				std::vector <uint32_t> vBuildOffsets(nMachines);
+
+				CBinaryReportWriter writer;
+				std::string stPayload, stRoundDocument;
+				CHdrHistogram latency;
+				std::unordered_map <uint64_t, std::chrono::steady_clock::time_point> mapInFlight;
+				CReportFrameReader reader;
+				std::string stBuffer;
+				std::vector <char> vReceive(64 * 1024);
+				SLoopbackResult totals;
+				uint64_t nSent = 0, nAcked = 0;
+
+				while (nAcked < nAssigned && !bFailed)
+				{
+					stBuffer.clear();
+					const auto tSent = std::chrono::steady_clock::now();
+					while (nSent < nAssigned && mapInFlight.size() < nWindow)
+					{
+						const auto nLocal = nSent % nMachines;
+						const auto nRound = static_cast<uint32_t>(nSent / nMachines);
+						const auto nMachineId = nConnection + nLocal * nConnections;
+						// The previous round of this machine has to be acknowledged first
+						if (mapInFlight.count(nMachineId))
+							break;
+
+						// Rounds drift the volatile facts, a few machines also get an OS update
+						auto machine = vResults[nMachineId % vResults.size()];
+						if (nRound)
+						{
+							const auto nMix = MixRound(nMachineId, nRound);
+							if (nMix % 1000000 < nChangeThreshold)
+								vBuildOffsets[nLocal] = nRound;
+							machine.os.nBuildNumber += vBuildOffsets[nLocal];
+							machine.ram.nAvailablePhysical = (std::min)(machine.ram.nAvailablePhysical + (nMix >> 40) % (uint64_t(64) * 1024 * 1024), machine.ram.nTotalPhysical);
+						}
+
+						size_t nReportBytes;
+						if (nBatchSize)
+						{
+							const auto nBefore = writer.GetEncodedSize();
+							uint16_t nSectionMask = BINARY_REPORT_ALL_SECTIONS;
+							if (options.bDelta)
+								nSectionMask = vReporters[nLocal].Add(writer, machine, nMachineId);
+							else
+								writer.Add(machine, nMachineId);
+							nReportBytes = writer.GetEncodedSize() - nBefore;
+
+							if (!(nSectionMask & BINARY_REPORT_DELTA))
+								totals.nFullCount++;
+							else if (nSectionMask & BINARY_REPORT_ALL_SECTIONS)
+								totals.nDeltaCount++;
+							else
+								totals.nHeartbeatCount++;
+						}
+						else
+						{
+							const auto& stDocument = nRound ? (stRoundDocument = SerializeLegacyJson(machine, labels)) : vDocuments[nMachineId % vDocuments.size()];
+							AppendJsonReportFrame(stBuffer, nMachineId, stDocument);
+							nReportBytes = sizeof(uint64_t) + stDocument.size();
+							totals.nFullCount++;
+						}
+						if (nRound)
+						{
+							totals.nSteadyReportCount++;
+							totals.nSteadyBytes += nReportBytes;
+						}
+
+						mapInFlight.emplace(nMachineId, tSent);
+						nSent++;
+
+						if (writer.GetReportCount() && (writer.GetReportCount() == nBatchSize || nSent == nAssigned || mapInFlight.size() == nWindow))
+						{
+							stPayload.clear();
+							writer.Finish(stPayload);
+							AppendReportFrame(stBuffer, EFrameType::FRAME_REPORT_BATCH, stPayload.data(), static_cast<uint32_t>(stPayload.size()));
+						}
+					}
+					// Stopped early on a machine still in flight
+					if (writer.GetReportCount())
+					{
+						stPayload.clear();
+						writer.Finish(stPayload);
+						AppendReportFrame(stBuffer, EFrameType::FRAME_REPORT_BATCH, stPayload.data(), static_cast<uint32_t>(stPayload.size()));
+					}
+					if (!stBuffer.empty())
+					{
+						if (!SendAll(nSocket, stBuffer))
+							break;
+						totals.nSentBytes += stBuffer.size();
+					}
+
+					const auto nRead = recv(nSocket, vReceive.data(), vReceive.size(), 0);
+					if (nRead <= 0)
+					{
+						if (nRead < 0 && errno == EINTR)
+							continue;
+						break;
+					}
+					reader.Append(vReceive.data(), static_cast<size_t>(nRead));
+
+					const auto tReceived = std::chrono::steady_clock::now();
+					SReportFrame frame;
+					while (reader.Next(frame))
+					{
+						uint64_t nMachineId = 0;
+						EReportAck nAck{};
+						if (!ParseAckFrame(frame, nMachineId, nAck))
+							continue;
+
+						const auto it = mapInFlight.find(nMachineId);
+						if (it == mapInFlight.end())
+							continue;
+
+						latency.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(tReceived - it->second).count()));
+						mapInFlight.erase(it);
+						nAcked++;
+						if (options.bDelta)
+							vReporters[(nMachineId - nConnection) / nConnections].OnAck(nAck);
+
+						if (nAck == EReportAck::REPORT_ACK_COMMITTED)
+							totals.nCommittedCount++;
+						else if (nAck == EReportAck::REPORT_ACK_RESYNC)
+							totals.nResyncCount++;
+						else
+							totals.nRejectedCount++;
+					}
+				}
+
+				if (nAcked < nAssigned)
+					bFailed = true;
+
+				std::lock_guard <std::mutex> lock(mtxResult);
+				result.nSentCount += nSent;
+				result.nCommittedCount += totals.nCommittedCount;
+				result.nRejectedCount += totals.nRejectedCount;
+				result.nResyncCount += totals.nResyncCount;
+				result.nFullCount += totals.nFullCount;
+				result.nDeltaCount += totals.nDeltaCount;
+				result.nHeartbeatCount += totals.nHeartbeatCount;
+				result.nSentBytes += totals.nSentBytes;
+				result.nSteadyReportCount += totals.nSteadyReportCount;
+				result.nSteadyBytes += totals.nSteadyBytes;
+				result.latency.Merge(latency);
+			});
+		}
+
+		for (auto& thread : vThreads)
+			thread.join();
+		result.dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+		for (const auto nSocket : vSockets)
+			close(nSocket);
+
+		if (bFailed)
+			std::cerr << "Loopback client lost its connection before every report was acknowledged" << std::endl;
+		return !bFailed;
+	}
+};
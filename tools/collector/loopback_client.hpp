@@ -0,0 +1,40 @@
+#pragma once
+#include "../../include/core/hdr_histogram.hpp"
+#include <cstdint>
+#include <string>
+
+namespace Win11SysCheck
+{
+	struct SLoopbackOptions
+	{
+		uint64_t nReportCount{ 100000 };
+		uint32_t nConnections{ 8 };
+		uint32_t nWindow{ 64 };		// Unacknowledged reports per connection
+		uint32_t nBatchSize{ 0 };	// Reports per binary batch frame, 0 sends one JSON frame per report
+		uint32_t nRounds{ 1 };		// Scheduled re-scans, every machine reports once per round
+		double dChangeRate{ 0.01 };	// Share of machines whose facts change between rounds
+		bool bDelta{ false };		// Send deltas against the last acknowledged report, implies binary
+		uint64_t nSeed{ 1 };
+		uint64_t nSkuCount{ 0 };
+	};
+
+	struct SLoopbackResult
+	{
+		uint64_t nSentCount{ 0 };
+		uint64_t nCommittedCount{ 0 };
+		uint64_t nRejectedCount{ 0 };
+		uint64_t nResyncCount{ 0 };
+		uint64_t nFullCount{ 0 };
+		uint64_t nDeltaCount{ 0 };
+		uint64_t nHeartbeatCount{ 0 };
+		uint64_t nSentBytes{ 0 };
+		uint64_t nSteadyReportCount{ 0 };	// Reports of the rounds after the first
+		uint64_t nSteadyBytes{ 0 };			// Their encoded size, frame headers excluded
+		double dSeconds{ 0.0 };
+		CHdrHistogram latency;	// Send to acknowledgement, microseconds
+	};
+
+	// Stand-in for an agent fleet: generated results are sent over blocking connections, one thread
+	// each, keeping a window of reports in flight so the collector sees sustained load
+	bool RunLoopbackClient(const std::string& stHost, uint16_t nPort, const SLoopbackOptions& options, SLoopbackResult& result);
+};
@@ -0,0 +1,149 @@
+#include "collector_server.hpp"
+#include "loopback_client.hpp"
+#include "../../include/core/command_line.hpp"
+#include <fmt/format.h>
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+
+using namespace Win11SysCheck;
+
+static volatile std::sig_atomic_t gs_vbInterrupted{ 0 };
+
+static void OnInterruptHandle(int)
+{
+	gs_vbInterrupted = 1;
+}
+
+static void PrintUsage()
+{
+	std::cerr << "Usage: Win11SysCheckCollector [--bind=ADDRESS] [--port=N] [--threads=N] [--store=PREFIX] [--row-group=N] [--commit-ms=N] "
+		"[--segment-rows=N] [--max-queue=N] [--metrics=FILE] [--histograms=FILE] "
+		"[--loopback=N [--connections=N] [--window=N] [--batch=N] [--rounds=N] [--change-rate=P] [--delta] [--seed=N] [--skus=N]] [--state=FILE]" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	const CCommandLine cmdLine(argc, argv);
+	if (cmdLine.Has("help"))
+	{
+		PrintUsage();
+		return EXIT_SUCCESS;
+	}
+
+	SCollectorOptions serverOptions;
+	serverOptions.stBindAddress = cmdLine.Get("bind", serverOptions.stBindAddress);
+	serverOptions.nPort = static_cast<uint16_t>(cmdLine.GetNumber("port", serverOptions.nPort));
+	serverOptions.nThreads = static_cast<uint32_t>(cmdLine.GetNumber("threads", (std::max)(std::thread::hardware_concurrency() / 2, 1u)));
+
+	SCommitterOptions committerOptions;
+	committerOptions.stStorePrefix = cmdLine.Get("store");
+	committerOptions.nBatchSize = static_cast<uint32_t>(cmdLine.GetNumber("row-group", committerOptions.nBatchSize));
+	committerOptions.nCommitIntervalMs = static_cast<uint32_t>(cmdLine.GetNumber("commit-ms", committerOptions.nCommitIntervalMs));
+	committerOptions.nSegmentRows = cmdLine.GetNumber("segment-rows", committerOptions.nSegmentRows);
+	committerOptions.nMaxQueue = cmdLine.GetNumber("max-queue", committerOptions.nMaxQueue);
+
+	const auto stMetricsFile = cmdLine.Get("metrics");
+	const auto stHistogramsFile = cmdLine.Get("histograms");
+
+	const auto stStateFile = cmdLine.Get("state");
+
+	CMetricsRegistry metrics;
+	CStoreCommitter committer(committerOptions, metrics);
+	CCollectorServer server(serverOptions, committer, metrics);
+
+	// Without the previous state every agent's first delta is answered with a resync
+	if (!stStateFile.empty() && std::filesystem::exists(stStateFile) && !server.GetStateStore().Load(stStateFile))
+	{
+		std::cerr << "Machine state: '" << stStateFile << "' could not be read" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!committer.Start([&server](std::vector <SPendingReport>& vReports, bool bCommitted) { server.OnCommitted(vReports, bCommitted); }))
+		return EXIT_FAILURE;
+	if (!server.Start())
+	{
+		committer.Stop();
+		return EXIT_FAILURE;
+	}
+	std::cout << fmt::format("Collector listening on {0}:{1} with {2} threads", serverOptions.stBindAddress, server.GetPort(), serverOptions.nThreads) << std::endl;
+
+	auto bSucceeded = true;
+	if (cmdLine.Has("loopback"))
+	{
+		SLoopbackOptions loopbackOptions;
+		loopbackOptions.nReportCount = cmdLine.GetNumber("loopback", loopbackOptions.nReportCount);
+		loopbackOptions.nConnections = static_cast<uint32_t>(cmdLine.GetNumber("connections", loopbackOptions.nConnections));
+		loopbackOptions.nWindow = static_cast<uint32_t>(cmdLine.GetNumber("window", loopbackOptions.nWindow));
+		loopbackOptions.nBatchSize = static_cast<uint32_t>(cmdLine.GetNumber("batch", loopbackOptions.nBatchSize));
+		loopbackOptions.nRounds = static_cast<uint32_t>(cmdLine.GetNumber("rounds", loopbackOptions.nRounds));
+		loopbackOptions.dChangeRate = cmdLine.GetDouble("change-rate", loopbackOptions.dChangeRate);
+		loopbackOptions.bDelta = cmdLine.Has("delta");
+		loopbackOptions.nSeed = cmdLine.GetNumber("seed", loopbackOptions.nSeed);
+		loopbackOptions.nSkuCount = cmdLine.GetNumber("skus", loopbackOptions.nSkuCount);
+
+		SLoopbackResult loopback;
+		bSucceeded = RunLoopbackClient(serverOptions.stBindAddress, server.GetPort(), loopbackOptions, loopback);
+
+		const auto& latency = loopback.latency;
+		std::cout << fmt::format("Loopback: {0} reports over {1} connections in {2:.3f} s, {3:.0f} reports/s, {4:.1f} MB/s",
+			loopback.nSentCount, loopbackOptions.nConnections, loopback.dSeconds,
+			loopback.dSeconds > 0 ? loopback.nSentCount / loopback.dSeconds : 0.0,
+			loopback.dSeconds > 0 ? loopback.nSentBytes / loopback.dSeconds / (1024 * 1024) : 0.0
+		) << std::endl;
+		std::cout << fmt::format("Acknowledged: {0} committed, {1} rejected, {2} resync; latency us p50 {3} p90 {4} p99 {5} max {6}",
+			loopback.nCommittedCount, loopback.nRejectedCount, loopback.nResyncCount,
+			latency.GetValueAtPercentile(50), latency.GetValueAtPercentile(90), latency.GetValueAtPercentile(99), latency.GetMax()
+		) << std::endl;
+		std::cout << fmt::format("Sent {0} full, {1} delta, {2} heartbeat reports", loopback.nFullCount, loopback.nDeltaCount, loopback.nHeartbeatCount) << std::endl;
+		if (loopback.nSteadyReportCount)
+		{
+			std::cout << fmt::format("Rounds after the first: {0} reports, {1:.1f} bytes per report",
+				loopback.nSteadyReportCount, static_cast<double>(loopback.nSteadyBytes) / loopback.nSteadyReportCount
+			) << std::endl;
+		}
+	}
+	else
+	{
+		std::signal(SIGINT, &OnInterruptHandle);
+		std::signal(SIGTERM, &OnInterruptHandle);
+
+		// Scraped through the node exporter textfile collector
+		while (!gs_vbInterrupted)
+		{
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+			if (!stMetricsFile.empty())
+				metrics.WriteTextFile(stMetricsFile);
+		}
+	}
+
+	server.Stop();
+	if (!committer.Stop())
+	{
+		std::cerr << "Fleet store could not be finalized" << std::endl;
+		bSucceeded = false;
+	}
+
+	const auto& ingest = committer.GetLatencyHistogram();
+	std::cout << fmt::format("Committed {0} reports in {1} group commits; ingest latency us p50 {2} p99 {3} max {4}",
+		committer.GetCommittedCount(), committer.GetCommitCount(),
+		ingest.GetValueAtPercentile(50), ingest.GetValueAtPercentile(99), ingest.GetMax()
+	) << std::endl;
+
+	if (!stMetricsFile.empty() && !metrics.WriteTextFile(stMetricsFile))
+	{
+		std::cerr << "Metrics: '" << stMetricsFile << "' could not be written" << std::endl;
+		bSucceeded = false;
+	}
+	if (!stStateFile.empty() && !server.GetStateStore().Save(stStateFile))
+	{
+		std::cerr << "Machine state: '" << stStateFile << "' could not be written" << std::endl;
+		bSucceeded = false;
+	}
+	if (!stHistogramsFile.empty() && !server.GetHistograms().Save(stHistogramsFile))
+	{
+		std::cerr << "Histograms: '" << stHistogramsFile << "' could not be written" << std::endl;
+		bSucceeded = false;
+	}
+	return bSucceeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
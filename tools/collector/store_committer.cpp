@@ -0,0 +1,178 @@
+#include "store_committer.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+
+namespace Win11SysCheck
+{
+	CStoreCommitter::CStoreCommitter(const SCommitterOptions& options, CMetricsRegistry& metrics) :
+		m_options(options),
+		m_queueDepth(metrics.Gauge("win11syscheck_collector_queue_depth", "Reports received and waiting for a group commit")),
+		m_commits(metrics.Counter("win11syscheck_collector_commits_total", "Group commits written to the fleet store")),
+		m_committed(metrics.Counter("win11syscheck_collector_reports_committed_total", "Reports written to the fleet store")),
+		m_commitFailures(metrics.Counter("win11syscheck_collector_commit_failures_total", "Group commits the fleet store refused")),
+		m_ingestLatency(metrics.Histogram("win11syscheck_collector_ingest_latency_seconds", "Time from a report being received to its commit", CHistogram::DefaultLatencyBounds())),
+		m_commitSize(metrics.Histogram("win11syscheck_collector_commit_size_reports", "Reports per group commit", { 1, 8, 64, 256, 1024, 4096, 16384, 65536 }))
+	{
+		m_options.nBatchSize = (std::max)(m_options.nBatchSize, 1u);
+		m_options.nMaxQueue = (std::max)(m_options.nMaxQueue, static_cast<size_t>(m_options.nBatchSize));
+	}
+	CStoreCommitter::~CStoreCommitter()
+	{
+		Stop();
+	}
+
+	bool CStoreCommitter::Start(TCommitCallback fnOnCommit)
+	{
+		m_fnOnCommit = std::move(fnOnCommit);
+		if (!m_options.stStorePrefix.empty() && !__OpenSegment())
+			return false;
+
+		m_vQueue.reserve(m_options.nMaxQueue);
+		m_thread = std::thread(&CStoreCommitter::__Run, this);
+		return true;
+	}
+
+	void CStoreCommitter::Submit(SPendingReport&& report)
+	{
+		std::unique_lock <std::mutex> lock(m_mtxQueue);
+		// Back pressure: I/O threads stop reading until the writer catches up
+		m_cvSpace.wait(lock, [this] { return m_vQueue.size() < m_options.nMaxQueue || m_bStopping; });
+
+		m_vQueue.emplace_back(std::move(report));
+		m_queueDepth.Set(static_cast<double>(m_vQueue.size()));
+		if (m_vQueue.size() >= m_options.nBatchSize)
+			m_cvQueue.notify_one();
+	}
+
+	bool CStoreCommitter::Stop()
+	{
+		{
+			std::lock_guard <std::mutex> lock(m_mtxQueue);
+			m_bStopping = true;
+		}
+		m_cvQueue.notify_one();
+		m_cvSpace.notify_all();
+		if (m_thread.joinable())
+			m_thread.join();
+
+		if (m_spStore)
+		{
+			if (!m_spStore->Close())
+				m_bFailed = true;
+			m_spStore.reset();
+		}
+		return !m_bFailed;
+	}
+
+	void CStoreCommitter::__Run()
+	{
+		std::vector <SPendingReport> vBatch;
+		vBatch.reserve(m_options.nMaxQueue);
+
+		while (true)
+		{
+			{
+				std::unique_lock <std::mutex> lock(m_mtxQueue);
+				// Group commit: wait for a full batch, but never hold a report longer than the interval
+				m_cvQueue.wait_for(lock, std::chrono::milliseconds(m_options.nCommitIntervalMs), [this] {
+					return m_vQueue.size() >= m_options.nBatchSize || m_bStopping;
+				});
+				if (m_vQueue.empty())
+				{
+					if (m_bStopping)
+						break;
+					continue;
+				}
+
+				vBatch.swap(m_vQueue);
+				m_queueDepth.Set(0);
+			}
+			m_cvSpace.notify_all();
+
+			for (size_t i = 0; i < vBatch.size(); i += m_options.nBatchSize)
+			{
+				const auto nCount = (std::min)(vBatch.size() - i, static_cast<size_t>(m_options.nBatchSize));
+				std::vector <SPendingReport> vGroup(
+					std::make_move_iterator(vBatch.begin() + i), std::make_move_iterator(vBatch.begin() + i + nCount)
+				);
+				__Commit(vGroup);
+			}
+			vBatch.clear();
+		}
+	}
+
+	bool CStoreCommitter::__Commit(std::vector <SPendingReport>& vReports)
+	{
+		// A failed segment rotation leaves nothing to write to, reject instead of acknowledging
+		auto bCommitted = !m_bFailed;
+		if (bCommitted && m_spStore)
+		{
+			std::vector <SFleetRecord> vRecords;
+			vRecords.reserve(vReports.size());
+			for (const auto& report : vReports)
+				vRecords.emplace_back(report.record);
+
+			bCommitted = m_spStore->AppendRowGroup(vRecords) && m_spStore->Flush();
+			if (bCommitted)
+			{
+				m_nSegmentRowCount += vRecords.size();
+				if (m_nSegmentRowCount >= m_options.nSegmentRows)
+				{
+					// The footer only speeds up opening, the next segment failing only affects later reports
+					bCommitted = m_spStore->Close();
+					if (bCommitted && !__OpenSegment())
+						m_bFailed = true;
+				}
+			}
+		}
+
+		if (bCommitted)
+		{
+			const auto tNow = std::chrono::steady_clock::now();
+			for (const auto& report : vReports)
+			{
+				const auto nLatencyUs = std::chrono::duration_cast<std::chrono::microseconds>(tNow - report.tReceived).count();
+				m_latency.Record(static_cast<uint64_t>(nLatencyUs));
+				m_ingestLatency.Observe(static_cast<double>(nLatencyUs) / 1e6);
+			}
+			m_nCommittedCount += vReports.size();
+			m_nCommitCount++;
+			m_commits.Increment();
+			m_committed.Increment(vReports.size());
+			m_commitSize.Observe(static_cast<double>(vReports.size()));
+		}
+		else
+		{
+			m_bFailed = true;
+			m_commitFailures.Increment();
+		}
+
+		if (m_fnOnCommit)
+			m_fnOnCommit(vReports, bCommitted);
+		return bCommitted;
+	}
+
+	bool CStoreCommitter::__OpenSegment()
+	{
+		// Segments of an earlier run hold acknowledged reports, a restart continues after them
+		std::string stFileName;
+		std::error_code ec;
+		do
+		{
+			stFileName = fmt::format("{0}.{1:06}.store", m_options.stStorePrefix, m_nSegmentIndex++);
+		} while (std::filesystem::exists(stFileName, ec));
+
+		m_spStore = std::make_unique<CFleetStoreWriter>(m_options.nBatchSize);
+		m_nSegmentRowCount = 0;
+		if (!m_spStore->Open(stFileName))
+		{
+			std::cerr << "Fleet store: '" << stFileName << "' could not be created" << std::endl;
+			m_spStore.reset();
+			return false;
+		}
+		return true;
+	}
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include "../../include/core/fleet_store.hpp"
+#include "../../include/core/hdr_histogram.hpp"
+#include "../../include/core/metrics.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	struct SPendingReport
+	{
+		SFleetRecord record;
+		uint32_t nWorker{ 0 };
+		int nSocket{ -1 };
+		uint64_t nConnectionId{ 0 };
+		std::chrono::steady_clock::time_point tReceived;
+	};
+
+	struct SCommitterOptions
+	{
+		std::string stStorePrefix;		// Segments are <prefix>.<index>.store, empty keeps nothing
+		uint32_t nBatchSize{ 4096 };	// Reports per group commit, also the row group size
+		uint32_t nCommitIntervalMs{ 20 };
+		uint64_t nSegmentRows{ 1000000 };
+		size_t nMaxQueue{ 262144 };		// Submitters block beyond this depth
+	};
+
+	using TCommitCallback = std::function<void(std::vector <SPendingReport>& vReports, bool bCommitted)>;
+
+	// Single writer: reports queue up from every I/O thread and are written as one row group per
+	// commit, acknowledgements are only released once their row group is synced to disk
+	class CStoreCommitter
+	{
+	public:
+		CStoreCommitter(const SCommitterOptions& options, CMetricsRegistry& metrics);
+		~CStoreCommitter();
+
+		bool Start(TCommitCallback fnOnCommit);
+		void Submit(SPendingReport&& report);
+		// Commits what is queued and finalizes the open segment
+		bool Stop();
+
+		uint64_t GetCommittedCount() const { return m_nCommittedCount; };
+		uint64_t GetCommitCount() const { return m_nCommitCount; };
+		// Receive to commit latency, read once the committer is stopped
+		const CHdrHistogram& GetLatencyHistogram() const { return m_latency; };
+
+	protected:
+		void __Run();
+		bool __Commit(std::vector <SPendingReport>& vReports);
+		bool __OpenSegment();
+
+	private:
+		SCommitterOptions m_options;
+		TCommitCallback m_fnOnCommit;
+
+		std::mutex m_mtxQueue;
+		std::condition_variable m_cvQueue;
+		std::condition_variable m_cvSpace;
+		std::vector <SPendingReport> m_vQueue;
+		bool m_bStopping{ false };
+		std::thread m_thread;
+
+		std::unique_ptr <CFleetStoreWriter> m_spStore;
+		uint32_t m_nSegmentIndex{ 0 };
+		uint64_t m_nSegmentRowCount{ 0 };
+		bool m_bFailed{ false };
+
+		uint64_t m_nCommittedCount{ 0 };
+		uint64_t m_nCommitCount{ 0 };
+		CHdrHistogram m_latency;
+
+		CGauge& m_queueDepth;
+		CCounter& m_commits;
+		CCounter& m_committed;
+		CCounter& m_commitFailures;
+		CHistogram& m_ingestLatency;
+		CHistogram& m_commitSize;
+	};
+};
@@ -0,0 +1,319 @@
+#include "../../include/core/cpu_database.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Turns the supported-processor lists and the signature table into the constexpr perfect hash
+// tables of cpu_database_table.hpp: cpu_db OUT_HEADER FILE.csv [FILE.csv...]
+
+using namespace Win11SysCheck;
+
+static constexpr uint32_t MAX_BUCKET_SEED = 0xFFFF;
+
+struct SModelRow
+{
+	ECPUVendor nVendor;
+	std::string stKey;
+	std::string stName;
+};
+
+struct SSignatureRow
+{
+	uint64_t nKey;
+	ECPUSupport nSupport;
+};
+
+struct SPerfectHash
+{
+	uint32_t nBucketMask{ 0 };
+	uint32_t nSlotMask{ 0 };
+	std::vector <uint16_t> vSeeds;
+	std::vector <int32_t> vSlots; // Row of each slot, -1 when empty
+};
+
+static uint32_t GetPowerOfTwo(size_t nValue)
+{
+	uint32_t nPower = 1;
+	while (nPower < nValue)
+		nPower <<= 1;
+	return nPower;
+}
+
+// Buckets are placed largest first, each gets the first seed that moves all its keys to free slots.
+// The slot table grows when a bucket finds no seed.
+static bool BuildPerfectHash(const std::vector <uint64_t>& vHashes, SPerfectHash& table)
+{
+	const auto nBucketCount = GetPowerOfTwo((std::max)(vHashes.size() / 4, size_t(1)));
+	auto nSlotCount = GetPowerOfTwo(vHashes.size() + vHashes.size() / 8 + 1);
+
+	std::vector <std::vector <uint32_t>> vBuckets(nBucketCount);
+	for (uint32_t i = 0; i < vHashes.size(); ++i)
+		vBuckets[GetPerfectHashBucket(vHashes[i], nBucketCount - 1)].emplace_back(i);
+
+	std::vector <uint32_t> vOrder(nBucketCount);
+	for (uint32_t i = 0; i < nBucketCount; ++i)
+		vOrder[i] = i;
+	std::stable_sort(vOrder.begin(), vOrder.end(), [&](uint32_t a, uint32_t b) { return vBuckets[a].size() > vBuckets[b].size(); });
+
+	for (; nSlotCount <= (1u << 24); nSlotCount <<= 1)
+	{
+		table.nBucketMask = nBucketCount - 1;
+		table.nSlotMask = nSlotCount - 1;
+		table.vSeeds.assign(nBucketCount, 0);
+		table.vSlots.assign(nSlotCount, -1);
+
+		auto bPlaced = true;
+		std::vector <uint32_t> vBucketSlots;
+		for (const auto nBucket : vOrder)
+		{
+			const auto& vKeys = vBuckets[nBucket];
+			if (vKeys.empty())
+				break;
+
+			auto bFound = false;
+			for (uint32_t nSeed = 0; nSeed <= MAX_BUCKET_SEED && !bFound; ++nSeed)
+			{
+				vBucketSlots.clear();
+				bFound = true;
+				for (const auto nKey : vKeys)
+				{
+					const auto nSlot = GetPerfectHashSlot(vHashes[nKey], nSeed, table.nSlotMask);
+					if (table.vSlots[nSlot] != -1 || std::find(vBucketSlots.begin(), vBucketSlots.end(), nSlot) != vBucketSlots.end())
+					{
+						bFound = false;
+						break;
+					}
+					vBucketSlots.emplace_back(nSlot);
+				}
+				if (bFound)
+				{
+					table.vSeeds[nBucket] = static_cast<uint16_t>(nSeed);
+					for (size_t i = 0; i < vKeys.size(); ++i)
+						table.vSlots[vBucketSlots[i]] = static_cast<int32_t>(vKeys[i]);
+				}
+			}
+			if (!bFound)
+			{
+				bPlaced = false;
+				break;
+			}
+		}
+		if (bPlaced)
+			return true;
+	}
+	return false;
+}
+
+static std::vector <std::string> SplitLine(const std::string& stLine)
+{
+	std::vector <std::string> vFields;
+	std::istringstream issLine(stLine);
+	std::string stField;
+	while (std::getline(issLine, stField, ','))
+	{
+		while (!stField.empty() && (stField.back() == '\r' || stField.back() == ' '))
+			stField.pop_back();
+		vFields.emplace_back(stField);
+	}
+	return vFields;
+}
+
+// Supported-processor list: Manufacturer,Brand,Model; the last word of the model is the key
+static bool ReadModelList(const std::string& stFileName, std::ifstream& file, std::vector <SModelRow>& vRows)
+{
+	std::string stLine;
+	for (size_t nLine = 2; std::getline(file, stLine); ++nLine)
+	{
+		const auto vFields = SplitLine(stLine);
+		if (vFields.empty() || vFields[0].empty())
+			continue;
+
+		const auto nVendor = vFields.size() == 3 ? GetCPUVendor(vFields[0]) : ECPUVendor::CPU_VENDOR_UNKNOWN;
+		if (nVendor == ECPUVendor::CPU_VENDOR_UNKNOWN)
+		{
+			std::cerr << stFileName << ":" << nLine << ": expected Manufacturer,Brand,Model" << std::endl;
+			return false;
+		}
+
+		const auto& stModel = vFields[2];
+		const auto nTokenPos = stModel.find_last_of(' ');
+		const auto stToken = nTokenPos == std::string::npos ? stModel : stModel.substr(nTokenPos + 1);
+		if (!std::all_of(stToken.begin(), stToken.end(), &IsCPUModelTokenChar))
+		{
+			std::cerr << stFileName << ":" << nLine << ": model '" << stModel << "' is not a processor name token" << std::endl;
+			return false;
+		}
+
+		char szKey[CPU_MODEL_KEY_SIZE]{};
+		const auto nLength = NormalizeCPUModelToken(stToken.data(), stToken.size(), szKey);
+		if (!nLength)
+		{
+			std::cerr << stFileName << ":" << nLine << ": model '" << stModel << "' is too long" << std::endl;
+			return false;
+		}
+		vRows.push_back({ nVendor, std::string(szKey, nLength), vFields[1] + " " + stModel });
+	}
+	return true;
+}
+
+// Signature table: Vendor,Family,Model,Stepping,Support with '*' for any model or stepping
+static bool ReadSignatures(const std::string& stFileName, std::ifstream& file, std::vector <SSignatureRow>& vRows)
+{
+	std::string stLine;
+	for (size_t nLine = 2; std::getline(file, stLine); ++nLine)
+	{
+		const auto vFields = SplitLine(stLine);
+		if (vFields.empty() || vFields[0].empty())
+			continue;
+
+		const auto nVendor = vFields.size() == 5 ? GetCPUVendor(vFields[0]) : ECPUVendor::CPU_VENDOR_UNKNOWN;
+		const auto nSupport = vFields.size() == 5 && vFields[4] == "supported" ? ECPUSupport::CPU_SUPPORT_SUPPORTED :
+			vFields.size() == 5 && vFields[4] == "unsupported" ? ECPUSupport::CPU_SUPPORT_UNSUPPORTED : ECPUSupport::CPU_SUPPORT_UNKNOWN;
+		if (nVendor == ECPUVendor::CPU_VENDOR_UNKNOWN || nSupport == ECPUSupport::CPU_SUPPORT_UNKNOWN || vFields[1] == "*" ||
+			(vFields[2] == "*" && vFields[3] != "*"))
+		{
+			std::cerr << stFileName << ":" << nLine << ": expected Vendor,Family,Model|*,Stepping|*,supported|unsupported" << std::endl;
+			return false;
+		}
+
+		const auto nFamily = static_cast<uint16_t>(std::strtoul(vFields[1].c_str(), nullptr, 10));
+		const auto nModel = vFields[2] == "*" ? CPU_SIGNATURE_ANY_MODEL : static_cast<uint16_t>(std::strtoul(vFields[2].c_str(), nullptr, 10));
+		const auto nStepping = vFields[3] == "*" ? CPU_SIGNATURE_ANY_STEPPING : static_cast<uint8_t>(std::strtoul(vFields[3].c_str(), nullptr, 10));
+		vRows.push_back({ GetCPUSignatureKey(nVendor, nFamily, nModel, nStepping), nSupport });
+	}
+	return true;
+}
+
+static const char* GetVendorEnumName(ECPUVendor nVendor)
+{
+	switch (nVendor)
+	{
+		case ECPUVendor::CPU_VENDOR_INTEL:
+			return "ECPUVendor::CPU_VENDOR_INTEL";
+		case ECPUVendor::CPU_VENDOR_AMD:
+			return "ECPUVendor::CPU_VENDOR_AMD";
+		case ECPUVendor::CPU_VENDOR_QUALCOMM:
+			return "ECPUVendor::CPU_VENDOR_QUALCOMM";
+		default:
+			return "ECPUVendor::CPU_VENDOR_UNKNOWN";
+	}
+}
+
+static void WriteSeeds(std::ostream& out, const char* szName, const SPerfectHash& table)
+{
+	out << "\tstatic constexpr uint16_t " << szName << "[] = {";
+	for (size_t i = 0; i < table.vSeeds.size(); ++i)
+		out << (i % 16 ? " " : "\n\t\t") << table.vSeeds[i] << ",";
+	out << "\n\t};\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::cerr << "Usage: " << argv[0] << " OUT_HEADER FILE.csv [FILE.csv...]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector <SModelRow> vModels;
+	std::vector <SSignatureRow> vSignatures;
+	for (auto i = 2; i < argc; ++i)
+	{
+		std::ifstream file(argv[i]);
+		std::string stHeader;
+		if (!file || !std::getline(file, stHeader))
+		{
+			std::cerr << "Input: '" << argv[i] << "' could not be read" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		const auto bRead = stHeader.compare(0, 7, "Vendor,") == 0 ? ReadSignatures(argv[i], file, vSignatures) : ReadModelList(argv[i], file, vModels);
+		if (!bRead)
+			return EXIT_FAILURE;
+	}
+
+	// The lists repeat models under several brands, the first spelling is kept
+	std::stable_sort(vModels.begin(), vModels.end(), [](const auto& a, const auto& b) { return a.nVendor != b.nVendor ? a.nVendor < b.nVendor : a.stKey < b.stKey; });
+	vModels.erase(std::unique(vModels.begin(), vModels.end(), [](const auto& a, const auto& b) { return a.nVendor == b.nVendor && a.stKey == b.stKey; }), vModels.end());
+
+	std::vector <uint64_t> vModelHashes, vSignatureHashes;
+	for (const auto& row : vModels)
+		vModelHashes.emplace_back(HashCPUModelKey(row.nVendor, row.stKey.data(), row.stKey.size()));
+	for (const auto& row : vSignatures)
+		vSignatureHashes.emplace_back(MixCPUKey(row.nKey));
+
+	for (const auto* pHashes : { &vModelHashes, &vSignatureHashes })
+	{
+		auto vSorted = *pHashes;
+		std::sort(vSorted.begin(), vSorted.end());
+		if (std::adjacent_find(vSorted.begin(), vSorted.end()) != vSorted.end())
+		{
+			std::cerr << "Duplicate key or 64 bit hash collision in the input" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	SPerfectHash models, signatures;
+	if (!BuildPerfectHash(vModelHashes, models) || !BuildPerfectHash(vSignatureHashes, signatures))
+	{
+		std::cerr << "No perfect hash found" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::ostringstream out;
+	out << "#pragma once\n";
+	out << "// Generated at build time from data/cpu/*.csv, do not edit\n\n";
+	out << "namespace Win11SysCheck\n{\n";
+	out << "\tstatic constexpr size_t CPU_MODEL_COUNT = " << vModels.size() << ";\n";
+	out << "\tstatic constexpr uint32_t CPU_MODEL_BUCKET_MASK = " << models.nBucketMask << ";\n";
+	out << "\tstatic constexpr uint32_t CPU_MODEL_SLOT_MASK = " << models.nSlotMask << ";\n";
+	out << "\tstatic constexpr uint32_t CPU_SIGNATURE_BUCKET_MASK = " << signatures.nBucketMask << ";\n";
+	out << "\tstatic constexpr uint32_t CPU_SIGNATURE_SLOT_MASK = " << signatures.nSlotMask << ";\n\n";
+
+	WriteSeeds(out, "gs_arCPUModelSeeds", models);
+	out << "\tstatic constexpr SCPUModelEntry gs_arCPUModelSlots[] = {\n";
+	for (const auto nRow : models.vSlots)
+	{
+		if (nRow < 0)
+		{
+			out << "\t\t{ ECPUVendor::CPU_VENDOR_UNKNOWN, 0, \"\", \"\" },\n";
+			continue;
+		}
+		const auto& row = vModels[nRow];
+		out << "\t\t{ " << GetVendorEnumName(row.nVendor) << ", " << row.stKey.size() << ", \"" << row.stKey << "\", \"" << row.stName << "\" },\n";
+	}
+	out << "\t};\n\n";
+
+	WriteSeeds(out, "gs_arCPUSignatureSeeds", signatures);
+	out << "\tstatic constexpr SCPUSignatureEntry gs_arCPUSignatureSlots[] = {\n";
+	for (const auto nRow : signatures.vSlots)
+	{
+		if (nRow < 0)
+		{
+			out << "\t\t{ 0, ECPUSupport::CPU_SUPPORT_UNKNOWN },\n";
+			continue;
+		}
+		const auto& row = vSignatures[nRow];
+		out << "\t\t{ 0x" << std::hex << row.nKey << std::dec << "ull, " <<
+			(row.nSupport == ECPUSupport::CPU_SUPPORT_SUPPORTED ? "ECPUSupport::CPU_SUPPORT_SUPPORTED" : "ECPUSupport::CPU_SUPPORT_UNSUPPORTED") << " },\n";
+	}
+	out << "\t};\n};\n";
+
+	const auto stOutput = out.str();
+	std::error_code ec;
+	std::filesystem::create_directories(std::filesystem::path(argv[1]).parent_path(), ec);
+	std::ofstream output(argv[1], std::ios::binary | std::ios::trunc);
+	if (!output.write(stOutput.data(), stOutput.size()))
+	{
+		std::cerr << "Output: '" << argv[1] << "' could not be written" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "CPU database: " << vModels.size() << " models in " << models.vSlots.size() << " slots, " <<
+		vSignatures.size() << " signatures in " << signatures.vSlots.size() << " slots" << std::endl;
+	return EXIT_SUCCESS;
+}
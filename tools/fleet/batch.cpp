@@ -0,0 +1,414 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/blocker_sketch.hpp"
+#include "../../include/core/fleet_store.hpp"
+#include "../../include/core/hardware_fingerprint.hpp"
+#include "../../include/core/hdr_histogram.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/result_export.hpp"
+#include "../../include/core/result_image.hpp"
+#include "../../include/core/work_stealing_pool.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace Win11SysCheck
+{
+	static constexpr size_t BATCH_CHUNK_SIZE = 64;
+
+	struct SBatchRow
+	{
+		std::string stFileName;
+		bool bReady{ false };
+		uint32_t nFailMask{ 0 }; // Bit per EMenuType
+	};
+
+	// Owned by one worker, merged once every task has finished
+	struct SBatchStats
+	{
+		uint64_t nFileCount{ 0 };
+		uint64_t nByteCount{ 0 };
+		uint64_t nErrorCount{ 0 };
+		uint64_t nReadyCount{ 0 };
+		std::array <uint64_t, static_cast<size_t>(EMenuType::MENU_TYPE_MAX)> arFailCounts{};
+		std::vector <SBatchRow> vRows;
+		std::vector <std::string> vErrors;
+		std::vector <SFleetRecord> vStoreRecords; // Pending row group of the fleet store
+		CBlockerAggregator blockers;
+		CFactHistograms histograms;
+	};
+
+	struct SBatchOptions
+	{
+		std::filesystem::path inRoot;
+		SLegacyLabels labels;
+		bool bDetails{ false };
+		bool bBlockers{ false };
+		CFleetStoreWriter* pStore{ nullptr };
+	};
+
+	uint64_t GetMachineId(const std::filesystem::path& inRoot, const std::filesystem::path& file, const SProbeResult& result)
+	{
+		if (result.nMachineId)
+			return result.nMachineId;
+
+		// The digits of result_<number>.json are an export time, not an identity
+		const auto relative = file.lexically_relative(inRoot);
+		const auto stIdentity = (relative.has_parent_path() ? relative.parent_path() : file.filename()).generic_string();
+		const auto nMachineId = HashBytes128(stIdentity.data(), stIdentity.size()).Get64();
+		return nMachineId ? nMachineId : 1;
+	}
+
+	bool IsResultFile(const std::filesystem::directory_entry& entry)
+	{
+		if (!entry.is_regular_file())
+			return false;
+
+		// Deltas only make sense against their base, the full exports already cover every machine
+		const auto stName = entry.path().filename().string();
+		const auto nDeltaSuffixLength = std::strlen(RESULT_DELTA_FILE_SUFFIX);
+		if (stName.size() > nDeltaSuffixLength && stName.compare(stName.size() - nDeltaSuffixLength, nDeltaSuffixLength, RESULT_DELTA_FILE_SUFFIX) == 0)
+			return false;
+		return stName.size() > 12 && stName.compare(0, 7, "result_") == 0 && stName.compare(stName.size() - 5, 5, ".json") == 0;
+	}
+
+	// The timer started before the result was read, so the latency covers parsing
+	static void EvaluateResult(SProbeResult& result, const std::string& stName, uint64_t nMachineId, CSimpleTimer<std::chrono::microseconds>& timer,
+		const SBatchOptions& options, SBatchStats& stats)
+	{
+		EvaluateReadiness(result);
+		stats.histograms.RecordLatency(timer.diff());
+		stats.histograms.Record(result);
+
+		SBatchRow row{};
+		row.bReady = CanSystemUpgrade(result);
+		for (size_t i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			if (result.arStatuses[i] != EStatus::STATUS_OK)
+			{
+				stats.arFailCounts[i]++;
+				row.nFailMask |= 1u << i;
+			}
+		}
+		if (row.bReady)
+			stats.nReadyCount++;
+
+		if (options.bBlockers)
+		{
+			std::vector <std::string> vReasons;
+			ExplainReadiness(result, vReasons);
+			stats.blockers.Add(vReasons);
+		}
+
+		if (options.bDetails)
+		{
+			row.stFileName = stName;
+			stats.vRows.emplace_back(std::move(row));
+		}
+
+		if (options.pStore)
+		{
+			stats.vStoreRecords.emplace_back(MakeFleetRecord(result, nMachineId));
+			if (stats.vStoreRecords.size() >= options.pStore->GetRowGroupSize())
+			{
+				if (!options.pStore->AppendRowGroup(stats.vStoreRecords))
+					stats.nErrorCount++;
+				stats.vStoreRecords.clear();
+			}
+		}
+	}
+
+	static void EvaluateResultFile(const std::string& stFileName, const SBatchOptions& options, SBatchStats& stats)
+	{
+		stats.nFileCount++;
+
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+
+		CMappedFile file;
+		SProbeResult result;
+		if (!file.Open(stFileName) || !ParseExportedJson(file.GetData(), file.GetSize(), result, options.labels))
+		{
+			stats.nErrorCount++;
+			stats.vErrors.emplace_back(stFileName);
+			return;
+		}
+		stats.nByteCount += file.GetSize();
+
+		EvaluateResult(result, stFileName, GetMachineId(options.inRoot, stFileName, result), timer, options, stats);
+	}
+
+	// Image machines are read in place, only the rules need the materialized result
+	static void EvaluateImageMachines(const CResultImageReader& image, size_t nFirst, size_t nLast, const SBatchOptions& options, SBatchStats& stats)
+	{
+		SProbeResult result;
+		for (auto i = nFirst; i < nLast; ++i)
+		{
+			stats.nFileCount++;
+
+			auto timer = CSimpleTimer<std::chrono::microseconds>();
+			const auto& machine = image.GetMachine(i);
+			image.ReadResult(machine, result);
+			stats.nByteCount += image.GetEntrySize(EResultImageSection::IMAGE_SECTION_MACHINES);
+
+			EvaluateResult(result, options.bDetails ? fmt::format("machine_{0}", machine.nMachineId) : std::string(), machine.nMachineId, timer, options, stats);
+		}
+	}
+
+	static std::string SerializeBatchStats(const SBatchStats& stats, double dSeconds, uint32_t nThreadCount, size_t nTopBlockers)
+	{
+		rapidjson::StringBuffer s;
+		rapidjson::PrettyWriter <rapidjson::StringBuffer> writer(s);
+
+		writer.StartObject();
+		writer.Key("files");
+		writer.Uint64(stats.nFileCount);
+		writer.Key("errors");
+		writer.Uint64(stats.nErrorCount);
+		writer.Key("upgrade_ready");
+		writer.Uint64(stats.nReadyCount);
+		writer.Key("seconds");
+		writer.Double(dSeconds);
+		writer.Key("threads");
+		writer.Uint(nThreadCount);
+
+		writer.Key("failures");
+		writer.StartObject();
+		for (size_t i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+		{
+			writer.Key(GetMenuTypeKey(static_cast<EMenuType>(i)).c_str());
+			writer.Uint64(stats.arFailCounts[i]);
+		}
+		writer.EndObject();
+
+		writer.Key("distributions");
+		writer.StartObject();
+		for (size_t i = 0; i < static_cast<size_t>(EFactHistogram::FACT_HISTOGRAM_MAX); ++i)
+		{
+			const auto nFact = static_cast<EFactHistogram>(i);
+			const auto& histogram = stats.histograms.Get(nFact);
+
+			writer.Key(GetFactHistogramName(nFact));
+			writer.StartObject();
+			writer.Key("min");
+			writer.Uint64(histogram.GetMin());
+			writer.Key("mean");
+			writer.Double(histogram.GetMean());
+			for (const auto nPercentile : { 50u, 90u, 99u })
+			{
+				writer.Key(fmt::format("p{0}", nPercentile).c_str());
+				writer.Uint64(histogram.GetValueAtPercentile(nPercentile));
+			}
+			writer.Key("max");
+			writer.Uint64(histogram.GetMax());
+			writer.EndObject();
+		}
+		writer.EndObject();
+
+		if (nTopBlockers)
+		{
+			writer.Key("top_blockers");
+			writer.StartArray();
+			for (const auto& blocker : stats.blockers.GetTopBlockers(nTopBlockers))
+			{
+				writer.StartObject();
+				writer.Key("reason");
+				writer.String(blocker.stKey.c_str());
+				writer.Key("machines");
+				writer.Uint64(blocker.nCount);
+				writer.Key("error");
+				writer.Uint64(blocker.nError);
+				writer.EndObject();
+			}
+			writer.EndArray();
+		}
+
+		writer.Key("error_files");
+		writer.StartArray();
+		for (const auto& stFileName : stats.vErrors)
+			writer.String(stFileName.c_str());
+		writer.EndArray();
+
+		if (!stats.vRows.empty())
+		{
+			writer.Key("machines");
+			writer.StartArray();
+			for (const auto& row : stats.vRows)
+			{
+				writer.StartObject();
+				writer.Key("file");
+				writer.String(row.stFileName.c_str());
+				writer.Key("ready");
+				writer.Bool(row.bReady);
+				writer.Key("failed");
+				writer.StartArray();
+				for (size_t i = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); i < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++i)
+				{
+					if (row.nFailMask & (1u << i))
+						writer.String(GetMenuTypeKey(static_cast<EMenuType>(i)).c_str());
+				}
+				writer.EndArray();
+				writer.EndObject();
+			}
+			writer.EndArray();
+		}
+
+		writer.EndObject();
+		return std::string(s.GetString(), s.GetSize());
+	}
+
+	int RunBatchCommand(const CCommandLine& cmdLine)
+	{
+		const auto stInDir = cmdLine.Get("in");
+		const auto stOutFile = cmdLine.Get("out");
+		const auto stStoreFile = cmdLine.Get("store");
+		const auto stSketchFile = cmdLine.Get("sketch");
+		const auto stHistogramFile = cmdLine.Get("histograms");
+		const auto nPrecision = static_cast<uint32_t>(cmdLine.GetNumber("precision", 3));
+		const auto nTopBlockers = static_cast<size_t>(cmdLine.GetNumber("topk", 0));
+		const auto nThreadCount = static_cast<uint32_t>(cmdLine.GetNumber("threads", 0));
+
+		// A result image is evaluated in place of a directory of exported files
+		std::error_code ec;
+		CResultImageReader image;
+		const auto bImage = std::filesystem::is_regular_file(stInDir, ec);
+		if (bImage && !image.Open(stInDir))
+		{
+			std::cerr << "Result image: '" << stInDir << "' could not be opened" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (!bImage && (stInDir.empty() || !std::filesystem::is_directory(stInDir, ec)))
+		{
+			std::cerr << "Input directory: '" << stInDir << "' does not exist" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		SBatchOptions options{};
+		options.inRoot = stInDir;
+		options.bDetails = cmdLine.Has("details");
+		options.bBlockers = nTopBlockers || !stSketchFile.empty();
+
+		CFleetStoreWriter store(static_cast<uint32_t>(cmdLine.GetNumber("row-group", FLEET_STORE_DEFAULT_ROW_GROUP_SIZE)));
+		if (!stStoreFile.empty())
+		{
+			if (!store.Open(stStoreFile))
+			{
+				std::cerr << "Fleet store: '" << stStoreFile << "' could not be created" << std::endl;
+				return EXIT_FAILURE;
+			}
+			options.pStore = &store;
+		}
+
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+
+		CWorkStealingPool pool(nThreadCount);
+		std::vector <SBatchStats> vWorkerStats(pool.GetThreadCount());
+		for (auto& stats : vWorkerStats)
+			stats.histograms = CFactHistograms(nPrecision);
+
+		// Files are handed out in chunks while the tree is still being walked
+		auto SubmitChunk = [&](std::vector <std::string>&& vChunk) {
+			pool.Submit([&, vFiles = std::move(vChunk)] {
+				auto& stats = vWorkerStats[CWorkStealingPool::GetWorkerIndex()];
+				for (const auto& stFileName : vFiles)
+					EvaluateResultFile(stFileName, options, stats);
+			});
+		};
+
+		if (bImage)
+		{
+			for (size_t i = 0; i < image.GetMachineCount(); i += BATCH_CHUNK_SIZE)
+			{
+				const auto nLast = (std::min)(i + BATCH_CHUNK_SIZE, image.GetMachineCount());
+				pool.Submit([&, i, nLast] {
+					EvaluateImageMachines(image, i, nLast, options, vWorkerStats[CWorkStealingPool::GetWorkerIndex()]);
+				});
+			}
+		}
+		else
+		{
+			std::vector <std::string> vChunk;
+			for (std::filesystem::recursive_directory_iterator it(stInDir, std::filesystem::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec))
+			{
+				if (!IsResultFile(*it))
+					continue;
+
+				vChunk.emplace_back(it->path().string());
+				if (vChunk.size() == BATCH_CHUNK_SIZE)
+				{
+					SubmitChunk(std::move(vChunk));
+					vChunk = {};
+				}
+			}
+			if (!vChunk.empty())
+				SubmitChunk(std::move(vChunk));
+		}
+		pool.Wait();
+
+		if (ec)
+			std::cerr << "Directory walk stopped early: " << ec.message() << std::endl;
+
+		SBatchStats total{};
+		total.histograms = CFactHistograms(nPrecision);
+		for (auto& stats : vWorkerStats)
+		{
+			total.nFileCount += stats.nFileCount;
+			total.nByteCount += stats.nByteCount;
+			total.nErrorCount += stats.nErrorCount;
+			total.nReadyCount += stats.nReadyCount;
+			for (size_t i = 0; i < total.arFailCounts.size(); ++i)
+				total.arFailCounts[i] += stats.arFailCounts[i];
+			total.blockers.Merge(stats.blockers);
+			total.histograms.Merge(stats.histograms);
+			std::move(stats.vRows.begin(), stats.vRows.end(), std::back_inserter(total.vRows));
+			std::move(stats.vErrors.begin(), stats.vErrors.end(), std::back_inserter(total.vErrors));
+			if (options.pStore && !store.AppendRowGroup(stats.vStoreRecords))
+				total.nErrorCount++;
+		}
+		if (options.pStore && !store.Close())
+		{
+			std::cerr << "Fleet store: '" << stStoreFile << "' could not be written" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (!stSketchFile.empty() && !total.blockers.Save(stSketchFile))
+		{
+			std::cerr << "Blocker sketch: '" << stSketchFile << "' could not be written" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (!stHistogramFile.empty() && !total.histograms.Save(stHistogramFile))
+		{
+			std::cerr << "Histograms: '" << stHistogramFile << "' could not be written" << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::sort(total.vRows.begin(), total.vRows.end(), [](const auto& lhs, const auto& rhs) { return lhs.stFileName < rhs.stFileName; });
+		std::sort(total.vErrors.begin(), total.vErrors.end());
+
+		const auto dSeconds = (std::max)(timer.diff(), size_t(1)) / 1000000.0;
+		const auto stDocument = SerializeBatchStats(total, dSeconds, pool.GetThreadCount(), nTopBlockers);
+
+		if (stOutFile.empty())
+		{
+			std::cout << stDocument << std::endl;
+		}
+		else
+		{
+			std::ofstream ofs(stOutFile, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!ofs.write(stDocument.data(), stDocument.size()))
+			{
+				std::cerr << "File: '" << stOutFile << "' could not be written" << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+		std::cerr << fmt::format("Evaluated {0} files ({1} errors, {2} upgrade ready) in {3:.3f} s with {4} threads: {5:.0f} files/s, {6:.1f} MB/s",
+			total.nFileCount, total.nErrorCount, total.nReadyCount, dSeconds, pool.GetThreadCount(), total.nFileCount / dSeconds, total.nByteCount / dSeconds / 1024 / 1024
+		) << std::endl;
+		return total.nErrorCount ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+};
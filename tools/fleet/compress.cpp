@@ -0,0 +1,132 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/block_compression.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include "../../include/core/output_file.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <iostream>
+#include <sstream>
+
+namespace Win11SysCheck
+{
+	// Pieces the streams are fed in, as a reader of a socket or file would
+	static constexpr size_t COMPRESS_PIECE_SIZE = 1024 * 1024;
+
+	static int CompressFile(const std::string& stIn, const std::string& stOut, bool bDecompress)
+	{
+		CMappedFile input;
+		if (!input.Open(stIn))
+		{
+			std::cerr << "Input: '" << stIn << "' could not be opened" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		COutputFile output;
+		if (stOut == "-" ? !output.OpenStandardOutput() : !output.Open(stOut))
+		{
+			std::cerr << "Output: '" << stOut << "' could not be created" << std::endl;
+			return EXIT_FAILURE;
+		}
+		output.SetCompression(!bDecompress);
+
+		CStreamDecompressor decompressor;
+		std::string stDecoded;
+		for (size_t nOffset = 0; nOffset < input.GetSize(); nOffset += COMPRESS_PIECE_SIZE)
+		{
+			const auto nPiece = (std::min)(COMPRESS_PIECE_SIZE, input.GetSize() - nOffset);
+			if (!bDecompress)
+			{
+				output.Write(input.GetData() + nOffset, nPiece);
+				continue;
+			}
+
+			stDecoded.clear();
+			if (!decompressor.Append(input.GetData() + nOffset, nPiece, stDecoded))
+			{
+				std::cerr << "Input: '" << stIn << "' is corrupt" << std::endl;
+				return EXIT_FAILURE;
+			}
+			output.Write(stDecoded.data(), stDecoded.size());
+		}
+		if (bDecompress && !decompressor.IsFinished())
+		{
+			std::cerr << "Input: '" << stIn << "' is truncated" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (!output.Commit())
+		{
+			std::cerr << "Output: '" << stOut << "' could not be written" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::cerr << fmt::format("{0} bytes to {1} bytes", input.GetSize(), output.GetStoredSize()) << std::endl;
+		return EXIT_SUCCESS;
+	}
+
+	// Without an output, reports the ratio and the streaming compress and decompress rates per file
+	int RunCompressCommand(const CCommandLine& cmdLine)
+	{
+		const auto stOut = cmdLine.Get("out");
+		if (!stOut.empty())
+			return CompressFile(cmdLine.Get("in"), stOut, cmdLine.Has("decompress"));
+
+		const auto nBlockSize = static_cast<uint32_t>(cmdLine.GetNumber("block", COMPRESSION_BLOCK_SIZE));
+		const auto nRepeatCount = (std::max)(cmdLine.GetNumber("repeat", 3), uint64_t(1));
+
+		std::cout << fmt::format("{0:<32} {1:>14} {2:>14} {3:>7} {4:>12} {5:>12}", "file", "bytes", "compressed", "ratio", "comp MB/s", "decomp MB/s") << std::endl;
+
+		std::istringstream issFiles(cmdLine.Get("in"));
+		std::string stFileName;
+		while (std::getline(issFiles, stFileName, ','))
+		{
+			CMappedFile input;
+			if (!input.Open(stFileName) || !input.GetSize())
+			{
+				std::cerr << "Input: '" << stFileName << "' could not be opened" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			size_t nCompressUs = (std::numeric_limits<size_t>::max)(), nDecompressUs = nCompressUs;
+			std::string stCompressed, stPiece, stDecoded;
+			for (uint64_t nRun = 0; nRun < nRepeatCount; ++nRun)
+			{
+				auto timer = CSimpleTimer<std::chrono::microseconds>();
+				CStreamCompressor compressor(nBlockSize);
+				stCompressed.clear();
+				for (size_t nOffset = 0; nOffset < input.GetSize(); nOffset += COMPRESS_PIECE_SIZE)
+					compressor.Append(input.GetData() + nOffset, (std::min)(COMPRESS_PIECE_SIZE, input.GetSize() - nOffset), stCompressed);
+				compressor.Finish(stCompressed);
+				nCompressUs = (std::min)(nCompressUs, timer.diff());
+
+				// Decoded pieces are consumed as they come, like a reader that parses the stream
+				timer.reset();
+				CStreamDecompressor decompressor;
+				size_t nDecoded = 0;
+				auto bDecoded = true;
+				for (size_t nOffset = 0; nOffset < stCompressed.size() && bDecoded; nOffset += COMPRESS_PIECE_SIZE)
+				{
+					stPiece.clear();
+					bDecoded = decompressor.Append(stCompressed.data() + nOffset, (std::min)(COMPRESS_PIECE_SIZE, stCompressed.size() - nOffset), stPiece);
+					nDecoded += stPiece.size();
+					if (nRun == 0)
+						stDecoded.append(stPiece);
+				}
+				nDecompressUs = (std::min)(nDecompressUs, timer.diff());
+
+				if (!bDecoded || !decompressor.IsFinished() || nDecoded != input.GetSize() ||
+					(nRun == 0 && std::memcmp(stDecoded.data(), input.GetData(), input.GetSize())))
+				{
+					std::cerr << "Input: '" << stFileName << "' did not survive the round trip" << std::endl;
+					return EXIT_FAILURE;
+				}
+			}
+
+			const auto dMegabytes = input.GetSize() / 1024.0 / 1024.0;
+			std::cout << fmt::format("{0:<32} {1:>14} {2:>14} {3:>7.2f} {4:>12.1f} {5:>12.1f}",
+				std::filesystem::path(stFileName).filename().string(), input.GetSize(), stCompressed.size(), input.GetSize() / static_cast<double>(stCompressed.size()),
+				dMegabytes / ((std::max)(nCompressUs, size_t(1)) / 1e6), dMegabytes / ((std::max)(nDecompressUs, size_t(1)) / 1e6)
+			) << std::endl;
+		}
+		return EXIT_SUCCESS;
+	}
+};
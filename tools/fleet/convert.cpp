@@ -0,0 +1,197 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/block_compression.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/result_exporter.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <iostream>
+
+namespace Win11SysCheck
+{
+	// The base is referenced by file name, the delta belongs next to it
+	static int WriteDeltaFile(const std::string& stIn, const std::string& stBase, const std::string& stOut, bool bCompress)
+	{
+		SProbeResult base, result;
+		if (!LoadResultExport(stBase, base))
+		{
+			std::cerr << "Base: '" << stBase << "' could not be read" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (!LoadResultExport(stIn, result))
+		{
+			std::cerr << "Input: '" << stIn << "' could not be read" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		COutputFile output;
+		if (stOut == "-" ? !output.OpenStandardOutput() : !output.Open(stOut))
+		{
+			std::cerr << "Output: '" << stOut << "' could not be created" << std::endl;
+			return EXIT_FAILURE;
+		}
+		output.SetCompression(bCompress);
+
+		size_t nChangedCount = 0;
+		if (!WriteResultDeltaJson(base, std::filesystem::path(stBase).filename().string(), result, output, nChangedCount) || !output.Commit())
+		{
+			std::cerr << "Output: '" << stOut << "' could not be written" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::cerr << fmt::format("Delta of {0} facts against {1}: {2} bytes", nChangedCount, stBase, output.GetStoredSize()) << std::endl;
+		return EXIT_SUCCESS;
+	}
+
+	// Rewrites exported results in any export format, deltas are rebuilt from their base first; files
+	// are replaced atomically, "-" streams to stdout. Without --split every input goes through one
+	// exporter, a CSV gets a row per machine. With --base one export is written as a delta instead.
+	int RunConvertCommand(const CCommandLine& cmdLine)
+	{
+		const auto stIn = cmdLine.Get("in");
+		const auto stOut = cmdLine.Get("out", "-");
+		const auto bSplit = cmdLine.Has("split");
+		const auto bCompress = cmdLine.Has("compress");
+		const auto bStandardOutput = stOut == "-";
+		if (cmdLine.Has("base"))
+			return WriteDeltaFile(stIn, cmdLine.Get("base"), stOut, bCompress);
+
+		const auto nFormat = FindExportFormat(cmdLine.Get("format", "json"));
+		if (nFormat == EExportFormat::EXPORT_FORMAT_MAX)
+		{
+			std::cerr << "Unknown format: " << cmdLine.Get("format") << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (bSplit && bStandardOutput)
+		{
+			std::cerr << "Split output needs a directory" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::error_code ec;
+		std::vector <std::filesystem::path> vInputs;
+		const auto bInDirectory = std::filesystem::is_directory(stIn, ec);
+		if (bInDirectory)
+		{
+			for (std::filesystem::recursive_directory_iterator it(stIn, std::filesystem::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec))
+			{
+				if (IsResultFile(*it))
+					vInputs.emplace_back(it->path());
+			}
+		}
+		else if (std::filesystem::is_regular_file(stIn, ec))
+		{
+			vInputs.emplace_back(stIn);
+		}
+		else
+		{
+			std::cerr << "Input: '" << stIn << "' does not exist" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (bSplit && !std::filesystem::create_directories(stOut, ec) && ec)
+		{
+			std::cerr << "Output directory: '" << stOut << "' could not be created" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		COutputFile output;
+		std::unique_ptr <CResultExporter> exporter;
+		if (!bSplit)
+		{
+			if (bStandardOutput ? !output.OpenStandardOutput() : !output.Open(stOut))
+			{
+				std::cerr << "Output: '" << stOut << "' could not be created" << std::endl;
+				return EXIT_FAILURE;
+			}
+			output.SetCompression(bCompress);
+			exporter = CreateResultExporter(nFormat, output);
+		}
+
+		const SLegacyLabels labels{};
+		uint64_t nConvertedCount = 0, nErrorCount = 0, nByteCount = 0;
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+		for (const auto& path : vInputs)
+		{
+			CMappedFile input;
+			if (!input.Open(path.string()))
+			{
+				std::cerr << "File: '" << path.string() << "' could not be opened" << std::endl;
+				nErrorCount++;
+				continue;
+			}
+
+			auto pData = input.GetData();
+			auto nSize = input.GetSize();
+			std::string stDecompressed;
+			SProbeResult result;
+			if (IsCompressedStream(pData, nSize))
+			{
+				if (!DecompressStream(pData, nSize, stDecompressed))
+					stDecompressed.clear();
+				pData = stDecompressed.data();
+				nSize = stDecompressed.size();
+			}
+			if (!ParseResultExport(pData, nSize, path.string(), result, labels))
+			{
+				std::cerr << "File: '" << path.string() << "' could not be parsed" << std::endl;
+				nErrorCount++;
+				continue;
+			}
+			// Only the stable schema carries the section statuses
+			if (!IsResultJson(pData, nSize))
+				EvaluateReadiness(result);
+
+			// Every format written below carries the same id
+			result.nMachineId = GetMachineId(bInDirectory ? std::filesystem::path(stIn) : path.parent_path(), path, result);
+			const auto nMachineId = result.nMachineId;
+			if (!bSplit)
+			{
+				if (!exporter->Add(result, nMachineId))
+				{
+					std::cerr << "Output: '" << stOut << "' could not be written" << std::endl;
+					return EXIT_FAILURE;
+				}
+				nConvertedCount++;
+				continue;
+			}
+
+			auto stTarget = (std::filesystem::path(stOut) / path.filename().replace_extension(GetExportFileExtension(nFormat))).string();
+			if (bCompress)
+				stTarget += COMPRESSED_FILE_SUFFIX;
+			if (!output.Open(stTarget))
+			{
+				std::cerr << "File: '" << stTarget << "' could not be created" << std::endl;
+				nErrorCount++;
+				continue;
+			}
+			output.SetCompression(bCompress);
+			exporter = CreateResultExporter(nFormat, output);
+			const auto bWritten = exporter->Add(result, nMachineId) && exporter->Finish() && output.Commit();
+			nByteCount += output.GetStoredSize();
+			if (!bWritten)
+			{
+				std::cerr << "File: '" << stTarget << "' could not be written" << std::endl;
+				nErrorCount++;
+				continue;
+			}
+			nConvertedCount++;
+		}
+
+		if (!bSplit)
+		{
+			const auto bFinished = exporter->Finish() && output.Commit();
+			nByteCount = output.GetStoredSize();
+			if (!bFinished)
+			{
+				std::cerr << "Output: '" << stOut << "' could not be written" << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+		const auto dSeconds = (std::max)(timer.diff(), size_t(1)) / 1000000.0;
+		std::cerr << fmt::format("Converted {0} documents ({1} failed) to {2}: {3} bytes in {4:.3f} s",
+			nConvertedCount, nErrorCount, GetExportFormatKey(nFormat), nByteCount, dSeconds
+		) << std::endl;
+		return nErrorCount ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+};
@@ -0,0 +1,139 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/cpu_name_matcher.hpp"
+#include "../../include/core/cpuid_features.hpp"
+#include "../../include/core/profile_generator.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <iostream>
+
+namespace Win11SysCheck
+{
+	static const char* GetSupportName(ECPUSupport nSupport)
+	{
+		switch (nSupport)
+		{
+			case ECPUSupport::CPU_SUPPORT_SUPPORTED:
+				return "supported";
+			case ECPUSupport::CPU_SUPPORT_UNSUPPORTED:
+				return "unsupported";
+			default:
+				return "unknown";
+		}
+	}
+
+	static const char* GetConfidenceName(ECPUMatchConfidence nConfidence)
+	{
+		switch (nConfidence)
+		{
+			case ECPUMatchConfidence::CPU_CONFIDENCE_HIGH:
+				return "high";
+			case ECPUMatchConfidence::CPU_CONFIDENCE_MEDIUM:
+				return "medium";
+			case ECPUMatchConfidence::CPU_CONFIDENCE_LOW:
+				return "low";
+			default:
+				return "none";
+		}
+	}
+
+	static void PrintClassification(const SCPUFacts& facts)
+	{
+		const auto classification = ClassifyProcessor(facts);
+		std::cout << fmt::format("{0}: {1}, {2} match, {3} confidence",
+			facts.stName, GetSupportName(classification.nSupport),
+			classification.nMatch == ECPUMatch::CPU_MATCH_MODEL_NAME ? "model name" : classification.nMatch == ECPUMatch::CPU_MATCH_SIGNATURE ? "signature" : "no",
+			GetConfidenceName(classification.nConfidence)
+		) << std::endl;
+		if (*classification.szModel)
+			std::cout << "Model: " << classification.szModel << std::endl;
+	}
+
+	// The processor running the tool, read through CPUID without the OS
+	static int RunLocalCPU()
+	{
+		SCPUIDInfo cpuid;
+		if (!ReadCPUID(cpuid))
+		{
+			std::cerr << "CPUID is not available on this processor" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		SCPUFacts facts;
+		facts.stVendor = cpuid.stVendor;
+		facts.stName = cpuid.stBrand;
+#if defined(_M_X64) || defined(__x86_64__)
+		facts.nArchitecture = EProcessorArchitecture::ARCHITECTURE_AMD64;
+#else
+		facts.nArchitecture = EProcessorArchitecture::ARCHITECTURE_INTEL;
+#endif
+		facts.nFamily = cpuid.nFamily;
+		facts.nModel = cpuid.nModel;
+		facts.nStepping = cpuid.nStepping;
+		facts.nFeatures = cpuid.features.GetBits();
+
+		std::cout << fmt::format("Vendor: {0}, signature {1:#x}: family {2} model {3} stepping {4}, max leaf {5:#x}/{6:#x}",
+			cpuid.stVendor, cpuid.nSignature, cpuid.nFamily, cpuid.nModel, cpuid.nStepping, cpuid.nMaxLeaf, cpuid.nMaxExtendedLeaf) << std::endl;
+		std::cout << "Features: " << FormatCPUFeatures(facts.nFeatures) << std::endl;
+
+		const auto nMissing = GetMissingInstructions(facts);
+		std::cout << fmt::format("24H2 instructions: {0}{1}", nMissing ? "missing " : "present", FormatCPUFeatures(nMissing)) << std::endl;
+		PrintClassification(facts);
+		return EXIT_SUCCESS;
+	}
+
+	// Classifies one processor or the local one, or reports how many generated processor names are classified per second
+	int RunCPUCommand(const CCommandLine& cmdLine)
+	{
+		if (cmdLine.Has("name"))
+		{
+			SCPUFacts facts;
+			facts.stVendor = cmdLine.Get("vendor", "GenuineIntel");
+			facts.stName = cmdLine.Get("name");
+			facts.nFamily = static_cast<uint16_t>(cmdLine.GetNumber("family", 0));
+			facts.nModel = static_cast<uint16_t>(cmdLine.GetNumber("model", 0));
+			facts.nStepping = static_cast<uint8_t>(cmdLine.GetNumber("stepping", 0));
+
+			PrintClassification(facts);
+			return EXIT_SUCCESS;
+		}
+		if (cmdLine.Has("local"))
+			return RunLocalCPU();
+
+		const auto nCount = (std::max)(cmdLine.GetNumber("count", 100000), uint64_t(1));
+		const auto nRepeatCount = (std::max)(cmdLine.GetNumber("repeat", 3), uint64_t(1));
+		const CProfileGenerator generator(cmdLine.GetNumber("seed", 1), cmdLine.GetNumber("skus", 0));
+
+		std::vector <SCPUFacts> vFacts;
+		vFacts.reserve(nCount);
+		for (uint64_t i = 0; i < nCount; ++i)
+			vFacts.emplace_back(generator.Generate(i).cpu);
+
+		// The automaton is built on first use, outside of the timed runs
+		const auto& matcher = GetCPUNameMatcher();
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+		size_t nBestUs = (std::numeric_limits<size_t>::max)();
+		std::array <uint64_t, 3> arSupportCounts{};
+		std::array <uint64_t, 4> arConfidenceCounts{};
+		for (uint64_t nRun = 0; nRun < nRepeatCount; ++nRun)
+		{
+			arSupportCounts = {};
+			arConfidenceCounts = {};
+			timer.reset();
+			for (const auto& facts : vFacts)
+			{
+				const auto classification = ClassifyProcessor(facts);
+				arSupportCounts[static_cast<size_t>(classification.nSupport)]++;
+				arConfidenceCounts[static_cast<size_t>(classification.nConfidence)]++;
+			}
+			nBestUs = (std::min)(nBestUs, timer.diff());
+		}
+
+		std::cout << fmt::format("Matcher: {0} models, {1} keys, {2} states", GetCPUModelCount(), matcher.GetKeyCount(), matcher.GetStateCount()) << std::endl;
+		std::cout << fmt::format("Classified {0} names: {1} supported, {2} unsupported, {3} unknown; confidence {4} high, {5} medium, {6} low",
+			nCount, arSupportCounts[1], arSupportCounts[2], arSupportCounts[0], arConfidenceCounts[3], arConfidenceCounts[2], arConfidenceCounts[1]) << std::endl;
+		std::cout << fmt::format("Best of {0} runs: {1:.3f} ms, {2:.2f} M names/s",
+			nRepeatCount, nBestUs / 1000.0, nCount / ((std::max)(nBestUs, size_t(1)) / 1e6) / 1e6) << std::endl;
+		return EXIT_SUCCESS;
+	}
+};
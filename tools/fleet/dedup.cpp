@@ -0,0 +1,114 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include "../../include/core/profile_catalog.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/result_export.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <iostream>
+
+namespace Win11SysCheck
+{
+	int RunDedupCommand(const CCommandLine& cmdLine)
+	{
+		const auto stInDir = cmdLine.Get("in");
+		const auto stCatalogFile = cmdLine.Get("catalog");
+		const auto stOutFile = cmdLine.Get("out");
+		const auto bVerify = cmdLine.Has("verify");
+
+		CProfileCatalog catalog;
+		std::vector <bool> vExpected; // Verdict of the full per machine evaluation
+		uint64_t nInputBytes = 0, nErrorCount = 0;
+		size_t nFullEvalNs = 0;
+
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+		if (!stInDir.empty())
+		{
+			std::error_code ec;
+			if (!std::filesystem::is_directory(stInDir, ec))
+			{
+				std::cerr << "Input directory: '" << stInDir << "' does not exist" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			const SLegacyLabels labels{};
+			for (std::filesystem::recursive_directory_iterator it(stInDir, std::filesystem::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec))
+			{
+				if (!IsResultFile(*it))
+					continue;
+
+				const auto stFileName = it->path().string();
+				CMappedFile file;
+				SProbeResult result;
+				if (!file.Open(stFileName) || !ParseExportedJson(file.GetData(), file.GetSize(), result, labels))
+				{
+					std::cerr << "File: '" << stFileName << "' could not be parsed" << std::endl;
+					nErrorCount++;
+					continue;
+				}
+				nInputBytes += file.GetSize();
+				catalog.Add(result, GetMachineId(stInDir, it->path(), result));
+
+				if (bVerify)
+				{
+					auto evalTimer = CSimpleTimer<std::chrono::nanoseconds>();
+					EvaluateReadiness(result);
+					vExpected.push_back(CanSystemUpgrade(result));
+					nFullEvalNs += evalTimer.diff();
+				}
+			}
+		}
+		else if (!stCatalogFile.empty())
+		{
+			if (!catalog.Load(stCatalogFile))
+			{
+				std::cerr << "Profile catalog: '" << stCatalogFile << "' could not be read" << std::endl;
+				return EXIT_FAILURE;
+			}
+			std::error_code ec;
+			nInputBytes = std::filesystem::file_size(stCatalogFile, ec);
+		}
+		else
+		{
+			std::cerr << "Input is not specified" << std::endl;
+			return EXIT_FAILURE;
+		}
+		const auto nLoadUs = timer.diff();
+
+		timer.reset();
+		catalog.EvaluateProfiles();
+		uint64_t nReadyCount = 0, nMismatchCount = 0;
+		for (size_t i = 0; i < catalog.GetMachineCount(); ++i)
+		{
+			const auto bReady = catalog.IsMachineReady(i);
+			if (bReady)
+				nReadyCount++;
+			if (i < vExpected.size() && vExpected[i] != bReady)
+				nMismatchCount++;
+		}
+		const auto nEvalUs = timer.diff();
+
+		uint64_t nOutputBytes = 0;
+		if (!stOutFile.empty())
+		{
+			if (!catalog.Save(stOutFile))
+			{
+				std::cerr << "Profile catalog: '" << stOutFile << "' could not be written" << std::endl;
+				return EXIT_FAILURE;
+			}
+			std::error_code ec;
+			nOutputBytes = std::filesystem::file_size(stOutFile, ec);
+		}
+
+		std::cout << fmt::format("{0} machines, {1} distinct profiles ({2:.1f} machines per profile), {3} upgrade ready",
+			catalog.GetMachineCount(), catalog.GetProfileCount(), catalog.GetMachineCount() / (std::max)(double(catalog.GetProfileCount()), 1.0), nReadyCount
+		) << std::endl;
+		std::cout << fmt::format("Loaded {0} bytes in {1:.3f} s, evaluated in {2:.3f} ms", nInputBytes, nLoadUs / 1e6, nEvalUs / 1e3) << std::endl;
+		if (nOutputBytes)
+			std::cout << fmt::format("Catalog: {0} bytes ({1:.1f}x smaller than the input)", nOutputBytes, nInputBytes / (std::max)(double(nOutputBytes), 1.0)) << std::endl;
+		if (bVerify)
+			std::cout << fmt::format("Per machine evaluation took {0:.3f} ms, {1} verdict mismatches", nFullEvalNs / 1e6, nMismatchCount) << std::endl;
+
+		return nErrorCount || nMismatchCount ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+};
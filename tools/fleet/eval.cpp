@@ -0,0 +1,112 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/fleet_eval.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <iostream>
+
+namespace Win11SysCheck
+{
+	// Re-runs the rules over the decoded columns of the first row group to measure the kernels alone
+	static void BenchmarkKernels(const CFleetStoreReader& reader, CFleetEvaluator& evaluator, uint64_t nRepeat)
+	{
+		if (!reader.GetRowGroupCount())
+			return;
+
+		const auto nRowCount = static_cast<size_t>(reader.GetRowGroupRowCount(0));
+		std::vector <std::vector <uint64_t>> vDecoded(static_cast<size_t>(EFleetColumn::COLUMN_MAX));
+		std::vector <const uint64_t*> vColumns(vDecoded.size(), nullptr);
+
+		size_t nPredicateCount = 0;
+		for (const auto& rule : evaluator.GetRules())
+		{
+			nPredicateCount += rule.vPredicates.size();
+			for (const auto& predicate : rule.vPredicates)
+			{
+				const auto nColumn = static_cast<size_t>(predicate.nColumn);
+				if (!vColumns[nColumn] && reader.ReadColumn(0, predicate.nColumn, vDecoded[nColumn]))
+					vColumns[nColumn] = vDecoded[nColumn].data();
+			}
+		}
+
+		std::vector <CSelectionBitmap> vRuleBitmaps;
+		CSelectionBitmap passBitmap;
+		uint64_t nChecksum = 0;
+
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+		for (uint64_t i = 0; i < nRepeat; ++i)
+		{
+			evaluator.EvaluateColumns(vColumns, nRowCount, vRuleBitmaps, passBitmap);
+			nChecksum += passBitmap.GetWords()[0];
+		}
+		const auto dSeconds = (std::max)(timer.diff(), size_t(1)) / 1000000.0;
+
+		std::cout << fmt::format("Kernels: {0} rows x {1} predicates x {2} runs in {3:.3f} s: {4:.1f} M predicate evaluations/s (checksum {5:x})",
+			nRowCount, nPredicateCount, nRepeat, dSeconds, nRowCount * nPredicateCount * nRepeat / dSeconds / 1000000.0, nChecksum
+		) << std::endl;
+	}
+
+	// The default policy must agree with the verdicts stored by the collector
+	static bool VerifyStoredVerdicts(const CFleetStoreReader& reader, const SFleetEvalResult& result)
+	{
+		uint64_t nStoredCount = 0;
+		std::vector <uint64_t> vValues;
+		for (size_t i = 0; i < reader.GetRowGroupCount(); ++i)
+		{
+			if (!reader.ReadColumn(i, EFleetColumn::COLUMN_UPGRADE_READY, vValues))
+				return false;
+			nStoredCount += std::count(vValues.begin(), vValues.end(), 1);
+		}
+
+		std::cout << fmt::format("Verify: {0} passed, {1} stored upgrade_ready", result.nPassCount, nStoredCount) << std::endl;
+		return nStoredCount == result.nPassCount;
+	}
+
+	int RunEvalCommand(const CCommandLine& cmdLine)
+	{
+		const auto stStoreFile = cmdLine.Get("store");
+		const auto nLevel = ParseSimdLevel(cmdLine.Get("simd", "auto").c_str());
+
+		CFleetStoreReader reader;
+		if (!reader.Open(stStoreFile))
+		{
+			std::cerr << "Fleet store: '" << stStoreFile << "' could not be opened" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::vector <SFleetRule> vRules;
+		if (!cmdLine.Has("rules"))
+			vRules = GetDefaultFleetPolicy();
+		else if (!ParseFleetRules(cmdLine.Get("rules"), vRules))
+		{
+			std::cerr << "Rules: '" << cmdLine.Get("rules") << "' could not be parsed" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		CFleetEvaluator evaluator(vRules, nLevel);
+
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+		SFleetEvalResult result;
+		if (!evaluator.EvaluateStore(reader, result))
+		{
+			std::cerr << "Fleet store: '" << stStoreFile << "' is missing a rule column or is corrupted" << std::endl;
+			return EXIT_FAILURE;
+		}
+		const auto dSeconds = (std::max)(timer.diff(), size_t(1)) / 1000000.0;
+
+		for (size_t i = 0; i < vRules.size(); ++i)
+			std::cout << fmt::format("{0}: {1} failed\t{2}", vRules[i].stName, result.vRuleFailCounts[i], FormatFleetRule(vRules[i])) << std::endl;
+		std::cout << fmt::format("Passed {0} of {1} machines in {2:.3f} s ({3}): {4:.1f} M predicate evaluations/s",
+			result.nPassCount, result.nRowCount, dSeconds, GetSimdLevelName(nLevel), result.nPredicateCount / dSeconds / 1000000.0
+		) << std::endl;
+
+		if (cmdLine.Has("verify") && (cmdLine.Has("rules") || !VerifyStoredVerdicts(reader, result)))
+		{
+			std::cerr << "Fleet store: '" << stStoreFile << "' verdicts do not match the default policy" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (cmdLine.Has("bench"))
+			BenchmarkKernels(reader, evaluator, cmdLine.GetNumber("bench", 100));
+		return EXIT_SUCCESS;
+	}
+};
@@ -0,0 +1,86 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/block_compression.hpp"
+#include "../../include/core/profile_generator.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/result_exporter.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <iostream>
+
+namespace Win11SysCheck
+{
+	// Exports generated machines through each back-end into <prefix>_<format>.<extension> and reports
+	// throughput of the content, with --compress also the stored size and the compression ratio
+	int RunExportCommand(const CCommandLine& cmdLine)
+	{
+		const auto nCount = cmdLine.GetNumber("count", 10000);
+		const auto stPrefix = cmdLine.Get("out", "export_bench");
+		const auto stFormat = cmdLine.Get("format", "all");
+		const auto bCompress = cmdLine.Has("compress");
+		const CProfileGenerator generator(cmdLine.GetNumber("seed", 1), cmdLine.GetNumber("skus", 0));
+
+		std::vector <EExportFormat> vFormats;
+		if (stFormat == "all")
+		{
+			for (auto i = 0; i < static_cast<int>(EExportFormat::EXPORT_FORMAT_MAX); ++i)
+				vFormats.emplace_back(static_cast<EExportFormat>(i));
+		}
+		else
+		{
+			const auto nFormat = FindExportFormat(stFormat);
+			if (nFormat == EExportFormat::EXPORT_FORMAT_MAX)
+			{
+				std::cerr << "Unknown format: " << stFormat << std::endl;
+				return EXIT_FAILURE;
+			}
+			vFormats.emplace_back(nFormat);
+		}
+
+		std::vector <SProbeResult> vResults;
+		vResults.reserve(nCount);
+		for (uint64_t i = 0; i < nCount; ++i)
+		{
+			auto result = generator.Generate(i);
+			EvaluateReadiness(result);
+			vResults.emplace_back(std::move(result));
+		}
+
+		std::cout << fmt::format("{0:<8} {1:>14} {2:>14} {3:>7} {4:>10} {5:>10} {6:>14}", "format", "bytes", "stored", "ratio", "ms", "MB/s", "machines/s") << std::endl;
+		for (const auto nFormat : vFormats)
+		{
+			auto stFile = fmt::format("{0}_{1}.{2}", stPrefix, GetExportFormatKey(nFormat), GetExportFileExtension(nFormat));
+			if (bCompress)
+				stFile += COMPRESSED_FILE_SUFFIX;
+
+			// Commit is timed as well, the sync is part of every export
+			auto timer = CSimpleTimer<std::chrono::microseconds>();
+			COutputFile file;
+			if (!file.Open(stFile))
+			{
+				std::cerr << "File: '" << stFile << "' could not be created" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			file.SetCompression(bCompress);
+			auto exporter = CreateResultExporter(nFormat, file);
+			auto bWritten = true;
+			for (size_t i = 0; i < vResults.size() && bWritten; ++i)
+				bWritten = exporter->Add(vResults[i], vResults[i].nMachineId);
+			bWritten = bWritten && exporter->Finish();
+
+			const auto nBytes = file.GetWrittenSize();
+			if (!bWritten || !file.Commit())
+			{
+				std::cerr << "File: '" << stFile << "' could not be written" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			const auto dSeconds = (std::max)(timer.diff(), size_t(1)) / 1000000.0;
+			const auto nStored = file.GetStoredSize();
+			std::cout << fmt::format("{0:<8} {1:>14} {2:>14} {3:>7.2f} {4:>10.2f} {5:>10.1f} {6:>14.0f}",
+				GetExportFormatKey(nFormat), nBytes, nStored, nBytes / static_cast<double>((std::max)(nStored, uint64_t(1))), dSeconds * 1000, nBytes / dSeconds / 1024 / 1024, vResults.size() / dSeconds
+			) << std::endl;
+		}
+		return EXIT_SUCCESS;
+	}
+};
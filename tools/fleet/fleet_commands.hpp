@@ -0,0 +1,42 @@
+#pragma once
+#include "../../include/core/command_line.hpp"
+#include "../../include/core/probe_result.hpp"
+#include <filesystem>
+
+namespace Win11SysCheck
+{
+	using TFleetCommand = int(*)(const CCommandLine& cmdLine);
+
+	struct SFleetCommand
+	{
+		const char* szName;
+		const char* szUsage;
+		TFleetCommand pfnRun;
+	};
+
+	// Legacy result file helpers shared by the commands reading exported directories
+	bool IsResultFile(const std::filesystem::directory_entry& entry);
+	// The id the scanner wrote into the export; for exports without one, a hash of the host directory
+	// below the input root, or of the file name for exports kept directly in the root
+	uint64_t GetMachineId(const std::filesystem::path& inRoot, const std::filesystem::path& file, const SProbeResult& result);
+
+	int RunGenerateCommand(const CCommandLine& cmdLine);
+	int RunBatchCommand(const CCommandLine& cmdLine);
+	int RunScanCommand(const CCommandLine& cmdLine);
+	int RunEvalCommand(const CCommandLine& cmdLine);
+	int RunIndexCommand(const CCommandLine& cmdLine);
+	int RunQueryCommand(const CCommandLine& cmdLine);
+	int RunTopKCommand(const CCommandLine& cmdLine);
+	int RunHistogramCommand(const CCommandLine& cmdLine);
+	int RunDedupCommand(const CCommandLine& cmdLine);
+	int RunKnownGoodCommand(const CCommandLine& cmdLine);
+	int RunWireCommand(const CCommandLine& cmdLine);
+	int RunSnapshotCommand(const CCommandLine& cmdLine);
+	int RunDriftCommand(const CCommandLine& cmdLine);
+	int RunWhatIfCommand(const CCommandLine& cmdLine);
+	int RunConvertCommand(const CCommandLine& cmdLine);
+	int RunExportCommand(const CCommandLine& cmdLine);
+	int RunImageCommand(const CCommandLine& cmdLine);
+	int RunCompressCommand(const CCommandLine& cmdLine);
+	int RunCPUCommand(const CCommandLine& cmdLine);
+};
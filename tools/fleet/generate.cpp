@@ -0,0 +1,191 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/blocker_sketch.hpp"
+#include "../../include/core/fleet_store.hpp"
+#include "../../include/core/profile_generator.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/result_export.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Win11SysCheck
+{
+	static constexpr uint64_t GENERATE_CHUNK_SIZE = 256;
+
+	enum class EGenerateFormat : uint8_t
+	{
+		GENERATE_FORMAT_NONE,
+		GENERATE_FORMAT_LEGACY, // result_<index>.json files in the output directory
+		GENERATE_FORMAT_JSON,	// Same files in the stable result schema
+		GENERATE_FORMAT_STORE	// Single fleet store file
+	};
+
+	int RunGenerateCommand(const CCommandLine& cmdLine)
+	{
+		const auto nCount = cmdLine.GetNumber("count", 1000);
+		const auto nStart = cmdLine.GetNumber("start", 0);
+		const auto nSeed = cmdLine.GetNumber("seed", 0x57494E3131ull);
+		const auto nSkuCount = cmdLine.GetNumber("skus", 0);
+		const auto stFormat = cmdLine.Get("format", "legacy");
+		const auto stOut = cmdLine.Get("out");
+		const auto stSketchFile = cmdLine.Get("sketch");
+		auto nThreadCount = static_cast<uint32_t>(cmdLine.GetNumber("threads", std::thread::hardware_concurrency()));
+		if (!nThreadCount)
+			nThreadCount = 1;
+
+		EGenerateFormat nFormat;
+		if (stFormat == "none")
+			nFormat = EGenerateFormat::GENERATE_FORMAT_NONE;
+		else if (stFormat == "legacy")
+			nFormat = EGenerateFormat::GENERATE_FORMAT_LEGACY;
+		else if (stFormat == "json")
+			nFormat = EGenerateFormat::GENERATE_FORMAT_JSON;
+		else if (stFormat == "store")
+			nFormat = EGenerateFormat::GENERATE_FORMAT_STORE;
+		else
+		{
+			std::cerr << "Unknown format: " << stFormat << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (nFormat != EGenerateFormat::GENERATE_FORMAT_NONE && stOut.empty())
+		{
+			std::cerr << "Output is not specified" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (nFormat == EGenerateFormat::GENERATE_FORMAT_LEGACY || nFormat == EGenerateFormat::GENERATE_FORMAT_JSON)
+		{
+			std::error_code ec;
+			if (!std::filesystem::create_directories(stOut, ec) && ec)
+			{
+				std::cerr << "Output directory: '" << stOut << "' could not be created" << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+		CFleetStoreWriter store(static_cast<uint32_t>(cmdLine.GetNumber("row-group", FLEET_STORE_DEFAULT_ROW_GROUP_SIZE)));
+		if (nFormat == EGenerateFormat::GENERATE_FORMAT_STORE && !store.Open(stOut))
+		{
+			std::cerr << "Fleet store: '" << stOut << "' could not be created" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		const CProfileGenerator generator(nSeed, nSkuCount);
+		const SLegacyLabels labels{};
+
+		std::atomic <uint64_t> nNextChunk{ 0 };
+		std::atomic <uint64_t> nReadyCount{ 0 };
+		std::atomic <uint64_t> nByteCount{ 0 };
+		std::atomic <bool> bFailed{ false };
+
+		std::mutex mtxBlockers;
+		CBlockerAggregator blockers;
+
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+
+		auto Worker = [&] {
+			uint64_t nLocalReady = 0, nLocalBytes = 0;
+			std::vector <SFleetRecord> vRecords;
+			std::vector <std::string> vReasons;
+			CBlockerAggregator localBlockers;
+
+			while (!bFailed)
+			{
+				const auto nBegin = nNextChunk.fetch_add(GENERATE_CHUNK_SIZE);
+				if (nBegin >= nCount)
+					break;
+				const auto nEnd = (std::min)(nCount, nBegin + GENERATE_CHUNK_SIZE);
+
+				for (auto i = nBegin; i < nEnd; ++i)
+				{
+					const auto result = generator.Generate(nStart + i);
+					if (CanSystemUpgrade(result))
+						nLocalReady++;
+
+					if (!stSketchFile.empty())
+					{
+						vReasons.clear();
+						ExplainReadiness(result, vReasons);
+						localBlockers.Add(vReasons);
+					}
+
+					if (nFormat == EGenerateFormat::GENERATE_FORMAT_STORE)
+					{
+						vRecords.emplace_back(MakeFleetRecord(result, nStart + i));
+						if (vRecords.size() >= store.GetRowGroupSize())
+						{
+							if (!store.AppendRowGroup(vRecords))
+								bFailed = true;
+							vRecords.clear();
+						}
+					}
+					else if (nFormat == EGenerateFormat::GENERATE_FORMAT_LEGACY || nFormat == EGenerateFormat::GENERATE_FORMAT_JSON)
+					{
+						const auto stDocument = nFormat == EGenerateFormat::GENERATE_FORMAT_JSON ? SerializeResultJson(result) : SerializeLegacyJson(result, labels);
+						const auto stFile = fmt::format("{0}/result_{1:08}.json", stOut, nStart + i);
+
+						std::ofstream ofs(stFile, std::ios::out | std::ios::binary | std::ios::trunc);
+						if (!ofs.write(stDocument.data(), stDocument.size()))
+						{
+							std::cerr << "File: '" << stFile << "' could not be written" << std::endl;
+							bFailed = true;
+							break;
+						}
+						nLocalBytes += stDocument.size();
+					}
+				}
+			}
+
+			if (!store.AppendRowGroup(vRecords))
+				bFailed = true;
+
+			nReadyCount += nLocalReady;
+			nByteCount += nLocalBytes;
+
+			if (!stSketchFile.empty())
+			{
+				std::lock_guard <std::mutex> lock(mtxBlockers);
+				blockers.Merge(localBlockers);
+			}
+		};
+
+		std::vector <std::thread> vThreads;
+		for (uint32_t i = 0; i < nThreadCount; ++i)
+			vThreads.emplace_back(Worker);
+		for (auto& thread : vThreads)
+			thread.join();
+
+		if (nFormat == EGenerateFormat::GENERATE_FORMAT_STORE)
+		{
+			if (!store.Close())
+				bFailed = true;
+
+			std::error_code ec;
+			nByteCount = std::filesystem::file_size(stOut, ec);
+		}
+
+		if (!stSketchFile.empty() && !blockers.Save(stSketchFile))
+		{
+			std::cerr << "Blocker sketch: '" << stSketchFile << "' could not be written" << std::endl;
+			bFailed = true;
+		}
+
+		if (bFailed)
+		{
+			std::cerr << "Profile generation failed" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		const auto dSeconds = (std::max)(timer.diff(), size_t(1)) / 1000000.0;
+		std::cout << fmt::format("Generated {0} profiles ({1} upgrade ready) in {2:.3f} s with {3} threads: {4:.0f} profiles/s, {5:.1f} MB/s",
+			nCount, nReadyCount.load(), dSeconds, nThreadCount, nCount / dSeconds, nByteCount.load() / dSeconds / 1024 / 1024
+		) << std::endl;
+		return EXIT_SUCCESS;
+	}
+};
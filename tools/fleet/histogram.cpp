@@ -0,0 +1,69 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/hdr_histogram.hpp"
+#include <fmt/format.h>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace Win11SysCheck
+{
+	// Merges the fact histograms written by batch runs and prints their percentiles as CSV
+	int RunHistogramCommand(const CCommandLine& cmdLine)
+	{
+		const auto stInFiles = cmdLine.Get("in");
+		const auto stPercentiles = cmdLine.Get("percentiles", "50,90,99,99.9");
+
+		if (stInFiles.empty())
+		{
+			std::cerr << "Histogram file is not specified" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::vector <double> vPercentiles;
+		std::istringstream issPercentiles(stPercentiles);
+		std::string stPercentile;
+		while (std::getline(issPercentiles, stPercentile, ','))
+			vPercentiles.emplace_back(std::strtod(stPercentile.c_str(), nullptr));
+
+		CFactHistograms total;
+		auto bFirst = true;
+
+		std::istringstream issFiles(stInFiles);
+		std::string stFileName;
+		while (std::getline(issFiles, stFileName, ','))
+		{
+			CFactHistograms shard;
+			if (!shard.Load(stFileName))
+			{
+				std::cerr << "Histograms: '" << stFileName << "' could not be read" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			if (bFirst)
+				total = std::move(shard);
+			else if (!total.Merge(shard))
+			{
+				std::cerr << "Histograms: '" << stFileName << "' has a different range or precision" << std::endl;
+				return EXIT_FAILURE;
+			}
+			bFirst = false;
+		}
+
+		std::cout << "fact,count,min,mean";
+		for (const auto dPercentile : vPercentiles)
+			std::cout << fmt::format(",p{0}", dPercentile);
+		std::cout << ",max" << std::endl;
+
+		for (size_t i = 0; i < static_cast<size_t>(EFactHistogram::FACT_HISTOGRAM_MAX); ++i)
+		{
+			const auto nFact = static_cast<EFactHistogram>(i);
+			const auto& histogram = total.Get(nFact);
+
+			std::cout << fmt::format("{0},{1},{2},{3:.2f}", GetFactHistogramName(nFact), histogram.GetTotalCount(), histogram.GetMin(), histogram.GetMean());
+			for (const auto dPercentile : vPercentiles)
+				std::cout << "," << histogram.GetValueAtPercentile(dPercentile);
+			std::cout << "," << histogram.GetMax() << std::endl;
+		}
+		return EXIT_SUCCESS;
+	}
+};
@@ -0,0 +1,92 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/result_export.hpp"
+#include "../../include/core/result_image.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <iostream>
+
+namespace Win11SysCheck
+{
+	// Prints one machine of a result image as a result schema document, or reports how fast the
+	// image opens, how fast its facts are scanned in place and how fast machines are materialized
+	int RunImageCommand(const CCommandLine& cmdLine)
+	{
+		const auto stIn = cmdLine.Get("in");
+		const auto nRepeatCount = (std::max)(cmdLine.GetNumber("repeat", 3), uint64_t(1));
+
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+		CResultImageReader image;
+		if (!image.Open(stIn))
+		{
+			std::cerr << "Result image: '" << stIn << "' could not be opened" << std::endl;
+			return EXIT_FAILURE;
+		}
+		const auto nOpenUs = timer.diff();
+
+		if (cmdLine.Has("id"))
+		{
+			const auto pMachine = image.FindMachine(cmdLine.GetNumber("id", 0));
+			if (!pMachine)
+			{
+				std::cerr << "Machine: " << cmdLine.Get("id") << " is not in the image" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			SProbeResult result;
+			image.ReadResult(*pMachine, result);
+
+			COutputFile output;
+			if (!output.OpenStandardOutput())
+				return EXIT_FAILURE;
+			WriteResultJson(result, output);
+			output.Put('\n');
+			return output.Commit() ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		// Touches every fixed width fact and string of each machine without copying
+		size_t nScanUs = (std::numeric_limits<size_t>::max)();
+		uint64_t nReadyCount = 0, nStringBytes = 0, nTotalMemory = 0;
+		for (uint64_t nRun = 0; nRun < nRepeatCount; ++nRun)
+		{
+			timer.reset();
+			nReadyCount = nStringBytes = nTotalMemory = 0;
+			for (size_t i = 0; i < image.GetMachineCount(); ++i)
+			{
+				const auto& machine = image.GetMachine(i);
+				nTotalMemory += machine.nTotalPhysical;
+				nStringBytes += image.GetString(machine.stCPUName).size();
+
+				const auto volumes = image.GetVolumes(machine);
+				for (uint32_t j = 0; j < volumes.size(); ++j)
+					nStringBytes += image.GetString(volumes[j].stPath).size();
+
+				auto bReady = true;
+				for (auto j = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); j < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++j)
+					bReady &= machine.arStatuses[j] == static_cast<uint8_t>(EStatus::STATUS_OK);
+				nReadyCount += bReady;
+			}
+			nScanUs = (std::min)(nScanUs, timer.diff());
+		}
+
+		size_t nReadUs = (std::numeric_limits<size_t>::max)();
+		SProbeResult result;
+		for (uint64_t nRun = 0; nRun < nRepeatCount; ++nRun)
+		{
+			timer.reset();
+			for (size_t i = 0; i < image.GetMachineCount(); ++i)
+				image.ReadResult(image.GetMachine(i), result);
+			nReadUs = (std::min)(nReadUs, timer.diff());
+		}
+
+		const auto nMachineCount = image.GetMachineCount();
+		std::cout << fmt::format("Image: {0} machines, {1} ready, {2} GB memory, {3} string bytes scanned, best of {4} runs",
+			nMachineCount, nReadyCount, nTotalMemory >> 30, nStringBytes, nRepeatCount
+		) << std::endl;
+		std::cout << fmt::format("{0:<12} {1:>10} {2:>14}", "access", "ms", "machines/s") << std::endl;
+		std::cout << fmt::format("{0:<12} {1:>10.3f} {2:>14}", "open", nOpenUs / 1000.0, "-") << std::endl;
+		for (const auto& [szName, nUs] : { std::pair{ "in place", nScanUs }, std::pair{ "materialize", nReadUs } })
+			std::cout << fmt::format("{0:<12} {1:>10.3f} {2:>14.0f}", szName, nUs / 1000.0, nMachineCount / ((std::max)(nUs, size_t(1)) / 1000000.0)) << std::endl;
+		return EXIT_SUCCESS;
+	}
+};
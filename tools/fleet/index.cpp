@@ -0,0 +1,138 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/fleet_index.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <iostream>
+#include <sstream>
+
+namespace Win11SysCheck
+{
+	int RunIndexCommand(const CCommandLine& cmdLine)
+	{
+		const auto stStoreFile = cmdLine.Get("store");
+		const auto stOutFile = cmdLine.Get("out");
+
+		CFleetStoreReader reader;
+		if (!reader.Open(stStoreFile))
+		{
+			std::cerr << "Fleet store: '" << stStoreFile << "' could not be opened" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		auto vColumns = CFleetIndex::GetDefaultColumns();
+		if (cmdLine.Has("columns"))
+		{
+			vColumns.clear();
+
+			std::istringstream iss(cmdLine.Get("columns"));
+			std::string stName;
+			while (std::getline(iss, stName, ','))
+			{
+				const auto nColumn = FindFleetColumn(stName);
+				if (nColumn == EFleetColumn::COLUMN_MAX)
+				{
+					std::cerr << "Unknown column: " << stName << std::endl;
+					return EXIT_FAILURE;
+				}
+				vColumns.emplace_back(nColumn);
+			}
+		}
+
+		auto timer = CSimpleTimer<std::chrono::milliseconds>();
+
+		CFleetIndex index;
+		if (!index.Build(reader, vColumns))
+		{
+			std::cerr << "Fleet store: '" << stStoreFile << "' could not be indexed" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (!index.Save(stOutFile))
+		{
+			std::cerr << "Index: '" << stOutFile << "' could not be written" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::cout << fmt::format("Indexed {0} columns over {1} machines in {2} ms", vColumns.size(), index.GetRowCount(), timer.diff()) << std::endl;
+		return EXIT_SUCCESS;
+	}
+
+	int RunQueryCommand(const CCommandLine& cmdLine)
+	{
+		const auto stIndexFile = cmdLine.Get("index");
+		const auto stWhere = cmdLine.Get("where");
+		const auto nRepeat = (std::max)(cmdLine.GetNumber("repeat", 1), uint64_t(1));
+
+		CFleetIndex index;
+		if (!index.Load(stIndexFile))
+		{
+			std::cerr << "Index: '" << stIndexFile << "' could not be loaded" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		// Value distribution of one column
+		if (cmdLine.Has("values"))
+		{
+			const auto nColumn = FindFleetColumn(cmdLine.Get("values"));
+			const auto pValues = nColumn == EFleetColumn::COLUMN_MAX ? nullptr : index.GetValues(nColumn);
+			if (!pValues)
+			{
+				std::cerr << "Column: '" << cmdLine.Get("values") << "' is not indexed" << std::endl;
+				return EXIT_FAILURE;
+			}
+			for (const auto& [stValue, bitmap] : *pValues)
+				std::cout << fmt::format("{0}\t{1}", bitmap.Cardinality(), stValue) << std::endl;
+			return EXIT_SUCCESS;
+		}
+
+		CRoaringBitmap result;
+		std::string stError;
+
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+		for (uint64_t i = 0; i < nRepeat; ++i)
+		{
+			if (!index.Query(stWhere, result, stError))
+			{
+				std::cerr << "Query: " << stError << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		const auto dMilliseconds = timer.diff() / 1000.0 / nRepeat;
+
+		std::cout << fmt::format("{0} of {1} machines match, {2:.3f} ms per query", result.Cardinality(), index.GetRowCount(), dMilliseconds) << std::endl;
+
+		// Machine ids of the first matches, read from the store the index was built from
+		const auto stStoreFile = cmdLine.Get("store");
+		if (!stStoreFile.empty())
+		{
+			CFleetStoreReader reader;
+			if (!reader.Open(stStoreFile) || reader.GetRowCount() != index.GetRowCount())
+			{
+				std::cerr << "Fleet store: '" << stStoreFile << "' does not match the index" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			std::vector <uint32_t> vRows;
+			const auto nLimit = cmdLine.GetNumber("limit", 20);
+			result.ForEach([&](uint32_t nRow) {
+				vRows.emplace_back(nRow);
+				return vRows.size() < nLimit;
+			});
+
+			size_t nGroup = 0;
+			uint64_t nGroupBegin = 0;
+			std::vector <uint64_t> vMachineIds;
+			for (const auto nRow : vRows)
+			{
+				while (nRow >= nGroupBegin + reader.GetRowGroupRowCount(nGroup))
+				{
+					nGroupBegin += reader.GetRowGroupRowCount(nGroup++);
+					vMachineIds.clear();
+				}
+				if (vMachineIds.empty() && !reader.ReadColumn(nGroup, EFleetColumn::COLUMN_MACHINE_ID, vMachineIds))
+					return EXIT_FAILURE;
+				std::cout << vMachineIds[nRow - nGroupBegin] << std::endl;
+			}
+		}
+		return EXIT_SUCCESS;
+	}
+};
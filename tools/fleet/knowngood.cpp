@@ -0,0 +1,84 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/bloom_filter.hpp"
+#include "../../include/core/profile_catalog.hpp"
+#include <fmt/format.h>
+#include <ctime>
+#include <iostream>
+#include <map>
+
+namespace Win11SysCheck
+{
+	// Builds the filter agents use to skip DxDiag. Members are fingerprints of the cheap probes whose
+	// every known machine passes all hardware sections, whatever adapter the DxDiag probe would find.
+	int RunKnownGoodCommand(const CCommandLine& cmdLine)
+	{
+		const auto stCatalogFile = cmdLine.Get("catalog");
+		const auto stOutFile = cmdLine.Get("out");
+
+		CProfileCatalog catalog;
+		if (stCatalogFile.empty() || !catalog.Load(stCatalogFile))
+		{
+			std::cerr << "Profile catalog: '" << stCatalogFile << "' could not be read" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (stOutFile.empty())
+		{
+			std::cerr << "Output is not specified" << std::endl;
+			return EXIT_FAILURE;
+		}
+		catalog.EvaluateProfiles();
+
+		std::map <SHardwareFingerprint, bool> mapGroups;
+		for (size_t i = 0; i < catalog.GetProfileCount(); ++i)
+		{
+			const auto& profile = catalog.GetProfile(i);
+
+			auto bReady = true;
+			for (size_t j = static_cast<uint8_t>(EMenuType::MENU_TYPE_OS); j < static_cast<uint8_t>(EMenuType::MENU_TYPE_MAX); ++j)
+			{
+				if (j != static_cast<size_t>(EMenuType::MENU_TYPE_INTERNET) && profile.arStatuses[j] != EStatus::STATUS_OK)
+					bReady = false;
+			}
+
+			const auto it = mapGroups.emplace(ComputeHardwareFingerprint(profile, false), bReady).first;
+			it->second = it->second && bReady;
+		}
+
+		uint64_t nGoodCount = 0;
+		for (const auto& [fingerprint, bReady] : mapGroups)
+			nGoodCount += bReady;
+
+		auto filter = cmdLine.Has("bits") ?
+			CBloomFilter::ForBitCount(cmdLine.GetNumber("bits"), nGoodCount) :
+			CBloomFilter::ForFalsePositiveRate(nGoodCount, cmdLine.GetDouble("fpr", 0.001));
+		filter.SetVersion(cmdLine.GetNumber("version", static_cast<uint64_t>(std::time(nullptr))));
+
+		for (const auto& [fingerprint, bReady] : mapGroups)
+		{
+			if (bReady)
+				filter.Insert(fingerprint);
+		}
+
+		// Every rejected group is a real negative, count how many the filter lets through
+		uint64_t nFalsePositiveCount = 0;
+		for (const auto& [fingerprint, bReady] : mapGroups)
+		{
+			if (!bReady && filter.MayContain(fingerprint))
+				nFalsePositiveCount++;
+		}
+
+		if (!filter.Save(stOutFile))
+		{
+			std::cerr << "Known good filter: '" << stOutFile << "' could not be written" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		const auto nRejectedCount = mapGroups.size() - nGoodCount;
+		std::cout << fmt::format("{0} profiles, {1} pre-DxDiag fingerprints, {2} known good", catalog.GetProfileCount(), mapGroups.size(), nGoodCount) << std::endl;
+		std::cout << fmt::format("Filter version {0}: {1} bits ({2} bytes), {3} hashes, estimated false positive rate {4:.6f}",
+			filter.GetVersion(), filter.GetBitCount(), (filter.GetBitCount() + 7) / 8, filter.GetHashCount(), filter.GetEstimatedFalsePositiveRate()
+		) << std::endl;
+		std::cout << fmt::format("Measured false positives: {0} of {1} rejected fingerprints", nFalsePositiveCount, nRejectedCount) << std::endl;
+		return EXIT_SUCCESS;
+	}
+};
@@ -0,0 +1,53 @@
+#include "fleet_commands.hpp"
+#include <cstring>
+#include <iostream>
+
+using namespace Win11SysCheck;
+
+static const SFleetCommand gs_arCommands[] = {
+	{ "generate", "generate --out=DIR|FILE [--count=N] [--start=N] [--seed=N] [--skus=N] [--format=legacy|json|store|none] [--row-group=N] [--sketch=FILE] [--threads=N]", &RunGenerateCommand },
+	{ "batch", "batch --in=DIR|IMAGE [--out=FILE] [--details] [--store=FILE] [--row-group=N] [--topk=N] [--sketch=FILE] [--histograms=FILE] [--precision=DIGITS] [--threads=N]", &RunBatchCommand },
+	{ "scan", "scan --store=FILE [--columns=NAME,...] [--limit=N] [--stats]", &RunScanCommand },
+	{ "eval", "eval --store=FILE [--rules=NAME:COLUMN>=VALUE,...;...] [--simd=scalar|sse4.2|avx2] [--bench[=RUNS]] [--verify]", &RunEvalCommand },
+	{ "index", "index --store=FILE --out=FILE [--columns=NAME,...]", &RunIndexCommand },
+	{ "query", "query --index=FILE (--where=EXPRESSION [--store=FILE] [--limit=N] [--repeat=N] | --values=COLUMN)", &RunQueryCommand },
+	{ "topk", "topk --sketch=FILE[,FILE...] [--k=N] [--reason=REASON]", &RunTopKCommand },
+	{ "histogram", "histogram --in=FILE[,FILE...] [--percentiles=P,...]", &RunHistogramCommand },
+	{ "dedup", "dedup (--in=DIR | --catalog=FILE) [--out=FILE] [--verify]", &RunDedupCommand },
+	{ "knowngood", "knowngood --catalog=FILE --out=FILE [--fpr=RATE | --bits=N] [--version=N]", &RunKnownGoodCommand },
+	{ "wire", "wire [--count=N] [--seed=N] [--skus=N] [--batch=N] [--sections=NAME,...]", &RunWireCommand },
+	{ "snapshot", "snapshot (--in=DIR | --count=N [--seed=N] [--skus=N] [--scan=N] [--change-rate=RATE]) --out=FILE [--volatile] [--compress]", &RunSnapshotCommand },
+	{ "drift", "drift --history=FILE,FILE[,FILE...] [--facts] [--top=N]", &RunDriftCommand },
+	{ "whatif", "whatif --store=FILE [--set=COLUMN=VALUE,COLUMN+=VALUE[ if CONDITION,...];...] [--policy=RULES] [--simd=scalar|sse4.2|avx2] [--threads=N]", &RunWhatIfCommand },
+	{ "convert", "convert --in=FILE|DIR [--out=FILE|-] [--split --out=DIR] [--format=json|legacy|csv|ndjson|binary|image] [--base=FILE] [--compress]", &RunConvertCommand },
+	{ "export", "export [--count=N] [--seed=N] [--skus=N] [--format=json|legacy|csv|ndjson|binary|image|all] [--out=PREFIX] [--compress]", &RunExportCommand },
+	{ "image", "image --in=FILE [--id=N] [--repeat=N]", &RunImageCommand },
+	{ "compress", "compress --in=FILE[,FILE...] [--out=FILE [--decompress]] [--block=BYTES] [--repeat=N]", &RunCompressCommand },
+	{ "cpu", "cpu (--name=TEXT [--vendor=ID] [--family=N --model=N --stepping=N] | --local | [--count=N] [--seed=N] [--skus=N] [--repeat=N])", &RunCPUCommand }
+};
+
+static void PrintUsage()
+{
+	std::cerr << "Usage: Win11SysCheckFleet <command> [options]" << std::endl;
+	for (const auto& command : gs_arCommands)
+		std::cerr << "\t" << command.szUsage << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	for (const auto& command : gs_arCommands)
+	{
+		if (!std::strcmp(argv[1], command.szName))
+			return command.pfnRun(CCommandLine(argc, argv, 2));
+	}
+
+	std::cerr << "Unknown command: " << argv[1] << std::endl;
+	PrintUsage();
+	return EXIT_FAILURE;
+}
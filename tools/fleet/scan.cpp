@@ -0,0 +1,103 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/fleet_store.hpp"
+#include "../../include/core/result_exporter.hpp"
+#include <fmt/format.h>
+#include <iostream>
+#include <sstream>
+
+namespace Win11SysCheck
+{
+	static bool ParseProjection(const std::string& stColumns, std::vector <EFleetColumn>& vProjection)
+	{
+		if (stColumns.empty())
+		{
+			for (size_t i = 0; i < static_cast<size_t>(EFleetColumn::COLUMN_MAX); ++i)
+				vProjection.emplace_back(static_cast<EFleetColumn>(i));
+			return true;
+		}
+
+		std::istringstream iss(stColumns);
+		std::string stName;
+		while (std::getline(iss, stName, ','))
+		{
+			const auto nColumn = FindFleetColumn(stName);
+			if (nColumn == EFleetColumn::COLUMN_MAX)
+			{
+				std::cerr << "Unknown column: " << stName << std::endl;
+				return false;
+			}
+			vProjection.emplace_back(nColumn);
+		}
+		return true;
+	}
+
+	int RunScanCommand(const CCommandLine& cmdLine)
+	{
+		const auto stStoreFile = cmdLine.Get("store");
+		const auto nLimit = cmdLine.GetNumber("limit", UINT64_MAX);
+
+		CFleetStoreReader reader;
+		if (!reader.Open(stStoreFile))
+		{
+			std::cerr << "Fleet store: '" << stStoreFile << "' could not be opened" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::vector <EFleetColumn> vProjection;
+		if (!ParseProjection(cmdLine.Get("columns"), vProjection))
+			return EXIT_FAILURE;
+
+		// Row group directory with the min/max statistics of the projected columns
+		if (cmdLine.Has("stats"))
+		{
+			std::cout << fmt::format("rows: {0} row groups: {1}{2}", reader.GetRowCount(), reader.GetRowGroupCount(), reader.IsRecovered() ? " (recovered, no footer)" : "") << std::endl;
+			for (size_t i = 0; i < reader.GetRowGroupCount(); ++i)
+			{
+				std::cout << fmt::format("group {0}: {1} rows", i, reader.GetRowGroupRowCount(i)) << std::endl;
+				for (const auto nColumn : vProjection)
+				{
+					const auto stats = reader.GetColumnStats(i, nColumn);
+					std::cout << fmt::format("\t{0}: min {1} max {2}", GetFleetColumnInfo(nColumn).szName, stats.nMin, stats.nMax) << std::endl;
+				}
+			}
+			return EXIT_SUCCESS;
+		}
+
+		std::string stLine;
+		for (size_t i = 0; i < vProjection.size(); ++i)
+			stLine += fmt::format("{0}{1}", i ? "," : "", GetFleetColumnInfo(vProjection[i]).szName);
+		std::cout << stLine << '\n';
+
+		uint64_t nPrinted = 0;
+		std::vector <SFleetRecord> vRecords;
+		for (size_t i = 0; i < reader.GetRowGroupCount() && nPrinted < nLimit; ++i)
+		{
+			if (!reader.ReadRecords(i, vProjection, vRecords))
+			{
+				std::cerr << "Row group: " << i << " is corrupted" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			for (const auto& record : vRecords)
+			{
+				if (nPrinted++ >= nLimit)
+					break;
+
+				stLine.clear();
+				for (size_t j = 0; j < vProjection.size(); ++j)
+				{
+					const auto& column = GetFleetColumnInfo(vProjection[j]);
+					if (j)
+						stLine += ',';
+					if (column.nKind == EFleetColumnKind::COLUMN_KIND_NUMBER)
+						stLine += std::to_string(column.pfnGetNumber(record));
+					else
+						AppendCsvField(stLine, record.*column.pString);
+				}
+				std::cout << stLine << '\n';
+			}
+		}
+		std::cout.flush();
+		return EXIT_SUCCESS;
+	}
+};
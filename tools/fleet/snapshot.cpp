@@ -0,0 +1,211 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/mapped_file.hpp"
+#include "../../include/core/profile_generator.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/result_export.hpp"
+#include "../../include/core/snapshot_tree.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+namespace Win11SysCheck
+{
+	// Writes the Merkle snapshot of one scan of the fleet, from exported results or from the generator
+	int RunSnapshotCommand(const CCommandLine& cmdLine)
+	{
+		const auto stInDir = cmdLine.Get("in");
+		const auto stOutFile = cmdLine.Get("out");
+
+		if (stOutFile.empty())
+		{
+			std::cerr << "Output is not specified" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		CSnapshotFileWriter writer(cmdLine.Has("volatile"));
+		uint64_t nErrorCount = 0;
+
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+		if (!stInDir.empty())
+		{
+			std::error_code ec;
+			if (!std::filesystem::is_directory(stInDir, ec))
+			{
+				std::cerr << "Input directory: '" << stInDir << "' does not exist" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			const SLegacyLabels labels{};
+			for (std::filesystem::recursive_directory_iterator it(stInDir, std::filesystem::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec))
+			{
+				if (!IsResultFile(*it))
+					continue;
+
+				const auto stFileName = it->path().string();
+				CMappedFile file;
+				SProbeResult result;
+				if (!file.Open(stFileName) || !ParseExportedJson(file.GetData(), file.GetSize(), result, labels))
+				{
+					std::cerr << "File: '" << stFileName << "' could not be parsed" << std::endl;
+					nErrorCount++;
+					continue;
+				}
+				EvaluateReadiness(result);
+
+				// Two exports of one id would leave the snapshot guessing which machine it holds
+				const auto nMachineId = GetMachineId(stInDir, it->path(), result);
+				if (!writer.Add(nMachineId, result))
+				{
+					std::cerr << fmt::format("File: '{0}' has the machine id {1} of another export", stFileName, nMachineId) << std::endl;
+					return EXIT_FAILURE;
+				}
+			}
+		}
+		else if (cmdLine.Has("count"))
+		{
+			const CProfileGenerator generator(cmdLine.GetNumber("seed", 1), cmdLine.GetNumber("skus", 0));
+			const auto nCount = cmdLine.GetNumber("count");
+			const auto nScan = static_cast<uint32_t>(cmdLine.GetNumber("scan", 0));
+			const auto dChangeRate = cmdLine.GetDouble("change-rate", 0.01);
+
+			for (uint64_t i = 0; i < nCount; ++i)
+			{
+				const auto result = generator.GenerateRescan(i, nScan, dChangeRate);
+				writer.Add(result.nMachineId, result);
+			}
+		}
+		else
+		{
+			std::cerr << "Input is not specified" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (!writer.Save(stOutFile, cmdLine.Has("compress")))
+		{
+			std::cerr << "Snapshot: '" << stOutFile << "' could not be written" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::error_code ec;
+		const auto nFileSize = std::filesystem::file_size(stOutFile, ec);
+		std::cout << fmt::format("{0} machines ({1} unreadable) in {2:.3f} s, {3} bytes", writer.GetMachineCount(), nErrorCount, timer.diff() / 1e6, nFileSize) << std::endl;
+		return nErrorCount ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	// Compares consecutive snapshots of a history. Machines with equal roots are skipped straight from
+	// the index, only the others are decoded and walked down their differing subtrees.
+	int RunDriftCommand(const CCommandLine& cmdLine)
+	{
+		const auto stHistory = cmdLine.Get("history");
+		const auto bFacts = cmdLine.Has("facts");
+		const auto nTopCount = static_cast<size_t>(cmdLine.GetNumber("top", 10));
+
+		std::vector <std::string> vFileNames;
+		std::istringstream iss(stHistory);
+		std::string stFileName;
+		while (std::getline(iss, stFileName, ','))
+			vFileNames.emplace_back(stFileName);
+
+		if (vFileNames.size() < 2)
+		{
+			std::cerr << "At least two snapshots are needed" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		auto before = std::make_unique<CSnapshotFileReader>();
+		if (!before->Open(vFileNames[0]))
+		{
+			std::cerr << "Snapshot: '" << vFileNames[0] << "' could not be read" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		// Changed facts go to stdout as CSV, the summary moves out of their way
+		auto& osSummary = bFacts ? std::cerr : std::cout;
+		if (bFacts)
+			std::cout << "from,to,machine,path,before,after" << std::endl;
+
+		uint64_t nCorruptCount = 0;
+		for (size_t nPair = 1; nPair < vFileNames.size(); ++nPair)
+		{
+			auto after = std::make_unique<CSnapshotFileReader>();
+			if (!after->Open(vFileNames[nPair]))
+			{
+				std::cerr << "Snapshot: '" << vFileNames[nPair] << "' could not be read" << std::endl;
+				return EXIT_FAILURE;
+			}
+			if (after->IncludesVolatile() != before->IncludesVolatile())
+				std::cerr << "Snapshots: '" << vFileNames[nPair - 1] << "' and '" << vFileNames[nPair] << "' disagree on volatile facts, every machine differs" << std::endl;
+
+			auto timer = CSimpleTimer<std::chrono::microseconds>();
+			uint64_t nUnchangedCount = 0, nChangedCount = 0, nAddedCount = 0, nRemovedCount = 0, nFactCount = 0;
+			std::map <std::string, uint64_t> mapPaths;
+			std::vector <SFactChange> vChanges;
+			CSnapshotTree treeBefore, treeAfter;
+
+			// Both indexes are sorted by machine id
+			size_t i = 0, j = 0;
+			while (i < before->GetMachineCount() || j < after->GetMachineCount())
+			{
+				const auto nIdBefore = i < before->GetMachineCount() ? before->GetMachineId(i) : UINT64_MAX;
+				const auto nIdAfter = j < after->GetMachineCount() ? after->GetMachineId(j) : UINT64_MAX;
+				if (j == after->GetMachineCount() || (i < before->GetMachineCount() && nIdBefore < nIdAfter))
+				{
+					nRemovedCount++;
+					++i;
+					continue;
+				}
+				if (i == before->GetMachineCount() || nIdAfter < nIdBefore)
+				{
+					nAddedCount++;
+					++j;
+					continue;
+				}
+
+				if (before->GetRootHash(i) == after->GetRootHash(j))
+				{
+					nUnchangedCount++;
+				}
+				else if (!before->ReadTree(i, treeBefore) || !after->ReadTree(j, treeAfter))
+				{
+					nCorruptCount++;
+				}
+				else
+				{
+					nChangedCount++;
+					vChanges.clear();
+					nFactCount += DiffSnapshots(treeBefore, treeAfter, vChanges);
+					for (const auto& change : vChanges)
+					{
+						mapPaths[change.stPath]++;
+						if (bFacts)
+							std::cout << fmt::format("{0},{1},{2},\"{3}\",\"{4}\",\"{5}\"", nPair - 1, nPair, nIdAfter, change.stPath, change.stBefore, change.stAfter) << std::endl;
+					}
+				}
+				++i;
+				++j;
+			}
+			const auto nDiffUs = timer.diff();
+
+			osSummary << fmt::format("{0} -> {1}: {2} unchanged, {3} changed ({4} facts), {5} added, {6} removed in {7:.3f} ms",
+				vFileNames[nPair - 1], vFileNames[nPair], nUnchangedCount, nChangedCount, nFactCount, nAddedCount, nRemovedCount, nDiffUs / 1e3
+			) << std::endl;
+
+			std::vector <std::pair <std::string, uint64_t>> vPaths(mapPaths.begin(), mapPaths.end());
+			std::stable_sort(vPaths.begin(), vPaths.end(), [](const auto& a, const auto& b) {
+				return a.second > b.second;
+			});
+			for (size_t k = 0; k < (std::min)(nTopCount, vPaths.size()); ++k)
+				osSummary << fmt::format("\t{0:>8} {1}", vPaths[k].second, vPaths[k].first) << std::endl;
+
+			before = std::move(after);
+		}
+
+		if (nCorruptCount)
+			std::cerr << nCorruptCount << " machines had a corrupt tree" << std::endl;
+		return nCorruptCount ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+};
@@ -0,0 +1,86 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/blocker_sketch.hpp"
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <iostream>
+#include <sstream>
+
+namespace Win11SysCheck
+{
+	// Merges the blocker sketches written by independent shards and prints the fleet wide ranking
+	int RunTopKCommand(const CCommandLine& cmdLine)
+	{
+		const auto stSketchFiles = cmdLine.Get("sketch");
+		const auto nCount = static_cast<size_t>(cmdLine.GetNumber("k", 20));
+
+		if (stSketchFiles.empty())
+		{
+			std::cerr << "Blocker sketch is not specified" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		CBlockerAggregator total;
+		auto bFirst = true;
+
+		std::istringstream iss(stSketchFiles);
+		std::string stFileName;
+		while (std::getline(iss, stFileName, ','))
+		{
+			CBlockerAggregator shard;
+			if (!shard.Load(stFileName))
+			{
+				std::cerr << "Blocker sketch: '" << stFileName << "' could not be read" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			if (bFirst)
+				total = std::move(shard);
+			else if (!total.Merge(shard))
+			{
+				std::cerr << "Blocker sketch: '" << stFileName << "' has different dimensions" << std::endl;
+				return EXIT_FAILURE;
+			}
+			bFirst = false;
+		}
+
+		rapidjson::StringBuffer s;
+		rapidjson::PrettyWriter <rapidjson::StringBuffer> writer(s);
+
+		writer.StartObject();
+		writer.Key("machines");
+		writer.Uint64(total.GetMachineCount());
+		writer.Key("blocked");
+		writer.Uint64(total.GetBlockedCount());
+
+		writer.Key("top_blockers");
+		writer.StartArray();
+		for (const auto& blocker : total.GetTopBlockers(nCount))
+		{
+			writer.StartObject();
+			writer.Key("reason");
+			writer.String(blocker.stKey.c_str());
+			writer.Key("machines");
+			writer.Uint64(blocker.nCount);
+			writer.Key("error");
+			writer.Uint64(blocker.nError);
+			writer.EndObject();
+		}
+		writer.EndArray();
+
+		const auto stReason = cmdLine.Get("reason");
+		if (!stReason.empty())
+		{
+			writer.Key("estimate");
+			writer.StartObject();
+			writer.Key("reason");
+			writer.String(stReason.c_str());
+			writer.Key("machines");
+			writer.Uint64(total.EstimateBlocker(stReason));
+			writer.EndObject();
+		}
+		writer.EndObject();
+
+		std::cout << std::string(s.GetString(), s.GetSize()) << std::endl;
+		return EXIT_SUCCESS;
+	}
+};
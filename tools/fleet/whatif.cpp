@@ -0,0 +1,70 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/fleet_whatif.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <iostream>
+#include <thread>
+
+namespace Win11SysCheck
+{
+	// Applies fact transforms and policy changes to a stored fleet and prints what they change per section
+	int RunWhatIfCommand(const CCommandLine& cmdLine)
+	{
+		const auto stStoreFile = cmdLine.Get("store");
+		const auto nLevel = ParseSimdLevel(cmdLine.Get("simd", "auto").c_str());
+		const auto nThreadCount = static_cast<uint32_t>(cmdLine.GetNumber("threads", std::thread::hardware_concurrency()));
+
+		CFleetStoreReader reader;
+		if (!reader.Open(stStoreFile))
+		{
+			std::cerr << "Fleet store: '" << stStoreFile << "' could not be opened" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::vector <SFleetTransform> vTransforms;
+		if (cmdLine.Has("set") && !ParseFleetTransforms(cmdLine.Get("set"), vTransforms))
+		{
+			std::cerr << "Transforms: '" << cmdLine.Get("set") << "' could not be parsed" << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::vector <SFleetRule> vPolicy;
+		if (cmdLine.Has("policy") && !ParseFleetRules(cmdLine.Get("policy"), vPolicy))
+		{
+			std::cerr << "Policy: '" << cmdLine.Get("policy") << "' could not be parsed" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (vTransforms.empty() && vPolicy.empty())
+		{
+			std::cerr << "Scenario is not specified" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		const CFleetSimulator simulator(GetDefaultFleetPolicy(), vPolicy, std::move(vTransforms), nLevel);
+
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+		SWhatIfResult result;
+		if (!simulator.SimulateStore(reader, result, nThreadCount))
+		{
+			std::cerr << "Fleet store: '" << stStoreFile << "' is missing a rule or transform column or is corrupted" << std::endl;
+			return EXIT_FAILURE;
+		}
+		const auto dSeconds = (std::max)(timer.diff(), size_t(1)) / 1000000.0;
+
+		std::cout << fmt::format("{0:<10} {1:>12} {2:>12} {3:>12} {4:>12}", "section", "failed", "what-if", "fixed", "broken") << std::endl;
+		for (size_t i = 0; i < simulator.GetRuleNames().size(); ++i)
+		{
+			const auto& delta = result.vRules[i];
+			std::cout << fmt::format("{0:<10} {1:>12} {2:>12} {3:>12} {4:>12}{5}", simulator.GetRuleNames()[i],
+				delta.nBaselineFailCount, delta.nScenarioFailCount, delta.nFixedCount, delta.nBrokenCount, simulator.IsRecomputed(i) ? "" : "  (unchanged)"
+			) << std::endl;
+		}
+
+		std::cout << fmt::format("Passed {0} -> {1} of {2} machines: {3} gained, {4} lost, {5} transformed",
+			result.nBaselinePassCount, result.nScenarioPassCount, result.nRowCount, result.nGainedCount, result.nLostCount, result.nTransformedCount
+		) << std::endl;
+		std::cout << fmt::format("Recomputed {0} of {1} predicate evaluations, {2} row groups skipped, in {3:.3f} s",
+			result.nScenarioPredicateCount, result.nBaselinePredicateCount, result.nSkippedRowGroupCount, dSeconds
+		) << std::endl;
+		return EXIT_SUCCESS;
+	}
+};
@@ -0,0 +1,198 @@
+#include "fleet_commands.hpp"
+#include "../../include/core/binary_report.hpp"
+#include "../../include/core/legacy_export.hpp"
+#include "../../include/core/profile_generator.hpp"
+#include "../../include/core/readiness_rules.hpp"
+#include "../../include/core/report_frame.hpp"
+#include "../../include/simple_timer.hpp"
+#include <fmt/format.h>
+#include <cstring>
+#include <iostream>
+
+namespace Win11SysCheck
+{
+	// Compares the agent wire encodings on generated machines: payload size, encode and decode speed
+	int RunWireCommand(const CCommandLine& cmdLine)
+	{
+		const auto nCount = cmdLine.GetNumber("count", 10000);
+		const auto nBatchSize = (std::max)(cmdLine.GetNumber("batch", 64), uint64_t(1));
+		const CProfileGenerator generator(cmdLine.GetNumber("seed", 1), cmdLine.GetNumber("skus", 0));
+
+		uint16_t nSectionMask = BINARY_REPORT_ALL_SECTIONS;
+		if (cmdLine.Has("sections") && !ParseSectionMask(cmdLine.Get("sections"), nSectionMask))
+		{
+			std::cerr << "Unknown section in: " << cmdLine.Get("sections") << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::vector <SProbeResult> vResults;
+		vResults.reserve(nCount);
+		for (uint64_t i = 0; i < nCount; ++i)
+		{
+			auto result = generator.Generate(i);
+			EvaluateReadiness(result);
+			vResults.emplace_back(std::move(result));
+		}
+		if (vResults.empty())
+		{
+			std::cerr << "Nothing to encode" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		const SLegacyLabels labels{};
+		auto timer = CSimpleTimer<std::chrono::microseconds>();
+
+		// JSON, one frame per report as the collector accepts it today
+		std::string stJsonStream;
+		for (size_t i = 0; i < vResults.size(); ++i)
+			AppendJsonReportFrame(stJsonStream, i, SerializeLegacyJson(vResults[i], labels));
+		const auto nJsonEncodeUs = timer.diff();
+
+		timer.reset();
+		uint64_t nJsonDecoded = 0;
+		{
+			CReportFrameReader reader;
+			reader.Append(stJsonStream.data(), stJsonStream.size());
+			SReportFrame frame;
+			while (reader.Next(frame))
+			{
+				SProbeResult result;
+				nJsonDecoded += ParseLegacyJson(frame.pPayload + sizeof(uint64_t), frame.nPayloadSize - sizeof(uint64_t), result);
+			}
+		}
+		const auto nJsonDecodeUs = timer.diff();
+
+		// Round trip check: the legacy text must keep the CPU features and so the CPU verdict
+		uint64_t nMismatchCount = 0;
+		{
+			CReportFrameReader reader;
+			reader.Append(stJsonStream.data(), stJsonStream.size());
+			SReportFrame frame;
+			while (reader.Next(frame))
+			{
+				uint64_t nMachineId = 0;
+				std::memcpy(&nMachineId, frame.pPayload, sizeof(nMachineId));
+
+				SProbeResult result;
+				if (nMachineId >= vResults.size() || !ParseLegacyJson(frame.pPayload + sizeof(uint64_t), frame.nPayloadSize - sizeof(uint64_t), result))
+				{
+					nMismatchCount++;
+					continue;
+				}
+				EvaluateReadiness(result);
+
+				const auto& original = vResults[nMachineId];
+				nMismatchCount += result.cpu.nFeatures != original.cpu.nFeatures || result.GetStatus(EMenuType::MENU_TYPE_CPU) != original.GetStatus(EMenuType::MENU_TYPE_CPU);
+			}
+		}
+
+		// Binary, one report per frame
+		timer.reset();
+		std::string stSingleStream, stPayload;
+		for (size_t i = 0; i < vResults.size(); ++i)
+		{
+			stPayload.clear();
+			EncodeBinaryReport(vResults[i], i, stPayload, nSectionMask);
+			AppendReportFrame(stSingleStream, EFrameType::FRAME_REPORT_BATCH, stPayload.data(), static_cast<uint32_t>(stPayload.size()));
+		}
+		const auto nSingleEncodeUs = timer.diff();
+
+		// Binary, nBatchSize reports per frame sharing one string table
+		timer.reset();
+		std::string stBatchStream;
+		{
+			CBinaryReportWriter writer(nSectionMask);
+			for (size_t i = 0; i < vResults.size(); ++i)
+			{
+				writer.Add(vResults[i], i);
+				if (writer.GetReportCount() == nBatchSize || i + 1 == vResults.size())
+				{
+					stPayload.clear();
+					writer.Finish(stPayload);
+					AppendReportFrame(stBatchStream, EFrameType::FRAME_REPORT_BATCH, stPayload.data(), static_cast<uint32_t>(stPayload.size()));
+				}
+			}
+		}
+		const auto nBatchEncodeUs = timer.diff();
+
+		timer.reset();
+		uint64_t nBinaryDecoded = 0;
+		std::string stOriginal, stDecoded;
+		{
+			CReportFrameReader reader;
+			reader.Append(stBatchStream.data(), stBatchStream.size());
+			SReportFrame frame;
+			while (reader.Next(frame))
+			{
+				CBinaryReportReader batch;
+				if (!batch.Open(frame.pPayload, frame.nPayloadSize))
+					break;
+
+				SProbeResult result;
+				uint64_t nMachineId = 0;
+				while (batch.Next(result, nMachineId))
+				{
+					nBinaryDecoded++;
+					// Round trip check: the decoded result must encode to the same bytes
+					if (nMachineId >= vResults.size())
+					{
+						nMismatchCount++;
+						continue;
+					}
+					stOriginal.clear();
+					stDecoded.clear();
+					EncodeBinaryReport(vResults[nMachineId], nMachineId, stOriginal, nSectionMask);
+					EncodeBinaryReport(result, nMachineId, stDecoded, nSectionMask);
+					nMismatchCount += stOriginal != stDecoded;
+				}
+				if (batch.IsCorrupt())
+					break;
+			}
+		}
+		const auto nVerifyUs = timer.diff();
+
+		// Decode again without the check for the timing
+		const auto DecodeStream = [](const std::string& stStream) {
+			CReportFrameReader reader;
+			reader.Append(stStream.data(), stStream.size());
+			SReportFrame frame;
+			SProbeResult result;
+			uint64_t nMachineId = 0;
+			while (reader.Next(frame))
+			{
+				CBinaryReportReader batch;
+				if (batch.Open(frame.pPayload, frame.nPayloadSize))
+				{
+					while (batch.Next(result, nMachineId))
+						;
+				}
+			}
+		};
+
+		timer.reset();
+		DecodeStream(stSingleStream);
+		const auto nSingleDecodeUs = timer.diff();
+
+		timer.reset();
+		DecodeStream(stBatchStream);
+		const auto nBatchDecodeUs = timer.diff();
+
+		const auto Print = [&](const char* szName, size_t nBytes, size_t nEncodeUs, size_t nDecodeUs) {
+			std::cout << fmt::format("{0:<16} {1:>12} {2:>10.1f} {3:>8.2f}x {4:>14.0f} {5:>14.0f}",
+				szName, nBytes, static_cast<double>(nBytes) / vResults.size(), static_cast<double>(stJsonStream.size()) / nBytes,
+				nEncodeUs ? vResults.size() * 1e6 / nEncodeUs : 0.0, nDecodeUs ? vResults.size() * 1e6 / nDecodeUs : 0.0
+			) << std::endl;
+		};
+
+		std::cout << fmt::format("{0} reports, batches of {1}", vResults.size(), nBatchSize) << std::endl;
+		std::cout << fmt::format("{0:<16} {1:>12} {2:>10} {3:>9} {4:>14} {5:>14}", "encoding", "bytes", "per report", "vs json", "encode/s", "decode/s") << std::endl;
+		Print("json", stJsonStream.size(), nJsonEncodeUs, nJsonDecodeUs);
+		Print("binary", stSingleStream.size(), nSingleEncodeUs, nSingleDecodeUs);
+		Print("binary batched", stBatchStream.size(), nBatchEncodeUs, nBatchDecodeUs);
+		std::cout << fmt::format("Decoded {0} JSON and {1} binary reports, {2} round trip mismatches ({3} us verify)",
+			nJsonDecoded, nBinaryDecoded, nMismatchCount, nVerifyUs
+		) << std::endl;
+
+		return nMismatchCount || nBinaryDecoded != vResults.size() ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+};